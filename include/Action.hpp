@@ -28,6 +28,8 @@
 #include <iostream>
 #include <memory>
 #include <atomic>
+#include <chrono>
+#include <functional>
 
 #include "util/Utf8String.hpp"
 #include "util/threading/ThreadTask.hpp"
@@ -189,6 +191,89 @@ namespace awsiotsdk {
         virtual ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                            std::shared_ptr<ActionData> p_action_data) = 0;
 
+        /**
+         * @brief Perform the Action for a queued request whose Ack handler is already registered
+         *
+         * Called instead of PerformAction when the Client Core runs an Action from its outbound queues. The Client
+         * Core registers the Ack handler of the request before calling this and removes it if the Action fails, so
+         * Actions that register the handler in PerformAction must override this and skip the registration. The
+         * default implementation calls PerformAction.
+         *
+         * @param p_network_connection - Network connection to be used to perform the Action
+         * @param p_action_data - Action data to be used for this run of the action
+         * @return ResponseCode indicating result of the API call
+         */
+        virtual ResponseCode PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                 std::shared_ptr<ActionData> p_action_data) {
+            return PerformAction(p_network_connection, p_action_data);
+        }
+
+        /**
+         * @brief Check if the Action can be driven by readiness events of its network connection
+         *
+         * Action runners of such Actions can be run by a util::Threading::IoReactor instead of a dedicated Thread
+         * Task, see PerformReadyAction
+         *
+         * @return bool - false by default
+         */
+        virtual bool IsReadinessDriven() {
+            return false;
+        }
+
+        /**
+         * @brief Perform one run of the Action after its network connection became readable
+         *
+         * Called instead of PerformAction when the Action runner is driven by an IoReactor. Must handle the data
+         * that is available and return without waiting for more. The default implementation returns FAILURE.
+         *
+         * @param p_network_connection - Network connection to be used to perform the Action
+         * @param p_action_data - Action data to be used for this run of the action
+         * @return ResponseCode indicating result of the API call
+         */
+        virtual ResponseCode PerformReadyAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                std::shared_ptr<ActionData> p_action_data) {
+            return ResponseCode::FAILURE;
+        }
+
+        /**
+         * @brief Check if the Action can be driven by timers
+         *
+         * Action runners of such Actions can be run by a util::Threading::TimerService instead of a dedicated Thread
+         * Task, see PerformTimedAction
+         *
+         * @return bool - false by default
+         */
+        virtual bool IsTimerDriven() {
+            return false;
+        }
+
+        /**
+         * @brief Perform one run of the Action when its timer is due
+         *
+         * Called instead of PerformAction when the Action runner is driven by a TimerService. Must do the work that
+         * is due and return without waiting for more. The default implementation does not run again.
+         *
+         * @param p_network_connection - Network connection to be used to perform the Action
+         * @param p_action_data - Action data to be used for this run of the action
+         * @return std::chrono::steady_clock::time_point - Time of the next run, time_point::max() to only run again
+         * when woken up
+         */
+        virtual std::chrono::steady_clock::time_point PerformTimedAction(
+            std::shared_ptr<NetworkConnection> p_network_connection, std::shared_ptr<ActionData> p_action_data) {
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+        /**
+         * @brief Set the handler that wakes up a timer driven Action runner
+         *
+         * Called by Client Core before the first run of an Action runner driven by a TimerService. Calling the
+         * handler runs the Action again as soon as possible. Does nothing by default.
+         *
+         * @param p_wakeup_handler - Handler to call when the Action should run early
+         */
+        virtual void SetTimerWakeupHandler(std::function<void()> p_wakeup_handler) {
+        }
+
         // Rule of 5 stuff
         // Disabling default, move and copy constructors
         // Actions instances can be run as threads if needed and should not be copied or moved
@@ -230,5 +315,18 @@ namespace awsiotsdk {
          */
         ResponseCode WriteToNetworkBuffer(std::shared_ptr<NetworkConnection> p_network_connection,
                                           const util::String &write_buf);
+
+        /**
+         * @brief Generic Network Write function for actions that send several buffers
+         *
+         * Writes the segments in order using a single gathered write, so buffers such as a packet header and a
+         * shared payload do not have to be combined by the caller.
+         *
+         * @param p_network_connection - Network connection to be used to perform Write
+         * @param segments - Buffers to be written to the network instance
+         * @return ResponeCode indicating result of the API call
+         */
+        ResponseCode WriteToNetworkBuffer(std::shared_ptr<NetworkConnection> p_network_connection,
+                                          const util::Vector<NetworkWriteSegment> &segments);
     };
 }
@@ -27,9 +27,14 @@
 #pragma once
 
 #include "ClientCoreState.hpp"
+#include "util/threading/Executor.hpp"
+#include "util/threading/IoReactor.hpp"
 #include "util/threading/ThreadTask.hpp"
+#include "util/threading/TimerService.hpp"
 
 namespace awsiotsdk {
+    class ReactorActionRunner;
+    class TimerActionRunner;
 
     /**
      * @brief Client Core Class
@@ -45,6 +50,30 @@ namespace awsiotsdk {
         util::Map<ActionType, std::shared_ptr<util::Threading::ThreadTask>> thread_map_;  ///< Map for storing currently active threads
 
         std::shared_ptr<ClientCoreState>p_client_core_state_;                             ///< Client Core state instance
+        std::shared_ptr<util::Threading::IoReactor> p_io_reactor_;                         ///< Shared reactor running readiness driven Action runners, if set
+        util::Map<ActionType, std::shared_ptr<ReactorActionRunner>> reactor_source_map_;   ///< Action runners registered with the reactor
+        std::shared_ptr<util::Threading::TimerService> p_timer_service_;                   ///< Shared timer service running timer driven Action runners, if set
+        util::Map<ActionType, std::shared_ptr<TimerActionRunner>> timer_runner_map_;       ///< Action runners scheduled on the timer service
+
+        /**
+         * @brief Unregister all Action runners from the reactor, waiting for running handlers to return
+         */
+        void UnregisterReactorSources();
+
+        /**
+         * @brief Stop all Action runners scheduled on the timer service, waiting for running ones to return
+         */
+        void StopTimerActionRunners();
+
+        /**
+         * @brief Stop all Thread Tasks, waking up Action runners that wait for state changes, and join them
+         */
+        void StopThreadTasks();
+
+        /**
+         * @brief Start the Thread Task processing the outbound action queue
+         */
+        void StartOutboundThreadTask();
 
         /**
          * @brief Constructor
@@ -73,6 +102,44 @@ namespace awsiotsdk {
             p_client_core_state_->SetProcessQueuedActions(process_queued_actions);
         }
 
+        /**
+         * @brief Set a reactor to run readiness driven Action runners on
+         *
+         * Action runners created after this call for Actions that are readiness driven, see
+         * Action::IsReadinessDriven, are registered with the reactor instead of getting their own Thread Task if
+         * the network connection is pollable, see NetworkConnection::IsPollable. The reactor can be shared by many
+         * clients.
+         *
+         * @param p_io_reactor - Reactor to use, nullptr to create Thread Tasks for all Action runners
+         */
+        void SetIoReactor(std::shared_ptr<util::Threading::IoReactor> p_io_reactor) {
+            p_io_reactor_ = p_io_reactor;
+        }
+
+        /**
+         * @brief Set a timer service to run timer driven Action runners on
+         *
+         * Action runners created after this call for Actions that are timer driven, see Action::IsTimerDriven, are
+         * scheduled on the timer service instead of getting their own Thread Task. The timer service can be shared by
+         * many clients.
+         *
+         * @param p_timer_service - Timer service to use, nullptr to create Thread Tasks for all Action runners
+         */
+        void SetTimerService(std::shared_ptr<util::Threading::TimerService> p_timer_service) {
+            p_timer_service_ = p_timer_service;
+        }
+
+        /**
+         * @brief Set an executor to process queued actions on
+         *
+         * Replaces the Thread Task processing the outbound action queue with tasks that are submitted to the executor
+         * when actions are queued, see ClientCoreState::SetExecutor. The executor can be shared by many clients.
+         * Action runners still get their own Thread Task unless they are run by a reactor.
+         *
+         * @param p_executor - Executor to use, nullptr to process queued actions on a Thread Task again
+         */
+        void SetExecutor(std::shared_ptr<util::Threading::Executor> p_executor);
+
         /**
          * @brief Factory method for creating a Client Core instance
          *
@@ -103,8 +170,9 @@ namespace awsiotsdk {
          * @brief Perform Action in Blocking Mode
          *
          * This API will perform the Action in Blocking mode. The timeout for the action to give a valid response
-         * is provided as an argument. This API stops processing of all outbound actions until Response is received
-         * for the requested Action Type
+         * is provided as an argument. The calling thread blocks until a Response is received for this Action or the
+         * timeout expires. Outbound actions continue to be processed while waiting, and multiple threads can perform
+         * blocking actions concurrently
          *
          * @param action_type - Type of the Action to be executed. Must be registered
          * @param action_data - Action Data to be passed as argument to the Action instance
@@ -135,7 +203,9 @@ namespace awsiotsdk {
          *
          * This API will create a new instance of the Action Type that is request in the API call and call perform
          * action on that instance in a new Thread Task. If the Action is Thread Aware, it will be executed until
-         * it finishes or the Thread Task is terminated (Usually on exit).
+         * it finishes or the Thread Task is terminated (Usually on exit). If a reactor is set and the Action is
+         * readiness driven, the instance is registered with the reactor instead. Only one runner is created for each
+         * Action Type that is run by the reactor.
          *
          * @param action_type - Type of the Action to be executed. Must be registered
          * @param action_data - Action Data to be passed as argument to the Action instance
@@ -28,11 +28,14 @@
 
 #include "util/Utf8String.hpp"
 #include "util/memory/stl/Map.hpp"
-#include "util/memory/stl/Queue.hpp"
+#include "util/memory/stl/Vector.hpp"
+#include "util/threading/Executor.hpp"
+#include "util/threading/LockFreeQueue.hpp"
 
 #include "Action.hpp"
 #include "ResponseCode.hpp"
 #include "NetworkConnection.hpp"
+#include "PendingAckTable.hpp"
 
 /**
  * Default sleep duration between each execution of Client Core thread operations
@@ -44,8 +47,45 @@
  */
 #define DEFAULT_MAX_QUEUE_SIZE 16
 
+/**
+ * Capacity of the queue for control actions, such as PUBACK, that are sent ahead of queued application actions
+ */
+#define DEFAULT_CONTROL_ACTION_QUEUE_SIZE 256
+
+/**
+ * Default max number of bytes from queued actions that are combined into one network write.
+ * Matches the max TLS record payload size
+ */
+#define DEFAULT_MAX_WRITE_BATCH_SIZE_BYTES 16384
+
+/**
+ * Default max time to wait for more queued actions before a partially filled write batch is sent
+ */
+#define DEFAULT_MAX_WRITE_BATCH_DELAY_MS 0
+
+/**
+ * Max number of queued actions dispatched by one outbound task before it yields its executor thread to other tasks
+ */
+#define OUTBOUND_ACTION_TASK_MAX_ACTIONS 64
+
+/**
+ * Default time after which a pending Ack is deleted and its handler called with ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR
+ */
+#define DEFAULT_ACK_TIMEOUT_MS 20000
+
 namespace awsiotsdk {
 
+    /**
+     * @brief Outbound Action Queue Overflow Policy
+     *
+     * Defines the behavior of ClientCoreState::EnqueueOutboundAction when the outbound action queue is full
+     */
+    enum class ActionQueueOverflowPolicy {
+        REJECT = 0,                 ///< Fail the enqueue request with ResponseCode::ACTION_QUEUE_FULL
+        OVERWRITE_OLDEST = 1,       ///< Drop the oldest queued action, its Ack handler is called with ResponseCode::ACTION_QUEUE_FULL
+        BLOCK_WITH_TIMEOUT = 2      ///< Block the calling thread until space is available or the configured timeout expires
+    };
+
     /**
      * @brief MQTT Disconnect Callback Context Data
      *
@@ -93,48 +133,264 @@ namespace awsiotsdk {
     protected:
 
         /**
-         * @brief Pending Ack Data Class
+         * @brief Action Rate Limit Class
          *
-         * Defining an internal class for storing information about Pending Acks.
+         * Defining an internal class for storing the token bucket used to rate limit an Action Type.
+         * Tokens are refilled continuously at the configured rate up to the configured burst size.
+         * Each dispatched action consumes one token.
          *
          */
-        class PendingAckData {
+        class ActionRateLimitData {
         public:
-            std::chrono::system_clock::time_point time_of_request_;           ///< Time at which the request was sent
-            ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler_;  ///< Handler to which response must be sent
+            double tokens_per_second_;                                  ///< Rate at which tokens are refilled
+            double max_tokens_;                                         ///< Maximum number of tokens that can be accumulated
+            double available_tokens_;                                   ///< Currently available tokens
+            std::chrono::steady_clock::time_point last_refill_time_;    ///< Time at which tokens were last refilled
         };
 
         std::atomic<uint16_t> next_action_id_;                                                   ///< Atomic, ID of the next Action that will be enqueued
         std::atomic_int cur_core_threads_;                                                       ///< Atomic, Count of currently running core threads
         std::atomic_int max_hardware_threads_;                                                   ///< Atomic, Count of the maximum allowed hardware threads
         std::atomic_size_t max_queue_size_;                                                      ///< Atomic, Current configured max queue size
-        std::chrono::seconds ack_timeout_;                                                       ///< Timeout for pending Acks, older Acks are deleted with a failed response
+        std::atomic<ActionQueueOverflowPolicy> overflow_policy_;                                 ///< Atomic, Behavior of enqueue requests when the queue is full
+        std::atomic<std::chrono::milliseconds::rep> overflow_block_timeout_ms_;                  ///< Atomic, Max time an enqueue request blocks for with ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT
+        std::atomic<std::chrono::milliseconds::rep> ack_timeout_ms_;                             ///< Atomic, Timeout for pending Acks, older Acks are deleted with a failed response
+        std::atomic<std::chrono::steady_clock::rep> next_ack_expiry_;                            ///< Atomic, Time since epoch at which the next pending Ack expires
 
         std::mutex register_action_lock_;                                                        ///< Mutex for Register Action Request flow
         std::mutex ack_map_lock_;                                                                ///< Mutex for Ack Map operations
 
-        // Used to perform blocking sync actions
-        std::mutex sync_action_request_lock_;                                                    ///< Mutex for Sync Action Request flow
-        std::mutex sync_action_response_lock_;                                                   ///< Mutex for Sync Action Response flow
-        std::condition_variable sync_action_response_wait_;                                      ///< Condition variable used to wake up calling thread on Sync Action response
-        ResponseCode sync_action_response_;                                                      ///< Variable to store received Sync Action response
+        std::mutex perform_action_lock_;                                                         ///< Mutex held while an Action writes to the Network Connection, keeps sync Actions from interleaving with queued Actions
 
         std::atomic_bool process_queued_actions_;                                                ///< Atomic, indicates whether currently queued Actions should be processed or not
         std::shared_ptr<std::atomic_bool> continue_execution_;                                   ///< Atomic, Used to synchronize running threads, false value causes running threads to stop
 
         util::Map<ActionType, std::unique_ptr<Action>> action_map_;                              ///< Map containing currently initialized Action Instances
-        util::Map<uint16_t, std::unique_ptr<PendingAckData>> pending_ack_map_;                   ///< Map containing currently pending Acks
+        PendingAckTable pending_ack_table_;                                                      ///< Table containing currently pending Acks
         util::Map<ActionType, Action::CreateHandlerPtr> action_create_handler_map_;              ///< Map containing currently registered Action Types and corrosponding Factories
 
-        util::Queue<std::pair<ActionType, std::shared_ptr<ActionData>>> outbound_action_queue_;  ///< Queue of outbound actions
+        util::Map<ActionType, std::unique_ptr<ActionRateLimitData>> action_rate_limit_map_;      ///< Map containing configured rate limits per Action Type
+        std::mutex action_rate_limit_lock_;                                                      ///< Mutex for Rate Limit operations
+
+        /**
+         * @brief Batched Write Connection Class
+         *
+         * Network connection wrapper passed to Actions by the outbound processing thread. Writes are collected
+         * instead of being sent and are written to the wrapped connection in one gathered write by ::EndBatch.
+         * Segments that own their buffer, such as shared publish payloads, are kept by reference rather than copied.
+         * Other writes are copied into an output buffer that is reused by every batch, so collecting writes does
+         * not allocate once the buffer has grown to the batch size. Consecutive copied writes are sent as one range.
+         * All other operations are forwarded to the wrapped connection. Pending writes are sent before any read.
+         *
+         */
+        class BatchedWriteConnection : public NetworkConnection {
+        protected:
+            std::shared_ptr<NetworkConnection> p_network_connection_;  ///< Wrapped connection
+            util::Vector<NetworkWriteSegment> pending_writes_;          ///< Writes collected since the last flush
+            util::Vector<size_t> pending_write_offsets_;                ///< Offset of each collected write in output_buffer_, SIZE_MAX if it owns its bytes
+            util::String output_buffer_;                                ///< Copies of collected writes that do not own their bytes
+            size_t pending_write_bytes_;                                ///< Total length of the collected writes
+            ResponseCode flush_rc_;                                     ///< First flush error since the batch started
+
+            ResponseCode FlushPendingWrites();
+
+            /**
+             * @brief Copy a write into the output buffer
+             *
+             * @param p_data - Start of the bytes to copy
+             * @param length - Number of bytes to copy
+             */
+            void CopyToOutputBuffer(const char *p_data, size_t length);
+
+            ResponseCode ConnectInternal();
+            ResponseCode WriteInternal(const util::String &buf, size_t &size_written_bytes_out);
+            ResponseCode WriteGatheredInternal(const util::Vector<NetworkWriteSegment> &segments,
+                                               size_t &size_written_bytes_out);
+            ResponseCode ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                      size_t size_bytes_to_read, size_t &size_read_bytes_out);
+            ResponseCode DisconnectInternal();
+
+        public:
+            BatchedWriteConnection(std::shared_ptr<NetworkConnection> p_network_connection);
+
+            bool IsConnected() { return p_network_connection_->IsConnected(); }
+            bool IsPhysicalLayerConnected() { return p_network_connection_->IsPhysicalLayerConnected(); }
+
+            /**
+             * @brief Get total length of the writes collected so far
+             * @return size_t byte count
+             */
+            size_t GetPendingWriteBytes() { return pending_write_bytes_; }
+
+            /**
+             * @brief Send all collected writes and start a new batch
+             * @return ResponseCode indicating whether all writes in the batch were sent
+             */
+            ResponseCode EndBatch();
+        };
+
+        typedef std::pair<ActionType, std::shared_ptr<ActionData>> OutboundAction;
+        typedef util::Threading::LockFreeQueue<OutboundAction> OutboundActionQueue;
+
+        std::atomic<OutboundActionQueue *> p_outbound_action_queue_;                             ///< Atomic, Queue that new outbound actions are added to
+        util::Vector<std::unique_ptr<OutboundActionQueue>> outbound_action_queues_;              ///< Owns all queues, closed queues replaced by a resize come before the current one
+        std::atomic_bool has_retired_outbound_action_queues_;                                    ///< Atomic, True if closed queues may still contain actions
+        OutboundActionQueue control_action_queue_;                                               ///< Control actions, dispatched ahead of the outbound queues and without rate limits
+        std::atomic_int active_enqueue_count_;                                                   ///< Atomic, Count of enqueue requests currently using a queue pointer
+        std::mutex outbound_action_queue_resize_lock_;                                           ///< Mutex for Outbound Action Queue resize operations
+
+        std::mutex outbound_action_queue_lock_;                                                  ///< Mutex used by the outbound processing thread to wait for actions
+        std::condition_variable outbound_action_queue_wait_;                                     ///< Condition variable used to wake up the outbound processing thread
+        std::atomic_bool is_outbound_processing_waiting_;                                        ///< Atomic, True while the outbound processing thread is waiting for actions
+
+        std::atomic_size_t max_write_batch_size_bytes_;                                          ///< Atomic, Max bytes combined into one network write by the outbound processing thread
+        std::atomic<std::chrono::milliseconds::rep> max_write_batch_delay_ms_;                   ///< Atomic, Max time the outbound processing thread waits to fill a write batch
+
+        std::mutex outbound_action_queue_space_lock_;                                            ///< Mutex used by blocked enqueue requests to wait for space
+        std::condition_variable outbound_action_queue_space_wait_;                               ///< Condition variable used to wake up blocked enqueue requests
+        std::atomic_int blocked_enqueue_count_;                                                  ///< Atomic, Count of enqueue requests waiting for space
+
+        std::mutex executor_lock_;                                                               ///< Mutex for the executor and the state of the outbound task
+        std::condition_variable outbound_task_wait_;                                             ///< Condition variable signaled when an outbound task returns
+        std::shared_ptr<util::Threading::Executor> p_executor_;                                  ///< Executor running outbound tasks, nullptr if the outbound processing thread is used
+        std::weak_ptr<ClientCoreState> p_executor_state_;                                        ///< This instance, captured by tasks submitted to the executor
+        uint64_t executor_generation_;                                                           ///< Incremented when the executor is changed, outbound tasks submitted before return without doing anything
+        bool is_outbound_task_running_;                                                          ///< True while an outbound task is processing actions
+        std::atomic_bool has_executor_;                                                          ///< Atomic, True if an executor is set
+        std::atomic_bool is_outbound_task_scheduled_;                                            ///< Atomic, True from when an outbound task is submitted until it returns
+        std::atomic_bool has_held_outbound_action_;                                              ///< Atomic, True if the outbound task holds back a dequeued action because of its rate limit
+        std::atomic<std::chrono::steady_clock::rep> next_outbound_task_wakeup_;                  ///< Atomic, Time since epoch of the last delayed outbound task that was requested
+        std::atomic<std::chrono::steady_clock::rep> last_outbound_action_time_;                  ///< Atomic, Time since epoch at which an action was last written to the network
+        OutboundAction held_outbound_action_;                                                    ///< Action held back by the outbound task, only used by the running outbound task
+        std::shared_ptr<BatchedWriteConnection> p_outbound_task_batch_connection_;               ///< Batch connection reused by outbound tasks
+        util::Vector<std::pair<uint16_t, ActionData::AsyncAckNotificationHandlerPtr>> outbound_task_batched_acks_;  ///< Ack handlers of the actions in the batch of the running outbound task
+
+        /**
+         * @brief Sync Action Response Class
+         *
+         * Defining an internal class used by a blocking PerformAction call to wait for its own response.
+         * Each call creates its own instance, so any number of sync actions can wait for responses concurrently.
+         *
+         */
+        class SyncActionResponse {
+        public:
+            std::mutex response_lock_;                  ///< Mutex for the response
+            std::condition_variable response_wait_;     ///< Condition variable used to wake up the calling thread
+            ResponseCode response_;                     ///< Received response
+            bool is_response_received_;                 ///< Indicates whether the response has been received
+        };
+
+        /**
+         * @brief Consume a rate limit token for an action of the specified type
+         *
+         * Refills the token bucket for the action type if a rate limit is configured and consumes one token
+         * if available.
+         *
+         * @param action_type - Type of the Action to be dispatched
+         * @return std::chrono::milliseconds Zero if the action can be dispatched, time until a token is available otherwise
+         */
+        std::chrono::milliseconds AcquireActionRateLimitToken(ActionType action_type);
+
+        /**
+         * @brief Add an action to the current outbound queue
+         *
+         * Retries on the replacement queue if the current one is closed by a concurrent resize.
+         * Wakes up the outbound processing thread on success.
+         *
+         * @param action - Action to add, moved from on success
+         * @return true if added, false if the queue is full
+         */
+        bool PushOutboundAction(OutboundAction &action);
+
+        /**
+         * @brief Remove the oldest outbound action, from queues closed by a resize first
+         * @param action[out] - Removed action
+         * @return true if an action was removed, false if there are no actions to process
+         */
+        bool PopOutboundAction(OutboundAction &action);
+
+        /**
+         * @brief Remove the oldest outbound action, waiting until the deadline if none are queued
+         *
+         * Also wakes up one enqueue request blocked on a full queue if an action was removed.
+         *
+         * @param action[out] - Removed action
+         * @param deadline - Time until which to wait
+         * @return true if an action was removed, false if the deadline passed
+         */
+        bool PopOutboundActionUntil(OutboundAction &action, std::chrono::steady_clock::time_point deadline);
+
+        /**
+         * @brief Wait until a control action is queued or the deadline passes
+         * @param deadline - Time until which to wait
+         */
+        void WaitForControlActionsUntil(std::chrono::steady_clock::time_point deadline);
+
+        /**
+         * @brief Perform all queued control actions
+         *
+         * @param p_network_connection - Network connection to pass to the actions
+         * @return size_t Number of control actions performed
+         */
+        size_t DispatchControlActions(std::shared_ptr<NetworkConnection> p_network_connection);
+
+        /**
+         * @brief Perform a dequeued outbound action
+         *
+         * Registers the Ack handler if provided and calls the Ack handler with the error if the action fails.
+         *
+         * @param action - Action to perform
+         * @param p_network_connection - Network connection to pass to the action
+         * @return ResponseCode indicating result of the action
+         */
+        ResponseCode DispatchOutboundAction(OutboundAction &action,
+                                            std::shared_ptr<NetworkConnection> p_network_connection);
+
+        /**
+         * @brief Send a batch of outbound actions
+         *
+         * If the batch could not be written, the Ack handlers of the actions in the batch that are still pending are
+         * called with the error.
+         *
+         * @param batch_connection - Connection the actions were performed on
+         * @param batched_acks - Action IDs and Ack handlers of the actions in the batch, cleared on return
+         */
+        void EndOutboundActionBatch(
+            BatchedWriteConnection &batch_connection,
+            util::Vector<std::pair<uint16_t, ActionData::AsyncAckNotificationHandlerPtr>> &batched_acks);
+
+        /**
+         * @brief Submit an outbound task to the executor, unless one is already scheduled or no executor is set
+         */
+        void ScheduleOutboundActionTask();
+
+        /**
+         * @brief Schedule an outbound task once the specified time is reached
+         *
+         * Does nothing if a delayed outbound task that runs no later is already pending
+         *
+         * @param wakeup_time - Time at which to run the task
+         */
+        void ScheduleOutboundActionTaskAt(std::chrono::steady_clock::time_point wakeup_time);
+
+        /**
+         * @brief Run an outbound task and schedule the next one
+         *
+         * @param executor_generation - Value of executor_generation_ when the task was submitted
+         */
+        void RunOutboundActionTask(uint64_t executor_generation);
 
         /**
-         * @brief Internal Action Handler for Sync Action responses
+         * @brief Dispatch queued actions without waiting
+         *
+         * Used by outbound tasks in place of ::ProcessOutboundActionQueue. Dispatches control actions and up to
+         * OUTBOUND_ACTION_TASK_MAX_ACTIONS queued actions, and deletes expired Acks. Queued actions are batched like
+         * on the outbound processing thread, except that the task does not wait for more actions to fill a batch.
          *
-         * @param action_id - ID of the Action that response was received for
-         * @param rc - Received response
+         * @return std::chrono::steady_clock::time_point time at which a rate limited action can be dispatched,
+         * time_point::max() if no action is held back
          */
-        void SyncActionHandler(uint16_t action_id, ResponseCode rc);
+        std::chrono::steady_clock::time_point ProcessOutboundActionTask();
 
     public:
         /**
@@ -166,6 +422,10 @@ namespace awsiotsdk {
          * @brief Define Handler for Resubscribe Callbacks
          *
          * This handler is used to provide notification to the application when a resubscribe occurs.
+         * Called once the SUBACKs of all resent subscriptions arrived or timed out, usually on the network read
+         * thread. The result is SUCCESS, MQTT_SUBSCRIBE_PARTIALLY_FAILED or MQTT_SUBSCRIBE_FAILED depending on the
+         * topic filters the server accepted, MQTT_REQUEST_TIMEOUT_ERROR if a SUBACK did not arrive, or the error
+         * of writing the subscribe packets.
          * NOTE: This handler should be NON-BLOCKING
          */
         typedef std::function<ResponseCode(util::String mqtt_client_id,
@@ -186,11 +446,12 @@ namespace awsiotsdk {
          * @return uint16_t Action ID
          */
         virtual uint16_t GetNextActionId() {
-            if (UINT16_MAX == next_action_id_) {
-                next_action_id_ = 1;
-                return UINT16_MAX;
+            uint16_t action_id = next_action_id_.load();
+            // Called concurrently by enqueuing threads, 0 is skipped on wrap around
+            while (!next_action_id_.compare_exchange_weak(action_id,
+                                                          static_cast<uint16_t>(UINT16_MAX == action_id ? 1 : action_id + 1))) {
             }
-            return next_action_id_++;
+            return action_id;
         };
 
         /**
@@ -201,9 +462,62 @@ namespace awsiotsdk {
 
         /**
          * @brief Set max size for action queue
+         *
+         * Replaces the queue with one of the requested size. Actions already queued are processed before any
+         * actions that are enqueued after the resize. A size of zero is treated as one.
+         *
          * @param size_t max_queue_size
          */
-        void SetMaxActionQueueSize(size_t max_queue_size) { max_queue_size_ = max_queue_size; }
+        void SetMaxActionQueueSize(size_t max_queue_size);
+
+        /**
+         * @brief Set how queued actions are combined into network writes
+         *
+         * The outbound processing thread performs queued actions back-to-back and sends everything they wrote in
+         * one gathered write once max_batch_size_bytes is reached, no more actions are queued, or max_batch_delay
+         * has passed since the first action in the batch. Acks are still tracked individually for each action.
+         *
+         * @param max_batch_size_bytes - Max bytes per batch, zero disables batching and each action writes directly
+         * @param max_batch_delay - Max time to wait for more actions to fill a batch, zero sends without waiting
+         */
+        void SetWriteBatchLimits(size_t max_batch_size_bytes, std::chrono::milliseconds max_batch_delay) {
+            max_write_batch_size_bytes_ = max_batch_size_bytes;
+            max_write_batch_delay_ms_ = max_batch_delay.count();
+        }
+
+        /**
+         * @brief Set the time after which pending Acks expire
+         *
+         * Expired Acks are deleted by the outbound processing thread and their handlers are called with
+         * ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR. Applies to Acks registered after the call.
+         *
+         * @param ack_timeout - Timeout for pending Acks
+         */
+        void SetAckTimeout(std::chrono::milliseconds ack_timeout) { ack_timeout_ms_ = ack_timeout.count(); }
+
+        /**
+         * @brief Get the time after which pending Acks expire
+         * @return std::chrono::milliseconds timeout
+         */
+        std::chrono::milliseconds GetAckTimeout() { return std::chrono::milliseconds(ack_timeout_ms_.load()); }
+
+        /**
+         * @brief Set the behavior of enqueue requests when the action queue is full
+         *
+         * @param overflow_policy - Policy to use, ActionQueueOverflowPolicy::REJECT by default
+         * @param block_timeout - Max time to block for, only used with ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT
+         */
+        void SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy overflow_policy,
+                                          std::chrono::milliseconds block_timeout = std::chrono::milliseconds(0)) {
+            overflow_block_timeout_ms_ = block_timeout.count();
+            overflow_policy_ = overflow_policy;
+        }
+
+        /**
+         * @brief Get the behavior of enqueue requests when the action queue is full
+         * @return ActionQueueOverflowPolicy current policy
+         */
+        ActionQueueOverflowPolicy GetActionQueueOverflowPolicy() { return overflow_policy_; }
 
         /**
          * @brief Get pointer to sync point used for execution status of the Core instance
@@ -218,7 +532,16 @@ namespace awsiotsdk {
          * @brief Sets whether the Client is allowed to process queue actions
          * @param process_queued_actions value to set it to
          */
-        void SetProcessQueuedActions(bool process_queued_actions) { process_queued_actions_ = process_queued_actions; }
+        void SetProcessQueuedActions(bool process_queued_actions) {
+            {
+                std::lock_guard<std::mutex> queue_lock(outbound_action_queue_lock_);
+                process_queued_actions_ = process_queued_actions;
+                outbound_action_queue_wait_.notify_all();
+            }
+            if (process_queued_actions) {
+                ScheduleOutboundActionTask();
+            }
+        }
 
         /**
          * @brief Get whether the Client can process queued actions
@@ -232,19 +555,77 @@ namespace awsiotsdk {
          * This function processes the actions queued up in the Outbound action queue.
          * The function accepts a Sync point that can be used to control execution in a separate thread.
          * If the value is set to false for the sync point, the function will perform one action from the queue.
-         * This puts the running thread to sleep if there are no queued up actions.
+         * The running thread blocks until an action is enqueued and then drains the queue back-to-back, subject only
+         * to any rate limits configured using ::SetActionRateLimit. The sync point is checked at least once every
+         * DEFAULT_CORE_THREAD_SLEEP_DURATION_MS.
          * DO NOT call from main thread unless you have a separate thread to queue up actions
          *
          * @param thread_task_out_sync
          */
         void ProcessOutboundActionQueue(std::shared_ptr<std::atomic_bool> thread_task_out_sync);
 
+        /**
+         * @brief Process outbound actions as tasks on an executor instead of a thread
+         *
+         * While an executor is set, a task is submitted whenever actions are queued and no task is scheduled yet,
+         * so an idle client does not use a thread. At most one task of an instance runs at a time, actions are
+         * dispatched in the order they were queued. Tasks are also scheduled for rate limited actions and for
+         * expiring Acks. ::ProcessOutboundActionQueue must not run while an executor is set. Blocks until a running
+         * task has returned, must not be called from an Ack handler.
+         *
+         * @param p_executor - Executor to use, nullptr to stop submitting tasks
+         * @param p_state - This instance, held weakly by submitted tasks
+         */
+        void SetExecutor(std::shared_ptr<util::Threading::Executor> p_executor, std::weak_ptr<ClientCoreState> p_state);
+
+        /**
+         * @brief Get the time at which an action was last written to the network
+         * @return std::chrono::steady_clock::time_point - time of the last write, the epoch if nothing was written
+         */
+        std::chrono::steady_clock::time_point GetLastOutboundActionTime() {
+            return std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(last_outbound_action_time_));
+        }
+
+        /**
+         * @brief Get the lock held while an Action writes to the network
+         *
+         * Action runners that write packets themselves instead of performing an Action must hold it while writing,
+         * so their packets are not interleaved with packets written by sync or queued Actions
+         *
+         * @return std::mutex& - perform action lock
+         */
+        std::mutex &GetPerformActionLock() {
+            return perform_action_lock_;
+        }
+
+        /**
+         * @brief Wake up Action runners that wait for state changes
+         *
+         * Called by Client Core after telling Action runners to stop, so runners waiting for an event notice the stop
+         * right away. Does nothing by default.
+         */
+        virtual void WakeActionRunners() {
+        }
+
+        /**
+         * @brief Enqueue control Actions that did not fit in the control queue earlier
+         *
+         * Called by the outbound processing whenever it has emptied the control queue, with the perform action lock
+         * held. Must not block. Does nothing by default.
+         *
+         * @return size_t - Number of control actions enqueued
+         */
+        virtual size_t EnqueueDeferredControlActions() {
+            return 0;
+        }
+
         /**
          * @brief Perform Action in Blocking Mode
          *
          * This API will perform the Action in Blocking mode. The timeout for the action to give a valid response
-         * is provided as an argument. This API stops processing of all outbound actions until Response is received
-         * for the requested Action Type
+         * is provided as an argument. The calling thread blocks until a Response is received for this Action or the
+         * timeout expires. Outbound actions continue to be processed while waiting, and multiple threads can perform
+         * blocking actions concurrently
          *
          * @param action_type - Type of the Action to be executed. Must be registered
          * @param action_data - Action Data to be passed as argument to the Action instance
@@ -283,6 +664,9 @@ namespace awsiotsdk {
         /**
          * @brief Enqueue Action for processing in Outbound Queue
          *
+         * Safe to call concurrently from any number of threads. Behavior when the queue is full depends on the
+         * configured ActionQueueOverflowPolicy.
+         *
          * @param action_type - Type of the Action
          * @param action_data - Data to be passed to perform Action
          * @param action_id_out[out] - Action ID that was assigned to this action by the Client
@@ -291,8 +675,61 @@ namespace awsiotsdk {
         ResponseCode EnqueueOutboundAction(ActionType action_type, std::shared_ptr<ActionData> action_data,
                                            uint16_t &action_id_out);
 
+        /**
+         * @brief Enqueue a control Action that is sent ahead of queued application Actions
+         *
+         * Used for packets that the peer waits for, such as PUBACK. Control actions are dispatched in the order they
+         * were enqueued, before any action in the outbound queue and without rate limits. Control actions queued at
+         * the same time are combined into one network write. Never blocks, so it is safe to call from the network
+         * read thread. Meant for packets without a response, a failed write of combined control actions is only logged.
+         *
+         * @param action_type - Type of the Action
+         * @param action_data - Data to be passed to perform Action
+         * @param action_id_out[out] - Action ID that was assigned to this action by the Client
+         * @return ResponseCode - SUCCESS, or ACTION_QUEUE_FULL if DEFAULT_CONTROL_ACTION_QUEUE_SIZE actions are queued
+         */
+        ResponseCode EnqueueControlAction(ActionType action_type, std::shared_ptr<ActionData> action_data,
+                                          uint16_t &action_id_out);
+
+        /**
+         * @brief Enqueue a control Action that keeps its current Action ID
+         *
+         * Used to send a request again, for example a publish after a reconnect, where the peer matches the
+         * response to the Action ID of the original request. Never blocks, like EnqueueControlAction.
+         *
+         * @param action_type - Type of the Action
+         * @param action_data - Data to be passed to perform Action
+         * @return ResponseCode - SUCCESS, or ACTION_QUEUE_FULL if DEFAULT_CONTROL_ACTION_QUEUE_SIZE actions are queued
+         */
+        ResponseCode RequeueControlAction(ActionType action_type, std::shared_ptr<ActionData> action_data);
+
+        /**
+         * @brief Configure a token bucket rate limit for the specified Action Type
+         *
+         * Queued actions of this type are dispatched at no more than max_actions_per_second on average, with bursts
+         * of up to burst_size actions. Actions are still dispatched in the order they were enqueued, so a rate
+         * limited action at the head of the queue delays the actions behind it. Action types without a configured
+         * rate limit are dispatched as soon as they are enqueued.
+         *
+         * @param action_type - Type of the Action to rate limit
+         * @param max_actions_per_second - Average dispatch rate, must be greater than zero
+         * @param burst_size - Maximum number of actions that can be dispatched back-to-back, must be greater than zero
+         * @return ResponseCode indicating result of the API call
+         */
+        ResponseCode SetActionRateLimit(ActionType action_type, double max_actions_per_second, size_t burst_size);
+
+        /**
+         * @brief Remove the rate limit configured for the specified Action Type, if any
+         * @param action_type - Type of the Action
+         */
+        void ClearActionRateLimit(ActionType action_type);
+
         /**
          * @brief Register Ack Handler for provided action id
+         *
+         * If an Ack is still pending for the Action ID, its handler is called with ResponseCode::FAILURE and the
+         * new handler receives the response.
+         *
          * @param action_id - Action ID
          * @param p_async_ack_handler - Handler to call on response
          * @return ResponseCode indicating result of the API call
@@ -303,8 +740,9 @@ namespace awsiotsdk {
         /**
          * @brief Delete Ack Handler for specified Action ID
          * @param action_id - Action ID
+         * @return true if an Ack Handler was pending for the Action ID
          */
-        void DeletePendingAck(uint16_t action_id);
+        bool DeletePendingAck(uint16_t action_id);
 
         /**
          * @brief Call registered Ack handler if it exists for specified Packet id
@@ -316,7 +754,8 @@ namespace awsiotsdk {
         /**
          * @brief Delete all expired Acks
          *
-         * Deletes all Acks where the timeouts have expired. Responds with Code indicating request timeout
+         * Deletes all Acks where the timeouts have expired. Responds with Code indicating request timeout.
+         * Called periodically by the outbound processing thread, or by outbound tasks if an executor is set
          */
         void DeleteExpiredAcks();
 
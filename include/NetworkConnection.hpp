@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <mutex>
@@ -34,7 +35,23 @@
 
 #include "ResponseCode.hpp"
 
+#define GATHERED_WRITE_MIN_DIRECT_SEGMENT_BYTES 16384
+
 namespace awsiotsdk {
+    /**
+     * @brief Network Write Segment Class
+     *
+     * Reference to a contiguous range of bytes. Used to write several buffers in a single gathered write.
+     * If p_owner_ is set, the range lies within the owning buffer and the segment can be kept beyond the write
+     * call without copying the bytes.
+     */
+    class NetworkWriteSegment {
+    public:
+        const char *p_data_;                            ///< Start of the range
+        size_t length_;                                 ///< Number of bytes in the range
+        std::shared_ptr<const util::String> p_owner_;   ///< Optional, immutable buffer containing the range
+    };
+
     /**
      * @brief Network Connection Class
      *
@@ -73,6 +90,22 @@ namespace awsiotsdk {
          */
         virtual ResponseCode WriteInternal(const util::String &buf, size_t &size_written_bytes_out) = 0;
 
+        /**
+         * @brief Write multiple buffers to the network socket in one operation
+         *
+         * Internal implementation of the WriteGathered function. The default implementation copies the segments
+         * into a single buffer and calls WriteInternal once, so that TLS implementations emit as few records as
+         * possible. Owned segments of at least GATHERED_WRITE_MIN_DIRECT_SEGMENT_BYTES are passed to WriteInternal
+         * as they are instead, since copying a large payload costs more than the extra record. Derived classes can
+         * override this if the transport supports scatter/gather writes natively.
+         *
+         * @param segments - Buffers to write, in order
+         * @param size_written_bytes_out - total number of bytes written
+         * @return ResponseCode - successful write or Network error code
+         */
+        virtual ResponseCode WriteGatheredInternal(const util::Vector<NetworkWriteSegment> &segments,
+                                                   size_t &size_written_bytes_out);
+
         /**
          * @brief Read bytes from the network socket
          *
@@ -86,6 +119,39 @@ namespace awsiotsdk {
         virtual ResponseCode ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                           size_t size_bytes_to_read, size_t &size_read_bytes_out) = 0;
 
+        /**
+         * @brief Read whatever bytes are available from the network socket
+         *
+         * Internal implementation of the ReadAvailable function. The default implementation reads exactly
+         * min_bytes_to_read bytes using ReadInternal. Derived classes should override this to return all bytes the
+         * transport already has available, up to max_bytes_to_read, so callers need fewer read calls.
+         *
+         * @param buf - reference to buffer where read bytes should be copied, must hold at least
+         *              buf_read_offset + max_bytes_to_read bytes
+         * @param buf_read_offset - offset in buf at which to copy read bytes
+         * @param min_bytes_to_read - number of bytes the caller needs to make progress, at least one
+         * @param max_bytes_to_read - maximum number of bytes to read
+         * @param size_read_bytes_out - reference to store number of bytes read
+         * @return ResponseCode - successful read, NETWORK_SSL_NOTHING_TO_READ if no bytes arrived within the read
+         *                        timeout, or Network error code
+         */
+        virtual ResponseCode ReadAvailableInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                                   size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                                   size_t &size_read_bytes_out);
+
+        /**
+         * @brief Wait until data is available to read
+         *
+         * Internal implementation of the WaitForReadable function. The default implementation sleeps for the
+         * timeout and reports the connection as readable so that the caller retries the read. Derived classes
+         * should override this to block on the underlying socket so the wait ends as soon as data arrives.
+         *
+         * @param timeout - maximum time to wait
+         * @return ResponseCode - SUCCESS if data may be available, NETWORK_SSL_NOTHING_TO_READ if the timeout
+         *                        expired, or Network error code
+         */
+        virtual ResponseCode WaitForReadableInternal(std::chrono::milliseconds timeout);
+
         /**
          * @brief Disconnect from network socket
          *
@@ -134,6 +200,18 @@ namespace awsiotsdk {
          */
         virtual ResponseCode Write(const util::String &buf, size_t &size_written_bytes_out) final;
 
+        /**
+         * @brief Write multiple buffers to the network socket in one operation
+         *
+         * Calls the internal gathered write function after obtaining write lock
+         *
+         * @param segments - Buffers to write, in order
+         * @param size_written_bytes_out - total number of bytes written
+         * @return ResponseCode - successful write or Network error code
+         */
+        virtual ResponseCode WriteGathered(const util::Vector<NetworkWriteSegment> &segments,
+                                           size_t &size_written_bytes_out) final;
+
         /**
          * @brief Read bytes from the network socket
          *
@@ -147,6 +225,61 @@ namespace awsiotsdk {
         virtual ResponseCode Read(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                   size_t size_bytes_to_read, size_t &size_read_bytes_out) final;
 
+        /**
+         * @brief Read available bytes from the network socket
+         *
+         * Reads at least one and at most max_bytes_to_read bytes. Returns as soon as some bytes are available
+         * rather than waiting for the full amount, so a single call can return several buffered MQTT packets.
+         *
+         * @param buf - reference to buffer where read bytes should be copied, must hold at least
+         *              buf_read_offset + max_bytes_to_read bytes
+         * @param buf_read_offset - offset in buf at which to copy read bytes
+         * @param min_bytes_to_read - number of bytes the caller needs to make progress, at least one
+         * @param max_bytes_to_read - maximum number of bytes to read
+         * @param size_read_bytes_out - reference to store number of bytes read
+         * @return ResponseCode - successful read or Network error code
+         */
+        virtual ResponseCode ReadAvailable(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                           size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                           size_t &size_read_bytes_out) final;
+
+        /**
+         * @brief Wait until data is available to read
+         *
+         * Calls the internal wait function after obtaining read lock. Allows read threads to block until data
+         * arrives instead of polling with fixed sleeps. The timeout bounds how long a thread takes to notice that
+         * it should stop.
+         *
+         * @param timeout - maximum time to wait
+         * @return ResponseCode - SUCCESS if data may be available, NETWORK_SSL_NOTHING_TO_READ if the timeout
+         *                        expired, or Network error code
+         */
+        virtual ResponseCode WaitForReadable(std::chrono::milliseconds timeout) final;
+
+        /**
+         * @brief Check if the connection provides a descriptor that can be waited on
+         *
+         * Such connections can be waited on by an event loop together with other connections, see
+         * util::Threading::IoReactor, instead of needing their own read thread. The default implementation returns
+         * false.
+         *
+         * @return bool - true if GetPollableDescriptor returns the socket descriptor while connected
+         */
+        virtual bool IsPollable() {
+            return false;
+        }
+
+        /**
+         * @brief Get the descriptor of the network socket
+         *
+         * The descriptor changes when the connection is reestablished. The default implementation returns -1.
+         *
+         * @return int - socket descriptor, -1 if not connected or not supported
+         */
+        virtual int GetPollableDescriptor() {
+            return -1;
+        }
+
         /**
          * @brief Disconnect from network socket
          *
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file PendingAckTable.hpp
+ * @brief Table of Ack handlers waiting for a response
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+#include "util/memory/stl/Vector.hpp"
+
+#include "Action.hpp"
+
+#define DEFAULT_PENDING_ACK_TABLE_CAPACITY 64
+
+namespace awsiotsdk {
+    /**
+     * @brief Pending Ack Table
+     *
+     * Stores the Ack handler of each request waiting for a response, keyed by Action ID, together with the time
+     * at which the request expires. Entries live in a preallocated slot array. Lookups use buckets indexed by the
+     * low bits of the Action ID, and a list ordered by expiry time makes finding expired entries O(1). Slots are
+     * only allocated when more requests are pending than ever before, registering and acking never allocate.
+     *
+     * Not thread safe, callers must synchronize access.
+     */
+    class PendingAckTable {
+    protected:
+        /**
+         * Slot index used to terminate lists
+         */
+        static const size_t NO_SLOT = static_cast<size_t>(-1);
+
+        /**
+         * @brief Pending Ack slot
+         */
+        class Slot {
+        public:
+            uint16_t action_id_;                                             ///< Action ID the handler is registered for
+            std::chrono::steady_clock::time_point expiry_time_;              ///< Time at which the request times out
+            ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler_; ///< Handler to which response must be sent
+            size_t next_in_bucket_;                                          ///< Next slot in the same bucket, or in the free list
+            size_t prev_by_expiry_;                                          ///< Slot expiring before this one
+            size_t next_by_expiry_;                                          ///< Slot expiring after this one
+        };
+
+        util::Vector<Slot> slots_;              ///< All slots, in use or free
+        util::Vector<size_t> buckets_;          ///< First slot of each bucket, size is a power of two
+        size_t free_slot_;                      ///< First free slot
+        size_t first_by_expiry_;                ///< Slot that expires first
+        size_t last_by_expiry_;                 ///< Slot that expires last
+        size_t size_;                           ///< Number of slots in use
+
+        /**
+         * @brief Find the slot for an Action ID
+         * @param action_id - Action ID
+         * @param prev_in_bucket_out - Slot before the found slot in its bucket, NO_SLOT if it is the first
+         * @return Slot index, NO_SLOT if the Action ID has no pending Ack
+         */
+        size_t FindSlot(uint16_t action_id, size_t &prev_in_bucket_out);
+
+        /**
+         * @brief Unlink a slot from its bucket and the expiry list and return it to the free list
+         * @param slot_index - Slot to free
+         * @param prev_in_bucket - Slot before it in its bucket, NO_SLOT if it is the first
+         */
+        void FreeSlot(size_t slot_index, size_t prev_in_bucket);
+
+        /**
+         * @brief Double the number of slots and buckets
+         */
+        void Grow();
+
+    public:
+        /**
+         * @brief Constructor
+         * @param initial_capacity - Number of slots to preallocate, rounded up to a power of two
+         */
+        PendingAckTable(size_t initial_capacity);
+
+        /**
+         * @brief Add a pending Ack, replacing any pending Ack with the same Action ID
+         *
+         * @param action_id - Action ID
+         * @param p_async_ack_handler - Handler to call on response
+         * @param expiry_time - Time at which the request times out
+         * @param p_replaced_handler_out - Receives the handler of the replaced Ack, nullptr if none was pending
+         */
+        void Insert(uint16_t action_id, ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                    std::chrono::steady_clock::time_point expiry_time,
+                    ActionData::AsyncAckNotificationHandlerPtr &p_replaced_handler_out);
+
+        /**
+         * @brief Remove the pending Ack for an Action ID
+         *
+         * @param action_id - Action ID
+         * @param p_async_ack_handler_out - Receives the handler of the removed Ack, can be nullptr
+         * @return true if a pending Ack was removed
+         */
+        bool Remove(uint16_t action_id, ActionData::AsyncAckNotificationHandlerPtr *p_async_ack_handler_out);
+
+        /**
+         * @brief Check whether an Action ID has a pending Ack
+         * @param action_id - Action ID
+         * @return true if the Action ID has a pending Ack
+         */
+        bool Contains(uint16_t action_id);
+
+        /**
+         * @brief Remove the pending Ack that expires first if it has expired
+         *
+         * @param now - Current time
+         * @param action_id_out - Receives the Action ID of the removed Ack
+         * @param p_async_ack_handler_out - Receives the handler of the removed Ack
+         * @return true if an expired Ack was removed
+         */
+        bool PopExpired(std::chrono::steady_clock::time_point now, uint16_t &action_id_out,
+                        ActionData::AsyncAckNotificationHandlerPtr &p_async_ack_handler_out);
+
+        /**
+         * @brief Get the time at which the next pending Ack expires
+         * @return Expiry time, std::chrono::steady_clock::time_point::max() if nothing is pending
+         */
+        std::chrono::steady_clock::time_point GetNextExpiryTime();
+
+        /**
+         * @brief Get number of pending Acks
+         * @return size_t count
+         */
+        size_t Size() { return size_; }
+
+        /**
+         * @brief Get number of preallocated slots
+         * @return size_t count
+         */
+        size_t Capacity() { return slots_.size(); }
+    };
+}
@@ -142,6 +142,8 @@ namespace awsiotsdk {
         MQTT_INVALID_DATA_ERROR = -719,                            ///< Provided data is invalid/not sufficient for the request
         MQTT_SUBSCRIBE_PARTIALLY_FAILED = -720,                    ///< Failed to subscribe to atleast one of the topics in the subscribe request
         MQTT_SUBSCRIBE_FAILED = -721,                              ///< Unable to subscribe to any of the topics in the subscribe request
+        MQTT_INFLIGHT_WINDOW_FULL_ERROR = -722,                    ///< The maximum number of unacknowledged QoS1 publishes are already in flight
+        MQTT_OFFLINE_STORE_FULL_ERROR = -723,                      ///< The offline publish store has no space for the publish
 
         // JSON Parsing Error Codes
 
@@ -281,6 +283,8 @@ namespace awsiotsdk {
         const util::String MQTT_INVALID_DATA_ERROR_STRING("Invalid/Insufficient data was provided in the MQTT request");
         const util::String MQTT_SUBSCRIBE_PARTIALLY_FAILED_STRING("Failed to subscribe to atleast one of the topics in the subscribe request");
         const util::String MQTT_SUBSCRIBE_FAILED_STRING("Failed to subscribe to any of the topics in the subscribe request");
+        const util::String MQTT_INFLIGHT_WINDOW_FULL_ERROR_STRING("The maximum number of unacknowledged MQTT publishes are in flight");
+        const util::String MQTT_OFFLINE_STORE_FULL_ERROR_STRING("The offline publish store is full");
         const util::String JSON_PARSE_KEY_NOT_FOUND_ERROR_STRING("Unable to find the requested key in the JSON");
         const util::String JSON_PARSE_KEY_UNEXPECTED_TYPE_ERROR_STRING("The value for the JSON key was of an unexpected type");
         const util::String JSON_PARSING_ERROR_STRING("Error occurred while parsing the JSON");
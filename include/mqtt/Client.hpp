@@ -231,6 +231,26 @@ namespace awsiotsdk {
                                      mqtt::QoS qos, const util::String &payload,
                                      std::chrono::milliseconds action_response_timeout);
 
+        /**
+         * @brief Perform Sync Publish with a shared payload
+         *
+         * Same as the Publish overload taking a String, except that the payload is shared instead of copied.
+         * Useful for large payloads, which are then written to the network straight from the given buffer.
+         * The buffer must not be modified after this call.
+         *
+         * @param p_topic_name topic name on which the publish is performed
+         * @param is_retained last message is retained
+         * @param is_duplicate is a duplicate message
+         * @param qos quality of service
+         * @param p_payload Shared buffer containing the MQTT message payload
+         * @param action_response_timeout Timeout in milliseconds within which response should be obtained after request is sent
+         *
+         * @return ResponseCode indicating status of request
+         */
+        virtual ResponseCode Publish(std::unique_ptr<Utf8String> p_topic_name, bool is_retained, bool is_duplicate,
+                                     mqtt::QoS qos, std::shared_ptr<const util::String> p_payload,
+                                     std::chrono::milliseconds action_response_timeout);
+
         /**
          * @brief Perform Sync Subscribe
          *
@@ -270,6 +290,11 @@ namespace awsiotsdk {
          * the Ack Handler is called if a PUBACK is received. If not, the handler is called with a ResponseCode
          * indicating timeout
          *
+         * QoS1 requests count against the in-flight window until they are acknowledged. If the window is full, the
+         * request is rejected with ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR. Requests that were sent but not
+         * acknowledged when the connection dropped are sent again after the client reconnects. If an offline publish
+         * store is set, see SetOfflinePublishStore, the request is stored instead and packet_id_out is set to zero
+         *
          * @param p_topic_name on which the publish is performed
          * @param is_retained last message is retained
          * @param is_duplicate is a duplicate message
@@ -285,6 +310,28 @@ namespace awsiotsdk {
                                           ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
                                           uint16_t &packet_id_out);
 
+        /**
+         * @brief Perform Async Publish with a shared payload
+         *
+         * Same as the PublishAsync overload taking a String, except that the payload is shared instead of copied.
+         * The buffer is held until the request has been written to the network, or for QoS1 until it has been
+         * acknowledged, and must not be modified after this call.
+         *
+         * @param p_topic_name on which the publish is performed
+         * @param is_retained last message is retained
+         * @param is_duplicate is a duplicate message
+         * @param qos quality of service
+         * @param p_payload Shared buffer containing the MQTT message payload
+         * @param p_async_ack_handler the ack handling function
+         * @param packet_id_out packet ID of the message being sent
+         *
+         * @return ResponseCode indicating status of request
+         */
+        virtual ResponseCode PublishAsync(std::unique_ptr<Utf8String> p_topic_name, bool is_retained, bool is_duplicate,
+                                          mqtt::QoS qos, std::shared_ptr<const util::String> p_payload,
+                                          ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                          uint16_t &packet_id_out);
+
         /**
          * @brief Perform Async Subscribe
          *
@@ -380,6 +427,126 @@ namespace awsiotsdk {
          */
         virtual void SetMaxReconnectBackoffTimeout(std::chrono::seconds max_reconnect_backoff_timeout);
 
+        /**
+         * @brief Set the strategy deciding the wait before each reconnect attempt
+         *
+         * The default FullJitterBackoffStrategy waits a random time up to an exponentially growing ceiling between
+         * the min and max back-off times, so a fleet of devices disconnected together does not reconnect in
+         * lockstep. ExponentialBackoffStrategy restores the back-off of earlier versions. Must be called before
+         * Connect.
+         *
+         * @param p_reconnect_backoff_strategy - Strategy to use, one instance per client, nullptr for the default
+         */
+        virtual void SetReconnectBackoffStrategy(
+            std::shared_ptr<mqtt::ReconnectBackoffStrategy> p_reconnect_backoff_strategy) {
+            p_client_state_->SetReconnectBackoffStrategy(p_reconnect_backoff_strategy);
+        }
+
+        /**
+         * @brief Get the histogram of times from losing the connection to a successful automatic reconnect
+         *
+         * @return ReconnectTimeHistogram reference, valid while the client exists
+         */
+        virtual mqtt::ReconnectTimeHistogram &GetReconnectTimeHistogram() {
+            return p_client_state_->GetReconnectTimeHistogram();
+        }
+
+        /**
+         * @brief Set the max number of QoS1 publishes sent by PublishAsync that can be waiting for a PUBACK
+         *
+         * Should not exceed the in-flight limit of the broker. The default is DEFAULT_MAX_INFLIGHT_PUBLISHES
+         *
+         * @param max_inflight_publishes - Max number of unacknowledged publishes, zero is treated as one
+         */
+        virtual void SetMaxInflightPublishes(size_t max_inflight_publishes) {
+            p_client_state_->SetMaxInflightPublishes(max_inflight_publishes);
+        }
+
+        /**
+         * @brief Get the number of QoS1 publishes sent by PublishAsync that are waiting for a PUBACK
+         *
+         * @return size_t count
+         */
+        virtual size_t GetInflightPublishCount() {
+            return p_client_state_->GetInflightPublishCount();
+        }
+
+        /**
+         * @brief Store QoS1 publishes made while offline on disk and send them after connecting
+         *
+         * While an offline publish store is set, QoS1 publishes made by PublishAsync while the client is
+         * disconnected or the in-flight window is full are appended to the store instead of failing. They are sent
+         * in order after connecting, at the rate set by SetOfflinePublishDrainRate. Publishes left in the store by
+         * a previous run of the application are sent as well. Must be called before Connect.
+         *
+         * @param p_offline_publish_store - Store to use, nullptr to disable
+         */
+        virtual void SetOfflinePublishStore(std::shared_ptr<mqtt::OfflinePublishStore> p_offline_publish_store) {
+            p_client_state_->SetOfflinePublishStore(p_offline_publish_store);
+        }
+
+        /**
+         * @brief Set the rate at which publishes from the offline publish store are sent after connecting
+         *
+         * The default is DEFAULT_OFFLINE_PUBLISH_DRAIN_RATE_PER_SECOND
+         *
+         * @param publishes_per_second - Max stored publishes sent per second, values below one are treated as one
+         */
+        virtual void SetOfflinePublishDrainRate(double publishes_per_second) {
+            p_client_state_->SetOfflinePublishDrainRate(publishes_per_second);
+        }
+
+        /**
+         * @brief Run subscription callbacks on the worker threads of a dispatcher
+         *
+         * By default subscription callbacks run on the network read thread, so a slow callback delays all other
+         * incoming packets. Must be called before Connect.
+         *
+         * @param p_inbound_dispatcher - Dispatcher to use, nullptr to run callbacks on the read thread
+         */
+        virtual void SetInboundDispatcher(std::shared_ptr<mqtt::InboundMessageDispatcher> p_inbound_dispatcher) {
+            p_client_state_->SetInboundDispatcher(p_inbound_dispatcher);
+        }
+
+        /**
+         * @brief Read incoming packets on a reactor shared with other clients
+         *
+         * By default each client has its own network read thread. With a reactor, incoming packets are read and
+         * handled on the reactor's worker threads when the network connection becomes readable, so many clients
+         * share a few threads. Only used if the network connection is pollable. Must be called before Connect.
+         *
+         * @param p_io_reactor - Reactor to use, nullptr to use a network read thread
+         */
+        virtual void SetIoReactor(std::shared_ptr<util::Threading::IoReactor> p_io_reactor) {
+            p_client_core_->SetIoReactor(p_io_reactor);
+        }
+
+        /**
+         * @brief Process queued actions on an executor shared with other clients
+         *
+         * By default each client has its own thread sending queued actions. With an executor, queued actions are
+         * sent by tasks that run on the executor's threads only while there is something to send.
+         *
+         * @param p_executor - Executor to use, nullptr to use an outbound processing thread
+         */
+        virtual void SetExecutor(std::shared_ptr<util::Threading::Executor> p_executor) {
+            p_client_core_->SetExecutor(p_executor);
+        }
+
+        /**
+         * @brief Run keep alive and reconnects on a timer service shared with other clients
+         *
+         * By default each client has its own keepalive thread. With a timer service, pings, ping response deadlines,
+         * reconnect backoff and sending of stored publishes are timers on the service, so a client uses no thread
+         * while nothing is due. Reconnect attempts block the timer thread unless the service runs its callbacks on an
+         * executor. Must be called before Connect.
+         *
+         * @param p_timer_service - Timer service to use, nullptr to use a keepalive thread
+         */
+        virtual void SetTimerService(std::shared_ptr<util::Threading::TimerService> p_timer_service) {
+            p_client_core_->SetTimerService(p_timer_service);
+        }
+
         /**
          * @brief Set the callback function for disconnects
          *
@@ -410,5 +577,14 @@ namespace awsiotsdk {
         virtual ResponseCode SetResubscribeCallbackPtr(ClientCoreState::ApplicationResubscribeCallbackPtr p_callback_ptr,
                                                        std::shared_ptr<ResubscribeCallbackContextData> p_app_handler_data);
 
+        /**
+         * @brief Get the time from the last automatic reconnect until all subscriptions were acknowledged again
+         *
+         * @return std::chrono::milliseconds - Time taken, negative if no resubscribe has finished yet
+         */
+        virtual std::chrono::milliseconds GetLastResubscribeDuration() {
+            return p_client_state_->GetLastResubscribeDuration();
+        }
+
     };
 }
@@ -22,19 +22,57 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
+#include <functional>
 
 #include "util/Utf8String.hpp"
+#include "util/memory/ObjectPool.hpp"
 #include "util/memory/stl/Map.hpp"
 
 #include "Action.hpp"
 #include "ClientCore.hpp"
 
 #include "mqtt/Common.hpp"
+#include "mqtt/InboundDispatcher.hpp"
+#include "mqtt/OfflinePublishStore.hpp"
+#include "mqtt/ReconnectBackoff.hpp"
+#include "mqtt/SubscriptionRegistry.hpp"
+
+/**
+ * Default max number of unacknowledged QoS1 publishes sent by PublishAsync. Matches the AWS IoT in-flight limit
+ */
+#define DEFAULT_MAX_INFLIGHT_PUBLISHES 100
+
+/**
+ * Default rate at which publishes stored while offline are sent after reconnecting
+ */
+#define DEFAULT_OFFLINE_PUBLISH_DRAIN_RATE_PER_SECOND 20
+
+/**
+ * Default max number of publish packets and of puback packets kept for reuse. Covers a full in-flight window
+ */
+#define DEFAULT_PACKET_POOL_SIZE 128
 
 namespace awsiotsdk {
     namespace mqtt {
+        class PublishPacket;
+        class PubackPacket;
+
         class ClientState : public ClientCoreState {
         protected:
+            /**
+             * @brief In-flight Publish Data Class
+             *
+             * Defining an internal class for storing a QoS1 publish that has not been acknowledged yet.
+             *
+             */
+            class InflightPublishData {
+            public:
+                std::shared_ptr<PublishPacket> p_publish_packet_;  ///< Packet to send again after a reconnect
+                bool is_sent_;                                     ///< Whether the packet has been written to the network
+                bool is_resend_deferred_;                          ///< Whether the packet waits for space in the control queue to be sent again
+                bool is_resend_queued_;                            ///< Whether the packet is in the control queue to be sent again
+            };
 
             bool is_session_present_;
             std::atomic_bool is_connected_;
@@ -42,18 +80,66 @@ namespace awsiotsdk {
             std::atomic_bool is_auto_reconnect_required_;
             std::atomic_bool is_pingreq_pending_;
 
-            uint16_t last_sent_packet_id_;
+            std::atomic<uint16_t> last_sent_packet_id_;
 
             std::chrono::seconds keep_alive_timeout_;
             std::chrono::seconds min_reconnect_backoff_timeout_;
             std::chrono::seconds max_reconnect_backoff_timeout_;
             std::chrono::milliseconds mqtt_command_timeout_;
 
+            std::shared_ptr<ReconnectBackoffStrategy> p_reconnect_backoff_strategy_;  ///< Waits before reconnect attempts
+            ReconnectTimeHistogram reconnect_time_histogram_;                        ///< Times taken to reconnect
+            std::atomic<std::chrono::milliseconds::rep> last_resubscribe_duration_ms_;  ///< Atomic, Time taken by the last resubscribe, -1 if none finished
+
             std::shared_ptr<ActionData> p_connect_data_;
 
             std::atomic_bool trigger_disconnect_callback_;
+
+            SubscriptionRegistry subscription_registry_;  ///< Subscriptions of this client, shared by all threads
+            std::shared_ptr<InboundMessageDispatcher> p_inbound_dispatcher_;  ///< Runs subscription callbacks, nullptr to run them on the read thread
+
+            std::mutex inflight_publish_lock_;                       ///< Mutex for in-flight publish operations
+            util::Vector<InflightPublishData> inflight_publishes_;   ///< Unacknowledged QoS1 publishes in the order they were sent
+            size_t max_inflight_publishes_;                          ///< Max number of unacknowledged QoS1 publishes
+            std::atomic<size_t> deferred_resend_count_;              ///< Atomic, number of publishes waiting to be sent again, see EnqueueDeferredControlActions
+
+            std::shared_ptr<OfflinePublishStore> p_offline_publish_store_;  ///< Store for QoS1 publishes made while offline, can be nullptr
+            std::mutex offline_publish_drain_lock_;                         ///< Mutex for draining the offline publish store
+            ActionRateLimitData offline_publish_drain_rate_;                ///< Rate at which stored publishes are sent
+            std::mutex offline_publish_handler_lock_;                       ///< Mutex for the handlers of stored publishes
+            util::Map<uint64_t, ActionData::AsyncAckNotificationHandlerPtr> offline_publish_handlers_;  ///< Ack handlers of stored publishes, by record ID
+
+            util::ObjectPool<PublishPacket> publish_packet_pool_;    ///< Publish packets reused once they have been sent and acked
+            util::ObjectPool<PubackPacket> puback_packet_pool_;      ///< Puback packets reused once they have been sent
+
+            std::atomic<std::chrono::steady_clock::rep> last_inbound_activity_time_;  ///< Atomic, Time since epoch at which a packet was last received
+            std::mutex keepalive_wakeup_lock_;                       ///< Mutex for waking up the keepalive
+            std::condition_variable keepalive_wakeup_wait_;          ///< Signaled when the keepalive is woken up
+            bool is_keepalive_wakeup_pending_;                       ///< True from a wakeup until the keepalive waits again
+            std::function<void()> p_keepalive_wakeup_handler_;       ///< Wakes up a keepalive run by a timer service, can be nullptr
+
+            /**
+             * @brief Queue a QoS1 publish and track it in the in-flight window
+             *
+             * @param p_publish_packet - Packet to publish
+             * @param p_async_ack_handler - Ack handler of the caller, can be nullptr
+             * @param packet_id_out - Packet ID assigned to the outgoing packet
+             * @return ResponseCode indicating status of request
+             */
+            ResponseCode EnqueueInflightPublish(std::shared_ptr<PublishPacket> p_publish_packet,
+                                                ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                                uint16_t &packet_id_out);
+
+            /**
+             * @brief Add a QoS1 publish to the offline publish store
+             *
+             * @param p_publish_packet - Packet to store
+             * @param p_async_ack_handler - Ack handler of the caller, can be nullptr
+             * @return ResponseCode indicating status of request
+             */
+            ResponseCode StorePublish(std::shared_ptr<PublishPacket> p_publish_packet,
+                                      ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler);
         public:
-            util::Map<util::String, std::shared_ptr<Subscription>> subscription_map_;
 
             // Rule of 5 stuff
             // Disable copying and moving because class contains std::atomic<> types used for thread synchronization
@@ -77,13 +163,24 @@ namespace awsiotsdk {
                     is_auto_reconnect_required_ = false;
                 }
                 SetProcessQueuedActions(value);
+                WakeKeepalive();
             }
 
             bool IsAutoReconnectEnabled() { return is_auto_reconnect_enabled_; }
-            void SetAutoReconnectEnabled(bool value) { is_auto_reconnect_enabled_ = value; }
+            void SetAutoReconnectEnabled(bool value) {
+                is_auto_reconnect_enabled_ = value;
+                if (value) {
+                    WakeKeepalive();
+                }
+            }
 
             bool IsAutoReconnectRequired() { return is_auto_reconnect_required_; }
-            void SetAutoReconnectRequired(bool value) { is_auto_reconnect_required_ = value; }
+            void SetAutoReconnectRequired(bool value) {
+                is_auto_reconnect_required_ = value;
+                if (value) {
+                    WakeKeepalive();
+                }
+            }
 
             bool IsPingreqPending() { return is_pingreq_pending_; }
             void SetPingreqPending(bool value) { is_pingreq_pending_ = value; }
@@ -106,6 +203,7 @@ namespace awsiotsdk {
             std::chrono::milliseconds GetMqttCommandTimeout() { return mqtt_command_timeout_; }
             void SetMqttCommandTimeout(std::chrono::milliseconds mqtt_command_timeout) {
                 mqtt_command_timeout_ = mqtt_command_timeout;
+                SetAckTimeout(mqtt_command_timeout);
             }
 
             std::chrono::seconds GetMinReconnectBackoffTimeout() { return min_reconnect_backoff_timeout_; }
@@ -118,11 +216,313 @@ namespace awsiotsdk {
                 max_reconnect_backoff_timeout_ = max_reconnect_backoff_timeout;
             }
 
+            /**
+             * @brief Set the strategy deciding the wait before each reconnect attempt
+             *
+             * Must be set before connecting. The default is a FullJitterBackoffStrategy using the min and max
+             * reconnect backoff
+             *
+             * @param p_reconnect_backoff_strategy - Strategy to use, nullptr to restore the default
+             */
+            void SetReconnectBackoffStrategy(std::shared_ptr<ReconnectBackoffStrategy> p_reconnect_backoff_strategy);
+            std::shared_ptr<ReconnectBackoffStrategy> GetReconnectBackoffStrategy() {
+                return p_reconnect_backoff_strategy_;
+            }
+
+            /**
+             * @brief Get the histogram of times from losing the connection to reconnecting, counted by the keepalive
+             * @return ReconnectTimeHistogram reference
+             */
+            ReconnectTimeHistogram &GetReconnectTimeHistogram() { return reconnect_time_histogram_; }
+
+            /**
+             * @brief Record the time from a reconnect to the SUBACK of the last subscription sent again, called by
+             * the keepalive
+             *
+             * @param resubscribe_duration - Time taken to resubscribe
+             */
+            void RecordResubscribeDuration(std::chrono::milliseconds resubscribe_duration) {
+                last_resubscribe_duration_ms_ = resubscribe_duration.count();
+            }
+
+            /**
+             * @brief Get the time from the last reconnect until the client was fully subscribed again
+             * @return std::chrono::milliseconds - Time taken, negative if no resubscribe has finished yet
+             */
+            std::chrono::milliseconds GetLastResubscribeDuration() {
+                return std::chrono::milliseconds(last_resubscribe_duration_ms_);
+            }
+
+            /**
+             * @brief Set the dispatcher used to run subscription callbacks for incoming messages
+             *
+             * Must be set before connecting. If not set, callbacks run on the network read thread
+             *
+             * @param p_inbound_dispatcher - Dispatcher to use, nullptr to run callbacks on the read thread
+             */
+            void SetInboundDispatcher(std::shared_ptr<InboundMessageDispatcher> p_inbound_dispatcher) {
+                p_inbound_dispatcher_ = p_inbound_dispatcher;
+            }
+            std::shared_ptr<InboundMessageDispatcher> GetInboundDispatcher() { return p_inbound_dispatcher_; }
+
+            /**
+             * @brief Set the max number of unacknowledged QoS1 publishes
+             *
+             * Publishes already in flight are not affected. A size of zero is treated as one
+             *
+             * @param max_inflight_publishes - Max number of unacknowledged QoS1 publishes
+             */
+            void SetMaxInflightPublishes(size_t max_inflight_publishes);
+
+            /**
+             * @brief Get the max number of unacknowledged QoS1 publishes
+             * @return size_t max count
+             */
+            size_t GetMaxInflightPublishes();
+
+            /**
+             * @brief Get the number of unacknowledged QoS1 publishes
+             * @return size_t count
+             */
+            size_t GetInflightPublishCount();
+
+            /**
+             * @brief Start tracking a QoS1 publish until it is acknowledged
+             *
+             * Must be called before the publish is queued, so it is tracked before the acknowledgement can arrive
+             *
+             * @param p_publish_packet - Publish to track
+             * @return ResponseCode - SUCCESS if tracked, MQTT_INFLIGHT_WINDOW_FULL_ERROR if the max number of
+             * unacknowledged publishes are already in flight
+             */
+            ResponseCode AddInflightPublish(std::shared_ptr<PublishPacket> p_publish_packet);
+
+            /**
+             * @brief Mark a tracked publish as written to the network. Has no effect if the publish is not tracked
+             * @param packet_id - Packet ID of the publish
+             */
+            void SetInflightPublishSent(uint16_t packet_id);
+
+            /**
+             * @brief Stop tracking a publish. Called when the publish is acknowledged or has failed, see KeepInflightPublish
+             * @param packet_id - Packet ID of the publish
+             */
+            void RemoveInflightPublish(uint16_t packet_id);
+
+            /**
+             * @brief Check whether a failed publish stays in the in-flight window
+             *
+             * Publishes that reached the network are only removed when they are acknowledged, or when they time out
+             * on a working connection. While the client is disconnected or reconnecting they are kept so they can be
+             * sent again after the reconnect
+             *
+             * @param packet_id - Packet ID of the publish
+             * @param ack_rc - Response the publish received
+             * @return true if the publish is kept and the response must not be passed on
+             */
+            bool KeepInflightPublish(uint16_t packet_id, ResponseCode ack_rc);
+
+            /**
+             * @brief Queue all unacknowledged publishes to be sent again after a reconnect
+             *
+             * The publishes are queued as control actions, so they are sent ahead of anything queued while the client
+             * was disconnected without writing from the network read thread. The duplicate flag is set if the session
+             * is present, otherwise the broker has no record of the publishes and they are sent as new messages.
+             * Publishes that have not been sent yet are left for the outbound processing thread. The window can be
+             * larger than the control queue, publishes that do not fit are queued by the outbound processing as the
+             * control queue drains, see EnqueueDeferredControlActions. Their Ack timeout starts when they are sent
+             */
+            void ResendInflightPublishes();
+
+            /**
+             * @brief Queue publishes to be sent again that did not fit in the control queue
+             * @return size_t - Number of publishes queued
+             */
+            virtual size_t EnqueueDeferredControlActions();
+
+            /**
+             * @brief Queue a publish
+             *
+             * QoS1 publishes are tracked in the in-flight window until they are acknowledged, fail or time out, see
+             * KeepInflightPublish. If an offline publish store is set, QoS1 publishes are stored instead while the
+             * client is disconnected, while the window is full and while earlier stored publishes have not been sent
+             * yet. A stored publish has no packet ID until it is sent, the ack handler is called with the packet ID
+             * used once it is acknowledged
+             *
+             * @param p_publish_packet - Packet to publish
+             * @param p_async_ack_handler - Ack handler of the caller, can be nullptr
+             * @param packet_id_out - Packet ID assigned to the outgoing packet, zero if the publish was stored
+             * @return ResponseCode indicating status of request
+             */
+            ResponseCode EnqueuePublish(std::shared_ptr<PublishPacket> p_publish_packet,
+                                        ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                        uint16_t &packet_id_out);
+
+            /**
+             * @brief Get a publish packet, reusing a pooled packet that is no longer in use if there is one
+             *
+             * @param p_topic_name - Topic name of the publish, must not be nullptr
+             * @param is_retained - Is retained flag
+             * @param is_duplicate - Is duplicate message flag
+             * @param qos - QoS of the publish
+             * @param payload - Payload of the publish, copied into the packet
+             * @return shared_ptr to the packet
+             */
+            std::shared_ptr<PublishPacket> AcquirePublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                                                                bool is_retained, bool is_duplicate, QoS qos,
+                                                                const util::String &payload);
+
+            /**
+             * @brief Get a publish packet sharing the payload, reusing a pooled packet if there is one
+             *
+             * @param p_topic_name - Topic name of the publish, must not be nullptr
+             * @param is_retained - Is retained flag
+             * @param is_duplicate - Is duplicate message flag
+             * @param qos - QoS of the publish
+             * @param p_payload - Shared payload of the publish, can be nullptr
+             * @return shared_ptr to the packet
+             */
+            std::shared_ptr<PublishPacket> AcquirePublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                                                                bool is_retained, bool is_duplicate, QoS qos,
+                                                                std::shared_ptr<const util::String> p_payload);
+
+            /**
+             * @brief Get a puback packet, reusing a pooled packet that is no longer in use if there is one
+             *
+             * @param publish_packet_id - Packet ID of the publish to acknowledge
+             * @return shared_ptr to the packet
+             */
+            std::shared_ptr<PubackPacket> AcquirePubackPacket(uint16_t publish_packet_id);
+
+            /**
+             * @brief Set the store used for QoS1 publishes made while offline
+             *
+             * Must be set before connecting. Publishes left in the store by a previous run are sent after connecting
+             *
+             * @param p_offline_publish_store - Store to use, nullptr to fail publishes made while offline
+             */
+            void SetOfflinePublishStore(std::shared_ptr<OfflinePublishStore> p_offline_publish_store) {
+                p_offline_publish_store_ = p_offline_publish_store;
+            }
+            std::shared_ptr<OfflinePublishStore> GetOfflinePublishStore() { return p_offline_publish_store_; }
+
+            /**
+             * @brief Set the rate at which stored publishes are sent while connected
+             *
+             * @param publishes_per_second - Max publishes sent per second, values below one are treated as one
+             */
+            void SetOfflinePublishDrainRate(double publishes_per_second);
+
+            /**
+             * @brief Queue stored publishes for sending, limited by the drain rate and the in-flight window
+             *
+             * Called by the keepalive while connected. Stored publishes are removed from the store once acknowledged,
+             * publishes that fail are sent again later
+             *
+             * @return std::chrono::steady_clock::time_point - Time at which to drain again, time_point::max() if the
+             * store has no publishes left to send
+             */
+            std::chrono::steady_clock::time_point DrainOfflinePublishes();
+
+            /**
+             * @brief Record that a packet was received, called by the network read action for every packet
+             */
+            void RecordInboundActivity() {
+                last_inbound_activity_time_ = std::chrono::steady_clock::now().time_since_epoch().count();
+            }
+
+            /**
+             * @brief Get the time at which a packet was last received
+             * @return std::chrono::steady_clock::time_point - time of the last packet, the epoch if none was received
+             */
+            std::chrono::steady_clock::time_point GetLastInboundActivityTime() {
+                return std::chrono::steady_clock::time_point(
+                    std::chrono::steady_clock::duration(last_inbound_activity_time_));
+            }
+
+            /**
+             * @brief Wake up the keepalive so it handles a state change right away
+             *
+             * Called when the connection state changes and when publishes are stored while connected. The keepalive
+             * otherwise sleeps until its next ping, PINGRESP deadline or reconnect attempt is due
+             */
+            void WakeKeepalive();
+
+            /**
+             * @brief Wait until the keepalive is woken up or a deadline has passed
+             *
+             * Used by a keepalive running on its own thread. Returns right away if it was woken up since the last wait
+             *
+             * @param deadline - Time at which to stop waiting
+             */
+            void WaitForKeepaliveWakeup(std::chrono::steady_clock::time_point deadline);
+
+            /**
+             * @brief Set the handler that wakes up a keepalive run by a timer service
+             *
+             * @param p_wakeup_handler - Handler to call on wakeups, nullptr if the keepalive runs on its own thread
+             */
+            void SetKeepaliveWakeupHandler(std::function<void()> p_wakeup_handler);
+
+            /**
+             * @brief Wake up the keepalive so it notices a stop request right away
+             */
+            virtual void WakeActionRunners() {
+                WakeKeepalive();
+            }
+
             std::shared_ptr<ActionData> GetAutoReconnectData() { return p_connect_data_; }
             void SetAutoReconnectData(std::shared_ptr<ActionData> p_connect_data) { p_connect_data_ = p_connect_data; }
 
+            /**
+             * @brief Get a subscription matching the given topic name
+             *
+             * If several subscriptions match, a subscription with exactly this topic filter is preferred
+             *
+             * @param p_topic_name - Topic name to match
+             * @return shared_ptr to the Subscription, nullptr if none match
+             */
             std::shared_ptr<Subscription> GetSubscription(util::String p_topic_name);
 
+            /**
+             * @brief Get all subscriptions matching the given topic name
+             *
+             * @param topic_name - Topic name to match
+             * @param matches[out] - Vector the matching subscriptions are appended to
+             */
+            void GetMatchingSubscriptions(const util::String &topic_name,
+                                          util::Vector<std::shared_ptr<Subscription>> &matches);
+
+            /**
+             * @brief Get a snapshot of all subscriptions
+             *
+             * The snapshot does not change, subscriptions added or removed after this call are not reflected in it
+             *
+             * @return shared_ptr to the snapshot
+             */
+            std::shared_ptr<const SubscriptionRegistry::Snapshot> GetSubscriptionSnapshot() {
+                return subscription_registry_.GetSnapshot();
+            }
+
+            /**
+             * @brief Update a snapshot held by the caller if subscriptions were added or removed since it was taken
+             *
+             * Does not take a lock if the snapshot is still current. Used on the incoming message path
+             *
+             * @param p_snapshot[in,out] - Snapshot held by the caller, can be nullptr
+             */
+            void RefreshSubscriptionSnapshot(std::shared_ptr<const SubscriptionRegistry::Snapshot> &p_snapshot) {
+                subscription_registry_.RefreshSnapshot(p_snapshot);
+            }
+
+            /**
+             * @brief Add a subscription, replacing an inactive subscription for the same topic filter
+             *
+             * @param p_subscription - Subscription to add
+             * @return ResponseCode - SUCCESS if added, FAILURE if an active subscription exists for the topic filter
+             */
+            ResponseCode AddSubscription(std::shared_ptr<Subscription> p_subscription);
+
             std::shared_ptr<Subscription> SetSubscriptionPacketInfo(util::String p_topic_name,
                                                                     uint16_t packet_id,
                                                                     uint8_t index_in_packet);
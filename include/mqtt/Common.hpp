@@ -21,6 +21,8 @@
 
 #pragma once
 
+#include <atomic>
+
 #include "util/Utf8String.hpp"
 #include "ResponseCode.hpp"
 
@@ -148,6 +150,14 @@ namespace awsiotsdk {
              */
             void WriteToBuffer(util::String &buf);
 
+            /**
+             * @brief Serialize and write Will Options to a buffer that has space for them
+             *
+             * @param p_buf - Target buffer
+             * @return Pointer to the byte after the Will Options
+             */
+            char *WriteToBuffer(char *p_buf);
+
             /**
              * @brief Set Connect flags in the provided buffer based on Will Options instance
              *
@@ -167,6 +177,24 @@ namespace awsiotsdk {
             virtual ~SubscriptionHandlerContextData() = 0;
         };
 
+        /**
+         * @brief MQTT Message Buffer View
+         *
+         * Non-owning reference to the topic name or payload of a received message. Points into the buffer the
+         * message was read into and is only valid for the duration of the subscription callback it is passed to.
+         */
+        class MessageBufferView {
+        public:
+            const char *p_data_;    ///< Start of the range
+            size_t length_;         ///< Number of bytes in the range
+
+            /**
+             * @brief Copy the referenced bytes into a String that outlives the callback
+             * @return util::String containing a copy of the bytes
+             */
+            util::String ToString() const { return util::String(p_data_, length_); }
+        };
+
         /**
          * @brief MQTT Subscription Definition
          *
@@ -187,17 +215,27 @@ namespace awsiotsdk {
             typedef std::function<ResponseCode(util::String topic_name, util::String payload,
                                                std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data)> ApplicationCallbackHandlerPtr;
 
-            ApplicationCallbackHandlerPtr p_app_handler_;                         ///< Pointer to the Application Handler
+            /**
+             * @brief Define handler for Application Callbacks that receive views of the message.
+             *
+             * Same as ApplicationCallbackHandlerPtr, except that topic name and payload are not copied. The views are
+             * only valid until the handler returns, handlers must copy any data they need to keep.
+             */
+            typedef std::function<ResponseCode(const MessageBufferView &topic_name, const MessageBufferView &payload,
+                                               std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data)> ApplicationViewCallbackHandlerPtr;
+
+            ApplicationCallbackHandlerPtr p_app_handler_;                         ///< Pointer to the Application Handler, empty if a view handler is used
+            ApplicationViewCallbackHandlerPtr p_app_view_handler_;                ///< Pointer to the Application View Handler, takes precedence over p_app_handler_ if set
             std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data_;  ///< Data to be passed to the Application Handler
             util::String p_topic_regex_;                                          ///< Topic regex string which is used if the topic is a wildcard topic
 
             // Disabling default constructor. Defining a virtual destructor
-            // Ensure Subscription Instances can be copied/moved
-            Subscription() = delete;                                    // Delete Default constructor
-            Subscription(const Subscription &) = default;               // Delete Copy constructor
-            Subscription(Subscription &&) = default;                    // Default Move constructor
-            Subscription &operator=(const Subscription &) & = default;  // Delete Copy assignment operator
-            Subscription &operator=(Subscription &&) & = default;       // Default Move assignment operator
+            // Disable copying and moving, instances are shared between threads and subscription registry snapshots
+            Subscription() = delete;                                   // Delete Default constructor
+            Subscription(const Subscription &) = delete;               // Delete Copy constructor
+            Subscription(Subscription &&) = delete;                    // Delete Move constructor
+            Subscription &operator=(const Subscription &) = delete;    // Delete Copy assignment operator
+            Subscription &operator=(Subscription &&) = delete;         // Delete Move assignment operator
             virtual ~Subscription() {
                 // Do NOT delete App handler data
             }
@@ -230,6 +268,36 @@ namespace awsiotsdk {
                                                         ApplicationCallbackHandlerPtr p_app_handler,
                                                         std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data);
 
+            /**
+             * @brief Factory method to create a Subscription instance whose handler receives views of the message
+             *
+             * Avoids copying the topic name and payload of each received message into Strings.
+             *
+             * @param p_topic_name - Topic name for this subscription
+             * @param max_qos - Max QoS
+             * @param p_app_view_handler - Application View Handler instance
+             * @param p_app_handler_data - Data to be passed to application handler. Can be nullptr
+             *
+             * @return shared_ptr Subscription instance, nullptr on error
+             */
+            static std::shared_ptr<Subscription> CreateWithViewHandler(std::unique_ptr<Utf8String> p_topic_name,
+                                                                       QoS max_qos,
+                                                                       ApplicationViewCallbackHandlerPtr p_app_view_handler,
+                                                                       std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data);
+
+            /**
+             * @brief Call the application handler with a received message
+             *
+             * Calls the view handler if one is set. Otherwise the topic name and payload are copied into Strings for
+             * the application handler.
+             *
+             * @param topic_name - Topic the message was received on
+             * @param payload - Message payload
+             *
+             * @return ResponseCode returned by the handler
+             */
+            ResponseCode InvokeHandler(const MessageBufferView &topic_name, const MessageBufferView &payload);
+
             /**
            * @brief Is the Topic Name Valid?
             *
@@ -256,7 +324,7 @@ namespace awsiotsdk {
              *
              * @return uint16_t ID of the packet
              */
-            uint16_t GetPacketId() { return packet_id_; }
+            uint16_t GetPacketId() { return static_cast<uint16_t>(ack_index_.load() >> 8); }
 
             /**
              * @brief Set expected index of Ack for this Subscription in the SUBACK packet
@@ -265,8 +333,7 @@ namespace awsiotsdk {
              * @param index_in_packet - Expected Index in packet
              */
             void SetAckIndex(uint16_t packet_id, uint8_t index_in_packet) {
-                packet_id_ = packet_id;
-                index_in_packet_ = index_in_packet;
+                ack_index_ = (static_cast<uint32_t>(packet_id) << 8) | index_in_packet;
             }
 
             /**
@@ -300,13 +367,12 @@ namespace awsiotsdk {
              * @return boolean indicating whether this Subscription was the target for the received SUBACK
              */
             bool IsInSuback(uint16_t packet_id, uint8_t index_in_packet) {
-                return (packet_id == packet_id_ && index_in_packet == index_in_packet_);
+                return (((static_cast<uint32_t>(packet_id) << 8) | index_in_packet) == ack_index_.load());
             }
         protected:
-            bool is_active_;                            ///< Boolean indicating weather the subscription is active or not
-            uint16_t packet_id_;                        ///< Packet Id of the Subscribe/Unsubscribe Packet
-            uint8_t index_in_packet_;                   ///< Index of the subscription in the Subscribe/Unsubscribe Packet
-            QoS max_qos_;                               ///< Max QoS for messages on this subscription
+            std::atomic_bool is_active_;                ///< Boolean indicating weather the subscription is active or not
+            std::atomic<uint32_t> ack_index_;           ///< Packet Id (upper 16 bits) and index (lower 8 bits) of the subscription in the Subscribe/Unsubscribe Packet
+            std::atomic<QoS> max_qos_;                  ///< Max QoS for messages on this subscription
             std::shared_ptr<Utf8String> p_topic_name_;  ///< Topic Name for this subscription
         };
     }
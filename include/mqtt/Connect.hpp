@@ -152,12 +152,6 @@ namespace awsiotsdk {
                                                          std::unique_ptr<Utf8String> p_password,
                                                          std::unique_ptr<mqtt::WillOptions> p_will_msg);
 
-            /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
-             */
-            util::String ToString();
-
             /**
              * @brief Get duration of Keep alive interval in seconds
              * @return std::chrono::seconds Keep alive interval duration
@@ -169,6 +163,13 @@ namespace awsiotsdk {
              * @return String containing the client ID
              */
             util::String GetClientID() { return p_client_id_ ? p_client_id_->ToStdString() : ""; }
+
+        protected:
+            /**
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
+             */
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -197,11 +198,12 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<DisconnectPacket> Create();
 
+        protected:
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
              */
-            util::String ToString();
+            char *WriteToBuffer(char *p_buf);
         };
 
         class PingreqPacket : public Packet {
@@ -225,11 +227,12 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<PingreqPacket> Create();
 
+        protected:
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
              */
-            util::String ToString();
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -350,11 +353,79 @@ namespace awsiotsdk {
          * @brief Define a class for KeepaliveActionRunner
          *
          * This class defines an action for performing a MQTT Keep Alive operation. This is meant to be run in a separate
-         * thread using ClientCore and will not do anything if called for one single execution using Perform Action.
+         * thread or by a timer service using ClientCore and does one check if called for one single execution using
+         * Perform Action.
          */
         class KeepaliveActionRunner : public Action {
         protected:
+            /**
+             * @brief Resubscribe Progress Class
+             *
+             * Defining an internal class for tracking the SUBACKs of the subscribe packets sent after a reconnect.
+             * Shared with the Ack handlers of the packets, which run on the network read thread.
+             */
+            class ResubscribeProgress {
+            public:
+                std::mutex progress_lock_;                          ///< Mutex for all progress updates
+                util::String client_id_;                            ///< Client ID passed to the resubscribe callback
+                std::chrono::steady_clock::time_point start_time_;  ///< Time at which the reconnect was accepted
+                size_t pending_packet_count_;                       ///< Number of subscribe packets without a SUBACK
+                bool has_success_;                                  ///< At least one topic filter was accepted
+                bool has_failure_;                                  ///< At least one topic filter was rejected
+                bool has_timeout_;                                  ///< At least one SUBACK did not arrive in time
+                bool is_finished_;                                  ///< Result was reported, later Acks are ignored
+            };
+
             std::shared_ptr<ClientState> p_client_state_;    ///< Shared Client State instance
+            util::String pingreq_data_;                      ///< Serialized ping request, identical for every ping
+            bool is_started_;                                ///< Has the first connect been seen
+            bool was_connected_;                             ///< Was the client connected on the last check
+            std::shared_ptr<ReconnectBackoffStrategy> p_reconnect_backoff_strategy_;  ///< Strategy used since the last loss
+            std::chrono::steady_clock::time_point disconnect_time_;         ///< Time at which the connection loss was seen
+            std::chrono::steady_clock::time_point next_reconnect_time_;     ///< Time of the next reconnect attempt
+            std::chrono::steady_clock::time_point keepalive_reference_time_;  ///< Time of the last ping request, or of the connect if none was sent since
+            util::String resubscribe_buffer_;                ///< Subscribe packets written together after a reconnect
+
+            /**
+             * @brief Report the result of a resubscribe to the Client state and the resubscribe callback
+             *
+             * @param p_client_state - Client state of the resubscribe
+             * @param progress - Progress of the resubscribe, already marked as finished
+             * @param rc - Result to report
+             */
+            static void FinishResubscribe(std::shared_ptr<ClientState> p_client_state,
+                                          const ResubscribeProgress &progress, ResponseCode rc);
+
+            /**
+             * @brief Restore the subscriptions after a reconnect
+             *
+             * If the server reports that the session is present, it still has the subscriptions. Only subscriptions
+             * that were never acknowledged are sent again, the others are marked active. Otherwise all subscriptions
+             * are sent again, in full subscribe packets that are written together without waiting for SUBACKs. Each
+             * topic filter is tracked by packet ID and index, SUBACKs activate accepted filters and remove rejected
+             * ones as they arrive. The resubscribe callback is called once the last SUBACK arrived or timed out, and
+             * the time this took is recorded in the Client state.
+             *
+             * @param p_network_connection - Network connection instance to write the subscribe packets to
+             * @param client_id - Client ID passed to the resubscribe callback
+             * @return ResponseCode - SUCCESS if all subscribe packets were written, error of the write otherwise. The
+             * resubscribe callback is called with the error before returning
+             */
+            ResponseCode Resubscribe(std::shared_ptr<NetworkConnection> p_network_connection,
+                                     const util::String &client_id);
+
+            /**
+             * @brief Do the keep alive work that is due
+             *
+             * Reconnects if required, sends publishes stored while offline, and sends a ping request or disconnects
+             * if the ping response is overdue. A ping request is skipped while packets are both sent and received,
+             * such traffic already shows the connection is alive and resets the keep alive timer of the server.
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @return std::chrono::steady_clock::time_point - Time at which more work is due, time_point::max() if
+             * nothing is due until the client state changes
+             */
+            std::chrono::steady_clock::time_point RunKeepalive(std::shared_ptr<NetworkConnection> p_network_connection);
         public:
             // Disabling default, move and copy constructors to match Action parent
             // Default virtual destructor
@@ -394,8 +465,9 @@ namespace awsiotsdk {
              * Performs the MQTT Keep Alive operation. Will send out Ping requests at Half the specified Keepalive
              * interval and expect a response to be received before that same period passes again. If a response is not
              * received during that time, assumes connection has been lost and initiates and performs a reconnect. Also
-             * resubscribes to any existing subscribed topics. Uses exponential backoff using minimum and maximum values
-             * defined in Client state.
+             * resubscribes to any existing subscribed topics. Waits before each reconnect attempt as decided by the
+             * reconnect backoff strategy of the Client state. Sleeps until the next of these is due or the client state changes, see
+             * ClientState::WakeKeepalive.
              *
              * @param p_network_connection - Network connection instance to use for performing this action
              * @param p_action_data - Action data specific to this execution of the Action
@@ -403,6 +475,26 @@ namespace awsiotsdk {
              */
             ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                        std::shared_ptr<ActionData> p_action_data);
+
+            bool IsTimerDriven() {
+                return true;
+            }
+
+            /**
+             * @brief Perform the MQTT Keep Alive work that is due, when run by a timer service
+             *
+             * Same as one pass of PerformAction. A reconnect attempt blocks for up to the MQTT command timeout
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @return std::chrono::steady_clock::time_point - Time at which more work is due
+             */
+            std::chrono::steady_clock::time_point PerformTimedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                                     std::shared_ptr<ActionData> p_action_data);
+
+            void SetTimerWakeupHandler(std::function<void()> p_wakeup_handler) {
+                p_client_state_->SetKeepaliveWakeupHandler(p_wakeup_handler);
+            }
         };
     }
 }
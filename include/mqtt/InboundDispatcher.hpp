@@ -0,0 +1,213 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file InboundDispatcher.hpp
+ * @brief Worker threads that run subscription callbacks for incoming messages
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "util/memory/stl/Queue.hpp"
+#include "util/memory/stl/String.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "ClientCoreState.hpp"
+#include "ResponseCode.hpp"
+#include "mqtt/Common.hpp"
+
+/**
+ * Default number of worker threads running subscription callbacks
+ */
+#define DEFAULT_INBOUND_DISPATCH_WORKER_COUNT 2
+
+/**
+ * Default max number of messages queued for each worker thread
+ */
+#define DEFAULT_INBOUND_DISPATCH_MAX_QUEUE_SIZE 64
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /**
+         * @brief Inbound Dispatch Statistics
+         *
+         * Counters describing the load on an InboundMessageDispatcher, used to detect slow subscription callbacks
+         */
+        class InboundDispatchStatistics {
+        public:
+            uint64_t messages_queued_;          ///< Messages accepted for dispatch
+            uint64_t messages_delivered_;       ///< Messages for which the subscription callback has returned
+            uint64_t messages_dropped_;         ///< Messages rejected or overwritten because a queue was full
+            uint64_t blocked_dispatch_count_;   ///< Dispatch requests that had to wait for queue space
+            size_t queued_message_count_;       ///< Messages currently waiting in all queues
+            size_t max_queue_depth_;            ///< Highest number of messages seen waiting in a single queue
+        };
+
+        /**
+         * @brief Inbound Message Dispatcher
+         *
+         * Runs subscription callbacks on a fixed set of worker threads so that slow callbacks do not hold up the
+         * network read thread. Each subscription is always handled by the same worker, so the messages of one
+         * subscription are delivered in the order they were received. Each worker has a bounded queue, what happens
+         * when it is full is controlled by the same overflow policies as the outbound action queue:
+         *  - REJECT drops the incoming message
+         *  - OVERWRITE_OLDEST drops the oldest queued message of that worker
+         *  - BLOCK_WITH_TIMEOUT blocks the read thread, pushing back on the server through the network connection
+         *
+         * A dispatcher can be shared by several clients. A subscription callback may stop or destroy the dispatcher,
+         * for example by destroying the last client using it, see Stop.
+         */
+        class InboundMessageDispatcher {
+        protected:
+            /**
+             * @brief Message waiting to be delivered to a subscription
+             */
+            class InboundMessage {
+            public:
+                std::shared_ptr<Subscription> p_subscription_;  ///< Subscription to deliver to
+                util::String topic_name_;                       ///< Topic the message was received on
+                std::shared_ptr<const util::String> p_payload_; ///< Message payload, shared by all subscriptions the message is queued for
+            };
+
+            /**
+             * @brief Worker thread and its queue
+             */
+            class Worker {
+            public:
+                std::mutex queue_lock_;                         ///< Guards queue_
+                std::condition_variable message_wait_;          ///< Signaled when a message is queued or the worker is stopped
+                std::condition_variable space_wait_;            ///< Signaled when a message is removed from the queue
+                util::Queue<InboundMessage> queue_;             ///< Messages waiting for this worker
+                std::thread thread_;                            ///< Worker thread
+                bool is_detached_;                              ///< Boolean, True = Stop was called from a callback on this worker
+            };
+
+            util::Vector<std::shared_ptr<Worker>> workers_;     ///< Workers, messages are assigned by subscription
+            size_t max_queue_size_;                             ///< Max number of messages queued per worker
+            ActionQueueOverflowPolicy overflow_policy_;         ///< Behavior of dispatch requests when a queue is full
+            std::chrono::milliseconds block_timeout_;           ///< Max time a dispatch request blocks for with BLOCK_WITH_TIMEOUT
+            std::atomic_bool is_running_;                       ///< Atomic, false once the dispatcher is stopped
+
+            std::atomic<uint64_t> messages_queued_;             ///< Atomic, see InboundDispatchStatistics
+            std::atomic<uint64_t> messages_delivered_;          ///< Atomic, see InboundDispatchStatistics
+            std::atomic<uint64_t> messages_dropped_;            ///< Atomic, see InboundDispatchStatistics
+            std::atomic<uint64_t> blocked_dispatch_count_;      ///< Atomic, see InboundDispatchStatistics
+            std::atomic_size_t max_queue_depth_;                ///< Atomic, see InboundDispatchStatistics
+
+            /**
+             * @brief Constructor
+             *
+             * @param worker_count - Number of worker threads, zero is treated as one
+             * @param max_queue_size - Max number of messages queued per worker, zero is treated as one
+             * @param overflow_policy - Behavior of dispatch requests when a queue is full
+             * @param block_timeout - Max time to block for, only used with ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT
+             */
+            InboundMessageDispatcher(size_t worker_count, size_t max_queue_size,
+                                     ActionQueueOverflowPolicy overflow_policy,
+                                     std::chrono::milliseconds block_timeout);
+
+            /**
+             * @brief Deliver queued messages until the dispatcher is stopped and the queue is empty
+             *
+             * Returns without accessing the dispatcher if the worker was detached while running a callback.
+             *
+             * @param p_worker - Worker this thread belongs to, kept alive by the thread
+             */
+            void RunWorker(std::shared_ptr<Worker> p_worker);
+
+        public:
+            // Rule of 5 stuff
+            // Disable copying and moving because class contains running threads and std::atomic<> types
+            InboundMessageDispatcher() = delete;                                             // Delete Default constructor
+            InboundMessageDispatcher(const InboundMessageDispatcher &) = delete;             // Delete Copy constructor
+            InboundMessageDispatcher(InboundMessageDispatcher &&) = delete;                  // Delete Move constructor
+            InboundMessageDispatcher &operator=(const InboundMessageDispatcher &) = delete;  // Delete Copy assignment operator
+            InboundMessageDispatcher &operator=(InboundMessageDispatcher &&) = delete;       // Delete Move assignment operator
+
+            /**
+             * @brief Destructor, stops the dispatcher
+             */
+            ~InboundMessageDispatcher();
+
+            /**
+             * @brief Factory method to create a dispatcher, worker threads are started immediately
+             *
+             * @param worker_count - Number of worker threads, zero is treated as one
+             * @param max_queue_size - Max number of messages queued per worker, zero is treated as one
+             * @param overflow_policy - Behavior of dispatch requests when a queue is full
+             * @param block_timeout - Max time to block for, only used with ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT
+             *
+             * @return shared_ptr to the dispatcher
+             */
+            static std::shared_ptr<InboundMessageDispatcher> Create(size_t worker_count, size_t max_queue_size,
+                                                                    ActionQueueOverflowPolicy overflow_policy,
+                                                                    std::chrono::milliseconds block_timeout);
+
+            /**
+             * @brief Queue a message for delivery to a subscription
+             *
+             * @param p_subscription - Subscription whose callback should be called
+             * @param topic_name - Topic the message was received on
+             * @param payload - Message payload
+             *
+             * @return ResponseCode - SUCCESS if queued, ACTION_QUEUE_FULL if the message was not queued because the
+             * queue was full, FAILURE if the dispatcher is stopped
+             */
+            ResponseCode Dispatch(std::shared_ptr<Subscription> p_subscription, util::String topic_name,
+                                  util::String payload);
+
+            /**
+             * @brief Queue a message with a shared payload for delivery to a subscription
+             *
+             * Allows a message that matches several subscriptions to be queued without copying its payload for each
+             * of them. The payload must not be modified after this call.
+             *
+             * @param p_subscription - Subscription whose callback should be called
+             * @param topic_name - Topic the message was received on
+             * @param p_payload - Shared buffer containing the message payload
+             *
+             * @return ResponseCode - SUCCESS if queued, ACTION_QUEUE_FULL if the message was not queued because the
+             * queue was full, FAILURE if the dispatcher is stopped
+             */
+            ResponseCode Dispatch(std::shared_ptr<Subscription> p_subscription, util::String topic_name,
+                                  std::shared_ptr<const util::String> p_payload);
+
+            /**
+             * @brief Stop the dispatcher
+             *
+             * Further dispatch requests fail. Messages that are already queued are delivered before the worker
+             * threads exit. Blocks until all workers have exited.
+             *
+             * When called from a subscription callback, including by the destructor, the worker running the callback
+             * is detached instead of joined. It exits once the callback returns, without delivering the messages
+             * still queued for it.
+             */
+            void Stop();
+
+            /**
+             * @brief Get the current statistics
+             * @return InboundDispatchStatistics
+             */
+            InboundDispatchStatistics GetStatistics();
+        };
+    }
+}
@@ -31,6 +31,11 @@
 
 #define MAX_NO_OF_REMAINING_LENGTH_BYTES 4
 
+/**
+ * Initial size of the buffer incoming bytes are read into. Grows to fit larger packets
+ */
+#define NETWORK_READ_BUFFER_INITIAL_SIZE_BYTES 4096
+
 namespace awsiotsdk {
     namespace mqtt {
 
@@ -46,19 +51,55 @@ namespace awsiotsdk {
             std::shared_ptr<NetworkConnection> p_network_connection_;  ///< Shared Network Connection instance
 
             std::atomic_bool is_waiting_for_connack_;                  ///< Is this waiting for connack?
+            util::Vector<unsigned char> receive_buf_;                  ///< Bytes read from the network in bulk
+            size_t receive_buf_start_;                                 ///< Offset of the first byte not yet decoded
+            size_t receive_buf_end_;                                   ///< Offset one past the last byte read
+            std::shared_ptr<const SubscriptionRegistry::Snapshot> p_subscription_snapshot_;  ///< Subscriptions incoming publishes are matched against
+            util::Vector<std::shared_ptr<Subscription>> matching_subscriptions_;  ///< Reused for subscription lookups of incoming publishes
+            util::String topic_name_;                                  ///< Reused for the topic name of incoming publishes
+            util::Vector<unsigned char> packet_buf_;                   ///< Reused for packets decoded by PerformReadyAction
 
             /**
-             * @brief Decode Remaining length from MQTT packet
+             * @brief Decode Remaining length of the next MQTT packet in the receive buffer
              *
              * @param rem_len reference in which to store decoded length
+             * @param rem_len_bytes reference in which to store the number of bytes used to encode the length,
+             *                      set to zero if the length is not fully received yet
+             *
+             * @return ResponseCode indicating status of request
+             */
+            ResponseCode DecodeRemainingLength(size_t &rem_len, size_t &rem_len_bytes);
+
+            /**
+             * @brief Get the number of bytes required to decode the next MQTT packet in the receive buffer
+             *
+             * @param required_bytes reference in which to store the length of the packet, or the number of bytes
+             *                       needed to decode its remaining length if that is not fully received yet
+             * @param rem_len_bytes reference in which to store the number of bytes used to encode the remaining
+             *                      length, set to zero if the length is not fully received yet
              *
              * @return ResponseCode indicating status of request
              */
-            ResponseCode DecodeRemainingLength(size_t &rem_len);
+            ResponseCode GetBufferedPacketLength(size_t &required_bytes, size_t &rem_len_bytes);
+
+            /**
+             * @brief Read available bytes from the network into the receive buffer
+             *
+             * @param required_bytes number of bytes the receive buffer must be able to hold from the start of the
+             *                       next packet
+             * @param min_bytes_to_read number of bytes to wait for
+             *
+             * @return ResponseCode indicating status of request, NETWORK_SSL_NOTHING_TO_READ if no bytes were read
+             */
+            ResponseCode FillReceiveBuffer(size_t required_bytes, size_t min_bytes_to_read);
 
             /**
              * @brief Read MQTT Packet from buffer
              *
+             * Packets are decoded from a receive buffer that is filled with as many bytes as the network connection
+             * has available, so a single network read usually provides several packets. The network is only read
+             * when the buffer does not contain a complete packet.
+             *
              * @param fixed_header_byte Reference to string in which Fixed header byte should be stored
              * @param read_buf Reference to string in which the rest of the packet should be stored
              *
@@ -66,6 +107,25 @@ namespace awsiotsdk {
              */
             ResponseCode ReadPacketFromNetwork(unsigned char &fixed_header_byte, util::Vector<unsigned char> &read_buf);
 
+            /**
+             * @brief Handle a received MQTT packet according to its type
+             *
+             * @param fixed_header_byte Fixed header byte of the packet
+             * @param read_buf Reference to string buffer containing the rest of the packet
+             *
+             * @return ResponseCode indicating status of request
+             */
+            ResponseCode HandlePacket(unsigned char fixed_header_byte, const util::Vector<unsigned char> &read_buf);
+
+            /**
+             * @brief Handle a failed network read by requesting a reconnect, unless the runner is stopping
+             *
+             * @param rc ResponseCode of the failed read
+             *
+             * @return ResponseCode of the disconnect request if one was made, rc otherwise
+             */
+            ResponseCode HandleReadError(ResponseCode rc);
+
             /**
              * @brief Handle MQTT Connack packet
              *
@@ -78,6 +138,9 @@ namespace awsiotsdk {
             /**
              * @brief Handle MQTT Publish packet
              *
+             * Topic name and payload are passed to subscription handlers as views into read_buf. They are only
+             * copied for handlers that take Strings and for messages queued to an InboundMessageDispatcher.
+             *
              * @param read_buf Reference to string buffer containing the MQTT Publish payload
              * @param is_duplicate MQTT Is Duplicate message flag
              * @param is_retained MQTT Is retained flag
@@ -148,6 +211,27 @@ namespace awsiotsdk {
              */
             ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                        std::shared_ptr<ActionData> p_action_data);
+
+            /**
+             * @brief Network Read Action can be run by an IoReactor
+             * @return true
+             */
+            bool IsReadinessDriven() {
+                return true;
+            }
+
+            /**
+             * @brief Handle the packets that are available after the Network Connection became readable
+             *
+             * Reads the bytes that already arrived and handles every complete packet in them without waiting for
+             * more. A partially received packet is kept until the rest of it arrives.
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformReadyAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                            std::shared_ptr<ActionData> p_action_data);
         };
     }
 }
@@ -0,0 +1,225 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file OfflinePublishStore.hpp
+ * @brief On-disk store for QoS1 publishes made while the client is offline
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/String.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "ResponseCode.hpp"
+
+/**
+ * Default size of one segment file of the offline publish store
+ */
+#define DEFAULT_OFFLINE_STORE_SEGMENT_SIZE_BYTES (1024 * 1024)
+
+/**
+ * Default max number of segment files of the offline publish store
+ */
+#define DEFAULT_OFFLINE_STORE_MAX_SEGMENT_COUNT 16
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /**
+         * @brief Define policy used when the offline publish store has no space for a new publish
+         */
+        enum class OfflineStoreOverflowPolicy {
+            REJECT_NEW = 0,      ///< Fail the new publish with MQTT_OFFLINE_STORE_FULL_ERROR
+            DROP_OLDEST = 1      ///< Delete the oldest segment, losing the publishes stored in it
+        };
+
+        /**
+         * @brief Offline Publish Store
+         *
+         * Append-only log of QoS1 publishes split into fixed size segment files in one directory. Segments are
+         * memory mapped and their blocks are allocated when they are created, so a full disk makes Append fail
+         * instead of faulting on a write to the mapping. Each stored publish is written to the disk before Append
+         * returns. Each record is marked as acknowledged in place once the broker acks it, and a segment is deleted
+         * once all its records are acknowledged and a newer segment is being written.
+         * Opening a directory with existing segments continues with the publishes that were not acknowledged.
+         *
+         * Publishes are handed out in the order they were stored. A publish that could not be delivered is
+         * released and handed out again before newer publishes.
+         *
+         * Only supported on POSIX platforms, Create returns nullptr on other platforms.
+         */
+        class OfflinePublishStore {
+        public:
+            /**
+             * @brief Stored publish, as handed out to be sent
+             */
+            class Record {
+            public:
+                uint64_t record_id_;                          ///< ID used to acknowledge or release the publish
+                util::String topic_name_;                     ///< Topic name of the publish
+                std::shared_ptr<const util::String> p_payload_;  ///< Payload of the publish
+                bool is_retained_;                            ///< Retained flag of the publish
+            };
+
+        protected:
+            /**
+             * @brief Memory mapped segment file
+             */
+            class Segment {
+            public:
+                int fd_;                    ///< File descriptor of the segment file
+                char *p_data_;              ///< Mapping of the segment file
+                size_t size_bytes_;         ///< Size of the segment file
+                size_t write_offset_;       ///< Offset the next record is appended at
+                size_t read_offset_;        ///< Offset of the next record to hand out
+                size_t live_record_count_;  ///< Number of records not acknowledged yet
+            };
+
+            std::mutex store_lock_;                      ///< Mutex for all store operations
+            util::String directory_path_;                ///< Directory containing the segment files
+            size_t segment_size_bytes_;                  ///< Size of each segment file
+            size_t max_segment_count_;                   ///< Max number of segment files
+            OfflineStoreOverflowPolicy overflow_policy_; ///< Policy used when all segments are full
+            util::Map<uint64_t, Segment> segments_;      ///< Segments keyed by sequence number, last one is written
+            util::Vector<uint64_t> released_record_ids_; ///< Records to hand out again, in the order they were stored
+            size_t pending_record_count_;                ///< Number of records not acknowledged yet
+
+            OfflinePublishStore(util::String directory_path, size_t segment_size_bytes, size_t max_segment_count,
+                                OfflineStoreOverflowPolicy overflow_policy);
+
+            /**
+             * @brief Get the path of the segment file with the given sequence number
+             */
+            util::String GetSegmentPath(uint64_t sequence_number);
+
+            /**
+             * @brief Open and map a segment file, creating it if required, and find the records in it
+             * @return ResponseCode - SUCCESS if the segment was added to segments_
+             */
+            ResponseCode OpenSegment(uint64_t sequence_number, bool is_new);
+
+            /**
+             * @brief Get the segment holding a record
+             * @return Iterator to the segment, segments_.end() if it was deleted
+             */
+            util::Map<uint64_t, Segment>::iterator FindSegment(uint64_t record_id);
+
+            /**
+             * @brief Unmap and delete a segment file
+             */
+            void DeleteSegment(util::Map<uint64_t, Segment>::iterator segment_itr);
+
+            /**
+             * @brief Load a record from a segment. The record must be valid
+             */
+            void ReadRecord(const Segment &segment, uint64_t sequence_number, size_t offset, Record &record_out);
+
+        public:
+            // Rule of 5 stuff
+            // Disable copying and moving because the class owns file descriptors and mappings
+            OfflinePublishStore() = delete;                                          // Delete Default constructor
+            OfflinePublishStore(const OfflinePublishStore &) = delete;               // Delete Copy constructor
+            OfflinePublishStore(OfflinePublishStore &&) = delete;                    // Delete Move constructor
+            OfflinePublishStore &operator=(const OfflinePublishStore &) & = delete;  // Delete Copy assignment operator
+            OfflinePublishStore &operator=(OfflinePublishStore &&) & = delete;       // Delete Move assignment operator
+            ~OfflinePublishStore();
+
+            /**
+             * @brief Create Factory method
+             *
+             * The directory must exist. Publishes left in it by a previous run are loaded
+             *
+             * @param directory_path - Directory to store the segment files in, should not be used for anything else
+             * @param segment_size_bytes - Size of each segment file, also the max size of one stored publish
+             * @param max_segment_count - Max number of segment files, values below two are treated as two
+             * @param overflow_policy - Policy used when all segments are full
+             * @return nullptr on error, unique_ptr pointing to an OfflinePublishStore otherwise
+             */
+            static std::unique_ptr<OfflinePublishStore> Create(util::String directory_path,
+                                                               size_t segment_size_bytes,
+                                                               size_t max_segment_count,
+                                                               OfflineStoreOverflowPolicy overflow_policy);
+
+            /**
+             * @brief Store a publish
+             *
+             * @param topic_name - Topic name of the publish
+             * @param payload - Payload of the publish
+             * @param is_retained - Retained flag of the publish
+             * @param record_id_out - ID of the stored record
+             * The record is written to the disk before Append returns
+             *
+             * @return ResponseCode - SUCCESS if stored, MQTT_OFFLINE_STORE_FULL_ERROR if there is no space for it in
+             * the store or on the disk, MQTT_INVALID_DATA_ERROR if it is larger than a segment, FILE_OPEN_ERROR or
+             * FAILURE if the segment file could not be created or written
+             */
+            ResponseCode Append(const util::String &topic_name, const util::String &payload, bool is_retained,
+                                uint64_t &record_id_out);
+
+            /**
+             * @brief Hand out the oldest publish that has not been handed out yet
+             *
+             * The publish stays in the store until it is acknowledged
+             *
+             * @param record_out - Stored publish
+             * @return bool - true if a publish was handed out, false if there are none left
+             */
+            bool GetNextRecord(Record &record_out);
+
+            /**
+             * @brief Mark a handed out publish as acknowledged, deleting its segment if it has no publishes left
+             * @param record_id - ID of the record
+             */
+            void AcknowledgeRecord(uint64_t record_id);
+
+            /**
+             * @brief Return a handed out publish to the store so it is handed out again
+             * @param record_id - ID of the record
+             */
+            void ReleaseRecord(uint64_t record_id);
+
+            /**
+             * @brief Check if any publish is waiting to be handed out
+             * @return bool
+             */
+            bool HasUnsentRecords();
+
+            /**
+             * @brief Get the number of publishes that have not been acknowledged
+             * @return size_t count
+             */
+            size_t GetPendingRecordCount();
+
+            /**
+             * @brief Get the number of segment files
+             * @return size_t count
+             */
+            size_t GetSegmentCount();
+
+            /**
+             * @brief Write all stored publishes to the disk
+             * @return ResponseCode - SUCCESS or FAILURE
+             */
+            ResponseCode Flush();
+        };
+    }
+}
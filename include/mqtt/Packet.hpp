@@ -105,6 +105,14 @@ namespace awsiotsdk {
              * @param p_buf Reference to target string
              */
             void AppendToBuffer(util::String &p_buf);
+
+            /**
+             * @brief Write this header to a buffer that has space for at least Length() bytes
+             *
+             * @param p_buf Buffer to write to
+             * @return Pointer to the byte after the header
+             */
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -140,11 +148,58 @@ namespace awsiotsdk {
             static void AppendUtf8StringToBuffer(util::String &buf, std::unique_ptr<Utf8String> &utf8_str);
             static void AppendUtf8StringToBuffer(util::String &buf, std::shared_ptr<Utf8String> &utf8_str);
 
+            /**
+             * @brief Write a value in network byte order. The buffer must have space for 2 bytes
+             * @return Pointer to the byte after the value
+             */
+            static char *WriteUInt16ToBuffer(char *p_buf, uint16_t value);
+
+            /**
+             * @brief Write a length prefixed string. Nothing is written for empty strings
+             * @return Pointer to the byte after the string
+             */
+            static char *WriteUtf8StringToBuffer(char *p_buf, Utf8String &utf8_str);
+
             static uint16_t ReadUInt16FromBuffer(const util::Vector<unsigned char> &buf, size_t &extract_index);
             static std::unique_ptr<Utf8String> ReadUtf8StringFromBuffer(const util::Vector<unsigned char> &buf,
                                                                         size_t &extract_index);
 
-            virtual util::String ToString() = 0;
+            /**
+             * @brief Serialize the packet into a buffer supplied by the caller
+             *
+             * The length is only checked once, the packet is written without allocating
+             *
+             * @param p_buf Buffer to write to
+             * @param buf_len Length of the buffer, must be at least Size()
+             * @param serialized_length_out Number of bytes written
+             * @return ResponseCode - SUCCESS, or FAILURE if the buffer is too small
+             */
+            ResponseCode SerializeToBuffer(char *p_buf, size_t buf_len, size_t &serialized_length_out);
+
+            /**
+             * @brief Serialize the packet into a string supplied by the caller, replacing its contents
+             *
+             * The string is resized to Size(), so reusing it for several packets only allocates when a packet is
+             * larger than any before it
+             *
+             * @param buf String to write to
+             */
+            void SerializeToBuffer(util::String &buf);
+
+            /**
+             * @brief Serialize the packet into a new string
+             * @return util::String containing the serialized packet
+             */
+            virtual util::String ToString();
+
+        protected:
+            /**
+             * @brief Write the serialized packet. The buffer must have space for Size() bytes
+             *
+             * @param p_buf Buffer to write to
+             * @return Pointer to the byte after the packet
+             */
+            virtual char *WriteToBuffer(char *p_buf) = 0;
         };
     }
 }
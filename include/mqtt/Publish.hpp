@@ -39,7 +39,8 @@ namespace awsiotsdk {
             bool is_duplicate_;                         ///< Is this message a duplicate QoS > 0 message?  Handled automatically by the MQTT client
             QoS qos_;                                   ///< Message Quality of Service
             std::unique_ptr<Utf8String> p_topic_name_;  ///< Topic Name this packet was published to
-            util::String payload_;                      ///< MQTT message payload
+            std::shared_ptr<const util::String> p_payload_; ///< MQTT message payload, shared with the caller and never modified
+            bool is_payload_owned_;                     ///< Payload buffer was allocated by this packet and can be reused by Reset
         public:
             // Ensure Default Constructor is deleted
             // Disabling default, move and copy constructors to match Packet parent
@@ -68,6 +69,45 @@ namespace awsiotsdk {
                           QoS qos,
                           const util::String &payload);
 
+            /**
+             * @brief Constructor, Individual data, takes ownership of the payload
+             *
+             * @warning This constructor can throw exceptions, it is recommended to use Factory create method
+             * Constructor is kept public to not restrict usage possibilities (eg. make_shared)
+             *
+             * @param p_topic_name Topic name on which message is to be published
+             * @param is_retained Is retained flag
+             * @param is_duplicate Is duplicate message flag
+             * @param qos QoS to use for this message, QoS2 is not supported currently
+             * @param payload String containing payload to send with message, moved into the packet. Can be zero length.
+             */
+            PublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                          bool is_retained,
+                          bool is_duplicate,
+                          QoS qos,
+                          util::String &&payload);
+
+            /**
+             * @brief Constructor, Individual data, shares the payload
+             *
+             * The payload is not copied. It must not be modified while the packet exists, it may be held until the
+             * packet has been written to the network.
+             *
+             * @warning This constructor can throw exceptions, it is recommended to use Factory create method
+             * Constructor is kept public to not restrict usage possibilities (eg. make_shared)
+             *
+             * @param p_topic_name Topic name on which message is to be published
+             * @param is_retained Is retained flag
+             * @param is_duplicate Is duplicate message flag
+             * @param qos QoS to use for this message, QoS2 is not supported currently
+             * @param p_payload Shared buffer containing payload to send with message. Can be nullptr or zero length.
+             */
+            PublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                          bool is_retained,
+                          bool is_duplicate,
+                          QoS qos,
+                          std::shared_ptr<const util::String> p_payload);
+
             /**
              * @brief Constructor, Deserializes data from buffer
              *
@@ -97,6 +137,38 @@ namespace awsiotsdk {
                                                          QoS qos,
                                                          const util::String &payload);
 
+            /**
+             * @brief Create Factory method using Individual data, takes ownership of the payload
+             *
+             * @param p_topic_name Topic name on which message is to be published
+             * @param is_retained Is retained flag
+             * @param is_duplicate Is duplicate message flag
+             * @param qos QoS to use for this message, QoS2 is not supported currently
+             * @param payload String containing payload to send with message, moved into the packet. Can be zero length
+             * @return nullptr on error, shared_ptr pointing to a created PublishPacket instance if successful
+             */
+            static std::shared_ptr<PublishPacket> Create(std::unique_ptr<Utf8String> p_topic_name,
+                                                         bool is_retained,
+                                                         bool is_duplicate,
+                                                         QoS qos,
+                                                         util::String &&payload);
+
+            /**
+             * @brief Create Factory method using Individual data, shares the payload
+             *
+             * @param p_topic_name Topic name on which message is to be published
+             * @param is_retained Is retained flag
+             * @param is_duplicate Is duplicate message flag
+             * @param qos QoS to use for this message, QoS2 is not supported currently
+             * @param p_payload Shared buffer containing payload to send with message. Can be nullptr or zero length
+             * @return nullptr on error, shared_ptr pointing to a created PublishPacket instance if successful
+             */
+            static std::shared_ptr<PublishPacket> Create(std::unique_ptr<Utf8String> p_topic_name,
+                                                         bool is_retained,
+                                                         bool is_duplicate,
+                                                         QoS qos,
+                                                         std::shared_ptr<const util::String> p_payload);
+
             /**
              * @brief Create Factory method which deserializes data from a buffer
              *
@@ -111,6 +183,39 @@ namespace awsiotsdk {
                                                          bool is_duplicate,
                                                          QoS qos);
 
+            /**
+             * @brief Reinitialize a packet that is no longer in use with new data
+             *
+             * Used to reuse pooled packets. The packet ID and ack handler are cleared. The payload is copied into the
+             * buffer of the previous payload if it was allocated by this packet and nothing else holds it
+             *
+             * @param p_topic_name Topic name on which message is to be published, must not be nullptr
+             * @param is_retained Is retained flag
+             * @param is_duplicate Is duplicate message flag
+             * @param qos QoS to use for this message, QoS2 is not supported currently
+             * @param payload String containing payload to send with message. Can be zero length
+             */
+            void Reset(std::unique_ptr<Utf8String> p_topic_name,
+                       bool is_retained,
+                       bool is_duplicate,
+                       QoS qos,
+                       const util::String &payload);
+
+            /**
+             * @brief Reinitialize a packet that is no longer in use with new data, shares the payload
+             *
+             * @param p_topic_name Topic name on which message is to be published, must not be nullptr
+             * @param is_retained Is retained flag
+             * @param is_duplicate Is duplicate message flag
+             * @param qos QoS to use for this message, QoS2 is not supported currently
+             * @param p_payload Shared buffer containing payload to send with message. Can be nullptr or zero length
+             */
+            void Reset(std::unique_ptr<Utf8String> p_topic_name,
+                       bool is_retained,
+                       bool is_duplicate,
+                       QoS qos,
+                       std::shared_ptr<const util::String> p_payload);
+
             /**
              * @brief Get the value of the Is Retained flag
              * @return boolean indicating the value of the Is Retained flag
@@ -123,6 +228,15 @@ namespace awsiotsdk {
              */
             bool IsDuplicate() { return is_duplicate_; }
 
+            /**
+             * @brief Set the value of the Is Duplicate message flag
+             *
+             * Used when an unacknowledged message is sent again. Has no effect on QoS0 messages
+             *
+             * @param is_duplicate new value of the Is Duplicate message flag
+             */
+            void SetDuplicate(bool is_duplicate);
+
             /**
              * @brief Get String containing topic name for this message
              * @return util::String with topic name
@@ -133,21 +247,53 @@ namespace awsiotsdk {
              * @brief Get string containing Payload
              * @return util::String with payload
              */
-            util::String GetPayload() { return payload_; }
+            util::String GetPayload() { return *p_payload_; }
+
+            /**
+             * @brief Get the shared buffer containing Payload, without copying it
+             * @return shared_ptr to the immutable payload, never nullptr
+             */
+            std::shared_ptr<const util::String> GetSharedPayload() { return p_payload_; }
 
             /**
              * @brief Get length of the payload
              * @return util::String with payload length
              */
-            size_t GetPayloadLen() { return payload_.length(); }
+            size_t GetPayloadLen() { return p_payload_->length(); }
 
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Serialize everything except the payload into a String
+             *
+             * The serialized packet is the returned header followed by the payload, which lets the payload be
+             * written from the shared buffer instead of being copied.
+             *
+             * @return String containing serialized fixed header, topic name and packet ID
              */
-            util::String ToString();
+            util::String HeaderToString();
+
+            /**
+             * @brief Serialize everything except the payload into a String supplied by the caller
+             *
+             * Replaces the contents of the String. Reusing it for several packets avoids allocating per packet
+             *
+             * @param buf String to write to
+             */
+            void SerializeHeaderToBuffer(util::String &buf);
 
             QoS GetQoS() { return qos_; }
+
+        protected:
+            /**
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
+             */
+            char *WriteToBuffer(char *p_buf);
+
+            /**
+             * @brief Write everything except the payload to a buffer that has space for it
+             * @return Pointer to the byte after the packet ID, or the topic name for QoS0
+             */
+            char *WriteHeaderToBuffer(char *p_buf);
         };
 
         /**
@@ -182,15 +328,16 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<PubackPacket> Create(uint16_t publish_packet_id);
 
-            /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
-             */
-            util::String ToString();
-
             uint16_t GetPublishPacketId() { return (uint16_t) publish_packet_id_.load(std::memory_order_relaxed); }
             void SetPublishPacketId(uint16_t publish_packet_id) { publish_packet_id_.store(publish_packet_id,
                                                                                            std::memory_order_relaxed); }
+
+        protected:
+            /**
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
+             */
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -200,7 +347,20 @@ namespace awsiotsdk {
          */
         class PublishActionAsync : public Action {
         protected:
-            std::shared_ptr<ClientState> p_client_state_;  ///< Shared Client State instance
+            std::shared_ptr<ClientState> p_client_state_;       ///< Shared Client State instance
+            util::String packet_buffer_;                        ///< Reused to serialize each packet, Actions are not run concurrently
+            util::Vector<NetworkWriteSegment> write_segments_;  ///< Reused for the gathered write of header and payload
+
+            /**
+             * @brief Write the Publish request, registering its Ack handler if requested
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @param should_register_ack - Register the Ack handler of the request, false if the caller did
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformRequest(std::shared_ptr<NetworkConnection> p_network_connection,
+                                        std::shared_ptr<ActionData> p_action_data, bool should_register_ack);
         public:
             // Disabling default, move and copy constructors to match Action parent
             // Default virtual destructor
@@ -247,6 +407,18 @@ namespace awsiotsdk {
              */
             ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                        std::shared_ptr<ActionData> p_action_data);
+
+            /**
+             * @brief Perform MQTT Publish Action for a queued request
+             *
+             * Same as PerformAction, except that the Ack handler is not registered, the Client Core already did.
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                             std::shared_ptr<ActionData> p_action_data);
         };
 
         /**
@@ -257,6 +429,7 @@ namespace awsiotsdk {
         class PubackActionAsync : public Action {
         protected:
             std::shared_ptr<ClientState> p_client_state_;  ///< Shared Client State instance
+            util::String packet_buffer_;                   ///< Reused to serialize each packet, Actions are not run concurrently
         public:
             // Disabling default, move and copy constructors to match Action parent
             PubackActionAsync() = delete;
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file ReconnectBackoff.hpp
+ * @brief Strategies for the wait before reconnect attempts, and a histogram of reconnect times
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <random>
+
+#include "util/memory/stl/Vector.hpp"
+
+/**
+ * Upper bound of the first bucket of the reconnect time histogram. The bound doubles with each bucket
+ */
+#define RECONNECT_TIME_HISTOGRAM_FIRST_BUCKET_MS 100
+
+/**
+ * Number of buckets of the reconnect time histogram. The last bucket holds all longer reconnect times
+ */
+#define RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT 18
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /**
+         * @brief Reconnect Backoff Strategy
+         *
+         * Decides how long the keepalive waits before each reconnect attempt after the connection is lost. Reset is
+         * called once the loss is detected, GetNextBackoff before every attempt including the first. Only used by the
+         * keepalive of one client, implementations do not need to be thread safe.
+         */
+        class ReconnectBackoffStrategy {
+        public:
+            /**
+             * @brief Start over for a new loss of the connection
+             *
+             * @param min_backoff - Min reconnect backoff set in the client state
+             * @param max_backoff - Max reconnect backoff set in the client state
+             */
+            virtual void Reset(std::chrono::milliseconds min_backoff, std::chrono::milliseconds max_backoff) = 0;
+
+            /**
+             * @brief Get the wait before the next reconnect attempt
+             * @return std::chrono::milliseconds - Wait before the attempt
+             */
+            virtual std::chrono::milliseconds GetNextBackoff() = 0;
+
+            virtual ~ReconnectBackoffStrategy() = default;
+        };
+
+        /**
+         * @brief Exponential backoff without jitter
+         *
+         * Attempts right away, then waits twice the min backoff and doubles the wait after every failed attempt until
+         * it reaches the max backoff. This was the only backoff of earlier versions. All clients that lose their
+         * connection at once attempt at the same times, use a jittered strategy for fleets of devices.
+         */
+        class ExponentialBackoffStrategy : public ReconnectBackoffStrategy {
+        protected:
+            std::chrono::milliseconds current_backoff_;  ///< Wait before the last attempt
+            std::chrono::milliseconds max_backoff_;      ///< Wait is not doubled past this
+            bool is_first_attempt_;                      ///< No attempt made since the reset
+
+        public:
+            ExponentialBackoffStrategy();
+
+            /**
+             * @brief Create Factory method
+             * @return shared_ptr to a new ExponentialBackoffStrategy
+             */
+            static std::shared_ptr<ExponentialBackoffStrategy> Create();
+
+            void Reset(std::chrono::milliseconds min_backoff, std::chrono::milliseconds max_backoff);
+            std::chrono::milliseconds GetNextBackoff();
+        };
+
+        /**
+         * @brief Exponential backoff with full jitter
+         *
+         * Waits a random time between zero and a ceiling before every attempt. The ceiling starts at the min
+         * backoff and doubles after every attempt until it reaches the max backoff. Clients that lose their
+         * connection at once spread their attempts over the whole ceiling, including the first one. This is the
+         * default strategy.
+         */
+        class FullJitterBackoffStrategy : public ReconnectBackoffStrategy {
+        protected:
+            std::mt19937 random_engine_;                 ///< Random source of this client
+            std::chrono::milliseconds min_backoff_;      ///< Ceiling of the first attempt
+            std::chrono::milliseconds max_backoff_;      ///< Max ceiling
+            std::chrono::milliseconds current_ceiling_;  ///< Ceiling of the next attempt
+
+        public:
+            /**
+             * @brief Constructor
+             * @param seed - Seed of the random source, should differ between clients
+             */
+            explicit FullJitterBackoffStrategy(uint32_t seed);
+
+            /**
+             * @brief Create Factory method, seeds the random source from std::random_device
+             * @return shared_ptr to a new FullJitterBackoffStrategy
+             */
+            static std::shared_ptr<FullJitterBackoffStrategy> Create();
+
+            /**
+             * @brief Create Factory method
+             * @param seed - Seed of the random source, should differ between clients
+             * @return shared_ptr to a new FullJitterBackoffStrategy
+             */
+            static std::shared_ptr<FullJitterBackoffStrategy> Create(uint32_t seed);
+
+            void Reset(std::chrono::milliseconds min_backoff, std::chrono::milliseconds max_backoff);
+            std::chrono::milliseconds GetNextBackoff();
+        };
+
+        /**
+         * @brief Decorrelated jitter backoff
+         *
+         * Waits a random time between the min backoff and three times the previous wait, capped at the max backoff.
+         * The first wait is between the min backoff and three times the min backoff. Waits grow about as fast as
+         * with full jitter but never drop to zero, so a client does not retry right after a failed attempt.
+         */
+        class DecorrelatedJitterBackoffStrategy : public ReconnectBackoffStrategy {
+        protected:
+            std::mt19937 random_engine_;               ///< Random source of this client
+            std::chrono::milliseconds min_backoff_;    ///< Min wait
+            std::chrono::milliseconds max_backoff_;    ///< Max wait
+            std::chrono::milliseconds last_backoff_;   ///< Previous wait, min backoff after a reset
+
+        public:
+            /**
+             * @brief Constructor
+             * @param seed - Seed of the random source, should differ between clients
+             */
+            explicit DecorrelatedJitterBackoffStrategy(uint32_t seed);
+
+            /**
+             * @brief Create Factory method, seeds the random source from std::random_device
+             * @return shared_ptr to a new DecorrelatedJitterBackoffStrategy
+             */
+            static std::shared_ptr<DecorrelatedJitterBackoffStrategy> Create();
+
+            /**
+             * @brief Create Factory method
+             * @param seed - Seed of the random source, should differ between clients
+             * @return shared_ptr to a new DecorrelatedJitterBackoffStrategy
+             */
+            static std::shared_ptr<DecorrelatedJitterBackoffStrategy> Create(uint32_t seed);
+
+            void Reset(std::chrono::milliseconds min_backoff, std::chrono::milliseconds max_backoff);
+            std::chrono::milliseconds GetNextBackoff();
+        };
+
+        /**
+         * @brief Backoff following a fixed schedule
+         *
+         * Waits the n-th duration of the schedule before the n-th attempt, and the last duration before all later
+         * attempts. The min and max backoff of the client state are not used.
+         */
+        class FixedScheduleBackoffStrategy : public ReconnectBackoffStrategy {
+        protected:
+            util::Vector<std::chrono::milliseconds> schedule_;  ///< Waits before consecutive attempts
+            size_t next_index_;                                 ///< Index of the next wait in the schedule
+
+        public:
+            /**
+             * @brief Constructor
+             * @param schedule - Waits before consecutive attempts, must not be empty
+             */
+            explicit FixedScheduleBackoffStrategy(util::Vector<std::chrono::milliseconds> schedule);
+
+            /**
+             * @brief Create Factory method
+             * @param schedule - Waits before consecutive attempts
+             * @return nullptr if the schedule is empty, shared_ptr to a new FixedScheduleBackoffStrategy otherwise
+             */
+            static std::shared_ptr<FixedScheduleBackoffStrategy> Create(
+                util::Vector<std::chrono::milliseconds> schedule);
+
+            void Reset(std::chrono::milliseconds min_backoff, std::chrono::milliseconds max_backoff);
+            std::chrono::milliseconds GetNextBackoff();
+        };
+
+        /**
+         * @brief Reconnect Time Histogram
+         *
+         * Counts the times from losing the connection to the successful reconnect in buckets with doubling upper
+         * bounds, starting at RECONNECT_TIME_HISTOGRAM_FIRST_BUCKET_MS. Thread safe.
+         */
+        class ReconnectTimeHistogram {
+        protected:
+            std::mutex histogram_lock_;                                     ///< Mutex for all histogram operations
+            uint64_t bucket_counts_[RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT];  ///< Number of reconnects per bucket
+            uint64_t total_count_;                                          ///< Number of reconnects
+            std::chrono::milliseconds max_reconnect_time_;                  ///< Longest reconnect time
+
+        public:
+            // Rule of 5 stuff
+            // Disable copying and moving because class contains a mutex
+            ReconnectTimeHistogram(const ReconnectTimeHistogram &) = delete;               // Delete Copy constructor
+            ReconnectTimeHistogram(ReconnectTimeHistogram &&) = delete;                    // Delete Move constructor
+            ReconnectTimeHistogram &operator=(const ReconnectTimeHistogram &) & = delete;  // Delete Copy assignment operator
+            ReconnectTimeHistogram &operator=(ReconnectTimeHistogram &&) & = delete;       // Delete Move assignment operator
+            ~ReconnectTimeHistogram() = default;
+
+            ReconnectTimeHistogram();
+
+            /**
+             * @brief Get the upper bound of a bucket
+             * @param bucket_index - Index of the bucket
+             * @return std::chrono::milliseconds - Longest reconnect time counted in the bucket, milliseconds::max()
+             * for the last bucket
+             */
+            static std::chrono::milliseconds GetBucketUpperBound(size_t bucket_index);
+
+            /**
+             * @brief Count a reconnect
+             * @param reconnect_time - Time from losing the connection to the successful reconnect
+             */
+            void Record(std::chrono::milliseconds reconnect_time);
+
+            /**
+             * @brief Get the number of reconnects in a bucket
+             * @param bucket_index - Index of the bucket
+             * @return uint64_t count, zero for indexes past the last bucket
+             */
+            uint64_t GetBucketCount(size_t bucket_index);
+
+            /**
+             * @brief Get the number of reconnects
+             * @return uint64_t count
+             */
+            uint64_t GetCount();
+
+            /**
+             * @brief Get the longest reconnect time
+             * @return std::chrono::milliseconds - zero if no reconnect was counted
+             */
+            std::chrono::milliseconds GetMax();
+
+            /**
+             * @brief Get an upper bound of a percentile of the reconnect times
+             *
+             * @param percentile - Percentile between 0 and 100
+             * @return std::chrono::milliseconds - Upper bound of the bucket containing the percentile, capped at the
+             * longest reconnect time. Zero if no reconnect was counted
+             */
+            std::chrono::milliseconds GetPercentile(double percentile);
+
+            /**
+             * @brief Remove all counted reconnects
+             */
+            void Reset();
+        };
+    }
+}
@@ -68,11 +68,12 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<SubscribePacket> Create(util::Vector <std::shared_ptr<Subscription>> subscription_list);
 
+        protected:
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
              */
-            util::String ToString();
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -111,11 +112,12 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<SubackPacket> Create(const util::Vector<unsigned char> &buf);
 
+        protected:
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
              */
-            util::String ToString();
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -154,11 +156,12 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<UnsubscribePacket> Create(util::Vector <std::unique_ptr<Utf8String>> topic_list);
 
+        protected:
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
              */
-            util::String ToString();
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -194,11 +197,12 @@ namespace awsiotsdk {
              */
             static std::shared_ptr<UnsubackPacket> Create(const util::Vector<unsigned char> &buf);
 
+        protected:
             /**
-             * @brief Serialize this packet into a String
-             * @return String containing serialized packet
+             * @brief Write the serialized packet to a buffer that has space for Size() bytes
+             * @return Pointer to the byte after the packet
              */
-            util::String ToString();
+            char *WriteToBuffer(char *p_buf);
         };
 
         /**
@@ -209,6 +213,18 @@ namespace awsiotsdk {
         class SubscribeActionAsync : public Action {
         protected:
             std::shared_ptr<ClientState> p_client_state_;  ///< Shared Client State instance
+            util::String packet_buffer_;                   ///< Reused to serialize each packet, Actions are not run concurrently
+
+            /**
+             * @brief Write the Subscribe request, registering its Ack handler if requested
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @param should_register_ack - Register the Ack handler of the request, false if the caller did
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformRequest(std::shared_ptr<NetworkConnection> p_network_connection,
+                                        std::shared_ptr<ActionData> p_action_data, bool should_register_ack);
         public:
             // Disabling default, move and copy constructors to match Action parent
             // Default virtual destructor
@@ -255,6 +271,18 @@ namespace awsiotsdk {
              */
             ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                        std::shared_ptr<ActionData> p_action_data);
+
+            /**
+             * @brief Perform MQTT Subscribe Action for a queued request
+             *
+             * Same as PerformAction, except that the Ack handler is not registered, the Client Core already did.
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                             std::shared_ptr<ActionData> p_action_data);
         };
 
         /**
@@ -265,6 +293,18 @@ namespace awsiotsdk {
         class UnsubscribeActionAsync : public Action {
         protected:
             std::shared_ptr<ClientState> p_client_state_;  ///< Shared Client State instance
+            util::String packet_buffer_;                   ///< Reused to serialize each packet, Actions are not run concurrently
+
+            /**
+             * @brief Write the Unsubscribe request, registering its Ack handler if requested
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @param should_register_ack - Register the Ack handler of the request, false if the caller did
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformRequest(std::shared_ptr<NetworkConnection> p_network_connection,
+                                        std::shared_ptr<ActionData> p_action_data, bool should_register_ack);
         public:
             // Disabling default, move and copy constructors to match Action parent
             // Default virtual destructor
@@ -312,6 +352,18 @@ namespace awsiotsdk {
              */
             ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                        std::shared_ptr<ActionData> p_action_data);
+
+            /**
+             * @brief Perform MQTT Unsubscribe Action for a queued request
+             *
+             * Same as PerformAction, except that the Ack handler is not registered, the Client Core already did.
+             *
+             * @param p_network_connection - Network connection instance to use for performing this action
+             * @param p_action_data - Action data specific to this execution of the Action
+             * @return - ResponseCode indicating status of the operation
+             */
+            ResponseCode PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                             std::shared_ptr<ActionData> p_action_data);
         };
     }
 }
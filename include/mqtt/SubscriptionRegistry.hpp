@@ -0,0 +1,155 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file SubscriptionRegistry.hpp
+ * @brief Thread safe registry of the MQTT subscriptions of a client
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/String.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "mqtt/Common.hpp"
+#include "mqtt/SubscriptionTopicTrie.hpp"
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /**
+         * @brief Subscription Registry
+         *
+         * Subscriptions are published as immutable snapshots. Every change copies the current snapshot, applies
+         * the change and replaces the current snapshot under a writer lock, so changes are expected to be rare
+         * compared to lookups. Readers keep a reference to the snapshot they use, which stays valid while newer
+         * snapshots are published. A reader that already holds a snapshot can check whether it is current with a
+         * single atomic load using RefreshSnapshot, without taking the writer lock.
+         *
+         * The Subscription instances are shared between snapshots. Their state (active flag, pending ack index,
+         * max QoS) is atomic and can be updated in place without publishing a new snapshot.
+         */
+        class SubscriptionRegistry {
+        public:
+            /**
+             * @brief Immutable view of the registered subscriptions
+             */
+            class Snapshot {
+            public:
+                util::Map<util::String, std::shared_ptr<Subscription>> subscription_map_;  ///< Subscriptions by topic filter
+                SubscriptionTopicTrie subscription_trie_;                                  ///< Index of subscription_map_ by topic level
+                uint64_t version_;                                                         ///< Version of the registry this snapshot was taken at
+
+                /**
+                 * @brief Get the subscription stored for a topic filter
+                 *
+                 * @param topic_filter - Topic filter the subscription was added with
+                 * @return shared_ptr to the Subscription, nullptr if none is stored
+                 */
+                std::shared_ptr<Subscription> Find(const util::String &topic_filter) const;
+
+                /**
+                 * @brief Find all subscriptions whose topic filter matches the given topic name
+                 *
+                 * @param topic_name - Topic name to match
+                 * @param matches[out] - Vector the matching subscriptions are appended to
+                 */
+                void GetMatchingSubscriptions(const util::String &topic_name,
+                                              util::Vector<std::shared_ptr<Subscription>> &matches) const {
+                    subscription_trie_.GetMatchingSubscriptions(topic_name, matches);
+                }
+            };
+
+        protected:
+            std::mutex write_lock_;                         ///< Serializes changes, guards p_snapshot_
+            std::shared_ptr<const Snapshot> p_snapshot_;    ///< Current snapshot
+            std::atomic<uint64_t> version_;                 ///< Version of the current snapshot
+
+            /**
+             * @brief Publish a new snapshot containing the given subscriptions. Must hold write_lock_
+             * @param subscription_map - Subscriptions of the new snapshot
+             */
+            void PublishSnapshot(util::Map<util::String, std::shared_ptr<Subscription>> subscription_map);
+
+        public:
+            /**
+             * @brief Predicate used to select subscriptions to remove
+             */
+            typedef std::function<bool(const std::shared_ptr<Subscription> &p_subscription)> SubscriptionFilter;
+
+            // Rule of 5 stuff
+            // Disable copying and moving because class contains std::atomic<> types used for thread synchronization
+            SubscriptionRegistry();                                                  // Default constructor
+            SubscriptionRegistry(const SubscriptionRegistry &) = delete;             // Delete Copy constructor
+            SubscriptionRegistry(SubscriptionRegistry &&) = delete;                  // Delete Move constructor
+            SubscriptionRegistry &operator=(const SubscriptionRegistry &) = delete;  // Delete Copy assignment operator
+            SubscriptionRegistry &operator=(SubscriptionRegistry &&) = delete;       // Delete Move assignment operator
+            ~SubscriptionRegistry() = default;                                       // Default destructor
+
+            /**
+             * @brief Get the current snapshot
+             * @return shared_ptr to the snapshot, never nullptr
+             */
+            std::shared_ptr<const Snapshot> GetSnapshot();
+
+            /**
+             * @brief Replace the given snapshot with the current one if a newer one was published
+             *
+             * Only takes the writer lock if the snapshot is out of date or nullptr
+             *
+             * @param p_snapshot[in,out] - Snapshot held by the caller
+             */
+            void RefreshSnapshot(std::shared_ptr<const Snapshot> &p_snapshot);
+
+            /**
+             * @brief Add a subscription unless an active subscription exists for the same topic filter
+             *
+             * An inactive subscription for the same topic filter is replaced
+             *
+             * @param p_subscription - Subscription to add
+             * @return true if the subscription was added
+             */
+            bool Add(std::shared_ptr<Subscription> p_subscription);
+
+            /**
+             * @brief Remove the subscription stored for a topic filter
+             *
+             * @param topic_filter - Topic filter the subscription was added with
+             * @return true if a subscription was removed
+             */
+            bool Remove(const util::String &topic_filter);
+
+            /**
+             * @brief Remove all subscriptions selected by a filter
+             *
+             * @param filter - Returns true for subscriptions that should be removed
+             * @param max_count - Maximum number of subscriptions to remove
+             * @return size_t number of subscriptions removed
+             */
+            size_t RemoveIf(const SubscriptionFilter &filter, size_t max_count);
+
+            /**
+             * @brief Get the version of the current snapshot
+             * @return uint64_t version, increases with every change
+             */
+            uint64_t GetVersion() { return version_.load(std::memory_order_acquire); }
+        };
+    }
+}
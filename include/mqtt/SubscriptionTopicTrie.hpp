@@ -0,0 +1,118 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file SubscriptionTopicTrie.hpp
+ * @brief Topic level trie used to find the subscriptions matching an incoming topic name
+ *
+ */
+
+#pragma once
+
+#include <memory>
+
+#include "util/memory/stl/String.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "mqtt/Common.hpp"
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /**
+         * @brief Subscription Topic Trie
+         *
+         * Stores subscriptions by topic filter, one trie level per topic level. Single level (+) and multi level (#)
+         * wildcards get dedicated slots in each node so matching a topic name only walks the nodes that can match it.
+         * Lookups do not allocate apart from growing the caller provided result vector. Not thread safe.
+         */
+        class SubscriptionTopicTrie {
+        protected:
+            /**
+             * @brief Trie node, corresponds to one topic level of one or more topic filters
+             */
+            class Node {
+            public:
+                util::Vector<std::pair<util::String, std::unique_ptr<Node>>> children_;  ///< Literal levels, sorted by level name
+                std::unique_ptr<Node> p_single_level_child_;                             ///< Child for the + wildcard level
+                std::shared_ptr<Subscription> p_subscription_;                           ///< Subscription for the filter ending at this node
+                std::shared_ptr<Subscription> p_multi_level_subscription_;               ///< Subscription for this node's filter followed by #
+
+                /**
+                 * @brief Check whether the node can be pruned
+                 * @return true if it has no subscriptions and no children
+                 */
+                bool IsEmpty() const;
+            };
+
+            Node root_;                 ///< Node for the level before the first topic level
+            size_t subscription_count_; ///< Number of subscriptions stored in the trie
+
+            void Match(const Node &node, const util::String &topic_name, size_t level_start, bool is_first_level,
+                       util::Vector<std::shared_ptr<Subscription>> &matches) const;
+
+            bool Remove(Node &node, const util::String &topic_filter, size_t level_start);
+
+        public:
+            // Rule of 5 stuff
+            // Nodes own their children through unique_ptrs, disable copying
+            SubscriptionTopicTrie();                                                   // Default constructor
+            SubscriptionTopicTrie(const SubscriptionTopicTrie &) = delete;             // Delete Copy constructor
+            SubscriptionTopicTrie(SubscriptionTopicTrie &&) = default;                 // Default Move constructor
+            SubscriptionTopicTrie &operator=(const SubscriptionTopicTrie &) = delete;  // Delete Copy assignment operator
+            SubscriptionTopicTrie &operator=(SubscriptionTopicTrie &&) = default;      // Default Move assignment operator
+            ~SubscriptionTopicTrie() = default;                                        // Default destructor
+
+            /**
+             * @brief Add a subscription, replacing any subscription stored for the same topic filter
+             *
+             * @param p_subscription - Subscription to add, keyed by its topic name
+             */
+            void Insert(std::shared_ptr<Subscription> p_subscription);
+
+            /**
+             * @brief Remove the subscription stored for a topic filter
+             *
+             * @param topic_filter - Topic filter the subscription was added with
+             * @return true if a subscription was removed
+             */
+            bool Remove(const util::String &topic_filter);
+
+            /**
+             * @brief Find all subscriptions whose topic filter matches the given topic name
+             *
+             * Matching follows the MQTT 3.1.1 rules: + matches exactly one level, # matches the parent level and any
+             * number of child levels, and wildcards in the first level do not match topic names starting with $.
+             * Subscriptions are appended in depth first order with literal levels visited before wildcards, so an
+             * exact topic filter match, if any, comes first.
+             *
+             * @param topic_name - Topic name of the incoming message
+             * @param matches[out] - Vector the matching subscriptions are appended to
+             */
+            void GetMatchingSubscriptions(const util::String &topic_name,
+                                          util::Vector<std::shared_ptr<Subscription>> &matches) const;
+
+            /**
+             * @brief Remove all subscriptions
+             */
+            void Clear();
+
+            /**
+             * @brief Get the number of subscriptions stored
+             * @return size_t subscription count
+             */
+            size_t Size() const { return subscription_count_; }
+        };
+    }
+}
@@ -55,5 +55,11 @@ namespace awsiotsdk {
         std::size_t Length();
 
         util::String ToStdString();
+
+        /**
+         * @brief Get a reference to the string without copying it
+         * @return const util::String reference, valid as long as this instance
+         */
+        const util::String &GetString() const { return data; }
     };
 }
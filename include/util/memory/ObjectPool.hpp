@@ -0,0 +1,115 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file ObjectPool.hpp
+ * @brief Pool of shared objects that are reused once nothing else holds them
+ *
+ * The pool keeps one reference to every object it hands out. An object whose use count has dropped back to one
+ * is only referenced by the pool, so no other thread can take a new reference to it and it can be handed out again.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+
+#include "util/Core_EXPORTS.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+namespace awsiotsdk {
+    namespace util {
+        /**
+         * @brief Pool of shared objects
+         *
+         * Callers take a free object with GetFree and reinitialize it. If there is none, they create a new object
+         * and pass it to Add, which keeps it for reuse while the pool has fewer than max_pool_size objects.
+         *
+         * @tparam T Type of the pooled objects
+         */
+        template<typename T>
+        class ObjectPool {
+        protected:
+            std::mutex pool_lock_;                      ///< Mutex for pool operations
+            util::Vector<std::shared_ptr<T>> objects_;  ///< Pooled objects, preallocated to max_pool_size_
+            size_t max_pool_size_;                      ///< Max number of pooled objects
+            size_t next_index_;                         ///< Index the search for a free object starts at
+
+        public:
+            /**
+             * @brief Constructor
+             * @param max_pool_size Max number of objects kept for reuse. Zero disables pooling
+             */
+            explicit ObjectPool(size_t max_pool_size) {
+                max_pool_size_ = max_pool_size;
+                next_index_ = 0;
+                objects_.reserve(max_pool_size_);
+            }
+
+            // Rule of 5 stuff
+            // Pooled objects are shared between threads, don't copy or move
+            ObjectPool(const ObjectPool &) = delete;
+            ObjectPool &operator=(const ObjectPool &) = delete;
+            ObjectPool(ObjectPool &&) = delete;
+            ObjectPool &operator=(ObjectPool &&) = delete;
+            ~ObjectPool() = default;
+
+            /**
+             * @brief Get a pooled object that nothing else holds
+             *
+             * Objects are released in roughly the order they were handed out, so the search starts after the
+             * object that was handed out last
+             *
+             * @return shared_ptr to the object, nullptr if all pooled objects are in use
+             */
+            std::shared_ptr<T> GetFree() {
+                std::lock_guard<std::mutex> pool_lock(pool_lock_);
+                size_t object_count = objects_.size();
+                for (size_t itr = 0; itr < object_count; itr++) {
+                    size_t index = (next_index_ + itr) % object_count;
+                    if (1 == objects_[index].use_count()) {
+                        // use_count is a relaxed load, order it after the last release of the object
+                        std::atomic_thread_fence(std::memory_order_acquire);
+                        next_index_ = (index + 1) % object_count;
+                        return objects_[index];
+                    }
+                }
+                return nullptr;
+            }
+
+            /**
+             * @brief Keep a newly created object for reuse, if the pool is not full
+             * @param p_object Object to keep
+             */
+            void Add(const std::shared_ptr<T> &p_object) {
+                std::lock_guard<std::mutex> pool_lock(pool_lock_);
+                if (nullptr != p_object && objects_.size() < max_pool_size_) {
+                    objects_.push_back(p_object);
+                }
+            }
+
+            /**
+             * @brief Get the number of pooled objects
+             * @return size_t count
+             */
+            size_t GetPooledCount() {
+                std::lock_guard<std::mutex> pool_lock(pool_lock_);
+                return objects_.size();
+            }
+        };
+    } // namespace util
+} // namespace awsiotsdk
@@ -30,5 +30,6 @@
 namespace awsiotsdk {
     namespace util {
         template<typename T> using Queue = std::queue<T>;
+        template<typename T> using Deque = std::deque<T>;
     } // namespace util
 } // namespace awsiotsdk
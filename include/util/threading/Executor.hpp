@@ -0,0 +1,74 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file Executor.hpp
+ * @brief Interface for running tasks on threads shared by many clients
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+
+#include "util/Core_EXPORTS.hpp"
+
+#include "ResponseCode.hpp"
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            /**
+             * @brief Executor
+             *
+             * Runs short tasks on threads owned by the executor. Lets the SDK schedule work as tasks instead of
+             * creating a thread per client, so an application can bound the number of threads no matter how many
+             * clients it runs. Tasks must not block for long, a blocked task holds up other tasks.
+             *
+             * This is an abstract class and cannot be instantiated, see WorkStealingExecutor.
+             */
+            class AWS_API_EXPORT Executor {
+            public:
+                typedef std::function<void()> Task;
+
+                /**
+                 * @brief Run a task as soon as a thread is available
+                 *
+                 * @param task - Task to run
+                 * @return ResponseCode - SUCCESS, NULL_VALUE_ERROR, or FAILURE if the executor is stopped
+                 */
+                virtual ResponseCode Submit(Task task) = 0;
+
+                /**
+                 * @brief Run a task once a delay has passed
+                 *
+                 * @param delay - Minimum time to wait before running the task
+                 * @param task - Task to run
+                 * @return ResponseCode - SUCCESS, NULL_VALUE_ERROR, or FAILURE if the executor is stopped
+                 */
+                virtual ResponseCode SubmitAfter(std::chrono::milliseconds delay, Task task) = 0;
+
+                /**
+                 * @brief Get the number of threads running tasks
+                 * @return size_t count
+                 */
+                virtual size_t GetWorkerCount() = 0;
+
+                virtual ~Executor() {}
+            };
+        }
+    }
+}
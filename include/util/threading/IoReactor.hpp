@@ -0,0 +1,214 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file IoReactor.hpp
+ * @brief Event loop that runs handlers for many readable descriptors on a small set of threads
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "util/Core_EXPORTS.hpp"
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/Queue.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "ResponseCode.hpp"
+
+/**
+ * Default number of worker threads running handlers of readable descriptors
+ */
+#define DEFAULT_IO_REACTOR_WORKER_COUNT 2
+
+/**
+ * Default interval at which descriptors of all registered sources are checked for changes
+ */
+#define DEFAULT_IO_REACTOR_POLL_INTERVAL_MS 100
+
+/**
+ * Max number of readiness events handled per wait of the reactor thread
+ */
+#define IO_REACTOR_MAX_EVENTS_PER_WAIT 64
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            /**
+             * @brief I/O Reactor
+             *
+             * Waits for many descriptors to become readable on one reactor thread and runs the handler of each
+             * readable source on a small pool of worker threads, so that connections cost a descriptor instead of a
+             * thread. A source is never handled by two workers at the same time, it is armed again once its handler
+             * returns. Handlers must not block waiting for data.
+             *
+             * The descriptor of a source can change, for example when a network connection is reestablished.
+             * Descriptors are queried again after each handler and at every poll interval, sources without a
+             * descriptor are skipped until they have one.
+             *
+             * Only supported on Linux, Create returns nullptr on other platforms.
+             */
+            class AWS_API_EXPORT IoReactor {
+            public:
+                /**
+                 * @brief Source of readiness events
+                 */
+                class EventSource {
+                public:
+                    /**
+                     * @brief Get the descriptor to wait on
+                     *
+                     * Called with the reactor lock held, must not block
+                     *
+                     * @return int - descriptor, -1 if there is currently nothing to wait on
+                     */
+                    virtual int GetDescriptor() = 0;
+
+                    /**
+                     * @brief Handle the descriptor becoming readable
+                     *
+                     * Called on a worker thread. Should handle all data that is available and return without waiting
+                     * for more
+                     */
+                    virtual void OnReadable() = 0;
+
+                    virtual ~EventSource() {}
+                };
+
+            protected:
+                /**
+                 * @brief Registered source and its state
+                 */
+                class Registration {
+                public:
+                    uint64_t registration_id_;               ///< ID stored in the epoll events of the source
+                    std::shared_ptr<EventSource> p_source_;  ///< Registered source
+                    int armed_fd_;                           ///< Descriptor last added to the epoll set, -1 if none
+                    bool is_busy_;                           ///< Is the source queued or being handled
+                    bool is_removed_;                        ///< Has the source been unregistered
+                    std::thread::id handler_thread_id_;      ///< Thread running the handler, if any
+                };
+
+                std::mutex reactor_lock_;                                       ///< Guards all registration state
+                std::condition_variable ready_wait_;                            ///< Signaled when a source is queued or the reactor is stopped
+                std::condition_variable idle_wait_;                             ///< Signaled when a handler returns
+                util::Map<uint64_t, std::shared_ptr<Registration>> registrations_;  ///< Registrations keyed by the ID stored in epoll events
+                util::Queue<std::shared_ptr<Registration>> ready_queue_;        ///< Readable sources waiting for a worker
+                uint64_t next_registration_id_;                                 ///< ID of the next registration
+                util::Vector<std::thread> workers_;                             ///< Worker threads
+                std::thread reactor_thread_;                                    ///< Thread waiting on the epoll set
+                std::chrono::milliseconds poll_interval_;                       ///< Interval at which descriptors are checked for changes
+                std::atomic_bool is_running_;                                   ///< Atomic, false once the reactor is stopped
+                int epoll_fd_;                                                  ///< epoll set of all armed descriptors
+                int wakeup_fd_;                                                 ///< eventfd used to interrupt the reactor thread
+
+                /**
+                 * @brief Constructor
+                 *
+                 * @param poll_interval - Interval at which descriptors are checked for changes
+                 */
+                IoReactor(std::chrono::milliseconds poll_interval);
+
+                /**
+                 * @brief Create the epoll set and start the threads
+                 * @param worker_count - Number of worker threads
+                 * @return ResponseCode - SUCCESS or FAILURE
+                 */
+                ResponseCode Start(size_t worker_count);
+
+                /**
+                 * @brief Arm the current descriptor of a source for the next readiness event
+                 *
+                 * Must be called with the reactor lock held and only while the source is not busy
+                 */
+                void Arm(Registration &registration);
+
+                /**
+                 * @brief Wait for readiness events and queue readable sources until the reactor is stopped
+                 */
+                void RunReactor();
+
+                /**
+                 * @brief Run handlers of queued sources until the reactor is stopped
+                 */
+                void RunWorker();
+
+            public:
+                // Rule of 5 stuff
+                // Disable copying and moving because class contains running threads and owns descriptors
+                IoReactor() = delete;                               // Delete Default constructor
+                IoReactor(const IoReactor &) = delete;              // Delete Copy constructor
+                IoReactor(IoReactor &&) = delete;                   // Delete Move constructor
+                IoReactor &operator=(const IoReactor &) = delete;   // Delete Copy assignment operator
+                IoReactor &operator=(IoReactor &&) = delete;        // Delete Move assignment operator
+
+                /**
+                 * @brief Destructor, stops the reactor
+                 */
+                ~IoReactor();
+
+                /**
+                 * @brief Factory method to create a reactor, threads are started immediately
+                 *
+                 * @param worker_count - Number of worker threads, zero is treated as one
+                 * @param poll_interval - Interval at which descriptors are checked for changes
+                 * @return nullptr on error, shared_ptr pointing to an IoReactor otherwise
+                 */
+                static std::shared_ptr<IoReactor> Create(size_t worker_count, std::chrono::milliseconds poll_interval);
+
+                /**
+                 * @brief Start handling readiness events of a source
+                 *
+                 * @param p_source - Source to register
+                 * @return ResponseCode - SUCCESS, NULL_VALUE_ERROR, or FAILURE if the reactor is stopped
+                 */
+                ResponseCode Register(std::shared_ptr<EventSource> p_source);
+
+                /**
+                 * @brief Stop handling readiness events of a source
+                 *
+                 * Blocks until a handler of the source that is running on another thread has returned, the handler is
+                 * not called again after this
+                 *
+                 * @param p_source - Source to unregister
+                 * @return ResponseCode - SUCCESS, or NULL_VALUE_ERROR if the source is not registered
+                 */
+                ResponseCode Unregister(const std::shared_ptr<EventSource> &p_source);
+
+                /**
+                 * @brief Stop the reactor
+                 *
+                 * Handlers that are running are allowed to finish, queued sources are not handled. Blocks until all
+                 * threads have exited, must not be called from a handler
+                 */
+                void Stop();
+
+                /**
+                 * @brief Get the number of registered sources
+                 * @return size_t count
+                 */
+                size_t GetRegisteredCount();
+            };
+        }
+    }
+}
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2010-2016 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file LockFreeQueue.hpp
+ * @brief Bounded lock-free queue
+ *
+ * Ring buffer where every slot carries a sequence number that tells producers and consumers whether the slot
+ * is free or holds data for the current lap. Multiple threads may push and pop concurrently without locks.
+ * For queue position pos, the slot sequence is 2 * pos while it is free and 2 * pos + 1 once written.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+#include "util/Core_EXPORTS.hpp"
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            /**
+             * @brief Bounded lock-free queue
+             *
+             * Capacity is fixed at construction. A queue can be closed, after which all pushes fail while pops
+             * continue to return the remaining items. This allows the queue to be replaced with a differently
+             * sized one without losing items that producers are concurrently adding.
+             *
+             * @tparam T Type of the queued items, must be default constructible and move assignable
+             */
+            template<typename T>
+            class LockFreeQueue {
+            protected:
+                /**
+                 * @brief Queue slot
+                 */
+                class Cell {
+                public:
+                    std::atomic_size_t sequence_;   ///< Position this slot is ready for, see class description
+                    T data_;                        ///< Stored item
+                };
+
+                /**
+                 * Set in the enqueue position once the queue is closed
+                 */
+                static const size_t CLOSED_FLAG = static_cast<size_t>(1) << (sizeof(size_t) * 8 - 1);
+
+                std::unique_ptr<Cell[]> p_cells_;   ///< Slots
+                size_t capacity_;                   ///< Number of slots
+                std::atomic_size_t enqueue_pos_;    ///< Position of the next push, CLOSED_FLAG set once closed
+                std::atomic_size_t dequeue_pos_;    ///< Position of the next pop
+
+            public:
+                /**
+                 * @brief Constructor
+                 * @param capacity Maximum number of items the queue can hold. Zero is treated as one
+                 */
+                explicit LockFreeQueue(size_t capacity) {
+                    capacity_ = (0 == capacity) ? 1 : capacity;
+                    p_cells_ = std::unique_ptr<Cell[]>(new Cell[capacity_]);
+                    for (size_t itr = 0; itr < capacity_; itr++) {
+                        p_cells_[itr].sequence_.store(2 * itr, std::memory_order_relaxed);
+                    }
+                    enqueue_pos_.store(0, std::memory_order_relaxed);
+                    dequeue_pos_.store(0, std::memory_order_relaxed);
+                }
+
+                // Rule of 5 stuff
+                // Slots are shared between threads, don't copy or move
+                LockFreeQueue(const LockFreeQueue &) = delete;
+                LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+                LockFreeQueue(LockFreeQueue &&) = delete;
+                LockFreeQueue &operator=(LockFreeQueue &&) = delete;
+                ~LockFreeQueue() = default;
+
+                /**
+                 * @brief Add an item at the back of the queue
+                 *
+                 * @param value Item to add, moved from only if the push succeeds
+                 * @return true if the item was added, false if the queue is full or closed
+                 */
+                bool TryPush(T &value) {
+                    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+                    Cell *p_cell;
+                    for (;;) {
+                        if (0 != (pos & CLOSED_FLAG)) {
+                            return false;
+                        }
+                        p_cell = &p_cells_[pos % capacity_];
+                        size_t sequence = p_cell->sequence_.load(std::memory_order_acquire);
+                        if (sequence == 2 * pos) {
+                            // Sequentially consistent so that callers can pair a successful push with a flag check
+                            if (enqueue_pos_.compare_exchange_weak(pos, pos + 1)) {
+                                break;
+                            }
+                        } else if (sequence < 2 * pos) {
+                            // Slot still holds an item from the previous lap
+                            return false;
+                        } else {
+                            pos = enqueue_pos_.load(std::memory_order_relaxed);
+                        }
+                    }
+                    p_cell->data_ = std::move(value);
+                    p_cell->sequence_.store(2 * pos + 1, std::memory_order_release);
+                    return true;
+                }
+
+                /**
+                 * @brief Remove the item at the front of the queue
+                 *
+                 * @param value[out] Removed item
+                 * @return true if an item was removed, false if the queue is empty
+                 */
+                bool TryPop(T &value) {
+                    size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+                    Cell *p_cell;
+                    for (;;) {
+                        p_cell = &p_cells_[pos % capacity_];
+                        size_t sequence = p_cell->sequence_.load(std::memory_order_acquire);
+                        if (sequence == 2 * pos + 1) {
+                            if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                                break;
+                            }
+                        } else if (sequence < 2 * pos + 1) {
+                            // Slot has not been written for this lap
+                            return false;
+                        } else {
+                            pos = dequeue_pos_.load(std::memory_order_relaxed);
+                        }
+                    }
+                    value = std::move(p_cell->data_);
+                    p_cell->data_ = T();
+                    p_cell->sequence_.store(2 * (pos + capacity_), std::memory_order_release);
+                    return true;
+                }
+
+                /**
+                 * @brief Close the queue, all subsequent pushes fail
+                 */
+                void Close() { enqueue_pos_.fetch_or(CLOSED_FLAG); }
+
+                /**
+                 * @brief Check whether the queue has been closed
+                 * @return true if closed
+                 */
+                bool IsClosed() { return 0 != (enqueue_pos_.load() & CLOSED_FLAG); }
+
+                /**
+                 * @brief Check whether the queue is closed and every item pushed before closing has been popped
+                 * @return true if no more items will ever be returned by this queue
+                 */
+                bool IsDrained() {
+                    size_t enqueue_pos = enqueue_pos_.load();
+                    return (0 != (enqueue_pos & CLOSED_FLAG)) && (enqueue_pos & ~CLOSED_FLAG) == dequeue_pos_.load();
+                }
+
+                /**
+                 * @brief Get the approximate number of items in the queue
+                 *
+                 * Includes pushes that have reserved a slot but not finished writing it.
+                 * @return size_t item count
+                 */
+                size_t Size() {
+                    size_t enqueue_pos = enqueue_pos_.load() & ~CLOSED_FLAG;
+                    size_t dequeue_pos = dequeue_pos_.load();
+                    return (enqueue_pos > dequeue_pos) ? enqueue_pos - dequeue_pos : 0;
+                }
+
+                /**
+                 * @brief Get the maximum number of items the queue can hold
+                 * @return size_t capacity
+                 */
+                size_t Capacity() { return capacity_; }
+            };
+
+            template<typename T>
+            const size_t LockFreeQueue<T>::CLOSED_FLAG;
+        }
+    }
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file TimerService.hpp
+ * @brief
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+
+#include "util/Core_EXPORTS.hpp"
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "util/threading/Executor.hpp"
+
+/**
+ * Min number of heap entries before cancelled timers are purged from the deadline heap
+ */
+#define TIMER_SERVICE_MIN_HEAP_PURGE_SIZE 64
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            /**
+             * @brief Timer Service
+             *
+             * Runs callbacks at their deadlines. All timers share one thread waiting for the earliest deadline of a
+             * heap, so timers cost an entry instead of a sleeping thread and can be cancelled or moved at any time.
+             * Callbacks run on the timer thread and must be short, or on an executor if one is given, in which case
+             * they may block without delaying other timers.
+             */
+            class AWS_API_EXPORT TimerService {
+            public:
+                typedef std::function<void()> Callback;
+                typedef uint64_t TimerId;  ///< Never zero for a scheduled timer
+
+            protected:
+                /**
+                 * @brief Deadline heap entry, ordered by deadline and then by scheduling order
+                 */
+                class DeadlineEntry {
+                public:
+                    std::chrono::steady_clock::time_point deadline_;  ///< Time at which the timer is due
+                    TimerId timer_id_;                                ///< Timer the entry belongs to
+
+                    bool operator>(const DeadlineEntry &other) const {
+                        return deadline_ > other.deadline_
+                            || (deadline_ == other.deadline_ && timer_id_ > other.timer_id_);
+                    }
+                };
+
+                std::mutex timer_lock_;                               ///< Guards all timer state
+                std::condition_variable timer_wait_;                  ///< Signaled when an earlier timer is scheduled or the service is stopped
+                std::condition_variable running_wait_;                ///< Signaled when a callback returns
+                std::priority_queue<DeadlineEntry, util::Vector<DeadlineEntry>, std::greater<DeadlineEntry>> deadline_heap_;  ///< Deadlines of pending timers, cancelled entries are skipped when they reach the top
+                util::Map<TimerId, Callback> pending_timers_;         ///< Callbacks of timers that are not due yet
+                util::Map<TimerId, std::thread::id> running_timers_;  ///< Timers whose callbacks are queued or running, with the thread running them
+                TimerId next_timer_id_;                               ///< ID of the next timer
+                bool is_running_;                                     ///< false once the service is stopped
+                std::shared_ptr<Executor> p_executor_;                ///< Executor running the callbacks, nullptr to run them on the timer thread
+                std::thread timer_thread_;                            ///< Thread waiting for the earliest deadline
+
+                /**
+                 * @brief Constructor
+                 *
+                 * @param p_executor - Executor running the callbacks, nullptr to run them on the timer thread
+                 */
+                TimerService(std::shared_ptr<Executor> p_executor);
+
+                /**
+                 * @brief Rebuild the heap from pending timers once cancelled entries outnumber them
+                 *
+                 * Must be called with the timer lock held
+                 */
+                void PurgeCancelledEntries();
+
+                /**
+                 * @brief Run a due callback and mark the timer as done
+                 *
+                 * @param timer_id - Timer the callback belongs to
+                 * @param callback - Callback to run
+                 */
+                void RunCallback(TimerId timer_id, Callback &callback);
+
+                /**
+                 * @brief Wait for deadlines and run or submit due callbacks until the service is stopped
+                 */
+                void RunTimers();
+
+            public:
+                // Rule of 5 stuff
+                // Disable copying and moving because class contains a running thread
+                TimerService() = delete;                                   // Delete Default constructor
+                TimerService(const TimerService &) = delete;               // Delete Copy constructor
+                TimerService(TimerService &&) = delete;                    // Delete Move constructor
+                TimerService &operator=(const TimerService &) = delete;    // Delete Copy assignment operator
+                TimerService &operator=(TimerService &&) = delete;         // Delete Move assignment operator
+
+                /**
+                 * @brief Destructor, stops the service
+                 */
+                ~TimerService();
+
+                /**
+                 * @brief Factory method to create a timer service, the timer thread is started immediately
+                 *
+                 * @param p_executor - Executor running the callbacks, nullptr to run them on the timer thread
+                 * @return shared_ptr to the timer service
+                 */
+                static std::shared_ptr<TimerService> Create(std::shared_ptr<Executor> p_executor);
+
+                /**
+                 * @brief Run a callback once a deadline has passed
+                 *
+                 * @param deadline - Time at which the callback is due, callbacks with a past deadline run right away
+                 * @param callback - Callback to run
+                 * @return TimerId - ID used to cancel the timer, zero if the callback is nullptr or the service is
+                 * stopped
+                 */
+                TimerId Schedule(std::chrono::steady_clock::time_point deadline, Callback callback);
+
+                /**
+                 * @brief Cancel a timer
+                 *
+                 * If the callback is running on another thread, blocks until it has returned. The callback is not
+                 * run after this returns, unless this is called from the callback itself
+                 *
+                 * @param timer_id - Timer to cancel
+                 * @return bool - true if the timer was pending and will not run, false if it already ran or is running
+                 */
+                bool Cancel(TimerId timer_id);
+
+                /**
+                 * @brief Get the number of timers that are not due yet
+                 * @return size_t count
+                 */
+                size_t GetPendingTimerCount();
+
+                /**
+                 * @brief Stop the service
+                 *
+                 * Pending timers are dropped, blocks until running callbacks have returned. Must not be called from a
+                 * callback
+                 */
+                void Stop();
+            };
+        }
+    }
+}
@@ -0,0 +1,158 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file WorkStealingExecutor.hpp
+ * @brief
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "util/Core_EXPORTS.hpp"
+#include "util/memory/stl/Queue.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "util/threading/Executor.hpp"
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            /**
+             * @brief Work Stealing Executor
+             *
+             * Executor with a fixed set of worker threads, each with its own task queue. Tasks submitted by a task are
+             * queued on the worker running it, so related work stays on the same thread. Other tasks are spread over
+             * the workers. A worker without tasks takes the newest task of another worker, so a few busy queues do not
+             * leave the other workers idle. Tasks can run in any order and on any worker, work that must not run
+             * concurrently has to be serialized by the submitter.
+             */
+            class AWS_API_EXPORT WorkStealingExecutor : public Executor {
+            protected:
+                /**
+                 * @brief Worker thread and its queue
+                 */
+                class Worker {
+                public:
+                    std::mutex task_lock_;              ///< Guards tasks_
+                    util::Deque<Task> tasks_;           ///< Tasks waiting for this worker, taken from the front by the worker and from the back by others
+                    std::thread thread_;                ///< Worker thread
+                    std::thread::id thread_id_;         ///< ID of the worker thread, not changed once the worker is started
+                };
+
+                util::Vector<std::unique_ptr<Worker>> workers_;                     ///< Workers
+                std::mutex schedule_lock_;                                          ///< Guards delayed_tasks_, used by idle workers to wait for tasks
+                std::condition_variable task_wait_;                                 ///< Signaled when a task is queued or the executor is stopped
+                std::multimap<std::chrono::steady_clock::time_point, Task> delayed_tasks_;  ///< Tasks waiting for their delay to pass, by due time
+                std::atomic<std::chrono::steady_clock::rep> next_delayed_task_time_;   ///< Atomic, Time since epoch at which the next delayed task is due
+                std::atomic_size_t queued_task_count_;                              ///< Atomic, Count of tasks in all worker queues
+                std::atomic_size_t idle_worker_count_;                              ///< Atomic, Count of workers waiting for tasks
+                std::atomic_size_t next_worker_index_;                              ///< Atomic, Worker that receives the next task submitted from outside the executor
+                std::atomic<uint64_t> stolen_task_count_;                           ///< Atomic, Count of tasks taken from the queue of another worker
+                std::atomic_bool is_running_;                                       ///< Atomic, false once the executor is stopped
+
+                /**
+                 * @brief Constructor
+                 */
+                WorkStealingExecutor();
+
+                /**
+                 * @brief Start the worker threads
+                 * @param worker_count - Number of worker threads
+                 */
+                void Start(size_t worker_count);
+
+                /**
+                 * @brief Get the index of the worker running on the calling thread
+                 * @return size_t index, number of workers if called from another thread
+                 */
+                size_t GetCurrentWorkerIndex();
+
+                /**
+                 * @brief Take a task from the worker's own queue, or else from another worker
+                 *
+                 * @param worker_index - Index of the worker looking for a task
+                 * @param task[out] - Task to run
+                 * @return bool - true if a task was found
+                 */
+                bool PopTask(size_t worker_index, Task &task);
+
+                /**
+                 * @brief Move delayed tasks that are due to the queue of a worker
+                 *
+                 * Must be called with the schedule lock held
+                 *
+                 * @param worker_index - Index of the worker receiving the tasks
+                 * @param now - Current time
+                 * @return bool - true if any task was moved
+                 */
+                bool MoveDueTasks(size_t worker_index, std::chrono::steady_clock::time_point now);
+
+                /**
+                 * @brief Run queued tasks until the executor is stopped
+                 * @param worker_index - Index of the worker this thread belongs to
+                 */
+                void RunWorker(size_t worker_index);
+
+            public:
+                // Rule of 5 stuff
+                // Disable copying and moving because class contains running threads and std::atomic<> types
+                WorkStealingExecutor(const WorkStealingExecutor &) = delete;              // Delete Copy constructor
+                WorkStealingExecutor(WorkStealingExecutor &&) = delete;                   // Delete Move constructor
+                WorkStealingExecutor &operator=(const WorkStealingExecutor &) = delete;   // Delete Copy assignment operator
+                WorkStealingExecutor &operator=(WorkStealingExecutor &&) = delete;        // Delete Move assignment operator
+
+                /**
+                 * @brief Destructor, stops the executor
+                 */
+                ~WorkStealingExecutor();
+
+                /**
+                 * @brief Factory method to create an executor, worker threads are started immediately
+                 *
+                 * @param worker_count - Number of worker threads, zero uses one per hardware thread
+                 * @return shared_ptr to the executor
+                 */
+                static std::shared_ptr<WorkStealingExecutor> Create(size_t worker_count);
+
+                ResponseCode Submit(Task task);
+                ResponseCode SubmitAfter(std::chrono::milliseconds delay, Task task);
+                size_t GetWorkerCount() { return workers_.size(); }
+
+                /**
+                 * @brief Stop the executor
+                 *
+                 * Further submit requests fail. Tasks that are running are allowed to finish, queued and delayed tasks
+                 * are not run. Blocks until all workers have exited, must not be called from a task
+                 */
+                void Stop();
+
+                /**
+                 * @brief Get the number of tasks that were taken from the queue of another worker
+                 * @return uint64_t count
+                 */
+                uint64_t GetStolenTaskCount() { return stolen_task_count_; }
+            };
+        }
+    }
+}
@@ -25,11 +25,208 @@
 #include "MbedTLSConnection.hpp"
 #include "util/logging/LogMacros.hpp"
 
+// Handshake parameters, used to tell if the server accepted the offered session
+#include "mbedtls/ssl_internal.h"
+
+#include <algorithm>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #define MBEDTLS_WRAPPER_LOG_TAG "[MbedTLS Wrapper]"
 #define MAX_CHARS_IN_PORT_NUMBER 6
 
 namespace awsiotsdk {
     namespace network {
+#if MBEDTLS_VERSION_NUMBER >= 0x02130000
+        /**
+         * @brief Open the session cache file, creating it readable by the owner only when writing
+         *
+         * @param session_cache_location - Path of the file
+         * @param for_write - True to truncate the file for writing, false to read it
+         * @return FILE* - opened file, nullptr on error
+         */
+        static FILE *OpenSessionCacheFile(const util::String &session_cache_location, bool for_write) {
+            if (!for_write) {
+                return fopen(session_cache_location.c_str(), "rb");
+            }
+#ifdef WIN32
+            return fopen(session_cache_location.c_str(), "wb");
+#else
+            int fd = open(session_cache_location.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+            if (-1 == fd) {
+                return nullptr;
+            }
+            FILE *p_file = fdopen(fd, "wb");
+            if (nullptr == p_file) {
+                close(fd);
+            }
+            return p_file;
+#endif
+        }
+#endif
+
+        MbedTLSCredentials::MbedTLSCredentials() {
+            mbedtls_x509_crt_init(&root_ca_);
+            mbedtls_x509_crt_init(&device_cert_);
+        }
+
+        MbedTLSCredentials::~MbedTLSCredentials() {
+            mbedtls_x509_crt_free(&root_ca_);
+            mbedtls_x509_crt_free(&device_cert_);
+        }
+
+        MbedTLSCredentialCache *MbedTLSCredentialCache::getInstance() {
+            static MbedTLSCredentialCache credential_cache;
+            return &credential_cache;
+        }
+
+        MbedTLSCredentialCache::FileStamp MbedTLSCredentialCache::GetFileStamp(const util::String &file_location) {
+            FileStamp file_stamp = {-1, 0, -1, -1};
+            struct stat file_status;
+            if (!file_location.empty() && 0 == stat(file_location.c_str(), &file_status)) {
+                file_stamp.modified_time_ = static_cast<long long>(file_status.st_mtime);
+#if defined(__APPLE__)
+                file_stamp.modified_time_nsec_ = static_cast<long long>(file_status.st_mtimespec.tv_nsec);
+#elif !defined(WIN32)
+                file_stamp.modified_time_nsec_ = static_cast<long long>(file_status.st_mtim.tv_nsec);
+#endif
+                file_stamp.inode_ = static_cast<long long>(file_status.st_ino);
+                file_stamp.size_ = static_cast<long long>(file_status.st_size);
+            }
+            return file_stamp;
+        }
+
+        ResponseCode MbedTLSCredentialCache::LoadCredentials(const util::String &root_ca_location,
+                                                             const util::String &device_cert_location,
+                                                             const util::String &device_private_key_location,
+                                                             std::shared_ptr<MbedTLSCredentials> &p_credentials_out) {
+            std::shared_ptr<MbedTLSCredentials> p_credentials = std::make_shared<MbedTLSCredentials>();
+
+            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "....Loading the CA root certificate... %s", root_ca_location.c_str());
+            int ret = mbedtls_x509_crt_parse_file(&p_credentials->root_ca_, root_ca_location.c_str());
+            if (ret < 0) {
+                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
+                              "Failed!!!  mbedtls_x509_crt_parse returned -0x%x while parsing root cert\n\n",
+                              -ret);
+                return ResponseCode::NETWORK_SSL_ROOT_CRT_PARSE_ERROR;
+            }
+            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "ok (%d skipped)\n", ret);
+
+            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "....Loading the client cert. and key...");
+            ret = mbedtls_x509_crt_parse_file(&p_credentials->device_cert_, device_cert_location.c_str());
+            if (ret != 0) {
+                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
+                              "Failed!!!  mbedtls_x509_crt_parse returned -0x%x while parsing device cert\n\n",
+                              -ret);
+                return ResponseCode::NETWORK_SSL_DEVICE_CRT_PARSE_ERROR;
+            }
+
+            FILE *p_file = fopen(device_private_key_location.c_str(), "rb");
+            long file_length = -1;
+            if (nullptr != p_file) {
+                if (0 == fseek(p_file, 0, SEEK_END)) {
+                    file_length = ftell(p_file);
+                    rewind(p_file);
+                }
+                if (0 < file_length) {
+                    p_credentials->device_private_key_.resize(static_cast<size_t>(file_length));
+                    if (p_credentials->device_private_key_.size() != fread(p_credentials->device_private_key_.data(),
+                                                                            1, p_credentials->device_private_key_.size(),
+                                                                            p_file)) {
+                        p_credentials->device_private_key_.clear();
+                    }
+                }
+                fclose(p_file);
+            }
+
+            // PEM keys are parsed as a null terminated string, the same as mbedtls_pk_parse_keyfile does
+            const char pem_begin[] = "-----BEGIN ";
+            if (p_credentials->device_private_key_.end() != std::search(p_credentials->device_private_key_.begin(),
+                                                                        p_credentials->device_private_key_.end(),
+                                                                        pem_begin, pem_begin + sizeof(pem_begin) - 1)) {
+                p_credentials->device_private_key_.push_back('\0');
+            }
+
+            // Parsed once here so a broken key is detected before the credentials are cached
+            mbedtls_pk_context pkey;
+            mbedtls_pk_init(&pkey);
+            ret = MBEDTLS_ERR_PK_FILE_IO_ERROR;
+            if (!p_credentials->device_private_key_.empty()) {
+                ret = mbedtls_pk_parse_key(&pkey, p_credentials->device_private_key_.data(),
+                                           p_credentials->device_private_key_.size(), nullptr, 0);
+            }
+            mbedtls_pk_free(&pkey);
+            if (ret != 0) {
+                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
+                              "Failed!!!  mbedtls_pk_parse_key returned -0x%x while parsing private key\n\n",
+                              -ret);
+                AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, " path : %s ", device_private_key_location.c_str());
+                return ResponseCode::NETWORK_SSL_KEY_PARSE_ERROR;
+            }
+            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, " ok\n");
+
+            p_credentials_out = p_credentials;
+            return ResponseCode::SUCCESS;
+        }
+
+        ResponseCode MbedTLSCredentialCache::GetCredentials(const util::String &root_ca_location,
+                                                            const util::String &device_cert_location,
+                                                            const util::String &device_private_key_location,
+                                                            std::shared_ptr<MbedTLSCredentials> &p_credentials_out) {
+            util::String entry_key = root_ca_location + "\n" + device_cert_location + "\n" + device_private_key_location;
+            CredentialEntry credential_entry;
+            credential_entry.root_ca_stamp_ = GetFileStamp(root_ca_location);
+            credential_entry.device_cert_stamp_ = GetFileStamp(device_cert_location);
+            credential_entry.device_private_key_stamp_ = GetFileStamp(device_private_key_location);
+
+            std::lock_guard<std::mutex> cache_lock(cache_lock_);
+            std::shared_ptr<MbedTLSCredentials> p_cached_credentials;
+            util::Map<util::String, CredentialEntry>::iterator itr = credential_entries_.find(entry_key);
+            if (credential_entries_.end() != itr) {
+                p_cached_credentials = itr->second.p_credentials_.lock();
+                if (nullptr != p_cached_credentials &&
+                    itr->second.root_ca_stamp_ == credential_entry.root_ca_stamp_ &&
+                    itr->second.device_cert_stamp_ == credential_entry.device_cert_stamp_ &&
+                    itr->second.device_private_key_stamp_ == credential_entry.device_private_key_stamp_) {
+                    p_credentials_out = p_cached_credentials;
+                    return ResponseCode::SUCCESS;
+                }
+            }
+
+            std::shared_ptr<MbedTLSCredentials> p_credentials;
+            ResponseCode rc = LoadCredentials(root_ca_location, device_cert_location, device_private_key_location,
+                                              p_credentials);
+            if (ResponseCode::SUCCESS != rc) {
+                if (nullptr == p_cached_credentials) {
+                    return rc;
+                }
+                AWS_LOG_WARN(MBEDTLS_WRAPPER_LOG_TAG,
+                             "Unable to reload changed credentials, continuing with the previously loaded ones");
+                p_credentials_out = p_cached_credentials;
+                return ResponseCode::SUCCESS;
+            }
+            if (nullptr != p_cached_credentials) {
+                AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "Reloaded changed credentials");
+            }
+
+            // Drop entries of credentials no connection uses anymore
+            for (itr = credential_entries_.begin(); credential_entries_.end() != itr;) {
+                if (itr->second.p_credentials_.expired()) {
+                    itr = credential_entries_.erase(itr);
+                } else {
+                    itr++;
+                }
+            }
+
+            credential_entry.p_credentials_ = p_credentials;
+            credential_entries_[entry_key] = credential_entry;
+            p_credentials_out = p_credentials;
+            return ResponseCode::SUCCESS;
+        }
+
         MbedTLSConnection::MbedTLSConnection(util::String endpoint,
                                              uint16_t endpoint_port,
                                              util::String root_ca_location,
@@ -53,6 +250,16 @@ namespace awsiotsdk {
             is_connected_ = false;
             requires_free_ = false;
             enable_alpn_ = false;
+
+            mbedtls_pk_init(&pkey_);
+
+            mbedtls_ssl_session_init(&saved_session_);
+            has_saved_session_ = false;
+            enable_session_resumption_ = true;
+            last_handshake_duration_ms_ = -1;
+            last_handshake_resumed_ = false;
+            full_handshake_count_ = 0;
+            resumed_handshake_count_ = 0;
         }
 
         MbedTLSConnection::MbedTLSConnection(util::String endpoint,
@@ -79,6 +286,148 @@ namespace awsiotsdk {
             return is_connected_;
         }
 
+        bool MbedTLSConnection::IsPollable() {
+            return true;
+        }
+
+        int MbedTLSConnection::GetPollableDescriptor() {
+            return is_connected_ ? server_fd_.fd : -1;
+        }
+
+        ResponseCode MbedTLSConnection::LoadCredentials() {
+            std::shared_ptr<MbedTLSCredentials> p_credentials;
+            ResponseCode rc = MbedTLSCredentialCache::getInstance()->GetCredentials(root_ca_location_,
+                                                                                    device_cert_location_,
+                                                                                    device_private_key_location_,
+                                                                                    p_credentials);
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
+            }
+            if (p_credentials == p_credentials_) {
+                return ResponseCode::SUCCESS;
+            }
+
+            // A session is bound to the credentials it was established with
+            if (nullptr != p_credentials_) {
+                ClearSession();
+            }
+            p_credentials_ = nullptr;
+            mbedtls_pk_free(&pkey_);
+            mbedtls_pk_init(&pkey_);
+            int ret = mbedtls_pk_parse_key(&pkey_, p_credentials->device_private_key_.data(),
+                                           p_credentials->device_private_key_.size(), nullptr, 0);
+            if (ret != 0) {
+                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
+                              "Failed!!!  mbedtls_pk_parse_key returned -0x%x while parsing private key\n\n",
+                              -ret);
+                return ResponseCode::NETWORK_SSL_KEY_PARSE_ERROR;
+            }
+            p_credentials_ = p_credentials;
+            return ResponseCode::SUCCESS;
+        }
+
+        void MbedTLSConnection::LoadPersistedSession() {
+            if (session_cache_location_.empty()) {
+                return;
+            }
+#if MBEDTLS_VERSION_NUMBER >= 0x02130000
+            FILE *p_file = OpenSessionCacheFile(session_cache_location_, false);
+            if (nullptr == p_file) {
+                return;
+            }
+            util::Vector<unsigned char> session_buf;
+            long file_length = -1;
+            if (0 == fseek(p_file, 0, SEEK_END)) {
+                file_length = ftell(p_file);
+                rewind(p_file);
+            }
+            if (0 < file_length) {
+                session_buf.resize(static_cast<size_t>(file_length));
+                if (session_buf.size() != fread(session_buf.data(), 1, session_buf.size(), p_file)) {
+                    session_buf.clear();
+                }
+            }
+            fclose(p_file);
+
+            if (session_buf.empty() ||
+                0 != mbedtls_ssl_session_load(&saved_session_, session_buf.data(), session_buf.size())) {
+                AWS_LOG_WARN(MBEDTLS_WRAPPER_LOG_TAG, "Unable to read TLS session from %s",
+                             session_cache_location_.c_str());
+                mbedtls_ssl_session_free(&saved_session_);
+                mbedtls_ssl_session_init(&saved_session_);
+                return;
+            }
+            has_saved_session_ = true;
+#else
+            AWS_LOG_WARN(MBEDTLS_WRAPPER_LOG_TAG, "Persisted TLS sessions require MbedTLS 2.19 or later");
+#endif
+        }
+
+        void MbedTLSConnection::PersistSession() {
+            if (session_cache_location_.empty() || !has_saved_session_) {
+                return;
+            }
+#if MBEDTLS_VERSION_NUMBER >= 0x02130000
+            size_t session_length = 0;
+            // Called without a buffer to get the serialized length
+            mbedtls_ssl_session_save(&saved_session_, nullptr, 0, &session_length);
+            util::Vector<unsigned char> session_buf(session_length);
+            FILE *p_file = nullptr;
+            if (0 < session_length &&
+                0 == mbedtls_ssl_session_save(&saved_session_, session_buf.data(), session_buf.size(),
+                                              &session_length)) {
+                p_file = OpenSessionCacheFile(session_cache_location_, true);
+            }
+            if (nullptr == p_file || session_length != fwrite(session_buf.data(), 1, session_length, p_file)) {
+                AWS_LOG_WARN(MBEDTLS_WRAPPER_LOG_TAG, "Unable to persist TLS session to %s",
+                             session_cache_location_.c_str());
+            }
+            if (nullptr != p_file) {
+                fclose(p_file);
+            }
+#endif
+        }
+
+        void MbedTLSConnection::ClearSession() {
+            std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+            mbedtls_ssl_session_free(&saved_session_);
+            mbedtls_ssl_session_init(&saved_session_);
+            has_saved_session_ = false;
+            if (!session_cache_location_.empty()) {
+                remove(session_cache_location_.c_str());
+            }
+        }
+
+        void MbedTLSConnection::SetSessionResumption(bool enable_session_resumption) {
+            if (!enable_session_resumption) {
+                ClearSession();
+            }
+            std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+            enable_session_resumption_ = enable_session_resumption;
+        }
+
+        void MbedTLSConnection::SetSessionCacheLocation(util::String session_cache_location) {
+            std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+            session_cache_location_ = session_cache_location;
+            PersistSession();
+        }
+
+        std::chrono::milliseconds MbedTLSConnection::GetLastHandshakeDuration() {
+            return std::chrono::milliseconds(last_handshake_duration_ms_);
+        }
+
+        bool MbedTLSConnection::WasLastHandshakeResumed() {
+            return last_handshake_resumed_;
+        }
+
+        uint32_t MbedTLSConnection::GetFullHandshakeCount() {
+            return full_handshake_count_;
+        }
+
+        uint32_t MbedTLSConnection::GetResumedHandshakeCount() {
+            return resumed_handshake_count_;
+        }
+
         int MbedTLSConnection::VerifyCertificate(void *data, mbedtls_x509_crt *crt, int depth, uint32_t *flags) {
             char buf[1024];
             ((void) data);
@@ -110,9 +459,6 @@ namespace awsiotsdk {
             mbedtls_ssl_init(&ssl_);
             mbedtls_ssl_config_init(&conf_);
             mbedtls_ctr_drbg_init(&ctr_drbg_);
-            mbedtls_x509_crt_init(&cacert_);
-            mbedtls_x509_crt_init(&clicert_);
-            mbedtls_pk_init(&pkey_);
 
             if (enable_alpn_) {
 #ifdef MBEDTLS_SSL_ALPN
@@ -138,34 +484,12 @@ namespace awsiotsdk {
                 return ResponseCode::NETWORK_SSL_INIT_ERROR;
             }
 
-            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "....Loading the CA root certificate... %s", root_ca_location_.c_str());
-            ret = mbedtls_x509_crt_parse_file(&cacert_, root_ca_location_.c_str());
-            if (ret < 0) {
-                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
-                              "Failed!!!  mbedtls_x509_crt_parse returned -0x%x while parsing root cert\n\n",
-                              -ret);
-                return ResponseCode::NETWORK_SSL_ROOT_CRT_PARSE_ERROR;
-            }
-            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "ok (%d skipped)\n", ret);
-
-            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "....Loading the client cert. and key...");
-            ret = mbedtls_x509_crt_parse_file(&clicert_, device_cert_location_.c_str());
-            if (ret != 0) {
-                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
-                              "Failed!!!  mbedtls_x509_crt_parse returned -0x%x while parsing device cert\n\n",
-                              -ret);
-                return ResponseCode::NETWORK_SSL_DEVICE_CRT_PARSE_ERROR;
+            // Cheap while the credential files are unchanged, picks up rotated credentials on reconnect
+            rc = LoadCredentials();
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
             }
 
-            ret = mbedtls_pk_parse_keyfile(&pkey_, device_private_key_location_.c_str(), "");
-            if (ret != 0) {
-                AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG,
-                              "Failed!!!  mbedtls_pk_parse_key returned -0x%x while parsing private key\n\n",
-                              -ret);
-                AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, " path : %s ", device_private_key_location_.c_str());
-                return ResponseCode::NETWORK_SSL_KEY_PARSE_ERROR;
-            }
-            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, " ok\n");
             snprintf(port_buf, MAX_CHARS_IN_PORT_NUMBER, "%d", endpoint_port_);
             AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "....Connecting to %s/%s...", endpoint_.c_str(), port_buf);
             if ((ret = mbedtls_net_connect(&server_fd_, endpoint_.c_str(), port_buf, MBEDTLS_NET_PROTO_TCP)) != 0) {
@@ -205,8 +529,8 @@ namespace awsiotsdk {
             }
             mbedtls_ssl_conf_rng(&conf_, mbedtls_ctr_drbg_random, &ctr_drbg_);
 
-            mbedtls_ssl_conf_ca_chain(&conf_, &cacert_, NULL);
-            if ((ret = mbedtls_ssl_conf_own_cert(&conf_, &clicert_, &pkey_)) !=
+            mbedtls_ssl_conf_ca_chain(&conf_, &p_credentials_->root_ca_, NULL);
+            if ((ret = mbedtls_ssl_conf_own_cert(&conf_, &p_credentials_->device_cert_, &pkey_)) !=
                 0) {
                 AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG, "Failed!!! mbedtls_ssl_conf_own_cert returned %d\n\n", ret);
                 return ResponseCode::NETWORK_SSL_UNKNOWN_ERROR;
@@ -226,10 +550,35 @@ namespace awsiotsdk {
                 return ResponseCode::NETWORK_SSL_UNKNOWN_ERROR;
             }
 
+            bool is_session_offered = false;
+            {
+                std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+                if (enable_session_resumption_) {
+                    if (!has_saved_session_) {
+                        LoadPersistedSession();
+                    }
+                    if (has_saved_session_) {
+                        ret = mbedtls_ssl_set_session(&ssl_, &saved_session_);
+                        if (0 != ret) {
+                            AWS_LOG_WARN(MBEDTLS_WRAPPER_LOG_TAG, "mbedtls_ssl_set_session returned -0x%x", -ret);
+                        }
+                        is_session_offered = (0 == ret);
+                    }
+                }
+            }
+
             AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "\n\nSSL state connect : %d ", ssl_.state);
             AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "....Performing the SSL/TLS handshake...");
-            while ((ret = mbedtls_ssl_handshake(&ssl_)) != 0) {
-                if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
+            bool is_resumed = false;
+            std::chrono::steady_clock::time_point handshake_start = std::chrono::steady_clock::now();
+            // Stepped through instead of mbedtls_ssl_handshake, whether the server accepted the offered session is
+            // only known while the handshake parameters exist
+            while (MBEDTLS_SSL_HANDSHAKE_OVER != ssl_.state) {
+                if (nullptr != ssl_.handshake) {
+                    is_resumed = (0 != ssl_.handshake->resume);
+                }
+                ret = mbedtls_ssl_handshake_step(&ssl_);
+                if (0 != ret && ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE) {
                     AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG, "Failed!!! mbedtls_ssl_handshake returned -0x%x\n", -ret);
                     if (ret == MBEDTLS_ERR_X509_CERT_VERIFY_FAILED) {
                         AWS_LOG_ERROR(MBEDTLS_WRAPPER_LOG_TAG, "    Unable to verify the server's certificate. "
@@ -239,10 +588,26 @@ namespace awsiotsdk {
                             "    Alternatively, you may want to use "
                             "auth_mode=optional for testing purposes.\n");
                     }
+                    if (is_session_offered) {
+                        // Do not offer a session the handshake failed with again
+                        ClearSession();
+                    }
                     return ResponseCode::NETWORK_SSL_TLS_HANDSHAKE_ERROR;
                 }
             }
 
+            std::chrono::milliseconds handshake_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - handshake_start);
+            last_handshake_duration_ms_ = handshake_duration.count();
+            last_handshake_resumed_ = is_resumed;
+            if (is_resumed) {
+                resumed_handshake_count_++;
+            } else {
+                full_handshake_count_++;
+            }
+            AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG, "TLS handshake completed in %lld ms, session %s",
+                         static_cast<long long>(handshake_duration.count()), is_resumed ? "resumed" : "new");
+
             AWS_LOG_INFO(MBEDTLS_WRAPPER_LOG_TAG,
                          " ok\n    [ Protocol is %s ]\n    [ Ciphersuite is %s ]\n",
                          mbedtls_ssl_get_version(&ssl_),
@@ -270,6 +635,17 @@ namespace awsiotsdk {
                 rc = ResponseCode::SUCCESS;
             }
 
+            if (ResponseCode::SUCCESS == rc) {
+                std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+                if (enable_session_resumption_) {
+                    // Also picks up a new session ticket the server sent during a resumed handshake
+                    mbedtls_ssl_session_free(&saved_session_);
+                    mbedtls_ssl_session_init(&saved_session_);
+                    has_saved_session_ = (0 == mbedtls_ssl_get_session(&ssl_, &saved_session_));
+                    PersistSession();
+                }
+            }
+
             mbedtls_ssl_conf_read_timeout(&conf_, static_cast<uint32_t>(tls_read_timeout_.count()));
             is_connected_ = true;
             return rc;
@@ -347,6 +723,56 @@ namespace awsiotsdk {
             return ResponseCode::NETWORK_SSL_READ_ERROR;
         }
 
+        ResponseCode MbedTLSConnection::ReadAvailableInternal(util::Vector<unsigned char> &buf,
+                                                              size_t buf_read_offset,
+                                                              size_t min_bytes_to_read,
+                                                              size_t max_bytes_to_read,
+                                                              size_t &size_read_bytes_out) {
+            int ret;
+            const auto start = std::chrono::system_clock::now();
+            auto elapsed_time = std::chrono::duration<double>();
+
+            size_read_bytes_out = 0;
+            do {
+                // This read will timeout after IOT_SSL_READ_TIMEOUT if there's no data to be read
+                ret = mbedtls_ssl_read(&ssl_, &buf[buf_read_offset + size_read_bytes_out],
+                                       max_bytes_to_read - size_read_bytes_out);
+                if (ret > 0) {
+                    size_read_bytes_out += ret;
+                } else if (ret != MBEDTLS_ERR_SSL_WANT_READ && ret != MBEDTLS_ERR_SSL_WANT_WRITE
+                    && ret != MBEDTLS_ERR_SSL_TIMEOUT) {
+                    return ResponseCode::NETWORK_SSL_READ_ERROR;
+                }
+                elapsed_time = std::chrono::system_clock::now() - start;
+                // Once the minimum is read, only continue with data that has already been decrypted
+            } while (size_read_bytes_out < max_bytes_to_read &&
+                     ((size_read_bytes_out < min_bytes_to_read &&
+                       tls_read_timeout_ > std::chrono::duration_cast<std::chrono::milliseconds>(elapsed_time)) ||
+                      (size_read_bytes_out >= min_bytes_to_read && 0 < mbedtls_ssl_get_bytes_avail(&ssl_))));
+
+            if (0 == size_read_bytes_out) {
+                return ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
+            }
+
+            return ResponseCode::SUCCESS;
+        }
+
+        ResponseCode MbedTLSConnection::WaitForReadableInternal(std::chrono::milliseconds timeout) {
+            // Data that was already received and decrypted does not show up on the socket
+            if (0 < mbedtls_ssl_get_bytes_avail(&ssl_)) {
+                return ResponseCode::SUCCESS;
+            }
+
+            int ret = mbedtls_net_poll(&server_fd_, MBEDTLS_NET_POLL_READ, static_cast<uint32_t>(timeout.count()));
+            if (0 < ret) {
+                return ResponseCode::SUCCESS;
+            } else if (0 == ret) {
+                return ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
+            }
+
+            return ResponseCode::NETWORK_SSL_READ_ERROR;
+        }
+
         ResponseCode MbedTLSConnection::DisconnectInternal() {
             if (is_connected_) {
                 int ret = 0;
@@ -358,9 +784,6 @@ namespace awsiotsdk {
             if(requires_free_) {
                 mbedtls_net_free(&server_fd_);
 
-                mbedtls_x509_crt_free(&clicert_);
-                mbedtls_x509_crt_free(&cacert_);
-                mbedtls_pk_free(&pkey_);
                 mbedtls_ssl_free(&ssl_);
                 mbedtls_ssl_config_free(&conf_);
                 mbedtls_ctr_drbg_free(&ctr_drbg_);
@@ -377,6 +800,8 @@ namespace awsiotsdk {
 
         MbedTLSConnection::~MbedTLSConnection() {
             Disconnect();
+            mbedtls_pk_free(&pkey_);
+            mbedtls_ssl_session_free(&saved_session_);
         }
     }
 }
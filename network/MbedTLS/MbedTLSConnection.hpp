@@ -21,6 +21,7 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>
 
 #include "mbedtls/config.h"
 
@@ -34,12 +35,121 @@
 #include "mbedtls/error.h"
 #include "mbedtls/debug.h"
 #include "mbedtls/timing.h"
+#include "mbedtls/version.h"
+
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/Vector.hpp"
 
 #include "NetworkConnection.hpp"
 #include "ResponseCode.hpp"
 
 namespace awsiotsdk {
     namespace network {
+        /**
+         * @brief Parsed credentials shared between connections
+         *
+         * The private key is kept as file contents and parsed by each connection. Private key contexts are only
+         * safe to use from several threads at once when MbedTLS is built with MBEDTLS_THREADING_C.
+         */
+        class MbedTLSCredentials {
+        public:
+            mbedtls_x509_crt root_ca_;                         ///< Parsed root CA chain
+            mbedtls_x509_crt device_cert_;                     ///< Parsed device certificate chain
+            util::Vector<unsigned char> device_private_key_;   ///< Contents of the device private key file
+
+            MbedTLSCredentials();
+
+            // Rule of 5 stuff
+            // Disable copying, the parsed certificates own allocated memory
+            MbedTLSCredentials(const MbedTLSCredentials &) = delete;
+            MbedTLSCredentials &operator=(const MbedTLSCredentials &) & = delete;
+
+            ~MbedTLSCredentials();
+        };
+
+        /**
+         * @brief Shared cache of parsed credentials
+         *
+         * Connections using the same root CA, device certificate and private key files share one set of parsed
+         * credentials, so reconnects and additional connections do not read and parse the files again. The files
+         * are checked for changes whenever credentials are requested, and are loaded again if they were modified.
+         * Connections keep using the credentials they connected with until they reconnect.
+         */
+        class MbedTLSCredentialCache {
+        protected:
+            /**
+             * @brief Modification time, inode and size of a credential file, used to detect changes
+             */
+            struct FileStamp {
+                long long modified_time_;                      ///< Last modification time in seconds, -1 if the file does not exist
+                long long modified_time_nsec_;                 ///< Nanosecond part of the modification time, 0 where not available
+                long long inode_;                              ///< Inode of the file, changes when the file is replaced, -1 if the file does not exist
+                long long size_;                               ///< File size in bytes, -1 if the file does not exist
+
+                bool operator==(const FileStamp &other) const {
+                    return modified_time_ == other.modified_time_ && modified_time_nsec_ == other.modified_time_nsec_
+                        && inode_ == other.inode_ && size_ == other.size_;
+                }
+            };
+
+            /**
+             * @brief Cached credentials and the state of the files they were loaded from
+             */
+            struct CredentialEntry {
+                std::weak_ptr<MbedTLSCredentials> p_credentials_;  ///< Credentials, expire once no connection uses them
+                FileStamp root_ca_stamp_;                      ///< Root CA file the credentials were loaded from
+                FileStamp device_cert_stamp_;                  ///< Device certificate file the credentials were loaded from
+                FileStamp device_private_key_stamp_;           ///< Private key file the credentials were loaded from
+            };
+
+            std::mutex cache_lock_;                            ///< Guards the entries, also serializes loading credentials
+            util::Map<util::String, CredentialEntry> credential_entries_;  ///< Entries keyed by the credential file paths
+
+            MbedTLSCredentialCache() = default;
+
+            /**
+             * @brief Get the modification time and size of a file
+             *
+             * @param file_location - Path of the file
+             * @return FileStamp - stamp of the file, all -1 if it does not exist
+             */
+            static FileStamp GetFileStamp(const util::String &file_location);
+
+            /**
+             * @brief Read and parse a set of credential files
+             *
+             * @param root_ca_location - Path of the root CA file
+             * @param device_cert_location - Path of the device certificate file
+             * @param device_private_key_location - Path of the device private key file
+             * @param p_credentials_out - Loaded credentials
+             * @return ResponseCode - SUCCESS or the TLS error for the credential that could not be loaded
+             */
+            static ResponseCode LoadCredentials(const util::String &root_ca_location,
+                                                const util::String &device_cert_location,
+                                                const util::String &device_private_key_location,
+                                                std::shared_ptr<MbedTLSCredentials> &p_credentials_out);
+
+        public:
+            static MbedTLSCredentialCache *getInstance();
+
+            /**
+             * @brief Get the parsed credentials for a set of credential files
+             *
+             * Returns the cached credentials if the files did not change since they were loaded. Otherwise loads them
+             * again. If loading changed files fails, for example because a file is only partially written, the
+             * previous credentials are returned and the files are checked again on the next call.
+             *
+             * @param root_ca_location - Path of the root CA file
+             * @param device_cert_location - Path of the device certificate file
+             * @param device_private_key_location - Path of the device private key file
+             * @param p_credentials_out - Credentials for the files
+             * @return ResponseCode - SUCCESS or the TLS error for the credential that could not be loaded
+             */
+            ResponseCode GetCredentials(const util::String &root_ca_location, const util::String &device_cert_location,
+                                        const util::String &device_private_key_location,
+                                        std::shared_ptr<MbedTLSCredentials> &p_credentials_out);
+        };
+
         /**
          * @brief MbedTLS Wrapper Class
          *
@@ -65,9 +175,8 @@ namespace awsiotsdk {
             mbedtls_ssl_context ssl_;
             mbedtls_ssl_config conf_;
             uint32_t flags_;
-            mbedtls_x509_crt cacert_;
-            mbedtls_x509_crt clicert_;
-            mbedtls_pk_context pkey_;
+            std::shared_ptr<MbedTLSCredentials> p_credentials_; ///< Certificates, shared through MbedTLSCredentialCache
+            mbedtls_pk_context pkey_;                          ///< Private key parsed from p_credentials_
             mbedtls_net_context server_fd_;
 
             bool enable_alpn_;
@@ -75,6 +184,49 @@ namespace awsiotsdk {
             // TODO: This is a Hotfix, requires a better approach
             std::atomic_bool requires_free_;                               ///< Boolean indicating whether the mbedtls struct variables have been allocated or not
 
+            // Session resumption
+            mbedtls_ssl_session saved_session_;                ///< Session offered for resumption on the next connect
+            bool has_saved_session_;                           ///< Boolean, True = saved_session_ holds a session
+            std::mutex ssl_session_lock_;                      ///< Guards the saved session and its settings
+            bool enable_session_resumption_;                   ///< Boolean, True = resume the previous TLS session on reconnect
+            util::String session_cache_location_;              ///< Optional path of the file the session is persisted to
+
+            // Handshake metrics
+            std::atomic<std::chrono::milliseconds::rep> last_handshake_duration_ms_; ///< Duration of the last successful handshake
+            std::atomic_bool last_handshake_resumed_;          ///< Boolean, True = the last successful handshake resumed a session
+            std::atomic<uint32_t> full_handshake_count_;       ///< Number of successful full handshakes
+            std::atomic<uint32_t> resumed_handshake_count_;    ///< Number of successful resumed handshakes
+
+            /**
+             * @brief Get the credentials for the configured files and parse the private key if they changed
+             *
+             * Uses the shared credential cache, the credential files are only read when they changed.
+             *
+             * @return ResponseCode - successful load or TLS error
+             */
+            ResponseCode LoadCredentials();
+
+            /**
+             * @brief Read the persisted session, if there is one
+             *
+             * Must be called with the session lock held. Requires MbedTLS 2.19 or later.
+             */
+            void LoadPersistedSession();
+
+            /**
+             * @brief Write the saved session to the session cache location, if one is set
+             *
+             * Must be called with the session lock held. Requires MbedTLS 2.19 or later.
+             */
+            void PersistSession();
+
+            /**
+             * @brief Forget the saved session, including its persisted copy
+             *
+             * Used when the session can no longer be resumed, like after changing the endpoint
+             */
+            void ClearSession();
+
             /**
              * @brief Create a TLS socket and open the connection
              *
@@ -104,6 +256,31 @@ namespace awsiotsdk {
             ResponseCode ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                       size_t size_bytes_to_read, size_t &size_read_bytes_out);
 
+            /**
+             * @brief Read available bytes from the network socket
+             *
+             * Waits for min_bytes_to_read bytes and returns all decrypted data up to max_bytes_to_read
+             *
+             * @param util::Vector<unsigned char> - reference to buffer where read bytes should be copied
+             * @param size_t - offset in the buffer where read bytes should be copied
+             * @param size_t - minimum number of bytes to read
+             * @param size_t - maximum number of bytes to read
+             * @param size_t - reference to store number of bytes read
+             * @return ResponseCode - successful read or TLS error code
+             */
+            ResponseCode ReadAvailableInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                               size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                               size_t &size_read_bytes_out);
+
+            /**
+             * @brief Wait until data is available to read from the network socket
+             *
+             * @param std::chrono::milliseconds - maximum time to wait
+             * @return ResponseCode - SUCCESS if data is available, NETWORK_SSL_NOTHING_TO_READ on timeout or
+             *                        TLS error code
+             */
+            ResponseCode WaitForReadableInternal(std::chrono::milliseconds timeout);
+
             /**
              * @brief Disconnect from network socket
              *
@@ -142,6 +319,56 @@ namespace awsiotsdk {
                               std::chrono::milliseconds tls_read_timeout, std::chrono::milliseconds tls_write_timeout,
                               bool server_verification_flag, bool enable_alpn);
 
+            /**
+             * @brief Enable or disable TLS session resumption
+             *
+             * When enabled, which is the default, reconnects offer the session ID or session ticket of the previous
+             * connection. The server can then skip the certificate exchange and client certificate signing of a full
+             * handshake. Falls back to a full handshake if the server does not accept the session.
+             *
+             * @param enable_session_resumption - True to resume sessions on reconnect
+             */
+            void SetSessionResumption(bool enable_session_resumption);
+
+            /**
+             * @brief Persist the TLS session to a file so it can be resumed after a restart
+             *
+             * The file contains the session secret and is created readable by the owner only. Use a separate file
+             * for each endpoint. Pass an empty string to only keep the session in memory, which is the default.
+             * Requires MbedTLS 2.19 or later, older versions only keep the session in memory.
+             *
+             * @param session_cache_location - Path of the session cache file
+             */
+            void SetSessionCacheLocation(util::String session_cache_location);
+
+            /**
+             * @brief Get the duration of the last successful TLS handshake
+             *
+             * @return std::chrono::milliseconds - handshake duration, -1 if no handshake completed yet
+             */
+            std::chrono::milliseconds GetLastHandshakeDuration();
+
+            /**
+             * @brief Check if the last successful TLS handshake resumed a previous session
+             *
+             * @return bool - true if the session was resumed
+             */
+            bool WasLastHandshakeResumed();
+
+            /**
+             * @brief Get the number of successful full TLS handshakes
+             *
+             * @return uint32_t - number of full handshakes
+             */
+            uint32_t GetFullHandshakeCount();
+
+            /**
+             * @brief Get the number of successful TLS handshakes that resumed a previous session
+             *
+             * @return uint32_t - number of resumed handshakes
+             */
+            uint32_t GetResumedHandshakeCount();
+
             /**
              * @brief Check if TLS layer is still connected
              *
@@ -160,6 +387,20 @@ namespace awsiotsdk {
              */
             bool IsPhysicalLayerConnected();
 
+            /**
+             * @brief Check if the connection provides a descriptor that can be waited on
+             *
+             * @return bool - true
+             */
+            bool IsPollable();
+
+            /**
+             * @brief Get the descriptor of the TCP socket
+             *
+             * @return int - socket descriptor, -1 if not connected
+             */
+            int GetPollableDescriptor();
+
             /**
              * @brief sets the path to the root CA
              *
@@ -167,7 +408,10 @@ namespace awsiotsdk {
              *
              * @param root_ca_location
              */
-            void SetRootCAPath(util::String root_ca_location) { root_ca_location_ = root_ca_location; }
+            void SetRootCAPath(util::String root_ca_location) {
+                root_ca_location_ = root_ca_location;
+                ClearSession();
+            }
 
             /**
              * @brief sets the endpoint and the port
@@ -177,6 +421,9 @@ namespace awsiotsdk {
              * @param endpoint_port
              */
             void SetEndpointAndPort(util::String endpoint, uint16_t endpoint_port) {
+                if (endpoint != endpoint_ || endpoint_port != endpoint_port_) {
+                    ClearSession();
+                }
                 endpoint_ = endpoint;
                 endpoint_port_ = endpoint_port;
             }
@@ -32,7 +32,9 @@
 #else
 #include <arpa/inet.h>
 #include <limits>
+#include <poll.h>
 #include <resolv.h>
+#include <sys/stat.h>
 #define MAX_PATH_LENGTH_ PATH_MAX
 #endif
 
@@ -40,6 +42,49 @@
 
 namespace awsiotsdk {
     namespace network {
+        /**
+         * @brief Open the session cache file, creating it readable by the owner only when writing
+         *
+         * @param session_cache_location - Path of the file
+         * @param for_write - True to truncate the file for writing, false to read it
+         * @return FILE* - opened file, nullptr on error
+         */
+        static FILE *OpenSessionCacheFile(const util::String &session_cache_location, bool for_write) {
+            if (!for_write) {
+                return fopen(session_cache_location.c_str(), "r");
+            }
+#ifdef WIN32
+            return fopen(session_cache_location.c_str(), "w");
+#else
+            int fd = open(session_cache_location.c_str(), O_WRONLY | O_CREAT | O_TRUNC, S_IRUSR | S_IWUSR);
+            if (-1 == fd) {
+                return nullptr;
+            }
+            FILE *p_file = fdopen(fd, "w");
+            if (nullptr == p_file) {
+                close(fd);
+            }
+            return p_file;
+#endif
+        }
+
+        /**
+         * @brief Wait for events on a set of sockets, unlike select this works for any descriptor value
+         *
+         * @param p_poll_fds - Sockets and the events to wait for, revents is set on return
+         * @param poll_fd_count - Number of entries in p_poll_fds
+         * @param timeout - Maximum time to wait, rounded up to whole milliseconds
+         * @return int - number of sockets with events, 0 on timeout, -1 on error
+         */
+        static int PollSockets(pollfd *p_poll_fds, size_t poll_fd_count, std::chrono::microseconds timeout) {
+            int timeout_ms = static_cast<int>((timeout.count() + 999) / 1000);
+#ifdef WIN32
+            return WSAPoll(p_poll_fds, static_cast<ULONG>(poll_fd_count), timeout_ms);
+#else
+            return poll(p_poll_fds, static_cast<nfds_t>(poll_fd_count), timeout_ms);
+#endif
+        }
+
         OpenSSLInitializer::~OpenSSLInitializer() {
             CONF_modules_free();
 #if OPENSSL_VERSION_NUMBER >= 0x10002000L && OPENSSL_VERSION_NUMBER < 0x10100000L
@@ -57,6 +102,129 @@ namespace awsiotsdk {
             return &initializer;
         }
 
+        OpenSSLContextCache *OpenSSLContextCache::getInstance() {
+            static OpenSSLContextCache context_cache;
+            return &context_cache;
+        }
+
+        OpenSSLContextCache::FileStamp OpenSSLContextCache::GetFileStamp(const util::String &file_location) {
+            FileStamp file_stamp = {-1, 0, -1, -1};
+            struct stat file_status;
+            if (!file_location.empty() && 0 == stat(file_location.c_str(), &file_status)) {
+                file_stamp.modified_time_ = static_cast<long long>(file_status.st_mtime);
+#if defined(__APPLE__)
+                file_stamp.modified_time_nsec_ = static_cast<long long>(file_status.st_mtimespec.tv_nsec);
+#elif !defined(WIN32)
+                file_stamp.modified_time_nsec_ = static_cast<long long>(file_status.st_mtim.tv_nsec);
+#endif
+                file_stamp.inode_ = static_cast<long long>(file_status.st_ino);
+                file_stamp.size_ = static_cast<long long>(file_status.st_size);
+            }
+            return file_stamp;
+        }
+
+        ResponseCode OpenSSLContextCache::CreateContext(const util::String &root_ca_location,
+                                                        const util::String &device_cert_location,
+                                                        const util::String &device_private_key_location,
+                                                        std::shared_ptr<SSL_CTX> &p_context_out) {
+            const SSL_METHOD *method;
+#if OPENSSL_VERSION_NUMBER >= 0x10002000L && OPENSSL_VERSION_NUMBER < 0x10100000L
+            method = TLSv1_2_method();
+#else
+            method = TLS_method();
+#endif
+
+            SSL_CTX *p_raw_context = SSL_CTX_new(method);
+            if (nullptr == p_raw_context) {
+                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL INIT Failed - Unable to create SSL Context");
+                return ResponseCode::NETWORK_SSL_INIT_ERROR;
+            }
+            std::shared_ptr<SSL_CTX> p_context(p_raw_context, SSL_CTX_free);
+
+            AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Root CA : %s", root_ca_location.c_str());
+            if (!SSL_CTX_load_verify_locations(p_context.get(), root_ca_location.c_str(), NULL)) {
+                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Root CA Loading error");
+                return ResponseCode::NETWORK_SSL_ROOT_CRT_PARSE_ERROR;
+            }
+
+            // TODO: streamline error codes for TLS
+            if (0 < device_cert_location.length() && 0 < device_private_key_location.length()) {
+                AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device crt : %s", device_cert_location.c_str());
+                if (!SSL_CTX_use_certificate_chain_file(p_context.get(), device_cert_location.c_str())) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Device Certificate Loading error");
+                    return ResponseCode::NETWORK_SSL_DEVICE_CRT_PARSE_ERROR;
+                }
+                AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device privkey : %s", device_private_key_location.c_str());
+                if (1 != SSL_CTX_use_PrivateKey_file(p_context.get(),
+                                                     device_private_key_location.c_str(),
+                                                     SSL_FILETYPE_PEM)) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Device Private Key Loading error");
+                    return ResponseCode::NETWORK_SSL_KEY_PARSE_ERROR;
+                }
+            }
+
+            // Sessions are kept by the connections instead of the context cache, see StoreNewSession
+            SSL_CTX_set_session_cache_mode(p_context.get(), SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(p_context.get(), &OpenSSLConnection::StoreNewSession);
+
+            p_context_out = p_context;
+            return ResponseCode::SUCCESS;
+        }
+
+        ResponseCode OpenSSLContextCache::GetContext(const util::String &root_ca_location,
+                                                     const util::String &device_cert_location,
+                                                     const util::String &device_private_key_location,
+                                                     std::shared_ptr<SSL_CTX> &p_context_out) {
+            util::String entry_key = root_ca_location + "\n" + device_cert_location + "\n" + device_private_key_location;
+            ContextEntry context_entry;
+            context_entry.root_ca_stamp_ = GetFileStamp(root_ca_location);
+            context_entry.device_cert_stamp_ = GetFileStamp(device_cert_location);
+            context_entry.device_private_key_stamp_ = GetFileStamp(device_private_key_location);
+
+            std::lock_guard<std::mutex> cache_lock(cache_lock_);
+            std::shared_ptr<SSL_CTX> p_cached_context;
+            util::Map<util::String, ContextEntry>::iterator itr = context_entries_.find(entry_key);
+            if (context_entries_.end() != itr) {
+                p_cached_context = itr->second.p_context_.lock();
+                if (nullptr != p_cached_context && itr->second.root_ca_stamp_ == context_entry.root_ca_stamp_ &&
+                    itr->second.device_cert_stamp_ == context_entry.device_cert_stamp_ &&
+                    itr->second.device_private_key_stamp_ == context_entry.device_private_key_stamp_) {
+                    p_context_out = p_cached_context;
+                    return ResponseCode::SUCCESS;
+                }
+            }
+
+            std::shared_ptr<SSL_CTX> p_context;
+            ResponseCode rc = CreateContext(root_ca_location, device_cert_location, device_private_key_location,
+                                            p_context);
+            if (ResponseCode::SUCCESS != rc) {
+                if (nullptr == p_cached_context) {
+                    return rc;
+                }
+                AWS_LOG_WARN(OPENSSL_WRAPPER_LOG_TAG,
+                             "Unable to reload changed credentials, continuing with the previously loaded ones");
+                p_context_out = p_cached_context;
+                return ResponseCode::SUCCESS;
+            }
+            if (nullptr != p_cached_context) {
+                AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG, "Reloaded changed credentials");
+            }
+
+            // Drop entries of contexts no connection uses anymore
+            for (itr = context_entries_.begin(); context_entries_.end() != itr;) {
+                if (itr->second.p_context_.expired()) {
+                    itr = context_entries_.erase(itr);
+                } else {
+                    itr++;
+                }
+            }
+
+            context_entry.p_context_ = p_context;
+            context_entries_[entry_key] = context_entry;
+            p_context_out = p_context;
+            return ResponseCode::SUCCESS;
+        }
+
         std::atomic_bool OpenSSLConnection::is_lib_initialized(false);
 
         OpenSSLConnection::OpenSSLConnection(util::String endpoint, uint16_t endpoint_port,
@@ -75,11 +243,16 @@ namespace awsiotsdk {
             tls_write_timeout_ = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
 
             is_connected_ = false;
-            certificates_read_flag_ = false;
             initializer = OpenSSLInitializer::getInstance();
             p_ssl_handle_ = nullptr;
             enable_alpn_ = false;
-            address_family_ = AF_INET6;
+
+            p_ssl_session_ = nullptr;
+            enable_session_resumption_ = true;
+            last_handshake_duration_ms_ = -1;
+            last_handshake_resumed_ = false;
+            full_handshake_count_ = 0;
+            resumed_handshake_count_ = 0;
         }
 
         OpenSSLConnection::OpenSSLConnection(util::String endpoint,
@@ -128,17 +301,16 @@ namespace awsiotsdk {
         }
 
         int OpenSSLConnection::WaitForSelect(int error_code) {
-            fd_set socketFds;
-            struct timeval timeout = {tls_write_timeout_.tv_sec, tls_write_timeout_.tv_usec};
-            FD_ZERO(&socketFds);
-            FD_SET(server_tcp_socket_fd_, &socketFds);
+            pollfd socket_poll_fd = {server_tcp_socket_fd_, 0, 0};
+            std::chrono::microseconds timeout(tls_write_timeout_.tv_sec * 1000000LL + tls_write_timeout_.tv_usec);
             if (SSL_ERROR_WANT_READ == error_code) {
-                return select(server_tcp_socket_fd_ + 1, &socketFds, NULL, NULL, &timeout);
+                socket_poll_fd.events = POLLIN;
             } else if (SSL_ERROR_WANT_WRITE == error_code) {
-                return select(server_tcp_socket_fd_ + 1, NULL, &socketFds, NULL, &timeout);
+                socket_poll_fd.events = POLLOUT;
             } else {
                 return 0;
             }
+            return PollSockets(&socket_poll_fd, 1, timeout);
         }
 
         ResponseCode OpenSSLConnection::Initialize() {
@@ -176,24 +348,102 @@ namespace awsiotsdk {
 #endif
                 is_lib_initialized = true;
             }
-            const SSL_METHOD *method;
-
             if (SSL_library_init() < 0) {
                 return ResponseCode::NETWORK_SSL_INIT_ERROR;
             }
 
-#if OPENSSL_VERSION_NUMBER >= 0x10002000L && OPENSSL_VERSION_NUMBER < 0x10100000L
-            method = TLSv1_2_method();
-#else
-            method = TLS_method();
-#endif
+            // The SSL context is created with the credentials on connect, see LoadCerts
+            return ResponseCode::SUCCESS;
+        }
 
-            if ((p_ssl_context_ = SSL_CTX_new(method)) == NULL) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " SSL INIT Failed - Unable to create SSL Context");
-                return ResponseCode::NETWORK_SSL_INIT_ERROR;
+        int OpenSSLConnection::StoreNewSession(SSL *p_ssl_handle, SSL_SESSION *p_session) {
+            OpenSSLConnection *p_connection = static_cast<OpenSSLConnection *>(SSL_get_app_data(p_ssl_handle));
+            if (nullptr == p_connection) {
+                return 0;
             }
 
-            return ResponseCode::SUCCESS;
+            std::lock_guard<std::mutex> session_lock(p_connection->ssl_session_lock_);
+            if (!p_connection->enable_session_resumption_) {
+                return 0;
+            }
+            if (nullptr != p_connection->p_ssl_session_) {
+                SSL_SESSION_free(p_connection->p_ssl_session_);
+            }
+            // Returning 1 hands the reference to the session over to the connection
+            p_connection->p_ssl_session_ = p_session;
+            p_connection->PersistSession();
+            return 1;
+        }
+
+        void OpenSSLConnection::LoadPersistedSession() {
+            if (session_cache_location_.empty()) {
+                return;
+            }
+            FILE *p_file = OpenSessionCacheFile(session_cache_location_, false);
+            if (nullptr == p_file) {
+                return;
+            }
+            p_ssl_session_ = PEM_read_SSL_SESSION(p_file, nullptr, nullptr, nullptr);
+            fclose(p_file);
+            if (nullptr == p_ssl_session_) {
+                AWS_LOG_WARN(OPENSSL_WRAPPER_LOG_TAG, "Unable to read TLS session from %s",
+                             session_cache_location_.c_str());
+            }
+        }
+
+        void OpenSSLConnection::PersistSession() {
+            if (session_cache_location_.empty() || nullptr == p_ssl_session_) {
+                return;
+            }
+            FILE *p_file = OpenSessionCacheFile(session_cache_location_, true);
+            if (nullptr == p_file || 1 != PEM_write_SSL_SESSION(p_file, p_ssl_session_)) {
+                AWS_LOG_WARN(OPENSSL_WRAPPER_LOG_TAG, "Unable to persist TLS session to %s",
+                             session_cache_location_.c_str());
+            }
+            if (nullptr != p_file) {
+                fclose(p_file);
+            }
+        }
+
+        void OpenSSLConnection::ClearSession() {
+            std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+            if (nullptr != p_ssl_session_) {
+                SSL_SESSION_free(p_ssl_session_);
+                p_ssl_session_ = nullptr;
+            }
+            if (!session_cache_location_.empty()) {
+                remove(session_cache_location_.c_str());
+            }
+        }
+
+        void OpenSSLConnection::SetSessionResumption(bool enable_session_resumption) {
+            if (!enable_session_resumption) {
+                ClearSession();
+            }
+            std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+            enable_session_resumption_ = enable_session_resumption;
+        }
+
+        void OpenSSLConnection::SetSessionCacheLocation(util::String session_cache_location) {
+            std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+            session_cache_location_ = session_cache_location;
+            PersistSession();
+        }
+
+        std::chrono::milliseconds OpenSSLConnection::GetLastHandshakeDuration() {
+            return std::chrono::milliseconds(last_handshake_duration_ms_);
+        }
+
+        bool OpenSSLConnection::WasLastHandshakeResumed() {
+            return last_handshake_resumed_;
+        }
+
+        uint32_t OpenSSLConnection::GetFullHandshakeCount() {
+            return full_handshake_count_;
+        }
+
+        uint32_t OpenSSLConnection::GetResumedHandshakeCount() {
+            return resumed_handshake_count_;
         }
 
         bool OpenSSLConnection::IsPhysicalLayerConnected() {
@@ -205,104 +455,190 @@ namespace awsiotsdk {
             return is_connected_;
         }
 
-        ResponseCode OpenSSLConnection::ConnectTCPSocket() {
-            const char *endpoint_char = endpoint_.c_str();
-            if (nullptr == endpoint_char) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "Hostname was null or empty.");
-                return ResponseCode::NETWORK_TCP_NO_ENDPOINT_SPECIFIED;
+        bool OpenSSLConnection::IsPollable() {
+            return true;
+        }
+
+        int OpenSSLConnection::GetPollableDescriptor() {
+            return is_connected_ ? server_tcp_socket_fd_ : -1;
+        }
+
+        int OpenSSLConnection::StartTCPConnect(const OpenSSLResolverCache::ResolvedAddress &address,
+                                               bool &is_connected_out) {
+            is_connected_out = false;
+            sockaddr_storage dest_addr = address.address_;
+            void *address_pointer = nullptr;
+            if (AF_INET6 == dest_addr.ss_family) {
+                reinterpret_cast<sockaddr_in6 *>(&dest_addr)->sin6_port = htons(endpoint_port_);
+                address_pointer = &reinterpret_cast<sockaddr_in6 *>(&dest_addr)->sin6_addr;
+            } else {
+                reinterpret_cast<sockaddr_in *>(&dest_addr)->sin_port = htons(endpoint_port_);
+                address_pointer = &reinterpret_cast<sockaddr_in *>(&dest_addr)->sin_addr;
             }
 
-#ifndef WIN32
-            if (res_init() == -1) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "DNS initialize error");
+            char straddr[INET6_ADDRSTRLEN];
+            inet_ntop(dest_addr.ss_family, address_pointer, straddr, sizeof(straddr));
+            AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG, "resolved %s to %s", endpoint_.c_str(), straddr);
+
+            int socket_fd = (int) socket(dest_addr.ss_family, SOCK_STREAM, 0);
+            if (-1 == socket_fd) {
+                return -1;
             }
+            if (ResponseCode::SUCCESS != SetSocketToNonBlocking(socket_fd)) {
+#ifdef WIN32
+                closesocket(socket_fd);
+#else
+                close(socket_fd);
 #endif
+                return -1;
+            }
 
-            sockaddr_in dest_addr{};
-            sockaddr_in6 dest_addr6{};
-            void *addressPointer = nullptr;
-
-            if (address_family_ == AF_INET6) {
-                memset(&dest_addr6, 0, sizeof(struct sockaddr_in6));
-                dest_addr6.sin6_family = AF_INET6;
-                dest_addr6.sin6_port = htons(endpoint_port_);
-            } else {
-                memset(&(dest_addr.sin_zero), '\0', 8);
-                dest_addr.sin_family = AF_INET;
-                dest_addr.sin_port = htons(endpoint_port_);
+            if (0 == connect(socket_fd, reinterpret_cast<sockaddr *>(&dest_addr), address.address_length_)) {
+                is_connected_out = true;
+                return socket_fd;
+            }
+#ifdef WIN32
+            if (WSAEWOULDBLOCK == WSAGetLastError()) {
+                return socket_fd;
             }
+            closesocket(socket_fd);
+#else
+            if (EINPROGRESS == errno) {
+                return socket_fd;
+            }
+            AWS_LOG_WARN(OPENSSL_WRAPPER_LOG_TAG, "connect to %s - %s", straddr, strerror(errno));
+            close(socket_fd);
+#endif
+            return -1;
+        }
 
-            //gethostbyname is not to be used anymore.
-            struct addrinfo hints{}, *result_add, *iterator;
-            memset(&hints, 0, sizeof(hints));
+        ResponseCode OpenSSLConnection::ConnectTCPSocket() {
+            if (endpoint_.empty()) {
+                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "Hostname was null or empty.");
+                return ResponseCode::NETWORK_TCP_NO_ENDPOINT_SPECIFIED;
+            }
 
-            hints.ai_family = address_family_;
+            std::chrono::milliseconds connect_timeout(tls_handshake_timeout_.tv_sec * 1000 +
+                                                      tls_handshake_timeout_.tv_usec / 1000);
+            std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() + connect_timeout;
 
-            int error = getaddrinfo(endpoint_char, nullptr, &hints, &result_add);
-            if ((error != 0) || (result_add == nullptr)) {
-                // found no ip address for the server
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "Error resolving hostname: %i", error);
-                return ResponseCode::NETWORK_TCP_UNKNOWN_HOST;
+            util::Vector<OpenSSLResolverCache::ResolvedAddress> addresses;
+            ResponseCode rc = OpenSSLResolverCache::getInstance()->Resolve(endpoint_, connect_timeout, addresses);
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
             }
 
-            // getaddrinfo can return multiple ip addresses.
-            iterator = result_add;
-            int connect_status;
-            do {
-                // init structs for address data
-                socklen_t socketLength;
-                sockaddr *sock_addr;
-                // add the address to the service used.
-                if (address_family_ == AF_INET6) {
-                    dest_addr6.sin6_addr = ((struct sockaddr_in6 *) (iterator->ai_addr))->sin6_addr;
-                    sock_addr = reinterpret_cast<sockaddr *>(&dest_addr6);
-                    socketLength = sizeof(dest_addr6);
-                    addressPointer = &dest_addr6.sin6_addr;
-                } else {
-                    dest_addr.sin_addr.s_addr =
-                            ((struct sockaddr_in *) (iterator->ai_addr))->sin_addr.s_addr;//set ip address
-                    sock_addr = reinterpret_cast<sockaddr *>(&dest_addr);
-                    socketLength = sizeof(dest_addr);
-                    addressPointer = &dest_addr.sin_addr;
+            // Attempts are started one after another but stay open, the first to connect wins
+            util::Vector<int> pending_socket_fds;
+            size_t next_address_index = 0;
+            std::chrono::steady_clock::time_point next_attempt_time = std::chrono::steady_clock::now();
+            int connected_socket_fd = -1;
+            while (-1 == connected_socket_fd) {
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "connect - timed out");
+                    break;
                 }
 
-                char straddr[INET6_ADDRSTRLEN];
-                inet_ntop(address_family_, addressPointer, straddr, sizeof(straddr));
-                AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG, "resolved %s to %s", endpoint_.c_str(), straddr);
+                if (addresses.size() > next_address_index && (now >= next_attempt_time || pending_socket_fds.empty())) {
+                    bool is_connected = false;
+                    int socket_fd = StartTCPConnect(addresses[next_address_index], is_connected);
+                    next_address_index++;
+                    next_attempt_time = now + std::chrono::milliseconds(OPENSSL_CONNECTION_ATTEMPT_DELAY_MS);
+                    if (is_connected) {
+                        connected_socket_fd = socket_fd;
+                    } else if (-1 != socket_fd) {
+                        pending_socket_fds.push_back(socket_fd);
+                    }
+                    continue;
+                }
+                if (pending_socket_fds.empty()) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "connect - no address could be connected to");
+                    break;
+                }
 
-                connect_status = connect(server_tcp_socket_fd_, sock_addr, socketLength);
+                // Wait for an attempt to finish, or until the next attempt is due
+                std::chrono::steady_clock::time_point wait_until = deadline;
+                if (addresses.size() > next_address_index && next_attempt_time < wait_until) {
+                    wait_until = next_attempt_time;
+                }
+                std::chrono::microseconds wait_time =
+                    std::chrono::duration_cast<std::chrono::microseconds>(wait_until - now);
+
+                // Failed attempts report POLLERR or POLLHUP, which are always returned
+                util::Vector<pollfd> poll_fds;
+                for (int socket_fd : pending_socket_fds) {
+                    pollfd socket_poll_fd = {socket_fd, POLLOUT, 0};
+                    poll_fds.push_back(socket_poll_fd);
+                }
+                int poll_retCode = PollSockets(poll_fds.data(), poll_fds.size(), wait_time);
+                if (-1 == poll_retCode) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "connect poll - %s", strerror(errno));
+                    break;
+                }
 
-                iterator = iterator->ai_next; //next value in address array
-            } while (connect_status == -1 && iterator != nullptr);
+                size_t poll_fd_index = 0;
+                for (util::Vector<int>::iterator itr = pending_socket_fds.begin(); pending_socket_fds.end() != itr;
+                     poll_fd_index++) {
+                    if (0 == poll_fds[poll_fd_index].revents) {
+                        itr++;
+                        continue;
+                    }
+                    int socket_error = 0;
+                    socklen_t socket_error_length = sizeof(socket_error);
+                    if (0 == getsockopt(*itr, SOL_SOCKET, SO_ERROR, (char *) &socket_error, &socket_error_length) &&
+                        0 == socket_error) {
+                        connected_socket_fd = *itr;
+                    } else {
+                        AWS_LOG_WARN(OPENSSL_WRAPPER_LOG_TAG, "connect - %s", strerror(socket_error));
+#ifdef WIN32
+                        closesocket(*itr);
+#else
+                        close(*itr);
+#endif
+                    }
+                    itr = pending_socket_fds.erase(itr);
+                    if (-1 != connected_socket_fd) {
+                        break;
+                    }
+                }
+            }
 
-            // free address info
-            freeaddrinfo(result_add);
+            for (int socket_fd : pending_socket_fds) {
+#ifdef WIN32
+                closesocket(socket_fd);
+#else
+                close(socket_fd);
+#endif
+            }
 
-            if (-1 != connect_status) {
-                return ResponseCode::SUCCESS;
+            if (-1 == connected_socket_fd) {
+                // The addresses may be stale after a network change
+                OpenSSLResolverCache::getInstance()->Expire(endpoint_);
+                return ResponseCode::NETWORK_TCP_CONNECT_ERROR;
             }
-            AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "connect - %s", strerror(errno));
-            return ResponseCode::NETWORK_TCP_CONNECT_ERROR;
+            server_tcp_socket_fd_ = connected_socket_fd;
+            return ResponseCode::SUCCESS;
         }
 
-        ResponseCode OpenSSLConnection::SetSocketToNonBlocking() {
+        ResponseCode OpenSSLConnection::SetSocketToNonBlocking(int socket_fd) {
             int status;
             ResponseCode ret_val = ResponseCode::SUCCESS;
 #if defined(WIN32) || defined(WIN64)
             u_long flag = 1L;
-            status = ioctlsocket(server_tcp_socket_fd_, FIONBIO, &flag);
+            status = ioctlsocket(socket_fd, FIONBIO, &flag);
             if (0 > status) {
                 AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "ioctlsocket - %s", strerror(errno));
                 ret_val = ResponseCode::NETWORK_TCP_CONNECT_ERROR;
             }
 #else
-            int flags = fcntl(server_tcp_socket_fd_, F_GETFL, 0);
+            int flags = fcntl(socket_fd, F_GETFL, 0);
             // set underlying socket to non blocking
             if (0 > flags) {
                 ret_val = ResponseCode::NETWORK_TCP_CONNECT_ERROR;
             }
 
-            status = fcntl(server_tcp_socket_fd_, F_SETFL, flags | O_NONBLOCK);
+            status = fcntl(socket_fd, F_SETFL, flags | O_NONBLOCK);
             if (0 > status) {
                 AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "fcntl - %s", strerror(errno));
                 ret_val = ResponseCode::NETWORK_TCP_CONNECT_ERROR;
@@ -360,29 +696,18 @@ namespace awsiotsdk {
         }
 
         ResponseCode OpenSSLConnection::LoadCerts() {
-            AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Root CA : %s", root_ca_location_.c_str());
-            if (!SSL_CTX_load_verify_locations(p_ssl_context_, root_ca_location_.c_str(), NULL)) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Root CA Loading error");
-                return ResponseCode::NETWORK_SSL_ROOT_CRT_PARSE_ERROR;
+            std::shared_ptr<SSL_CTX> p_context;
+            ResponseCode rc = OpenSSLContextCache::getInstance()->GetContext(root_ca_location_, device_cert_location_,
+                                                                             device_private_key_location_, p_context);
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
             }
 
-            // TODO: streamline error codes for TLS
-            if (0 < device_cert_location_.length() && 0 < device_private_key_location_.length()) {
-                AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device crt : %s", device_cert_location_.c_str());
-                if (!SSL_CTX_use_certificate_chain_file(p_ssl_context_, device_cert_location_.c_str())) {
-                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Device Certificate Loading error");
-                    return ResponseCode::NETWORK_SSL_DEVICE_CRT_PARSE_ERROR;
-                }
-                AWS_LOG_DEBUG(OPENSSL_WRAPPER_LOG_TAG, "Device privkey : %s", device_private_key_location_.c_str());
-                if (1 != SSL_CTX_use_PrivateKey_file(p_ssl_context_,
-                                                     device_private_key_location_.c_str(),
-                                                     SSL_FILETYPE_PEM)) {
-                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Device Private Key Loading error");
-                    return ResponseCode::NETWORK_SSL_KEY_PARSE_ERROR;
-                }
+            if (nullptr != p_ssl_context_ && p_context != p_ssl_context_) {
+                // A session is bound to the credentials it was established with
+                ClearSession();
             }
-
-            certificates_read_flag_ = true;
+            p_ssl_context_ = p_context;
             return ResponseCode::SUCCESS;
         }
 
@@ -392,43 +717,30 @@ namespace awsiotsdk {
             // Configure a non-zero callback if desired
             SSL_set_verify(p_ssl_handle_, SSL_VERIFY_PEER, nullptr);
 
-            server_tcp_socket_fd_ = (int)socket(address_family_, SOCK_STREAM, 0);
-            if (-1 == server_tcp_socket_fd_) {
-                return ResponseCode::NETWORK_TCP_SETUP_ERROR;
-            }
-
+            // The socket is connected in non-blocking mode
             networkResponse = ConnectTCPSocket();
             if (ResponseCode::SUCCESS != networkResponse) {
                 AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, "TCP Connection error");
-#ifdef WIN32
-                closesocket(server_tcp_socket_fd_);
-#else
-                close(server_tcp_socket_fd_);
-#endif
                 return networkResponse;
             }
 
             SSL_set_fd(p_ssl_handle_, server_tcp_socket_fd_);
 
-            networkResponse = SetSocketToNonBlocking();
-            if (ResponseCode::SUCCESS != networkResponse) {
-                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Unable to set the socket to Non-Blocking");
+            std::chrono::steady_clock::time_point handshake_start = std::chrono::steady_clock::now();
+            networkResponse = AttemptConnect();
+            if (X509_V_OK != SSL_get_verify_result(p_ssl_handle_)) {
+                AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Server Certificate Verification failed.");
+                networkResponse = ResponseCode::NETWORK_SSL_CONNECT_ERROR;
             } else {
-                networkResponse = AttemptConnect();
-                if (X509_V_OK != SSL_get_verify_result(p_ssl_handle_)) {
-                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " Server Certificate Verification failed.");
+                // ensure you have a valid certificate returned, otherwise no certificate exchange happened
+                auto cert_destroyer = [](X509 *cert) {
+                    if (nullptr != cert) X509_free(cert);
+                };
+                std::unique_ptr<X509, decltype(cert_destroyer)> cert(SSL_get_peer_certificate(p_ssl_handle_),
+                                                                     cert_destroyer);
+                if (nullptr == cert) {
+                    AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " No certificate exchange happened");
                     networkResponse = ResponseCode::NETWORK_SSL_CONNECT_ERROR;
-                } else {
-                    // ensure you have a valid certificate returned, otherwise no certificate exchange happened
-                    auto cert_destroyer = [](X509 *cert) {
-                        if (nullptr != cert) X509_free(cert);
-                    };
-                    std::unique_ptr<X509, decltype(cert_destroyer)> cert(SSL_get_peer_certificate(p_ssl_handle_),
-                                                                         cert_destroyer);
-                    if (nullptr == cert) {
-                        AWS_LOG_ERROR(OPENSSL_WRAPPER_LOG_TAG, " No certificate exchange happened");
-                        networkResponse = ResponseCode::NETWORK_SSL_CONNECT_ERROR;
-                    }
                 }
             }
 
@@ -438,6 +750,19 @@ namespace awsiotsdk {
 #else
                 close(server_tcp_socket_fd_);
 #endif
+            } else {
+                std::chrono::milliseconds handshake_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - handshake_start);
+                bool is_resumed = (1 == SSL_session_reused(p_ssl_handle_));
+                last_handshake_duration_ms_ = handshake_duration.count();
+                last_handshake_resumed_ = is_resumed;
+                if (is_resumed) {
+                    resumed_handshake_count_++;
+                } else {
+                    full_handshake_count_++;
+                }
+                AWS_LOG_INFO(OPENSSL_WRAPPER_LOG_TAG, "TLS handshake completed in %lld ms, session %s",
+                             static_cast<long long>(handshake_duration.count()), is_resumed ? "resumed" : "new");
             }
 
             return networkResponse;
@@ -452,15 +777,35 @@ namespace awsiotsdk {
 
             X509_VERIFY_PARAM *param = nullptr;
 
-            if (!certificates_read_flag_) {
-                networkResponse = LoadCerts();
-                if (ResponseCode::SUCCESS != networkResponse) {
-                    return networkResponse;
-                }
+            // Cheap while the credential files are unchanged, picks up rotated credentials on reconnect
+            networkResponse = LoadCerts();
+            if (ResponseCode::SUCCESS != networkResponse) {
+                return networkResponse;
             }
 
             if (nullptr == p_ssl_handle_) {
-                p_ssl_handle_ = SSL_new(p_ssl_context_);
+                p_ssl_handle_ = SSL_new(p_ssl_context_.get());
+            }
+            SSL_set_app_data(p_ssl_handle_, this);
+
+            bool is_session_offered = false;
+            {
+                std::lock_guard<std::mutex> session_lock(ssl_session_lock_);
+                if (enable_session_resumption_) {
+                    if (nullptr == p_ssl_session_) {
+                        LoadPersistedSession();
+                    }
+                    if (nullptr != p_ssl_session_ &&
+                        SSL_SESSION_get_time(p_ssl_session_) + SSL_SESSION_get_timeout(p_ssl_session_) <
+                            static_cast<long>(time(nullptr))) {
+                        // Expired sessions are not offered, the server would reject them anyway
+                        SSL_SESSION_free(p_ssl_session_);
+                        p_ssl_session_ = nullptr;
+                    }
+                    if (nullptr != p_ssl_session_) {
+                        is_session_offered = (1 == SSL_set_session(p_ssl_handle_, p_ssl_session_));
+                    }
+                }
             }
 
             // Requires OpenSSL v1.0.2 and above
@@ -487,16 +832,16 @@ namespace awsiotsdk {
                 }
             }
 
+            // Both address families are tried while connecting the TCP socket
             networkResponse = PerformSSLConnect();
-            if (ResponseCode::SUCCESS != networkResponse && address_family_ == AF_INET6) {
-                // IPv6 connection unsucessful retry with IPv4
-                address_family_ = AF_INET;
-                networkResponse = PerformSSLConnect();
-            }
 
             if (ResponseCode::SUCCESS != networkResponse) {
                 SSL_free(p_ssl_handle_);
                 p_ssl_handle_ = nullptr;
+                if (is_session_offered && ResponseCode::NETWORK_SSL_CONNECT_ERROR == networkResponse) {
+                    // Do not offer a session the handshake failed with again
+                    ClearSession();
+                }
             }
 
             if (ResponseCode::SUCCESS == networkResponse) {
@@ -598,6 +943,80 @@ namespace awsiotsdk {
             return errorStatus;
         }
 
+        ResponseCode OpenSSLConnection::ReadAvailableInternal(util::Vector<unsigned char> &buf,
+                                                              size_t buf_read_offset,
+                                                              size_t min_bytes_to_read,
+                                                              size_t max_bytes_to_read,
+                                                              size_t &size_read_bytes_out) {
+            int ssl_retcode;
+            int select_retCode;
+            int cur_read_len = 0;
+            ResponseCode errorStatus = ResponseCode::SUCCESS;
+
+            size_read_bytes_out = 0;
+            while (is_connected_ && size_read_bytes_out < max_bytes_to_read) {
+                ERR_clear_error();
+                if (nullptr == p_ssl_handle_) {
+                    return ResponseCode::NETWORK_SSL_READ_ERROR;
+                }
+                cur_read_len = SSL_read(p_ssl_handle_, &buf[buf_read_offset + size_read_bytes_out],
+                                        (int) (max_bytes_to_read - size_read_bytes_out));
+                if (0 < cur_read_len) {
+                    size_read_bytes_out += (size_t) cur_read_len;
+                    continue;
+                }
+
+                ssl_retcode = SSL_get_error(p_ssl_handle_, cur_read_len);
+                if (SSL_ERROR_WANT_READ == ssl_retcode) {
+                    if (size_read_bytes_out >= min_bytes_to_read) {
+                        // Everything the socket had available has been read
+                        break;
+                    }
+                    select_retCode = WaitForSelect(SSL_ERROR_WANT_READ);
+                    if (0 < select_retCode) {
+                        continue;
+                    } else if (0 == select_retCode) { //0 == SELECT_TIMEOUT
+                        errorStatus = ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
+                    } else { // SELECT_ERROR
+                        errorStatus = ResponseCode::NETWORK_SSL_READ_ERROR;
+                    }
+                } else if (SSL_ERROR_ZERO_RETURN == ssl_retcode) {
+                    errorStatus = ResponseCode::NETWORK_SSL_CONNECTION_CLOSED_ERROR;
+                } else {
+                    errorStatus = ResponseCode::NETWORK_SSL_READ_ERROR;
+                }
+                break;
+            }
+
+            // Bytes read before the timeout are returned, the caller keeps them until the rest arrives
+            if (ResponseCode::NETWORK_SSL_NOTHING_TO_READ == errorStatus && 0 < size_read_bytes_out) {
+                errorStatus = ResponseCode::SUCCESS;
+            }
+
+            return errorStatus;
+        }
+
+        ResponseCode OpenSSLConnection::WaitForReadableInternal(std::chrono::milliseconds timeout) {
+            if (nullptr == p_ssl_handle_) {
+                return ResponseCode::NETWORK_SSL_READ_ERROR;
+            }
+
+            // Data that was already received and decrypted does not show up on the socket
+            if (0 < SSL_pending(p_ssl_handle_)) {
+                return ResponseCode::SUCCESS;
+            }
+
+            pollfd socket_poll_fd = {server_tcp_socket_fd_, POLLIN, 0};
+            int poll_retCode = PollSockets(&socket_poll_fd, 1, timeout);
+            if (0 < poll_retCode) {
+                return ResponseCode::SUCCESS;
+            } else if (0 == poll_retCode) {
+                return ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
+            }
+
+            return ResponseCode::NETWORK_SSL_READ_ERROR;
+        }
+
         ResponseCode OpenSSLConnection::DisconnectInternal() {
             if (!is_connected_) {
                 return ResponseCode::SUCCESS;
@@ -629,7 +1048,6 @@ namespace awsiotsdk {
             ERR_remove_thread_state(NULL);
 #endif
 
-            certificates_read_flag_ = false;
 #ifdef WIN32
             closesocket(server_tcp_socket_fd_);
 #else
@@ -642,7 +1060,9 @@ namespace awsiotsdk {
             if (is_connected_) {
                 Disconnect();
             }
-            SSL_CTX_free(p_ssl_context_);
+            if (nullptr != p_ssl_session_) {
+                SSL_SESSION_free(p_ssl_session_);
+            }
 #ifdef WIN32
             WSACleanup();
 #endif
@@ -45,9 +45,18 @@
 #include <openssl/x509_vfy.h>
 #include <string.h>
 
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/Vector.hpp"
+
 #include "NetworkConnection.hpp"
+#include "OpenSSLResolverCache.hpp"
 #include "ResponseCode.hpp"
 
+/**
+ * Delay before connecting to the next address while earlier attempts are still pending, see RFC 8305
+ */
+#define OPENSSL_CONNECTION_ATTEMPT_DELAY_MS 250
+
 namespace awsiotsdk {
     namespace network {
         /**
@@ -76,12 +85,97 @@ namespace awsiotsdk {
 
         };
 
+        /**
+         * @brief Shared cache of SSL contexts with loaded credentials
+         *
+         * Connections using the same root CA, device certificate and private key files share one SSL context, so
+         * reconnects and additional connections do not read and parse the files again. The files are checked for
+         * changes whenever a context is requested, and a new context is loaded if they were modified. Connections
+         * keep using the context they connected with until they reconnect.
+         */
+        class OpenSSLContextCache {
+        protected:
+            /**
+             * @brief Modification time, inode and size of a credential file, used to detect changes
+             */
+            struct FileStamp {
+                long long modified_time_;                  ///< Last modification time in seconds, -1 if the file does not exist
+                long long modified_time_nsec_;             ///< Nanosecond part of the modification time, 0 where not available
+                long long inode_;                          ///< Inode of the file, changes when the file is replaced, -1 if the file does not exist
+                long long size_;                           ///< File size in bytes, -1 if the file does not exist
+
+                bool operator==(const FileStamp &other) const {
+                    return modified_time_ == other.modified_time_ && modified_time_nsec_ == other.modified_time_nsec_
+                        && inode_ == other.inode_ && size_ == other.size_;
+                }
+            };
+
+            /**
+             * @brief Cached context and the state of the files it was loaded from
+             */
+            struct ContextEntry {
+                std::weak_ptr<SSL_CTX> p_context_;         ///< Context, expires once no connection uses it
+                FileStamp root_ca_stamp_;                  ///< Root CA file the context was loaded from
+                FileStamp device_cert_stamp_;              ///< Device certificate file the context was loaded from
+                FileStamp device_private_key_stamp_;       ///< Private key file the context was loaded from
+            };
+
+            std::mutex cache_lock_;                        ///< Guards the entries, also serializes loading contexts
+            util::Map<util::String, ContextEntry> context_entries_;    ///< Entries keyed by the credential file paths
+
+            OpenSSLContextCache() = default;
+
+            /**
+             * @brief Get the modification time and size of a file
+             *
+             * @param file_location - Path of the file
+             * @return FileStamp - stamp of the file, all -1 if it does not exist
+             */
+            static FileStamp GetFileStamp(const util::String &file_location);
+
+            /**
+             * @brief Create an SSL context and load the credentials into it
+             *
+             * @param root_ca_location - Path of the root CA file
+             * @param device_cert_location - Path of the device certificate chain file, can be empty
+             * @param device_private_key_location - Path of the device private key file, can be empty
+             * @param p_context_out - Created context
+             * @return ResponseCode - SUCCESS or the TLS error for the credential that could not be loaded
+             */
+            static ResponseCode CreateContext(const util::String &root_ca_location,
+                                              const util::String &device_cert_location,
+                                              const util::String &device_private_key_location,
+                                              std::shared_ptr<SSL_CTX> &p_context_out);
+
+        public:
+            static OpenSSLContextCache *getInstance();
+
+            /**
+             * @brief Get the SSL context for a set of credential files
+             *
+             * Returns the cached context if the files did not change since it was loaded. Otherwise loads a new one.
+             * If reloading changed files fails, for example because a file is only partially written, the previous
+             * context is returned and the files are checked again on the next call.
+             *
+             * @param root_ca_location - Path of the root CA file
+             * @param device_cert_location - Path of the device certificate chain file, can be empty
+             * @param device_private_key_location - Path of the device private key file, can be empty
+             * @param p_context_out - Context for the credentials
+             * @return ResponseCode - SUCCESS or the TLS error for the credential that could not be loaded
+             */
+            ResponseCode GetContext(const util::String &root_ca_location, const util::String &device_cert_location,
+                                    const util::String &device_private_key_location,
+                                    std::shared_ptr<SSL_CTX> &p_context_out);
+        };
+
         /**
          * @brief OpenSSL Wrapper Class
          *
          * Defines a reference wrapper for OpenSSL libraries
          */
         class OpenSSLConnection : public NetworkConnection {
+            friend class OpenSSLContextCache;
+
         protected:
             static std::atomic_bool is_lib_initialized; ///< Boolean, True = Library is initialized, False otherwise
             OpenSSLInitializer *initializer;            ///< Pointer to dummy library instance
@@ -98,39 +192,94 @@ namespace awsiotsdk {
             uint16_t endpoint_port_;                    ///< Endpoint port
             util::String endpoint_;                     ///< Endpoint for this connection
 
-            SSL_CTX *p_ssl_context_;                    ///< SSL Context instance
+            std::shared_ptr<SSL_CTX> p_ssl_context_;    ///< SSL Context instance, shared through OpenSSLContextCache
             SSL *p_ssl_handle_;                         ///< SSL Handle
             int server_tcp_socket_fd_;                  ///< Server Socket descriptor
 
-            bool certificates_read_flag_;
             bool enable_alpn_;
 
-            int address_family_;                       ///< Should be AF_INET or AF_INET6
-
             std::mutex clean_shutdown_action_lock_;
             std::condition_variable shutdown_timeout_condition_;
 
+            // Session resumption
+            SSL_SESSION *p_ssl_session_;                ///< Session offered for resumption on the next connect, nullptr if none
+            std::mutex ssl_session_lock_;               ///< Guards the session, new tickets can arrive while reading
+            bool enable_session_resumption_;            ///< Boolean, True = resume the previous TLS session on reconnect
+            util::String session_cache_location_;       ///< Optional path of the file the session is persisted to
+
+            // Handshake metrics
+            std::atomic<std::chrono::milliseconds::rep> last_handshake_duration_ms_; ///< Duration of the last successful handshake
+            std::atomic_bool last_handshake_resumed_;       ///< Boolean, True = the last successful handshake resumed a session
+            std::atomic<uint32_t> full_handshake_count_;    ///< Number of successful full handshakes
+            std::atomic<uint32_t> resumed_handshake_count_; ///< Number of successful resumed handshakes
+
+            /**
+             * @brief Store a session received from the server
+             *
+             * Registered as the new session callback of the SSL context. Called during the handshake for TLS 1.2 and
+             * when a session ticket is read after the handshake for TLS 1.3.
+             *
+             * @param p_ssl_handle - SSL handle the session was received on
+             * @param p_session - Received session
+             * @return int - 1 if the session was kept, 0 otherwise
+             */
+            static int StoreNewSession(SSL *p_ssl_handle, SSL_SESSION *p_session);
+
+            /**
+             * @brief Read the persisted session, if there is one
+             *
+             * Must be called with the session lock held
+             */
+            void LoadPersistedSession();
+
+            /**
+             * @brief Write the current session to the session cache location, if one is set
+             *
+             * Must be called with the session lock held
+             */
+            void PersistSession();
+
+            /**
+             * @brief Forget the current session, including its persisted copy
+             *
+             * Used when the session can no longer be resumed, like after changing the endpoint
+             */
+            void ClearSession();
+
             /**
              * @brief Wait for socket FDs to become ready for read or write operations
              *
              * It is assumed that this function will be called only on SSL_ERROR_WANT_READ or SSL_ERROR_WANT_WRITE
              *
              * @param error_code - error generated by preceding socket operation
-             * @return int - return code of the select operation
+             * @return int - return code of the poll operation
              */
             int WaitForSelect(int error_code);
 
             /**
-             * @brief Set TLS socket to non-blocking mode
+             * @brief Set a socket to non-blocking mode
              *
+             * @param socket_fd - descriptor of the socket
              * @return ResponseCode - successful operation or TLS error
              */
-            ResponseCode SetSocketToNonBlocking();
+            ResponseCode SetSocketToNonBlocking(int socket_fd);
+
+            /**
+             * @brief Start a non-blocking connect to an address
+             *
+             * @param address - address to connect to
+             * @param is_connected_out - set to true if the connection was established immediately
+             * @return int - descriptor of the connecting socket, -1 if the attempt failed
+             */
+            int StartTCPConnect(const OpenSSLResolverCache::ResolvedAddress &address, bool &is_connected_out);
 
             /**
              * @brief Create a TCP socket and open the connection
              *
-             * Creates an open socket connection
+             * Resolves the endpoint through the shared resolver cache and races connections to its addresses. The
+             * next address is tried after OPENSSL_CONNECTION_ATTEMPT_DELAY_MS or as soon as an attempt fails,
+             * without cancelling pending attempts. The first established connection is used. Resolving and
+             * connecting together are bounded by the TLS handshake timeout.
              *
              * @return ResponseCode - successful connection or TCP error
              */
@@ -146,11 +295,11 @@ namespace awsiotsdk {
             ResponseCode AttemptConnect();
 
             /**
-             * @brief Create a TLS socket and open the connection
+             * @brief Get the SSL context for the configured credentials
              *
-             * Creates an open socket connection including TLS handshake.
+             * Uses the shared context cache, the credential files are only read when they changed.
              *
-             * @return ResponseCode - successful connection or TLS error
+             * @return ResponseCode - successful load or TLS error
              */
             ResponseCode LoadCerts();
 
@@ -192,6 +341,31 @@ namespace awsiotsdk {
             ResponseCode ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                       size_t size_bytes_to_read, size_t &size_read_bytes_out);
 
+            /**
+             * @brief Read available bytes from the network socket
+             *
+             * Waits for min_bytes_to_read bytes and returns all decrypted data up to max_bytes_to_read
+             *
+             * @param util::Vector<unsigned char> - reference to buffer where read bytes should be copied
+             * @param size_t - offset in the buffer where read bytes should be copied
+             * @param size_t - minimum number of bytes to read
+             * @param size_t - maximum number of bytes to read
+             * @param size_t - reference to store number of bytes read
+             * @return ResponseCode - successful read or TLS error code
+             */
+            ResponseCode ReadAvailableInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                               size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                               size_t &size_read_bytes_out);
+
+            /**
+             * @brief Wait until data is available to read from the network socket
+             *
+             * @param std::chrono::milliseconds - maximum time to wait
+             * @return ResponseCode - SUCCESS if data is available, NETWORK_SSL_NOTHING_TO_READ on timeout or
+             *                        TLS error code
+             */
+            ResponseCode WaitForReadableInternal(std::chrono::milliseconds timeout);
+
             /**
              * @brief Disconnect from network socket
              *
@@ -256,7 +430,7 @@ namespace awsiotsdk {
              */
             void SetRootCAPath(util::String root_ca_location) {
                 root_ca_location_ = root_ca_location;
-                certificates_read_flag_ = false;
+                ClearSession();
             }
 
             /**
@@ -267,10 +441,62 @@ namespace awsiotsdk {
              * @param endpoint_port
              */
             void SetEndpointAndPort(util::String endpoint, uint16_t endpoint_port) {
+                if (endpoint != endpoint_ || endpoint_port != endpoint_port_) {
+                    ClearSession();
+                }
                 endpoint_ = endpoint;
                 endpoint_port_ = endpoint_port;
             }
 
+            /**
+             * @brief Enable or disable TLS session resumption
+             *
+             * When enabled, which is the default, reconnects offer the session of the previous connection. The server
+             * can then skip the certificate exchange and client certificate signing of a full handshake. Falls back
+             * to a full handshake if the server does not accept the session.
+             *
+             * @param enable_session_resumption - True to resume sessions on reconnect
+             */
+            void SetSessionResumption(bool enable_session_resumption);
+
+            /**
+             * @brief Persist the TLS session to a file so it can be resumed after a restart
+             *
+             * The file contains the session secret and is created readable by the owner only. Use a separate file
+             * for each endpoint. Pass an empty string to only keep the session in memory, which is the default.
+             *
+             * @param session_cache_location - Path of the session cache file
+             */
+            void SetSessionCacheLocation(util::String session_cache_location);
+
+            /**
+             * @brief Get the duration of the last successful TLS handshake
+             *
+             * @return std::chrono::milliseconds - handshake duration, -1 if no handshake completed yet
+             */
+            std::chrono::milliseconds GetLastHandshakeDuration();
+
+            /**
+             * @brief Check if the last successful TLS handshake resumed a previous session
+             *
+             * @return bool - true if the session was resumed
+             */
+            bool WasLastHandshakeResumed();
+
+            /**
+             * @brief Get the number of successful full TLS handshakes
+             *
+             * @return uint32_t - number of full handshakes
+             */
+            uint32_t GetFullHandshakeCount();
+
+            /**
+             * @brief Get the number of successful TLS handshakes that resumed a previous session
+             *
+             * @return uint32_t - number of resumed handshakes
+             */
+            uint32_t GetResumedHandshakeCount();
+
             /**
              * @brief Check if TLS layer is still connected
              *
@@ -289,6 +515,20 @@ namespace awsiotsdk {
              */
             bool IsPhysicalLayerConnected();
 
+            /**
+             * @brief Check if the connection provides a descriptor that can be waited on
+             *
+             * @return bool - true
+             */
+            bool IsPollable();
+
+            /**
+             * @brief Get the descriptor of the TCP socket
+             *
+             * @return int - socket descriptor, -1 if not connected
+             */
+            int GetPollableDescriptor();
+
             virtual ~OpenSSLConnection();
         };
     }
@@ -0,0 +1,253 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file OpenSSLResolverCache.cpp
+ * @brief Implementation of the shared cache of resolved endpoint addresses
+ */
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "OpenSSLResolverCache.hpp"
+#include "util/logging/LogMacros.hpp"
+
+#define OPENSSL_RESOLVER_LOG_TAG "[OpenSSL Resolver]"
+
+namespace awsiotsdk {
+    namespace network {
+        OpenSSLResolverCache::OpenSSLResolverCache() {
+            idle_thread_count_ = 0;
+            is_stopping_ = false;
+            time_to_live_ = std::chrono::seconds(OPENSSL_DNS_CACHE_TTL_SECS);
+            lookup_abandon_time_ = std::chrono::seconds(OPENSSL_DNS_LOOKUP_ABANDON_SECS);
+        }
+
+        OpenSSLResolverCache::~OpenSSLResolverCache() {
+            StopResolverThreads();
+        }
+
+        OpenSSLResolverCache *OpenSSLResolverCache::getInstance() {
+            // Never destroyed, a resolver thread can be blocked in getaddrinfo during exit
+            static OpenSSLResolverCache *p_resolver_cache = new OpenSSLResolverCache();
+            return p_resolver_cache;
+        }
+
+        void OpenSSLResolverCache::SetTimeToLive(std::chrono::milliseconds time_to_live) {
+            std::lock_guard<std::mutex> cache_lock(cache_lock_);
+            time_to_live_ = time_to_live;
+        }
+
+        int OpenSSLResolverCache::LookupAddresses(const util::String &endpoint,
+                                                  util::Vector<ResolvedAddress> &addresses_out) {
+            struct addrinfo hints{}, *p_result = nullptr;
+            memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            int error = getaddrinfo(endpoint.c_str(), nullptr, &hints, &p_result);
+            if (0 != error) {
+                return error;
+            }
+
+            util::Vector<ResolvedAddress> preferred_addresses;
+            util::Vector<ResolvedAddress> other_addresses;
+            int preferred_family = AF_UNSPEC;
+            for (struct addrinfo *p_iterator = p_result; nullptr != p_iterator; p_iterator = p_iterator->ai_next) {
+                if ((AF_INET != p_iterator->ai_family && AF_INET6 != p_iterator->ai_family) ||
+                    sizeof(sockaddr_storage) < p_iterator->ai_addrlen) {
+                    continue;
+                }
+                if (AF_UNSPEC == preferred_family) {
+                    preferred_family = p_iterator->ai_family;
+                }
+                ResolvedAddress resolved_address;
+                memset(&resolved_address.address_, 0, sizeof(resolved_address.address_));
+                memcpy(&resolved_address.address_, p_iterator->ai_addr, p_iterator->ai_addrlen);
+                resolved_address.address_length_ = static_cast<socklen_t>(p_iterator->ai_addrlen);
+                if (preferred_family == p_iterator->ai_family) {
+                    preferred_addresses.push_back(resolved_address);
+                } else {
+                    other_addresses.push_back(resolved_address);
+                }
+            }
+            freeaddrinfo(p_result);
+
+            // Alternate between the address families so a broken family only delays the connect by one attempt
+            addresses_out.clear();
+            for (size_t itr = 0; preferred_addresses.size() > itr || other_addresses.size() > itr; itr++) {
+                if (preferred_addresses.size() > itr) {
+                    addresses_out.push_back(preferred_addresses[itr]);
+                }
+                if (other_addresses.size() > itr) {
+                    addresses_out.push_back(other_addresses[itr]);
+                }
+            }
+            return 0;
+        }
+
+        void OpenSSLResolverCache::StartLookup(const util::String &endpoint, CacheEntry &cache_entry) {
+            std::shared_ptr<Lookup> p_new_lookup = std::make_shared<Lookup>();
+            p_new_lookup->is_done_ = false;
+            p_new_lookup->error_ = 0;
+            p_new_lookup->start_time_ = std::chrono::steady_clock::now();
+            cache_entry.p_pending_lookup_ = p_new_lookup;
+
+            LookupRequest lookup_request;
+            lookup_request.endpoint_ = endpoint;
+            lookup_request.p_lookup_ = p_new_lookup;
+            lookup_requests_.push(lookup_request);
+
+            JoinRetiredThreads();
+            // Threads blocked in an abandoned lookup may never return, they do not count toward the limit
+            size_t hung_thread_count = 0;
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            for (const std::shared_ptr<Lookup> &p_running_lookup : running_lookups_) {
+                if (now - p_running_lookup->run_start_time_ >= lookup_abandon_time_) {
+                    hung_thread_count++;
+                }
+            }
+            if (lookup_requests_.size() > idle_thread_count_ &&
+                OPENSSL_DNS_RESOLVER_THREAD_COUNT + hung_thread_count > resolver_threads_.size()) {
+                resolver_threads_.push_back(std::thread(&OpenSSLResolverCache::RunResolverThread, this));
+            } else {
+                lookup_requested_.notify_one();
+            }
+        }
+
+        void OpenSSLResolverCache::RunResolverThread() {
+            std::unique_lock<std::mutex> cache_lock(cache_lock_);
+            while (!is_stopping_) {
+                if (lookup_requests_.empty()) {
+                    // Threads started in place of hung ones exit once the hung lookups returned
+                    if (resolver_threads_.size() - retired_thread_ids_.size() > OPENSSL_DNS_RESOLVER_THREAD_COUNT) {
+                        retired_thread_ids_.push_back(std::this_thread::get_id());
+                        return;
+                    }
+                    idle_thread_count_++;
+                    lookup_requested_.wait(cache_lock);
+                    idle_thread_count_--;
+                    continue;
+                }
+
+                LookupRequest lookup_request = lookup_requests_.front();
+                lookup_requests_.pop();
+                std::shared_ptr<Lookup> p_lookup = lookup_request.p_lookup_;
+                util::Map<util::String, CacheEntry>::iterator entry_itr = cache_entries_.find(lookup_request.endpoint_);
+
+                // Skip lookups that were abandoned while they were queued
+                util::Vector<ResolvedAddress> addresses;
+                int error = EAI_AGAIN;
+                if (cache_entries_.end() != entry_itr && p_lookup == entry_itr->second.p_pending_lookup_) {
+                    p_lookup->run_start_time_ = std::chrono::steady_clock::now();
+                    running_lookups_.push_back(p_lookup);
+                    cache_lock.unlock();
+                    error = LookupAddresses(lookup_request.endpoint_, addresses);
+                    cache_lock.lock();
+                    running_lookups_.erase(std::find(running_lookups_.begin(), running_lookups_.end(), p_lookup));
+                }
+
+                p_lookup->is_done_ = true;
+                p_lookup->error_ = error;
+                p_lookup->addresses_ = addresses;
+                // Entries are never erased, the result is only stored if the lookup was not replaced meanwhile
+                if (cache_entries_.end() != entry_itr && p_lookup == entry_itr->second.p_pending_lookup_) {
+                    entry_itr->second.p_pending_lookup_ = nullptr;
+                    if (!addresses.empty()) {
+                        entry_itr->second.addresses_ = addresses;
+                        entry_itr->second.expiry_time_ = std::chrono::steady_clock::now() + time_to_live_;
+                    }
+                }
+                lookup_done_.notify_all();
+            }
+        }
+
+        void OpenSSLResolverCache::JoinRetiredThreads() {
+            for (const std::thread::id &retired_thread_id : retired_thread_ids_) {
+                util::Vector<std::thread>::iterator thread_itr =
+                    std::find_if(resolver_threads_.begin(), resolver_threads_.end(),
+                                 [retired_thread_id](const std::thread &resolver_thread) {
+                                     return retired_thread_id == resolver_thread.get_id();
+                                 });
+                if (resolver_threads_.end() != thread_itr) {
+                    // The thread no longer needs the cache lock, it only has to return
+                    thread_itr->join();
+                    resolver_threads_.erase(thread_itr);
+                }
+            }
+            retired_thread_ids_.clear();
+        }
+
+        void OpenSSLResolverCache::StopResolverThreads() {
+            {
+                std::lock_guard<std::mutex> cache_lock(cache_lock_);
+                is_stopping_ = true;
+            }
+            lookup_requested_.notify_all();
+            for (std::thread &resolver_thread : resolver_threads_) {
+                if (resolver_thread.joinable()) {
+                    resolver_thread.join();
+                }
+            }
+        }
+
+        ResponseCode OpenSSLResolverCache::Resolve(const util::String &endpoint, std::chrono::milliseconds timeout,
+                                                   util::Vector<ResolvedAddress> &addresses_out) {
+            std::unique_lock<std::mutex> cache_lock(cache_lock_);
+            CacheEntry &cache_entry = cache_entries_[endpoint];
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (!cache_entry.addresses_.empty() && now < cache_entry.expiry_time_) {
+                addresses_out = cache_entry.addresses_;
+                return ResponseCode::SUCCESS;
+            }
+
+            if (nullptr == cache_entry.p_pending_lookup_) {
+                StartLookup(endpoint, cache_entry);
+            } else if (now - cache_entry.p_pending_lookup_->start_time_ >= lookup_abandon_time_) {
+                AWS_LOG_WARN(OPENSSL_RESOLVER_LOG_TAG, "Lookup of %s did not finish, starting a new one",
+                             endpoint.c_str());
+                StartLookup(endpoint, cache_entry);
+            }
+            std::shared_ptr<Lookup> p_lookup = cache_entry.p_pending_lookup_;
+            bool is_done = lookup_done_.wait_for(cache_lock, timeout, [p_lookup] { return p_lookup->is_done_; });
+            if (is_done && !p_lookup->addresses_.empty()) {
+                addresses_out = p_lookup->addresses_;
+                return ResponseCode::SUCCESS;
+            }
+
+            // Entries are never erased, so the reference is still valid
+            if (!cache_entry.addresses_.empty()) {
+                AWS_LOG_WARN(OPENSSL_RESOLVER_LOG_TAG, "Unable to resolve %s, using previously resolved addresses",
+                             endpoint.c_str());
+                addresses_out = cache_entry.addresses_;
+                return ResponseCode::SUCCESS;
+            }
+            if (is_done) {
+                AWS_LOG_ERROR(OPENSSL_RESOLVER_LOG_TAG, "Error resolving hostname: %i", p_lookup->error_);
+            } else {
+                AWS_LOG_ERROR(OPENSSL_RESOLVER_LOG_TAG, "Timed out resolving hostname %s", endpoint.c_str());
+            }
+            return ResponseCode::NETWORK_TCP_UNKNOWN_HOST;
+        }
+
+        void OpenSSLResolverCache::Expire(const util::String &endpoint) {
+            std::lock_guard<std::mutex> cache_lock(cache_lock_);
+            util::Map<util::String, CacheEntry>::iterator entry_itr = cache_entries_.find(endpoint);
+            if (cache_entries_.end() != entry_itr) {
+                entry_itr->second.expiry_time_ = std::chrono::steady_clock::time_point();
+            }
+        }
+    }
+}
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file OpenSSLResolverCache.hpp
+ * @brief Defines the shared cache of resolved endpoint addresses used by the OpenSSL wrapper
+ */
+
+#pragma once
+
+#ifdef WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#pragma comment(lib,"ws2_32")
+#else
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#endif
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/Queue.hpp"
+#include "util/memory/stl/String.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "ResponseCode.hpp"
+
+/**
+ * Time resolved endpoint addresses are reused before the endpoint is resolved again
+ */
+#define OPENSSL_DNS_CACHE_TTL_SECS 60
+
+/**
+ * Maximum number of threads resolving endpoints, further lookups wait for a free thread. Threads blocked in abandoned
+ * lookups are not counted
+ */
+#define OPENSSL_DNS_RESOLVER_THREAD_COUNT 2
+
+/**
+ * Age after which an unfinished lookup is abandoned and the next request starts a new one
+ */
+#define OPENSSL_DNS_LOOKUP_ABANDON_SECS 30
+
+namespace awsiotsdk {
+    namespace network {
+        /**
+         * @brief Shared cache of resolved endpoint addresses
+         *
+         * Endpoints are resolved on a small pool of resolver threads, so a slow resolver only delays a connect up to
+         * the given timeout. Concurrent requests for the same endpoint share one lookup. Results are reused for the
+         * time to live. If resolving fails or times out, the last known addresses are used. A lookup that has not
+         * finished after OPENSSL_DNS_LOOKUP_ABANDON_SECS is abandoned, its result is ignored and the next request
+         * starts a new lookup. Its thread stays blocked until the lookup returns, so a new thread is started in its
+         * place.
+         */
+        class OpenSSLResolverCache {
+        public:
+            /**
+             * @brief A resolved address, the port is set when connecting
+             */
+            struct ResolvedAddress {
+                sockaddr_storage address_;                 ///< IPv4 or IPv6 socket address
+                socklen_t address_length_;                 ///< Length of the address
+            };
+
+        protected:
+            /**
+             * @brief State of a lookup queued for or running on a resolver thread
+             */
+            struct Lookup {
+                bool is_done_;                             ///< Boolean, True = the lookup finished
+                int error_;                                ///< Return value of getaddrinfo
+                util::Vector<ResolvedAddress> addresses_;  ///< Resolved addresses, in the order they should be tried
+                std::chrono::steady_clock::time_point start_time_;     ///< Time the lookup was requested
+                std::chrono::steady_clock::time_point run_start_time_; ///< Time a resolver thread started the lookup
+            };
+
+            /**
+             * @brief Lookup waiting for a resolver thread
+             */
+            struct LookupRequest {
+                util::String endpoint_;                    ///< Endpoint to resolve
+                std::shared_ptr<Lookup> p_lookup_;         ///< Lookup the result is stored in
+            };
+
+            /**
+             * @brief Cached addresses of an endpoint
+             */
+            struct CacheEntry {
+                util::Vector<ResolvedAddress> addresses_;  ///< Last resolved addresses, kept after they expire
+                std::chrono::steady_clock::time_point expiry_time_;    ///< Time the addresses have to be resolved again
+                std::shared_ptr<Lookup> p_pending_lookup_; ///< Current lookup, nullptr if none
+            };
+
+            std::mutex cache_lock_;                        ///< Guards the entries, lookups and request queue
+            std::condition_variable lookup_done_;          ///< Notified when a lookup finishes
+            std::condition_variable lookup_requested_;     ///< Notified when a lookup is queued or the threads stop
+            util::Map<util::String, CacheEntry> cache_entries_;    ///< Entries keyed by endpoint
+            util::Queue<LookupRequest> lookup_requests_;   ///< Lookups waiting for a resolver thread
+            util::Vector<std::thread> resolver_threads_;   ///< Resolver threads, started when lookups are queued
+            util::Vector<std::shared_ptr<Lookup>> running_lookups_;    ///< Lookups running on a resolver thread
+            util::Vector<std::thread::id> retired_thread_ids_;     ///< Resolver threads that exited and can be joined
+            size_t idle_thread_count_;                     ///< Resolver threads waiting for a request
+            bool is_stopping_;                             ///< Boolean, True = resolver threads should exit
+            std::chrono::milliseconds time_to_live_;       ///< Time resolved addresses are reused
+            std::chrono::milliseconds lookup_abandon_time_;    ///< Age after which an unfinished lookup is replaced
+
+            OpenSSLResolverCache();
+
+            /**
+             * @brief Queue a new lookup for an endpoint, replacing the current one
+             *
+             * Must be called with the cache lock held. A resolver thread is started if none is idle and the thread
+             * limit is not reached. Threads running a lookup older than the abandon time do not count toward the
+             * limit, so hung lookups do not keep new lookups queued.
+             *
+             * @param endpoint - Endpoint to resolve
+             * @param cache_entry - Entry of the endpoint
+             */
+            void StartLookup(const util::String &endpoint, CacheEntry &cache_entry);
+
+            /**
+             * @brief Run lookups from the request queue until the threads are stopped
+             */
+            void RunResolverThread();
+
+            /**
+             * @brief Join the resolver threads that exited because the thread limit was exceeded
+             *
+             * Must be called with the cache lock held. Threads started in place of hung ones exit once the hung
+             * lookups returned.
+             */
+            void JoinRetiredThreads();
+
+            /**
+             * @brief Stop and join the resolver threads
+             *
+             * Waits for running lookups to return. Subclasses that override LookupAddresses must call this from their
+             * destructor.
+             */
+            void StopResolverThreads();
+
+            /**
+             * @brief Resolve an endpoint, called on a resolver thread without the cache lock
+             *
+             * IPv6 and IPv4 addresses are interleaved, starting with the family preferred by the resolver.
+             *
+             * @param endpoint - Endpoint to resolve
+             * @param addresses_out - Addresses of the endpoint
+             * @return int - return value of getaddrinfo, 0 on success
+             */
+            virtual int LookupAddresses(const util::String &endpoint, util::Vector<ResolvedAddress> &addresses_out);
+
+        public:
+            static OpenSSLResolverCache *getInstance();
+
+            /**
+             * @brief Set how long resolved addresses are reused
+             *
+             * @param time_to_live - Time to live of resolved addresses, defaults to OPENSSL_DNS_CACHE_TTL_SECS
+             */
+            void SetTimeToLive(std::chrono::milliseconds time_to_live);
+
+            /**
+             * @brief Get the addresses of an endpoint
+             *
+             * @param endpoint - Endpoint to resolve
+             * @param timeout - Maximum time to wait for the resolver
+             * @param addresses_out - Addresses of the endpoint
+             * @return ResponseCode - SUCCESS or NETWORK_TCP_UNKNOWN_HOST if no address is known
+             */
+            ResponseCode Resolve(const util::String &endpoint, std::chrono::milliseconds timeout,
+                                 util::Vector<ResolvedAddress> &addresses_out);
+
+            /**
+             * @brief Resolve an endpoint again on the next request
+             *
+             * Used when none of the addresses could be connected to, for example after a network change. The
+             * addresses are still used if resolving fails.
+             *
+             * @param endpoint - Endpoint to expire
+             */
+            void Expire(const util::String &endpoint);
+
+            virtual ~OpenSSLResolverCache();
+        };
+    }
+}
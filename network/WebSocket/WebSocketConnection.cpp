@@ -23,6 +23,7 @@
 #include <ws2tcpip.h>
 #pragma comment(lib,"ws2_32")
 #endif
+#include <algorithm>
 #include <iostream>
 #include <thread>
 #include <iterator>
@@ -184,59 +185,90 @@ namespace awsiotsdk {
             return rc;
         }
 
-        ResponseCode WebSocketConnection::ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
-                                                       size_t size_bytes_to_read, size_t &size_read_bytes_out) {
+        ResponseCode WebSocketConnection::ReceiveFrames(size_t size_bytes_required) {
             ResponseCode ret_code = ResponseCode::SUCCESS;
-            bool continue_polling = true;
-
-            do {
-                // See if we already have enough bytes for this read request
-                if (curr_read_buf_size_ >= size_bytes_to_read) {
-                    auto in_buf_itr = std::next(buf.begin(), buf_read_offset);
-                    if (in_buf_itr != buf.end()) {
-                        buf.erase(in_buf_itr, buf.end());
-                    }
-                    // Yes we have. Retrieve from the buffer and update the buffer status
-                    std::vector<unsigned char>::iterator itr = std::next(read_buf_.begin(), size_bytes_to_read);
-                    std::move(read_buf_.begin(), itr, std::back_inserter(buf));
-                    read_buf_.erase(read_buf_.begin(), itr);
-
-                    // Update buffer status
-                    curr_read_buf_size_ -= size_bytes_to_read;
-                    size_read_bytes_out = size_bytes_to_read;
-                    continue_polling = false;
+
+            // Retrieve new wss frames from network until we have enough bytes
+            while (curr_read_buf_size_ < size_bytes_required) {
+                wslay_frame_iocb *new_ws_frame = static_cast<wslay_frame_iocb *> (wss_frame_read_.get());
+                ssize_t ws_read_res = wslay_frame_recv(p_wslay_frame_Context_, new_ws_frame);
+                if (ws_read_res < 0) {
+                    ClearBuffer(); // Force a new ws frame
+                    //is_connected_ = false;
+                    ret_code = ResponseCode::WEBSOCKET_FRAME_RECEIVE_ERROR;
+                    break;
+                } else if (ViolateServerToClientWsProtocol(new_ws_frame)) {
+                    ClearBuffer();
+                    //is_connected_ = false;
+                    ret_code = ResponseCode::WEBSOCKET_PROTOCOL_VIOLATION;
+                    break;
+                } else if (WSLAY_CONNECTION_CLOSE == new_ws_frame->opcode) {
+                    ClearBuffer();
+                    //is_connected_ = false;
+                    ret_code = ResponseCode::WEBSOCKET_MAX_LIFETIME_REACHED;
+                    break;
+                } else if (WSLAY_PING == new_ws_frame->opcode) {
+                    SendPongFromClient();
+                } else if (WSLAY_PONG == new_ws_frame->opcode) {
+                    // Ignore this PONG and receive the next ws frame
                 } else {
-                    // Unfortunately we don't. Retrieve a new wss frame from network
-                    wslay_frame_iocb *new_ws_frame = static_cast<wslay_frame_iocb *> (wss_frame_read_.get());
-                    ssize_t ws_read_res = wslay_frame_recv(p_wslay_frame_Context_, new_ws_frame);
-                    if (ws_read_res < 0) {
-                        ClearBuffer(); // Force a new ws frame
-                        //is_connected_ = false;
-                        ret_code = ResponseCode::WEBSOCKET_FRAME_RECEIVE_ERROR;
-                        continue_polling = false;
-                    } else if (ViolateServerToClientWsProtocol(new_ws_frame)) {
-                        ClearBuffer();
-                        //is_connected_ = false;
-                        ret_code = ResponseCode::WEBSOCKET_PROTOCOL_VIOLATION;
-                        continue_polling = false;
-                    } else if (WSLAY_CONNECTION_CLOSE == new_ws_frame->opcode) {
-                        ClearBuffer();
-                        //is_connected_ = false;
-                        ret_code = ResponseCode::WEBSOCKET_MAX_LIFETIME_REACHED;
-                        continue_polling = false;
-                    } else if (WSLAY_PING == new_ws_frame->opcode) {
-                        SendPongFromClient();
-                    } else if (WSLAY_PONG == new_ws_frame->opcode) {
-                        // Ignore this PONG and receive the next ws frame
-                    } else {
-                        AppendBytesToBuffer((char *) (new_ws_frame->data), new_ws_frame->data_length);
-                    }
+                    AppendBytesToBuffer((char *) (new_ws_frame->data), new_ws_frame->data_length);
+                }
+            }
+
+            return ret_code;
+        }
+
+        ResponseCode WebSocketConnection::ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                                       size_t size_bytes_to_read, size_t &size_read_bytes_out) {
+            ResponseCode ret_code = ReceiveFrames(size_bytes_to_read);
+            if (ResponseCode::SUCCESS == ret_code) {
+                auto in_buf_itr = std::next(buf.begin(), buf_read_offset);
+                if (in_buf_itr != buf.end()) {
+                    buf.erase(in_buf_itr, buf.end());
                 }
-            } while (continue_polling);
+                // Retrieve from the buffer and update the buffer status
+                std::vector<unsigned char>::iterator itr = std::next(read_buf_.begin(), size_bytes_to_read);
+                std::move(read_buf_.begin(), itr, std::back_inserter(buf));
+                read_buf_.erase(read_buf_.begin(), itr);
+
+                // Update buffer status
+                curr_read_buf_size_ -= size_bytes_to_read;
+                size_read_bytes_out = size_bytes_to_read;
+            }
 
             return ret_code;
         }
 
+        ResponseCode WebSocketConnection::ReadAvailableInternal(util::Vector<unsigned char> &buf,
+                                                                size_t buf_read_offset,
+                                                                size_t min_bytes_to_read,
+                                                                size_t max_bytes_to_read,
+                                                                size_t &size_read_bytes_out) {
+            ResponseCode ret_code = ReceiveFrames(std::min(min_bytes_to_read, max_bytes_to_read));
+            if (ResponseCode::SUCCESS == ret_code) {
+                // Hand over everything already decoded, it may contain several MQTT packets
+                size_t size_bytes_to_read = std::min(curr_read_buf_size_, max_bytes_to_read);
+                std::vector<unsigned char>::iterator itr = std::next(read_buf_.begin(), size_bytes_to_read);
+                std::copy(read_buf_.begin(), itr, std::next(buf.begin(), buf_read_offset));
+                read_buf_.erase(read_buf_.begin(), itr);
+
+                curr_read_buf_size_ -= size_bytes_to_read;
+                size_read_bytes_out = size_bytes_to_read;
+            }
+
+            return ret_code;
+        }
+
+        ResponseCode WebSocketConnection::WaitForReadableInternal(std::chrono::milliseconds timeout) {
+            // Frame data that was already decoded does not show up on the socket
+            if (0 < curr_read_buf_size_) {
+                return ResponseCode::SUCCESS;
+            }
+
+            return openssl_connection_.WaitForReadable(timeout);
+        }
+
         size_t WebSocketConnection::AppendBytesToBuffer(const char *dest_buf, size_t num_bytes_to_append) {
             size_t itr;
             for (itr = 0; itr < num_bytes_to_append; itr++) {
@@ -314,6 +346,14 @@ namespace awsiotsdk {
             return openssl_connection_.IsPhysicalLayerConnected();
         }
 
+        bool WebSocketConnection::IsPollable() {
+            return true;
+        }
+
+        int WebSocketConnection::GetPollableDescriptor() {
+            return is_connected_ ? openssl_connection_.GetPollableDescriptor() : -1;
+        }
+
         WebSocketConnection::~WebSocketConnection() {
             delete p_wslay_frame_Callbacks_;
             wslay_frame_context_free(p_wslay_frame_Context_);
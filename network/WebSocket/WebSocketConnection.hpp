@@ -117,6 +117,14 @@ namespace awsiotsdk {
              */
             void ClearBuffer(void);
 
+            /**
+             * @brief Receive WebSocket frames until the decode buffer holds enough bytes
+             *
+             * @param size_t - number of bytes required in the decode buffer
+             * @return ResponseCode - SUCCESS once enough bytes are buffered or WebSocket error code
+             */
+            ResponseCode ReceiveFrames(size_t size_bytes_required);
+
             /**
              * @brief Create a WebSocket and negotiate the connection
              *
@@ -147,6 +155,31 @@ namespace awsiotsdk {
             ResponseCode ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                       size_t size_bytes_to_read, size_t &size_read_bytes_out);
 
+            /**
+             * @brief Read decoded bytes from the network WebSocket
+             *
+             * Waits for min_bytes_to_read bytes and returns all decoded frame data up to max_bytes_to_read
+             *
+             * @param unsigned char pointer - pointer to buffer where read bytes should be copied
+             * @param size_t - offset in the buffer where read bytes should be copied
+             * @param size_t - minimum number of bytes to read
+             * @param size_t - maximum number of bytes to read
+             * @param size_t - pointer to store number of bytes read
+             * @return ResponseCode - successful read or WebSocket error code
+             */
+            ResponseCode ReadAvailableInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                               size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                               size_t &size_read_bytes_out);
+
+            /**
+             * @brief Wait until data is available to read from the network WebSocket
+             *
+             * @param std::chrono::milliseconds - maximum time to wait
+             * @return ResponseCode - SUCCESS if data is available, NETWORK_SSL_NOTHING_TO_READ on timeout or
+             *                        WebSocket error code
+             */
+            ResponseCode WaitForReadableInternal(std::chrono::milliseconds timeout);
+
             /**
              * @brief Disconnect from network WebSocket
              *
@@ -259,6 +292,20 @@ namespace awsiotsdk {
              */
             bool IsPhysicalLayerConnected();
 
+            /**
+             * @brief Check if the connection provides a descriptor that can be waited on
+             *
+             * @return bool - true
+             */
+            bool IsPollable();
+
+            /**
+             * @brief Get the descriptor of the underlying TLS socket
+             *
+             * @return int - socket descriptor, -1 if not connected
+             */
+            int GetPollableDescriptor();
+
             virtual ~WebSocketConnection();
         };
 
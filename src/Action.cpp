@@ -54,8 +54,10 @@ namespace awsiotsdk {
                                             bytes_to_read - total_read_bytes,
                                             cur_read_bytes);
             total_read_bytes += cur_read_bytes;
-            if (total_read_bytes != bytes_to_read) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(DEFAULT_NETWORK_ACTION_THREAD_SLEEP_DURATION_MS));
+            if (ResponseCode::SUCCESS == rc && total_read_bytes != bytes_to_read) {
+                // Wake up as soon as the rest of the data arrives
+                p_network_connection->WaitForReadable(
+                    std::chrono::milliseconds(DEFAULT_NETWORK_ACTION_THREAD_SLEEP_DURATION_MS));
             }
         } while (_p_thread_continue_ && total_read_bytes != bytes_to_read && ResponseCode::SUCCESS == rc);
 
@@ -89,9 +91,10 @@ namespace awsiotsdk {
         ResponseCode rc = ResponseCode::FAILURE;
 
         std::atomic_bool &_p_thread_continue_ = *p_thread_continue_;
-        util::String temp_buf = write_buf;
+        // Only copy the remainder after a partial write
+        util::String temp_buf;
         do {
-            rc = p_network_connection->Write(temp_buf, cur_written_bytes);
+            rc = p_network_connection->Write(0 == total_written_bytes ? write_buf : temp_buf, cur_written_bytes);
             total_written_bytes += cur_written_bytes;
             if (total_written_bytes != bytes_to_write) {
                 temp_buf = write_buf.substr(total_written_bytes);
@@ -109,4 +112,29 @@ namespace awsiotsdk {
 
         return rc;
     }
+
+    ResponseCode Action::WriteToNetworkBuffer(std::shared_ptr<NetworkConnection> p_network_connection,
+                                              const util::Vector<NetworkWriteSegment> &segments) {
+        if (nullptr == p_network_connection) {
+            return ResponseCode::NULL_VALUE_ERROR;
+        }
+
+        size_t bytes_to_write = 0;
+        for (const NetworkWriteSegment &segment : segments) {
+            bytes_to_write += segment.length_;
+        }
+
+        if (0 == bytes_to_write) {
+            return ResponseCode::NETWORK_NOTHING_TO_WRITE_ERROR;
+        }
+
+        // Gathered writes retry partial writes internally
+        size_t total_written_bytes = 0;
+        ResponseCode rc = p_network_connection->WriteGathered(segments, total_written_bytes);
+        if (ResponseCode::SUCCESS == rc && total_written_bytes != bytes_to_write) {
+            rc = ResponseCode::FAILURE;
+        }
+
+        return rc;
+    }
 }
\ No newline at end of file
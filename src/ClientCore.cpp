@@ -26,6 +26,184 @@
 #define LOG_TAG_CLIENT_CORE "[Client Core]"
 
 namespace awsiotsdk {
+    /**
+     * @brief Action runner driven by readiness events of its network connection
+     */
+    class ReactorActionRunner : public util::Threading::IoReactor::EventSource {
+    protected:
+        std::unique_ptr<Action> p_action_;                         ///< Action performed when the connection is readable
+        std::shared_ptr<NetworkConnection> p_network_connection_;  ///< Network connection passed to the Action
+        std::shared_ptr<ActionData> p_action_data_;                ///< Action data passed to the Action
+        std::shared_ptr<std::atomic_bool> p_continue_;             ///< Sync variable of the Action, same as for a Thread Task
+
+    public:
+        ReactorActionRunner(std::unique_ptr<Action> p_action, std::shared_ptr<NetworkConnection> p_network_connection,
+                            std::shared_ptr<ActionData> p_action_data)
+            : p_action_(std::move(p_action)), p_network_connection_(std::move(p_network_connection)),
+              p_action_data_(std::move(p_action_data)) {
+            p_continue_ = std::make_shared<std::atomic_bool>(true);
+            p_action_->SetParentThreadSync(p_continue_);
+        }
+
+        /**
+         * @brief Tell the Action to stop, a handler that is running no longer requests reconnects
+         */
+        void Stop() {
+            *p_continue_ = false;
+        }
+
+        int GetDescriptor() {
+            return p_network_connection_->GetPollableDescriptor();
+        }
+
+        void OnReadable() {
+            p_action_->PerformReadyAction(p_network_connection_, p_action_data_);
+        }
+    };
+
+    /**
+     * @brief Action runner driven by a timer service
+     *
+     * Runs the Action whenever the time it returned from its last run is due, or earlier when woken up. Runs never
+     * overlap, a wakeup during a run schedules the next run right after it.
+     */
+    class TimerActionRunner : public std::enable_shared_from_this<TimerActionRunner> {
+    protected:
+        std::unique_ptr<Action> p_action_;                                 ///< Action performed when its timer is due
+        std::shared_ptr<NetworkConnection> p_network_connection_;          ///< Network connection passed to the Action
+        std::shared_ptr<ActionData> p_action_data_;                        ///< Action data passed to the Action
+        std::shared_ptr<util::Threading::TimerService> p_timer_service_;   ///< Timer service the runs are scheduled on
+        std::mutex runner_lock_;                                           ///< Guards the schedule of the runner
+        util::Threading::TimerService::TimerId timer_id_;                  ///< Timer of the next or the current run, zero if none
+        uint64_t schedule_generation_;                                     ///< Incremented on every schedule, timers of older schedules do nothing
+        std::chrono::steady_clock::time_point next_run_time_;              ///< Time of the next run
+        bool is_running_;                                                  ///< True while the Action runs
+        bool is_wakeup_pending_;                                           ///< True if woken up during a run
+        bool is_stopped_;                                                  ///< True once stopped
+
+        /**
+         * @brief Schedule the next run, must be called with the runner lock held
+         * @param run_time - Time of the next run, time_point::max() to only run again when woken up
+         */
+        void ScheduleRun(std::chrono::steady_clock::time_point run_time) {
+            schedule_generation_++;
+            next_run_time_ = run_time;
+            timer_id_ = 0;
+            if (std::chrono::steady_clock::time_point::max() == run_time) {
+                return;
+            }
+            std::weak_ptr<TimerActionRunner> p_weak_runner = shared_from_this();
+            uint64_t schedule_generation = schedule_generation_;
+            timer_id_ = p_timer_service_->Schedule(run_time, [p_weak_runner, schedule_generation] {
+                std::shared_ptr<TimerActionRunner> p_runner = p_weak_runner.lock();
+                if (nullptr != p_runner) {
+                    p_runner->Run(schedule_generation);
+                }
+            });
+        }
+
+        /**
+         * @brief Run the Action and schedule the next run
+         * @param schedule_generation - Schedule the timer belongs to
+         */
+        void Run(uint64_t schedule_generation) {
+            {
+                std::lock_guard<std::mutex> runner_lock(runner_lock_);
+                if (is_stopped_ || schedule_generation != schedule_generation_) {
+                    return;
+                }
+                is_running_ = true;
+            }
+
+            std::chrono::steady_clock::time_point run_time
+                = p_action_->PerformTimedAction(p_network_connection_, p_action_data_);
+
+            std::lock_guard<std::mutex> runner_lock(runner_lock_);
+            is_running_ = false;
+            if (is_stopped_) {
+                return;
+            }
+            if (is_wakeup_pending_) {
+                is_wakeup_pending_ = false;
+                run_time = std::chrono::steady_clock::now();
+            }
+            ScheduleRun(run_time);
+        }
+
+    public:
+        TimerActionRunner(std::unique_ptr<Action> p_action, std::shared_ptr<NetworkConnection> p_network_connection,
+                          std::shared_ptr<ActionData> p_action_data,
+                          std::shared_ptr<util::Threading::TimerService> p_timer_service)
+            : p_action_(std::move(p_action)), p_network_connection_(std::move(p_network_connection)),
+              p_action_data_(std::move(p_action_data)), p_timer_service_(std::move(p_timer_service)) {
+            timer_id_ = 0;
+            schedule_generation_ = 0;
+            next_run_time_ = std::chrono::steady_clock::time_point::max();
+            is_running_ = false;
+            is_wakeup_pending_ = false;
+            is_stopped_ = false;
+        }
+
+        /**
+         * @brief Schedule the first run right away
+         */
+        void Start() {
+            std::weak_ptr<TimerActionRunner> p_weak_runner = shared_from_this();
+            p_action_->SetTimerWakeupHandler([p_weak_runner] {
+                std::shared_ptr<TimerActionRunner> p_runner = p_weak_runner.lock();
+                if (nullptr != p_runner) {
+                    p_runner->Wakeup();
+                }
+            });
+            std::lock_guard<std::mutex> runner_lock(runner_lock_);
+            ScheduleRun(std::chrono::steady_clock::now());
+        }
+
+        /**
+         * @brief Run the Action as soon as possible, does not block
+         */
+        void Wakeup() {
+            util::Threading::TimerService::TimerId replaced_timer_id = 0;
+            {
+                std::lock_guard<std::mutex> runner_lock(runner_lock_);
+                if (is_stopped_) {
+                    return;
+                }
+                if (is_running_) {
+                    is_wakeup_pending_ = true;
+                    return;
+                }
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                if (next_run_time_ <= now) {
+                    return;
+                }
+                replaced_timer_id = timer_id_;
+                ScheduleRun(now);
+            }
+            if (0 != replaced_timer_id) {
+                // Does nothing if it runs anyway, only keeps the heap small
+                p_timer_service_->Cancel(replaced_timer_id);
+            }
+        }
+
+        /**
+         * @brief Stop scheduling runs, waiting for a run on another thread to return
+         */
+        void Stop() {
+            p_action_->SetTimerWakeupHandler(nullptr);
+            util::Threading::TimerService::TimerId timer_id;
+            {
+                std::lock_guard<std::mutex> runner_lock(runner_lock_);
+                is_stopped_ = true;
+                timer_id = timer_id_;
+                timer_id_ = 0;
+            }
+            if (0 != timer_id) {
+                p_timer_service_->Cancel(timer_id);
+            }
+        }
+    };
+
     std::unique_ptr<ClientCore> ClientCore::Create(std::shared_ptr<NetworkConnection> p_network_connection,
                                                    std::shared_ptr<ClientCoreState> p_state) {
         if (nullptr == p_network_connection || nullptr == p_state) {
@@ -40,7 +218,10 @@ namespace awsiotsdk {
         p_client_core_state_ = p_state;
         p_client_core_state_->p_network_connection_ = p_network_connection;
         p_client_core_state_->SetProcessQueuedActions(false);
+        StartOutboundThreadTask();
+    }
 
+    void ClientCore::StartOutboundThreadTask() {
         std::shared_ptr<std::atomic_bool> thread_task_out_sync = std::make_shared<std::atomic_bool>(true);
         std::shared_ptr<util::Threading::ThreadTask> thread_task_out = std::shared_ptr<util::Threading::ThreadTask>(
             new util::Threading::ThreadTask(util::Threading::DestructorAction::JOIN,
@@ -50,6 +231,19 @@ namespace awsiotsdk {
         thread_task_out->Run(&ClientCoreState::ProcessOutboundActionQueue, p_client_core_state_, thread_task_out_sync);
     }
 
+    void ClientCore::SetExecutor(std::shared_ptr<util::Threading::Executor> p_executor) {
+        if (nullptr != p_executor) {
+            // Joins the outbound thread before the first task can run
+            thread_map_.erase(ActionType::CORE_PROCESS_OUTBOUND);
+            p_client_core_state_->SetExecutor(p_executor, p_client_core_state_);
+        } else {
+            p_client_core_state_->SetExecutor(nullptr, std::weak_ptr<ClientCoreState>());
+            if (thread_map_.end() == thread_map_.find(ActionType::CORE_PROCESS_OUTBOUND)) {
+                StartOutboundThreadTask();
+            }
+        }
+    }
+
     ResponseCode ClientCore::RegisterAction(ActionType action_type, Action::CreateHandlerPtr p_action_create_handler) {
         return p_client_core_state_->RegisterAction(action_type, p_action_create_handler, p_client_core_state_);
     }
@@ -76,6 +270,29 @@ namespace awsiotsdk {
         p_action = p_action_create_handler(p_client_core_state_);
         if (nullptr == p_action) {
             rc = ResponseCode::NULL_VALUE_ERROR;
+        } else if (nullptr != p_io_reactor_ && p_action->IsReadinessDriven()
+            && p_client_core_state_->p_network_connection_->IsPollable()) {
+            if (reactor_source_map_.end() != reactor_source_map_.find(action_type)) {
+                return ResponseCode::SUCCESS;
+            }
+            std::shared_ptr<ReactorActionRunner> p_reactor_source
+                = std::make_shared<ReactorActionRunner>(std::move(p_action),
+                                                        p_client_core_state_->p_network_connection_,
+                                                        p_action_data);
+            rc = p_io_reactor_->Register(p_reactor_source);
+            if (ResponseCode::SUCCESS == rc) {
+                reactor_source_map_.insert(std::make_pair(action_type, p_reactor_source));
+            }
+        } else if (nullptr != p_timer_service_ && p_action->IsTimerDriven()) {
+            if (timer_runner_map_.end() != timer_runner_map_.find(action_type)) {
+                return ResponseCode::SUCCESS;
+            }
+            std::shared_ptr<TimerActionRunner> p_timer_runner
+                = std::make_shared<TimerActionRunner>(std::move(p_action),
+                                                      p_client_core_state_->p_network_connection_,
+                                                      p_action_data, p_timer_service_);
+            timer_runner_map_.insert(std::make_pair(action_type, p_timer_runner));
+            p_timer_runner->Start();
         } else {
             std::shared_ptr<std::atomic_bool> thread_task_sync = std::make_shared<std::atomic_bool>(true);
             p_action->SetParentThreadSync(thread_task_sync);
@@ -91,11 +308,41 @@ namespace awsiotsdk {
         return rc;
     }
 
-    void ClientCore::GracefulShutdownAllThreadTasks() {
+    void ClientCore::UnregisterReactorSources() {
+        for (auto &reactor_source : reactor_source_map_) {
+            reactor_source.second->Stop();
+            p_io_reactor_->Unregister(reactor_source.second);
+        }
+        reactor_source_map_.clear();
+    }
+
+    void ClientCore::StopTimerActionRunners() {
+        for (auto &timer_runner : timer_runner_map_) {
+            timer_runner.second->Stop();
+        }
+        timer_runner_map_.clear();
+    }
+
+    void ClientCore::StopThreadTasks() {
+        for (auto &thread_task : thread_map_) {
+            thread_task.second->Stop();
+        }
+        // Runners sleeping until their next deadline check the sync point right away
+        p_client_core_state_->WakeActionRunners();
         thread_map_.clear();
     }
 
+    void ClientCore::GracefulShutdownAllThreadTasks() {
+        UnregisterReactorSources();
+        StopTimerActionRunners();
+        p_client_core_state_->SetExecutor(nullptr, std::weak_ptr<ClientCoreState>());
+        StopThreadTasks();
+    }
+
     ClientCore::~ClientCore() {
-        thread_map_.clear();
+        UnregisterReactorSources();
+        StopTimerActionRunners();
+        p_client_core_state_->SetExecutor(nullptr, std::weak_ptr<ClientCoreState>());
+        StopThreadTasks();
     }
 }
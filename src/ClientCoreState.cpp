@@ -19,23 +19,143 @@
  *
  */
 
+#include <algorithm>
+#include <cstdint>
+
 #include "util/logging/LogMacros.hpp"
 
 #include "ClientCoreState.hpp"
 
-#ifndef MAX_CORE_ACTION_PROCESSING_RATE_HZ
-#define MAX_CORE_ACTION_PROCESSING_RATE_HZ 5
-#endif
-
 #define LOG_TAG_CLIENT_CORE_STATE "[Client Core State]"
 
 namespace awsiotsdk {
-    ClientCoreState::ClientCoreState() {
+    ClientCoreState::ClientCoreState()
+        : pending_ack_table_(DEFAULT_PENDING_ACK_TABLE_CAPACITY), control_action_queue_(DEFAULT_CONTROL_ACTION_QUEUE_SIZE) {
         continue_execution_ = std::make_shared<std::atomic_bool>(true);
         max_queue_size_ = DEFAULT_MAX_QUEUE_SIZE;
+        overflow_policy_ = ActionQueueOverflowPolicy::REJECT;
+        overflow_block_timeout_ms_ = 0;
+        outbound_action_queues_.push_back(
+            std::unique_ptr<OutboundActionQueue>(new OutboundActionQueue(DEFAULT_MAX_QUEUE_SIZE)));
+        p_outbound_action_queue_ = outbound_action_queues_.back().get();
+        has_retired_outbound_action_queues_ = false;
+        active_enqueue_count_ = 0;
+        is_outbound_processing_waiting_ = false;
+        blocked_enqueue_count_ = 0;
+        max_write_batch_size_bytes_ = DEFAULT_MAX_WRITE_BATCH_SIZE_BYTES;
+        max_write_batch_delay_ms_ = DEFAULT_MAX_WRITE_BATCH_DELAY_MS;
         max_hardware_threads_ = std::thread::hardware_concurrency();
         cur_core_threads_ = 0;
         next_action_id_ = 1;
+        ack_timeout_ms_ = DEFAULT_ACK_TIMEOUT_MS;
+        next_ack_expiry_ = std::chrono::steady_clock::time_point::max().time_since_epoch().count();
+        executor_generation_ = 0;
+        is_outbound_task_running_ = false;
+        has_executor_ = false;
+        is_outbound_task_scheduled_ = false;
+        has_held_outbound_action_ = false;
+        next_outbound_task_wakeup_ = 0;
+        last_outbound_action_time_ = 0;
+    }
+
+    ClientCoreState::BatchedWriteConnection::BatchedWriteConnection(
+        std::shared_ptr<NetworkConnection> p_network_connection) {
+        p_network_connection_ = p_network_connection;
+        pending_write_bytes_ = 0;
+        flush_rc_ = ResponseCode::SUCCESS;
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::FlushPendingWrites() {
+        if (pending_writes_.empty()) {
+            return ResponseCode::SUCCESS;
+        }
+
+        // The output buffer may have moved while growing, ranges are resolved once it is complete
+        for (size_t i = 0; i < pending_writes_.size(); i++) {
+            if (SIZE_MAX != pending_write_offsets_[i]) {
+                pending_writes_[i].p_data_ = output_buffer_.data() + pending_write_offsets_[i];
+            }
+        }
+
+        size_t size_written_bytes = 0;
+        ResponseCode rc = p_network_connection_->WriteGathered(pending_writes_, size_written_bytes);
+        pending_writes_.clear();
+        pending_write_offsets_.clear();
+        // Keeps the capacity for the next batch
+        output_buffer_.clear();
+        pending_write_bytes_ = 0;
+        if (ResponseCode::SUCCESS != rc && ResponseCode::SUCCESS == flush_rc_) {
+            flush_rc_ = rc;
+        }
+        return rc;
+    }
+
+    void ClientCoreState::BatchedWriteConnection::CopyToOutputBuffer(const char *p_data, size_t length) {
+        size_t offset = output_buffer_.length();
+        output_buffer_.append(p_data, length);
+        if (!pending_write_offsets_.empty() && SIZE_MAX != pending_write_offsets_.back()) {
+            // Directly follows the previous copied write
+            pending_writes_.back().length_ += length;
+        } else {
+            NetworkWriteSegment pending_write;
+            pending_write.p_data_ = nullptr;
+            pending_write.length_ = length;
+            pending_writes_.push_back(std::move(pending_write));
+            pending_write_offsets_.push_back(offset);
+        }
+        pending_write_bytes_ += length;
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::EndBatch() {
+        FlushPendingWrites();
+        ResponseCode rc = flush_rc_;
+        flush_rc_ = ResponseCode::SUCCESS;
+        return rc;
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::ConnectInternal() {
+        return p_network_connection_->Connect();
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::WriteInternal(const util::String &buf,
+                                                                        size_t &size_written_bytes_out) {
+        CopyToOutputBuffer(buf.data(), buf.length());
+        size_written_bytes_out = buf.length();
+        return ResponseCode::SUCCESS;
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::WriteGatheredInternal(
+        const util::Vector<NetworkWriteSegment> &segments, size_t &size_written_bytes_out) {
+        size_written_bytes_out = 0;
+        for (const NetworkWriteSegment &segment : segments) {
+            // Segments without an owner may not outlive this call, copy them
+            if (nullptr == segment.p_owner_) {
+                CopyToOutputBuffer(segment.p_data_, segment.length_);
+            } else {
+                pending_writes_.push_back(segment);
+                pending_write_offsets_.push_back(SIZE_MAX);
+                pending_write_bytes_ += segment.length_;
+            }
+            size_written_bytes_out += segment.length_;
+        }
+        return ResponseCode::SUCCESS;
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::ReadInternal(util::Vector<unsigned char> &buf,
+                                                                       size_t buf_read_offset,
+                                                                       size_t size_bytes_to_read,
+                                                                       size_t &size_read_bytes_out) {
+        // A response can't arrive for a request that is still buffered
+        ResponseCode rc = FlushPendingWrites();
+        if (ResponseCode::SUCCESS != rc) {
+            return rc;
+        }
+        return p_network_connection_->Read(buf, buf_read_offset, size_bytes_to_read, size_read_bytes_out);
+    }
+
+    ResponseCode ClientCoreState::BatchedWriteConnection::DisconnectInternal() {
+        FlushPendingWrites();
+        return p_network_connection_->Disconnect();
     }
 
     ClientCoreState::~ClientCoreState() {
@@ -66,18 +186,160 @@ namespace awsiotsdk {
         return rc;
     }
 
+    void ClientCoreState::SetMaxActionQueueSize(size_t max_queue_size) {
+        if (0 == max_queue_size) {
+            max_queue_size = 1;
+        }
+
+        {
+            std::lock_guard<std::mutex> resize_lock(outbound_action_queue_resize_lock_);
+            OutboundActionQueue *p_cur_queue = p_outbound_action_queue_;
+            max_queue_size_ = max_queue_size;
+            if (p_cur_queue->Capacity() == max_queue_size) {
+                return;
+            }
+
+            if (!has_retired_outbound_action_queues_ && 0 == active_enqueue_count_) {
+                // Free queues left over from a previous resize, see PopOutboundAction
+                outbound_action_queues_.erase(outbound_action_queues_.begin(), outbound_action_queues_.end() - 1);
+            }
+
+            // Producers that still hold the old queue fail to push once it is closed and retry on the new one.
+            // The outbound processing thread drains the old queue first to preserve ordering
+            outbound_action_queues_.push_back(
+                std::unique_ptr<OutboundActionQueue>(new OutboundActionQueue(max_queue_size)));
+            p_outbound_action_queue_ = outbound_action_queues_.back().get();
+            p_cur_queue->Close();
+            has_retired_outbound_action_queues_ = true;
+        }
+
+        std::lock_guard<std::mutex> space_lock(outbound_action_queue_space_lock_);
+        outbound_action_queue_space_wait_.notify_all();
+    }
+
+    bool ClientCoreState::PushOutboundAction(OutboundAction &action) {
+        bool is_pushed = false;
+        OutboundActionQueue *p_queue = p_outbound_action_queue_;
+        while (!(is_pushed = p_queue->TryPush(action)) && p_queue->IsClosed()) {
+            p_queue = p_outbound_action_queue_;
+        }
+
+        // Push is sequentially consistent, pairs with the processing thread setting the flag before checking the queue
+        if (is_pushed && is_outbound_processing_waiting_) {
+            std::lock_guard<std::mutex> queue_lock(outbound_action_queue_lock_);
+            outbound_action_queue_wait_.notify_one();
+        }
+        if (is_pushed) {
+            ScheduleOutboundActionTask();
+        }
+
+        return is_pushed;
+    }
+
+    bool ClientCoreState::PopOutboundAction(OutboundAction &action) {
+        if (has_retired_outbound_action_queues_) {
+            std::lock_guard<std::mutex> resize_lock(outbound_action_queue_resize_lock_);
+            util::Vector<std::unique_ptr<OutboundActionQueue>>::iterator itr = outbound_action_queues_.begin();
+            for (; itr + 1 != outbound_action_queues_.end(); itr++) {
+                if ((*itr)->TryPop(action)) {
+                    return true;
+                }
+                if (!(*itr)->IsDrained()) {
+                    // A push that started before the queue was closed has not completed yet
+                    return false;
+                }
+            }
+            // Enqueue requests that start after this point can only be using the current queue. Queues that are
+            // still referenced by running requests are freed on the next resize
+            if (0 == active_enqueue_count_) {
+                outbound_action_queues_.erase(outbound_action_queues_.begin(), outbound_action_queues_.end() - 1);
+            }
+            has_retired_outbound_action_queues_ = false;
+        }
+
+        OutboundActionQueue *p_queue = p_outbound_action_queue_;
+        return p_queue->TryPop(action);
+    }
+
     ResponseCode
     ClientCoreState::EnqueueOutboundAction(ActionType action_type, std::shared_ptr<ActionData> p_action_data,
                                            uint16_t &action_id_out) {
-        if (outbound_action_queue_.size() >= max_queue_size_) {
-            // TODO : Add option to overwrite oldest action
+        uint16_t action_id = GetNextActionId();
+        p_action_data->SetActionId(action_id);
+        OutboundAction action = std::make_pair(action_type, p_action_data);
+        util::Vector<OutboundAction> dropped_actions;
+
+        active_enqueue_count_++;
+        bool is_pushed = PushOutboundAction(action);
+        if (!is_pushed) {
+            ActionQueueOverflowPolicy overflow_policy = overflow_policy_;
+            if (ActionQueueOverflowPolicy::OVERWRITE_OLDEST == overflow_policy) {
+                do {
+                    OutboundAction dropped_action;
+                    OutboundActionQueue *p_queue = p_outbound_action_queue_;
+                    if (p_queue->TryPop(dropped_action)) {
+                        dropped_actions.push_back(std::move(dropped_action));
+                    }
+                    is_pushed = PushOutboundAction(action);
+                } while (!is_pushed);
+            } else if (ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT == overflow_policy) {
+                std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now()
+                    + std::chrono::milliseconds(overflow_block_timeout_ms_);
+                std::unique_lock<std::mutex> space_lock(outbound_action_queue_space_lock_);
+                blocked_enqueue_count_++;
+                // Count is incremented before retrying so a pop that races with the retry always notifies
+                while (!(is_pushed = PushOutboundAction(action))
+                    && std::cv_status::no_timeout == outbound_action_queue_space_wait_.wait_until(space_lock,
+                                                                                                    deadline)) {
+                }
+                blocked_enqueue_count_--;
+            }
+        }
+        active_enqueue_count_--;
+
+        for (OutboundAction &dropped_action : dropped_actions) {
+            AWS_LOG_WARN(LOG_TAG_CLIENT_CORE_STATE,
+                         "Outbound action queue full, dropping oldest queued action with ID : %u",
+                         dropped_action.second->GetActionId());
+            if (nullptr != dropped_action.second->p_async_ack_handler_) {
+                dropped_action.second->p_async_ack_handler_(dropped_action.second->GetActionId(),
+                                                            ResponseCode::ACTION_QUEUE_FULL);
+            }
+        }
+
+        if (!is_pushed) {
             return ResponseCode::ACTION_QUEUE_FULL;
         }
 
-        action_id_out = GetNextActionId();
-        p_action_data->SetActionId(action_id_out);
-        outbound_action_queue_.push(std::make_pair(action_type, p_action_data));
+        action_id_out = action_id;
+        return ResponseCode::SUCCESS;
+    }
 
+    ResponseCode
+    ClientCoreState::EnqueueControlAction(ActionType action_type, std::shared_ptr<ActionData> p_action_data,
+                                          uint16_t &action_id_out) {
+        uint16_t action_id = GetNextActionId();
+        p_action_data->SetActionId(action_id);
+        ResponseCode rc = RequeueControlAction(action_type, p_action_data);
+        if (ResponseCode::SUCCESS == rc) {
+            action_id_out = action_id;
+        }
+        return rc;
+    }
+
+    ResponseCode
+    ClientCoreState::RequeueControlAction(ActionType action_type, std::shared_ptr<ActionData> p_action_data) {
+        OutboundAction action = std::make_pair(action_type, p_action_data);
+        if (!control_action_queue_.TryPush(action)) {
+            return ResponseCode::ACTION_QUEUE_FULL;
+        }
+
+        // Push is sequentially consistent, pairs with the processing thread setting the flag before checking the queue
+        if (is_outbound_processing_waiting_) {
+            std::lock_guard<std::mutex> queue_lock(outbound_action_queue_lock_);
+            outbound_action_queue_wait_.notify_one();
+        }
+        ScheduleOutboundActionTask();
         return ResponseCode::SUCCESS;
     }
 
@@ -94,142 +356,550 @@ namespace awsiotsdk {
         return rc;
     }
 
-    void ClientCoreState::SyncActionHandler(uint16_t action_id, ResponseCode rc) {
-        std::lock_guard<std::mutex> block_handler_lock(sync_action_response_lock_);
-        sync_action_response_ = rc;
-        sync_action_response_wait_.notify_all();
-    }
-
     ResponseCode ClientCoreState::PerformAction(ActionType action_type, std::shared_ptr<ActionData> p_action_data,
                                                 std::chrono::milliseconds action_reponse_timeout) {
-        std::lock_guard<std::mutex> sync_action_lock(sync_action_request_lock_);
-        ResponseCode rc = ResponseCode::FAILURE;
-
         util::Map<ActionType, std::unique_ptr<Action>>::const_iterator itr = action_map_.find(action_type);
         if (itr == action_map_.end()) {
-            rc = ResponseCode::ACTION_NOT_REGISTERED_ERROR;
-        } else {
-            std::unique_lock<std::mutex> block_handler_lock(sync_action_response_lock_);
+            return ResponseCode::ACTION_NOT_REGISTERED_ERROR;
+        }
+
+        std::shared_ptr<SyncActionResponse> p_sync_response = std::make_shared<SyncActionResponse>();
+        p_sync_response->response_ = ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR;
+        p_sync_response->is_response_received_ = false;
+        // The handler only references the waiter, so a response arriving after the call returns is ignored safely
+        p_action_data->p_async_ack_handler_ = [p_sync_response](uint16_t action_id, ResponseCode rc) {
+            std::lock_guard<std::mutex> response_lock(p_sync_response->response_lock_);
+            p_sync_response->response_ = rc;
+            p_sync_response->is_response_received_ = true;
+            p_sync_response->response_wait_.notify_all();
+        };
+        p_action_data->SetActionId(GetNextActionId());
+
+        ResponseCode rc;
+        {
+            // Only held while writing, waiting for the response does not block other actions
+            std::lock_guard<std::mutex> perform_action_lock(perform_action_lock_);
+            rc = itr->second->PerformAction(p_network_connection_, p_action_data);
+        }
+        if (ResponseCode::SUCCESS != rc) {
+            return rc;
+        }
+        last_outbound_action_time_ = std::chrono::steady_clock::now().time_since_epoch().count();
+
+        bool is_ack_pending;
+        {
+            std::lock_guard<std::mutex> ack_lock(ack_map_lock_);
+            is_ack_pending = pending_ack_table_.Contains(p_action_data->GetActionId());
+        }
+
+        std::unique_lock<std::mutex> response_lock(p_sync_response->response_lock_);
+        if (is_ack_pending
+            && !p_sync_response->response_wait_.wait_for(response_lock, action_reponse_timeout, [p_sync_response] {
+                return p_sync_response->is_response_received_;
+            })) {
+            response_lock.unlock();
+            // Stop waiting for the response so that the Action ID can be reused
+            DeletePendingAck(p_action_data->GetActionId());
+            response_lock.lock();
+        }
+
+        if (p_sync_response->is_response_received_) {
+            rc = p_sync_response->response_;
+        } else if (is_ack_pending) {
+            rc = ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR;
+        }
+        return rc;
+    }
+
+    ResponseCode ClientCoreState::SetActionRateLimit(ActionType action_type, double max_actions_per_second,
+                                                     size_t burst_size) {
+        if (0 >= max_actions_per_second || 0 == burst_size) {
+            return ResponseCode::FAILURE;
+        }
+
+        std::unique_ptr<ActionRateLimitData> p_rate_limit_data =
+            std::unique_ptr<ActionRateLimitData>(new ActionRateLimitData());
+        p_rate_limit_data->tokens_per_second_ = max_actions_per_second;
+        p_rate_limit_data->max_tokens_ = static_cast<double>(burst_size);
+        p_rate_limit_data->available_tokens_ = p_rate_limit_data->max_tokens_;
+        p_rate_limit_data->last_refill_time_ = std::chrono::steady_clock::now();
+
+        std::lock_guard<std::mutex> rate_limit_lock(action_rate_limit_lock_);
+        action_rate_limit_map_[action_type] = std::move(p_rate_limit_data);
+        return ResponseCode::SUCCESS;
+    }
+
+    void ClientCoreState::ClearActionRateLimit(ActionType action_type) {
+        std::lock_guard<std::mutex> rate_limit_lock(action_rate_limit_lock_);
+        action_rate_limit_map_.erase(action_type);
+    }
+
+    std::chrono::milliseconds ClientCoreState::AcquireActionRateLimitToken(ActionType action_type) {
+        std::lock_guard<std::mutex> rate_limit_lock(action_rate_limit_lock_);
+        util::Map<ActionType, std::unique_ptr<ActionRateLimitData>>::const_iterator itr =
+            action_rate_limit_map_.find(action_type);
+        if (itr == action_rate_limit_map_.end()) {
+            return std::chrono::milliseconds(0);
+        }
+
+        ActionRateLimitData &rate_limit = *(itr->second);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> elapsed = now - rate_limit.last_refill_time_;
+        rate_limit.available_tokens_ = std::min(rate_limit.max_tokens_,
+                                                rate_limit.available_tokens_
+                                                    + elapsed.count() * rate_limit.tokens_per_second_);
+        rate_limit.last_refill_time_ = now;
+
+        if (1.0 <= rate_limit.available_tokens_) {
+            rate_limit.available_tokens_ -= 1.0;
+            return std::chrono::milliseconds(0);
+        }
+
+        // Round up so the token is guaranteed to be available when the wait ends
+        double wait_ms = (1.0 - rate_limit.available_tokens_) * 1000 / rate_limit.tokens_per_second_;
+        return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(wait_ms) + 1);
+    }
+
+    bool ClientCoreState::PopOutboundActionUntil(OutboundAction &action,
+                                                 std::chrono::steady_clock::time_point deadline) {
+        bool is_popped = process_queued_actions_ && PopOutboundAction(action);
+        if (!is_popped && std::chrono::steady_clock::now() < deadline) {
+            // Wake up as soon as an action is enqueued
             {
-                sync_action_response_ = ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR;
-                p_action_data->p_async_ack_handler_ = std::bind(&ClientCoreState::SyncActionHandler, this,
-                                                                std::placeholders::_1, std::placeholders::_2);
-                p_action_data->SetActionId(GetNextActionId());
-                rc = itr->second->PerformAction(p_network_connection_, p_action_data);
+                std::unique_lock<std::mutex> queue_lock(outbound_action_queue_lock_);
+                is_outbound_processing_waiting_ = true;
+                outbound_action_queue_wait_.wait_until(queue_lock, deadline, [this] {
+                    OutboundActionQueue *p_queue = p_outbound_action_queue_;
+                    return process_queued_actions_
+                        && (0 < p_queue->Size() || has_retired_outbound_action_queues_
+                            || 0 < control_action_queue_.Size());
+                });
+                is_outbound_processing_waiting_ = false;
             }
+            is_popped = process_queued_actions_ && PopOutboundAction(action);
+        }
+
+        if (is_popped && 0 < blocked_enqueue_count_) {
+            std::lock_guard<std::mutex> space_lock(outbound_action_queue_space_lock_);
+            outbound_action_queue_space_wait_.notify_one();
+        }
+
+        return is_popped;
+    }
+
+    void ClientCoreState::WaitForControlActionsUntil(std::chrono::steady_clock::time_point deadline) {
+        std::unique_lock<std::mutex> queue_lock(outbound_action_queue_lock_);
+        is_outbound_processing_waiting_ = true;
+        outbound_action_queue_wait_.wait_until(queue_lock, deadline, [this] {
+            return process_queued_actions_ && 0 < control_action_queue_.Size();
+        });
+        is_outbound_processing_waiting_ = false;
+    }
 
-            if (ResponseCode::SUCCESS == rc
-                && pending_ack_map_.find(p_action_data->GetActionId()) != pending_ack_map_.end()) {
-                sync_action_response_wait_.wait_for(block_handler_lock, action_reponse_timeout);
-                rc = sync_action_response_;
+    size_t ClientCoreState::DispatchControlActions(std::shared_ptr<NetworkConnection> p_network_connection) {
+        size_t dispatched_count = 0;
+        OutboundAction control_action;
+        while (process_queued_actions_) {
+            if (!control_action_queue_.TryPop(control_action)) {
+                if (0 == EnqueueDeferredControlActions()) {
+                    break;
+                }
+                continue;
+            }
+            DispatchOutboundAction(control_action, p_network_connection);
+            dispatched_count++;
+        }
+        return dispatched_count;
+    }
+
+    ResponseCode ClientCoreState::DispatchOutboundAction(OutboundAction &action,
+                                                         std::shared_ptr<NetworkConnection> p_network_connection) {
+        ResponseCode rc = ResponseCode::SUCCESS;
+        std::shared_ptr<ActionData> p_action_data = std::move(action.second);
+        util::Map<ActionType, std::unique_ptr<Action>>::const_iterator itr = action_map_.find(action.first);
+        ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler = p_action_data->p_async_ack_handler_;
+        if (itr != action_map_.end()) {
+            if (nullptr != p_async_ack_handler) {
+                // Add Ack before sending request. Read request runs in separate thread and may receive response
+                // before ack is added, if we add it after sending the request.
+                rc = RegisterPendingAck(p_action_data->GetActionId(), p_async_ack_handler);
+                if (ResponseCode::SUCCESS != rc) {
+                    p_async_ack_handler(p_action_data->GetActionId(), rc);
+                    AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
+                                  "Registering Ack Handler for Outbound Queued Action failed. %s",
+                                  ResponseHelper::ToString(rc).c_str());
+                }
+            }
+            // rc will be ResponseCode::SUCCESS by default at this point if no Ack handler was provided
+            if (ResponseCode::SUCCESS == rc) {
+                rc = itr->second->PerformQueuedAction(p_network_connection, p_action_data);
+                if (ResponseCode::SUCCESS == rc) {
+                    last_outbound_action_time_ = std::chrono::steady_clock::now().time_since_epoch().count();
+                } else {
+                    if (nullptr != p_async_ack_handler) {
+                        // Delete waiting for Ack for Failed Actions
+                        DeletePendingAck(p_action_data->GetActionId());
+                        p_async_ack_handler(p_action_data->GetActionId(), rc);
+                    }
+                    AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
+                                  "Performing Outbound Queued Action failed. %s",
+                                  ResponseHelper::ToString(rc).c_str());
+                }
             }
+        } else {
+            rc = ResponseCode::ACTION_NOT_REGISTERED_ERROR;
+            AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
+                          "Performing Outbound Queued Action failed. %s",
+                          ResponseHelper::ToString(rc).c_str());
         }
 
         return rc;
     }
 
     void ClientCoreState::ProcessOutboundActionQueue(std::shared_ptr<std::atomic_bool> thread_task_out_sync) {
-        ResponseCode rc = ResponseCode::SUCCESS;
-        int action_execution_delay = 1000 / MAX_CORE_ACTION_PROCESSING_RATE_HZ;
         std::atomic_bool &_thread_task_out_sync = *thread_task_out_sync;
+        std::chrono::milliseconds max_wait_duration(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS);
+        std::shared_ptr<BatchedWriteConnection> p_batch_connection;
+        util::Vector<std::pair<uint16_t, ActionData::AsyncAckNotificationHandlerPtr>> batched_acks;
+        OutboundAction next_action;
+        bool has_next_action = false;
+        if (has_held_outbound_action_) {
+            // Left over by an outbound task before the executor was removed
+            next_action = std::move(held_outbound_action_);
+            has_next_action = true;
+            has_held_outbound_action_ = false;
+        }
         do {
-            // Reset ResponseCode state
-            rc = ResponseCode::SUCCESS;
-            if (/*!process_queued_actions_ || */outbound_action_queue_.empty()) {
-                std::this_thread::sleep_for(std::chrono::milliseconds(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS));
-                continue;
+            DeleteExpiredAcks();
+            if (!has_next_action) {
+                // The timeout only exists so the thread sync point is checked periodically. Returns early without
+                // an action if control actions are queued
+                has_next_action = PopOutboundActionUntil(next_action,
+                                                         std::chrono::steady_clock::now() + max_wait_duration);
             }
-            std::lock_guard<std::mutex> sync_action_lock(sync_action_request_lock_);
-            auto next = std::chrono::system_clock::now() + std::chrono::milliseconds(action_execution_delay);
-            ActionType action_type = outbound_action_queue_.front().first;
-            std::shared_ptr<ActionData> p_action_data = outbound_action_queue_.front().second;
-
-            outbound_action_queue_.pop();
-            util::Map<ActionType, std::unique_ptr<Action>>::const_iterator itr = action_map_.find(action_type);
-            ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler = p_action_data->p_async_ack_handler_;
-            if (itr != action_map_.end()) {
-                if (nullptr != p_async_ack_handler) {
-                    // Add Ack before sending request. Read request runs in separate thread and may receive response
-                    // before ack is added, if we add it after sending the request.
-                    rc = RegisterPendingAck(p_action_data->GetActionId(), p_async_ack_handler);
-                    if (ResponseCode::SUCCESS != rc) {
-                        p_async_ack_handler(p_action_data->GetActionId(), rc);
-                        AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
-                                      "Registering Ack Handler for Outbound Queued Action failed. %s",
-                                      ResponseHelper::ToString(rc).c_str());
+
+            // The dequeued action is held until it can be dispatched so that ordering is preserved
+            std::chrono::milliseconds rate_limit_delay(0);
+            if (has_next_action) {
+                rate_limit_delay = AcquireActionRateLimitToken(next_action.first);
+            }
+
+            if (!has_next_action || 0 < rate_limit_delay.count()) {
+                if (!process_queued_actions_ || 0 == control_action_queue_.Size()) {
+                    if (has_next_action) {
+                        // Control actions are not held back by the rate limit of the next queued action
+                        WaitForControlActionsUntil(std::chrono::steady_clock::now()
+                                                       + std::min(rate_limit_delay, max_wait_duration));
                     }
+                    continue;
                 }
-                // rc will be ResponseCode::SUCCESS by default at this point if no Ack handler was provided
-                if (ResponseCode::SUCCESS == rc) {
-                    rc = itr->second->PerformAction(p_network_connection_, p_action_data);
-                    if (ResponseCode::SUCCESS != rc) {
-                        if (nullptr != p_async_ack_handler) {
-                            // Delete waiting for Ack for Failed Actions
-                            DeletePendingAck(p_action_data->GetActionId());
-                            p_async_ack_handler(p_action_data->GetActionId(), rc);
-                        }
-                        AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
-                                      "Performing Outbound Queued Action failed. %s",
-                                      ResponseHelper::ToString(rc).c_str());
-                    }
+
+                std::lock_guard<std::mutex> perform_action_lock(perform_action_lock_);
+                if (0 == max_write_batch_size_bytes_) {
+                    DispatchControlActions(p_network_connection_);
+                    continue;
                 }
-            } else {
-                rc = ResponseCode::ACTION_NOT_REGISTERED_ERROR;
-                AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
-                              "Performing Outbound Queued Action failed. %s",
-                              ResponseHelper::ToString(rc).c_str());
-            }
-            // This is not perfect since we have no control over how long an action takes.
-            // But it will definitely ensure that we don't exceed the max rate
-            std::this_thread::sleep_until(next);
+                if (nullptr == p_batch_connection) {
+                    p_batch_connection = std::make_shared<BatchedWriteConnection>(p_network_connection_);
+                }
+                DispatchControlActions(p_batch_connection);
+                ResponseCode rc = p_batch_connection->EndBatch();
+                if (ResponseCode::SUCCESS != rc) {
+                    AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
+                                  "Writing batch of Control Actions failed. %s",
+                                  ResponseHelper::ToString(rc).c_str());
+                }
+                continue;
+            }
+
+            // Held for the whole batch so that sync actions are not written ahead of buffered async actions
+            std::lock_guard<std::mutex> perform_action_lock(perform_action_lock_);
+            size_t max_batch_size_bytes = max_write_batch_size_bytes_;
+            if (0 == max_batch_size_bytes) {
+                DispatchControlActions(p_network_connection_);
+                has_next_action = false;
+                DispatchOutboundAction(next_action, p_network_connection_);
+                continue;
+            }
+
+            if (nullptr == p_batch_connection) {
+                p_batch_connection = std::make_shared<BatchedWriteConnection>(p_network_connection_);
+            }
+
+            std::chrono::steady_clock::time_point batch_deadline = std::chrono::steady_clock::now()
+                + std::chrono::milliseconds(max_write_batch_delay_ms_.load());
+            do {
+                // Control actions queued while the batch is filled go out ahead of the next queued action
+                DispatchControlActions(p_batch_connection);
+                std::shared_ptr<ActionData> p_action_data = next_action.second;
+                has_next_action = false;
+                if (ResponseCode::SUCCESS == DispatchOutboundAction(next_action, p_batch_connection)
+                    && nullptr != p_action_data->p_async_ack_handler_) {
+                    batched_acks.push_back(std::make_pair(p_action_data->GetActionId(),
+                                                          p_action_data->p_async_ack_handler_));
+                }
+
+                if (p_batch_connection->GetPendingWriteBytes() >= max_batch_size_bytes
+                    || !PopOutboundActionUntil(next_action, batch_deadline)) {
+                    break;
+                }
+                has_next_action = true;
+            } while (0 == AcquireActionRateLimitToken(next_action.first).count());
+
+            EndOutboundActionBatch(*p_batch_connection, batched_acks);
         } while (_thread_task_out_sync);
     }
 
+    void ClientCoreState::EndOutboundActionBatch(
+        BatchedWriteConnection &batch_connection,
+        util::Vector<std::pair<uint16_t, ActionData::AsyncAckNotificationHandlerPtr>> &batched_acks) {
+        ResponseCode rc = batch_connection.EndBatch();
+        if (ResponseCode::SUCCESS != rc) {
+            // Actions in the batch succeeded individually but nothing they wrote may have reached the network
+            for (std::pair<uint16_t, ActionData::AsyncAckNotificationHandlerPtr> &batched_ack : batched_acks) {
+                if (DeletePendingAck(batched_ack.first)) {
+                    batched_ack.second(batched_ack.first, rc);
+                }
+            }
+            AWS_LOG_ERROR(LOG_TAG_CLIENT_CORE_STATE,
+                          "Writing batch of Outbound Queued Actions failed. %s",
+                          ResponseHelper::ToString(rc).c_str());
+        }
+        batched_acks.clear();
+    }
+
+    void ClientCoreState::SetExecutor(std::shared_ptr<util::Threading::Executor> p_executor,
+                                      std::weak_ptr<ClientCoreState> p_state) {
+        {
+            std::unique_lock<std::mutex> executor_lock(executor_lock_);
+            p_executor_ = p_executor;
+            p_executor_state_ = p_state;
+            has_executor_ = (nullptr != p_executor);
+            // Tasks that were submitted before return without processing actions once they run
+            executor_generation_++;
+            outbound_task_wait_.wait(executor_lock, [this] {
+                return !is_outbound_task_running_;
+            });
+            is_outbound_task_scheduled_ = false;
+        }
+
+        // Picks up actions that were queued before
+        ScheduleOutboundActionTask();
+    }
+
+    void ClientCoreState::ScheduleOutboundActionTask() {
+        // A task that is already scheduled checks the queues again before it returns
+        if (!has_executor_ || is_outbound_task_scheduled_) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> executor_lock(executor_lock_);
+        if (nullptr == p_executor_ || is_outbound_task_scheduled_) {
+            return;
+        }
+        std::weak_ptr<ClientCoreState> p_state = p_executor_state_;
+        uint64_t executor_generation = executor_generation_;
+        ResponseCode rc = p_executor_->Submit([p_state, executor_generation] {
+            std::shared_ptr<ClientCoreState> p_client_state = p_state.lock();
+            if (nullptr != p_client_state) {
+                p_client_state->RunOutboundActionTask(executor_generation);
+            }
+        });
+        is_outbound_task_scheduled_ = (ResponseCode::SUCCESS == rc);
+    }
+
+    void ClientCoreState::ScheduleOutboundActionTaskAt(std::chrono::steady_clock::time_point wakeup_time) {
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (!has_executor_ || wakeup_time <= now) {
+            ScheduleOutboundActionTask();
+            return;
+        }
+
+        std::chrono::steady_clock::rep pending_wakeup = next_outbound_task_wakeup_;
+        if (pending_wakeup > now.time_since_epoch().count()
+            && pending_wakeup <= wakeup_time.time_since_epoch().count()) {
+            return;
+        }
+        next_outbound_task_wakeup_ = wakeup_time.time_since_epoch().count();
+
+        std::lock_guard<std::mutex> executor_lock(executor_lock_);
+        if (nullptr == p_executor_) {
+            return;
+        }
+        std::weak_ptr<ClientCoreState> p_state = p_executor_state_;
+        // Round up so the task does not run before the wakeup time
+        std::chrono::milliseconds delay
+            = std::chrono::duration_cast<std::chrono::milliseconds>(wakeup_time - now) + std::chrono::milliseconds(1);
+        p_executor_->SubmitAfter(delay, [p_state] {
+            std::shared_ptr<ClientCoreState> p_client_state = p_state.lock();
+            if (nullptr != p_client_state) {
+                p_client_state->ScheduleOutboundActionTask();
+            }
+        });
+    }
+
+    void ClientCoreState::RunOutboundActionTask(uint64_t executor_generation) {
+        {
+            std::lock_guard<std::mutex> executor_lock(executor_lock_);
+            if (executor_generation != executor_generation_) {
+                return;
+            }
+            is_outbound_task_running_ = true;
+        }
+
+        std::chrono::steady_clock::time_point wakeup_time = ProcessOutboundActionTask();
+
+        {
+            std::lock_guard<std::mutex> executor_lock(executor_lock_);
+            is_outbound_task_running_ = false;
+            is_outbound_task_scheduled_ = false;
+            outbound_task_wait_.notify_all();
+        }
+
+        // Actions queued while this task was scheduled did not submit a task of their own
+        OutboundActionQueue *p_queue = p_outbound_action_queue_;
+        if (process_queued_actions_
+            && (0 < control_action_queue_.Size()
+                || (!has_held_outbound_action_ && (0 < p_queue->Size() || has_retired_outbound_action_queues_)))) {
+            ScheduleOutboundActionTask();
+            return;
+        }
+
+        std::chrono::steady_clock::time_point ack_expiry_time
+            = std::chrono::steady_clock::time_point(std::chrono::steady_clock::duration(next_ack_expiry_.load()));
+        wakeup_time = std::min(wakeup_time, ack_expiry_time);
+        if (std::chrono::steady_clock::time_point::max() != wakeup_time) {
+            ScheduleOutboundActionTaskAt(wakeup_time);
+        }
+    }
+
+    std::chrono::steady_clock::time_point ClientCoreState::ProcessOutboundActionTask() {
+        DeleteExpiredAcks();
+
+        // Held for the whole task so that sync actions are not written ahead of buffered async actions
+        std::lock_guard<std::mutex> perform_action_lock(perform_action_lock_);
+        size_t max_batch_size_bytes = max_write_batch_size_bytes_;
+        std::shared_ptr<NetworkConnection> p_network_connection = p_network_connection_;
+        if (0 < max_batch_size_bytes) {
+            if (nullptr == p_outbound_task_batch_connection_) {
+                p_outbound_task_batch_connection_ = std::make_shared<BatchedWriteConnection>(p_network_connection_);
+            }
+            p_network_connection = p_outbound_task_batch_connection_;
+        }
+
+        std::chrono::steady_clock::time_point wakeup_time = std::chrono::steady_clock::time_point::max();
+        size_t dispatched_count = 0;
+        while (process_queued_actions_ && OUTBOUND_ACTION_TASK_MAX_ACTIONS > dispatched_count) {
+            // Control actions are not held back by the rate limit of the next queued action
+            dispatched_count += DispatchControlActions(p_network_connection);
+            if (!has_held_outbound_action_) {
+                if (!PopOutboundAction(held_outbound_action_)) {
+                    break;
+                }
+                has_held_outbound_action_ = true;
+                if (0 < blocked_enqueue_count_) {
+                    std::lock_guard<std::mutex> space_lock(outbound_action_queue_space_lock_);
+                    outbound_action_queue_space_wait_.notify_one();
+                }
+            }
+
+            std::chrono::milliseconds rate_limit_delay = AcquireActionRateLimitToken(held_outbound_action_.first);
+            if (0 < rate_limit_delay.count()) {
+                wakeup_time = std::chrono::steady_clock::now() + rate_limit_delay;
+                break;
+            }
+
+            std::shared_ptr<ActionData> p_action_data = held_outbound_action_.second;
+            has_held_outbound_action_ = false;
+            if (ResponseCode::SUCCESS == DispatchOutboundAction(held_outbound_action_, p_network_connection)
+                && 0 < max_batch_size_bytes && nullptr != p_action_data->p_async_ack_handler_) {
+                outbound_task_batched_acks_.push_back(std::make_pair(p_action_data->GetActionId(),
+                                                                     p_action_data->p_async_ack_handler_));
+            }
+            dispatched_count++;
+
+            if (0 < max_batch_size_bytes
+                && p_outbound_task_batch_connection_->GetPendingWriteBytes() >= max_batch_size_bytes) {
+                EndOutboundActionBatch(*p_outbound_task_batch_connection_, outbound_task_batched_acks_);
+            }
+        }
+
+        if (0 < max_batch_size_bytes) {
+            EndOutboundActionBatch(*p_outbound_task_batch_connection_, outbound_task_batched_acks_);
+        }
+        return wakeup_time;
+    }
+
     ResponseCode ClientCoreState::RegisterPendingAck(uint16_t action_id,
                                                      ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler) {
         if (nullptr == p_async_ack_handler) {
             return ResponseCode::NULL_VALUE_ERROR;
         }
 
-        std::unique_ptr<PendingAckData> p_pending_ack_data = std::unique_ptr<PendingAckData>(new PendingAckData());
-        p_pending_ack_data->p_async_ack_handler_ = p_async_ack_handler;
-        p_pending_ack_data->time_of_request_ = std::chrono::system_clock::now();
+        std::chrono::steady_clock::time_point expiry_time = std::chrono::steady_clock::now()
+            + std::chrono::milliseconds(ack_timeout_ms_.load());
 
-        std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
-        pending_ack_map_.insert(std::make_pair(action_id, std::move(p_pending_ack_data)));
+        ActionData::AsyncAckNotificationHandlerPtr p_replaced_handler;
+        {
+            std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
+            pending_ack_table_.Insert(action_id, std::move(p_async_ack_handler), expiry_time, p_replaced_handler);
+            next_ack_expiry_ = pending_ack_table_.GetNextExpiryTime().time_since_epoch().count();
+        }
+        // The earlier request can no longer be matched to its response, complete it so its caller is not left waiting
+        if (nullptr != p_replaced_handler) {
+            AWS_LOG_WARN(LOG_TAG_CLIENT_CORE_STATE, "Ack for Action ID %u replaced by a newer request", action_id);
+            p_replaced_handler(action_id, ResponseCode::FAILURE);
+        }
+        // Outbound tasks only run when needed, make sure one deletes the Ack if it expires
+        if (has_executor_) {
+            ScheduleOutboundActionTaskAt(expiry_time);
+        }
         return ResponseCode::SUCCESS;
     }
 
-    void ClientCoreState::DeletePendingAck(uint16_t action_id) {
+    bool ClientCoreState::DeletePendingAck(uint16_t action_id) {
         std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
-        util::Map<uint16_t, std::unique_ptr<PendingAckData>>::const_iterator itr = pending_ack_map_.find(action_id);
-        if (itr != pending_ack_map_.end()) {
-            pending_ack_map_.erase(itr);
-        }
+        bool is_deleted = pending_ack_table_.Remove(action_id, nullptr);
+        next_ack_expiry_ = pending_ack_table_.GetNextExpiryTime().time_since_epoch().count();
+        return is_deleted;
     }
 
     void ClientCoreState::DeleteExpiredAcks() {
-        std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        util::Map<uint16_t, std::unique_ptr<PendingAckData>>::const_iterator itr = pending_ack_map_.begin();
-        while (itr != pending_ack_map_.end()) {
-            std::chrono::seconds diff = std::chrono::duration_cast<std::chrono::seconds>(
-                now - itr->second->time_of_request_);
-            if (diff > ack_timeout_) {
-                itr->second->p_async_ack_handler_(itr->first, ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR);
-                pending_ack_map_.erase(itr);
-            }
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        // Avoid taking the lock on every pass of the outbound thread when nothing has expired
+        if (now.time_since_epoch().count() < next_ack_expiry_) {
+            return;
         }
+
+        uint16_t action_id;
+        ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler;
+        do {
+            {
+                std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
+                bool is_expired = pending_ack_table_.PopExpired(now, action_id, p_async_ack_handler);
+                next_ack_expiry_ = pending_ack_table_.GetNextExpiryTime().time_since_epoch().count();
+                if (!is_expired) {
+                    break;
+                }
+            }
+            // Handlers are called without holding the lock as they may register or delete Acks
+            AWS_LOG_WARN(LOG_TAG_CLIENT_CORE_STATE, "Ack for Action ID %u timed out", action_id);
+            p_async_ack_handler(action_id, ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR);
+            p_async_ack_handler = nullptr;
+        } while (true);
     }
 
     void ClientCoreState::ForwardReceivedAck(uint16_t action_id, ResponseCode rc) {
-        std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
-        // No response code because all Acks might not have registered handlers. No other possible error
-        util::Map<uint16_t, std::unique_ptr<PendingAckData>>::const_iterator itr = pending_ack_map_.find(action_id);
-        if (itr != pending_ack_map_.end()) {
-            itr->second->p_async_ack_handler_(action_id, rc);
-            pending_ack_map_.erase(itr);
+        ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler;
+        {
+            std::lock_guard<std::mutex> sync_action_lock(ack_map_lock_);
+            // No response code because all Acks might not have registered handlers. No other possible error
+            if (!pending_ack_table_.Remove(action_id, &p_async_ack_handler)) {
+                return;
+            }
+            next_ack_expiry_ = pending_ack_table_.GetNextExpiryTime().time_since_epoch().count();
         }
+        p_async_ack_handler(action_id, rc);
     }
 
     void ClientCoreState::ClearRegisteredActions() {
@@ -237,6 +907,11 @@ namespace awsiotsdk {
     }
 
     void ClientCoreState::ClearOutboundActionQueue() {
-        util::Queue<std::pair<ActionType, std::shared_ptr<ActionData>>>().swap(outbound_action_queue_);
+        std::lock_guard<std::mutex> resize_lock(outbound_action_queue_resize_lock_);
+        OutboundAction action;
+        for (std::unique_ptr<OutboundActionQueue> &p_queue : outbound_action_queues_) {
+            while (p_queue->TryPop(action)) {
+            }
+        }
     }
 }
\ No newline at end of file
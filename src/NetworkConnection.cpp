@@ -22,6 +22,9 @@
  *
  */
 
+#include <algorithm>
+#include <thread>
+
 #include "util/memory/stl/String.hpp"
 #include "NetworkConnection.hpp"
 
@@ -47,6 +50,82 @@ namespace awsiotsdk {
         return rc;
     }
 
+    ResponseCode NetworkConnection::WriteGathered(const util::Vector<NetworkWriteSegment> &segments,
+                                                  size_t &size_written_bytes_out) {
+        ResponseCode rc;
+        std::lock_guard<std::mutex> write_guard(write_mutex);
+        {
+            // Check connection state before calling internal write
+            if (IsConnected()) {
+                rc = WriteGatheredInternal(segments, size_written_bytes_out);
+            } else {
+                rc = ResponseCode::NETWORK_DISCONNECTED_ERROR;
+            }
+        }
+        return rc;
+    }
+
+    ResponseCode NetworkConnection::WriteGatheredInternal(const util::Vector<NetworkWriteSegment> &segments,
+                                                          size_t &size_written_bytes_out) {
+        size_written_bytes_out = 0;
+
+        // Implementations may write partially, keep writing until done or failed
+        auto write_buffer = [this, &size_written_bytes_out](const util::String &buf) {
+            size_t buf_written_bytes = 0;
+            ResponseCode rc = ResponseCode::SUCCESS;
+            while (ResponseCode::SUCCESS == rc && buf_written_bytes < buf.length()) {
+                size_t cur_written_bytes = 0;
+                rc = (0 == buf_written_bytes) ? WriteInternal(buf, cur_written_bytes)
+                                              : WriteInternal(buf.substr(buf_written_bytes), cur_written_bytes);
+                if (ResponseCode::SUCCESS == rc && 0 == cur_written_bytes) {
+                    rc = ResponseCode::NETWORK_SSL_WRITE_ERROR;
+                }
+                buf_written_bytes += cur_written_bytes;
+            }
+            size_written_bytes_out += buf_written_bytes;
+            return rc;
+        };
+
+        // Large buffers that are already a complete util::String are written without copying
+        auto is_direct_write = [](const NetworkWriteSegment &segment) {
+            return nullptr != segment.p_owner_ && GATHERED_WRITE_MIN_DIRECT_SEGMENT_BYTES <= segment.length_
+                && segment.p_owner_->data() == segment.p_data_ && segment.p_owner_->length() == segment.length_;
+        };
+
+        size_t copied_length = 0;
+        for (const NetworkWriteSegment &segment : segments) {
+            if (!is_direct_write(segment)) {
+                copied_length += segment.length_;
+            }
+        }
+
+        util::String buf;
+        buf.reserve(copied_length);
+        ResponseCode rc = ResponseCode::SUCCESS;
+        for (const NetworkWriteSegment &segment : segments) {
+            if (!is_direct_write(segment)) {
+                buf.append(segment.p_data_, segment.length_);
+                continue;
+            }
+
+            if (!buf.empty()) {
+                rc = write_buffer(buf);
+                buf.clear();
+            }
+            if (ResponseCode::SUCCESS == rc) {
+                rc = write_buffer(*segment.p_owner_);
+            }
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
+            }
+        }
+
+        if (!buf.empty()) {
+            rc = write_buffer(buf);
+        }
+        return rc;
+    }
+
     ResponseCode NetworkConnection::Read(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                          size_t size_bytes_to_read, size_t &size_read_bytes_out) {
         ResponseCode rc;
@@ -62,6 +141,49 @@ namespace awsiotsdk {
         return rc;
     }
 
+    ResponseCode NetworkConnection::ReadAvailable(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                                  size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                                  size_t &size_read_bytes_out) {
+        ResponseCode rc;
+        std::lock_guard<std::mutex> read_guard(read_mutex);
+        {
+            // Check connection state before calling internal read
+            if (IsConnected()) {
+                rc = ReadAvailableInternal(buf, buf_read_offset, min_bytes_to_read, max_bytes_to_read,
+                                           size_read_bytes_out);
+            } else {
+                rc = ResponseCode::NETWORK_DISCONNECTED_ERROR;
+            }
+        }
+        return rc;
+    }
+
+    ResponseCode NetworkConnection::ReadAvailableInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                                          size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                                          size_t &size_read_bytes_out) {
+        return ReadInternal(buf, buf_read_offset, std::min(min_bytes_to_read, max_bytes_to_read),
+                            size_read_bytes_out);
+    }
+
+    ResponseCode NetworkConnection::WaitForReadable(std::chrono::milliseconds timeout) {
+        ResponseCode rc;
+        std::lock_guard<std::mutex> read_guard(read_mutex);
+        {
+            // Check connection state before calling internal wait
+            if (IsConnected()) {
+                rc = WaitForReadableInternal(timeout);
+            } else {
+                rc = ResponseCode::NETWORK_DISCONNECTED_ERROR;
+            }
+        }
+        return rc;
+    }
+
+    ResponseCode NetworkConnection::WaitForReadableInternal(std::chrono::milliseconds timeout) {
+        std::this_thread::sleep_for(timeout);
+        return ResponseCode::SUCCESS;
+    }
+
     ResponseCode NetworkConnection::Disconnect() {
         // Disconnect irrespective of state of other requests
         std::lock(read_mutex, write_mutex);
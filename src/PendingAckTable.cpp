@@ -0,0 +1,178 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file PendingAckTable.cpp
+ * @brief
+ *
+ */
+
+#include "PendingAckTable.hpp"
+
+namespace awsiotsdk {
+    const size_t PendingAckTable::NO_SLOT;
+
+    PendingAckTable::PendingAckTable(size_t initial_capacity) {
+        size_t capacity = 1;
+        while (capacity < initial_capacity) {
+            capacity <<= 1;
+        }
+
+        slots_.resize(capacity);
+        buckets_.assign(capacity, NO_SLOT);
+        for (size_t itr = 0; itr < capacity; itr++) {
+            slots_[itr].next_in_bucket_ = (itr + 1 < capacity) ? itr + 1 : NO_SLOT;
+        }
+        free_slot_ = 0;
+        first_by_expiry_ = NO_SLOT;
+        last_by_expiry_ = NO_SLOT;
+        size_ = 0;
+    }
+
+    size_t PendingAckTable::FindSlot(uint16_t action_id, size_t &prev_in_bucket_out) {
+        prev_in_bucket_out = NO_SLOT;
+        size_t slot_index = buckets_[action_id & (buckets_.size() - 1)];
+        while (NO_SLOT != slot_index && action_id != slots_[slot_index].action_id_) {
+            prev_in_bucket_out = slot_index;
+            slot_index = slots_[slot_index].next_in_bucket_;
+        }
+        return slot_index;
+    }
+
+    void PendingAckTable::FreeSlot(size_t slot_index, size_t prev_in_bucket) {
+        Slot &slot = slots_[slot_index];
+
+        if (NO_SLOT == prev_in_bucket) {
+            buckets_[slot.action_id_ & (buckets_.size() - 1)] = slot.next_in_bucket_;
+        } else {
+            slots_[prev_in_bucket].next_in_bucket_ = slot.next_in_bucket_;
+        }
+
+        if (NO_SLOT == slot.prev_by_expiry_) {
+            first_by_expiry_ = slot.next_by_expiry_;
+        } else {
+            slots_[slot.prev_by_expiry_].next_by_expiry_ = slot.next_by_expiry_;
+        }
+        if (NO_SLOT == slot.next_by_expiry_) {
+            last_by_expiry_ = slot.prev_by_expiry_;
+        } else {
+            slots_[slot.next_by_expiry_].prev_by_expiry_ = slot.prev_by_expiry_;
+        }
+
+        slot.p_async_ack_handler_ = nullptr;
+        slot.next_in_bucket_ = free_slot_;
+        free_slot_ = slot_index;
+        size_--;
+    }
+
+    void PendingAckTable::Grow() {
+        size_t old_capacity = slots_.size();
+        size_t new_capacity = old_capacity << 1;
+
+        // Only called when every slot is in use, so the expiry list stays valid and only buckets need rebuilding
+        slots_.resize(new_capacity);
+        buckets_.assign(new_capacity, NO_SLOT);
+        for (size_t itr = 0; itr < old_capacity; itr++) {
+            size_t bucket = slots_[itr].action_id_ & (new_capacity - 1);
+            slots_[itr].next_in_bucket_ = buckets_[bucket];
+            buckets_[bucket] = itr;
+        }
+        for (size_t itr = old_capacity; itr < new_capacity; itr++) {
+            slots_[itr].next_in_bucket_ = (itr + 1 < new_capacity) ? itr + 1 : NO_SLOT;
+        }
+        free_slot_ = old_capacity;
+    }
+
+    void PendingAckTable::Insert(uint16_t action_id, ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                 std::chrono::steady_clock::time_point expiry_time,
+                                 ActionData::AsyncAckNotificationHandlerPtr &p_replaced_handler_out) {
+        p_replaced_handler_out = nullptr;
+        Remove(action_id, &p_replaced_handler_out);
+
+        if (NO_SLOT == free_slot_) {
+            Grow();
+        }
+
+        size_t slot_index = free_slot_;
+        Slot &slot = slots_[slot_index];
+        free_slot_ = slot.next_in_bucket_;
+
+        slot.action_id_ = action_id;
+        slot.expiry_time_ = expiry_time;
+        slot.p_async_ack_handler_ = std::move(p_async_ack_handler);
+
+        size_t bucket = action_id & (buckets_.size() - 1);
+        slot.next_in_bucket_ = buckets_[bucket];
+        buckets_[bucket] = slot_index;
+
+        // Acks normally share one timeout, so the new entry almost always belongs at the tail
+        size_t prev_by_expiry = last_by_expiry_;
+        while (NO_SLOT != prev_by_expiry && slots_[prev_by_expiry].expiry_time_ > expiry_time) {
+            prev_by_expiry = slots_[prev_by_expiry].prev_by_expiry_;
+        }
+        slot.prev_by_expiry_ = prev_by_expiry;
+        if (NO_SLOT == prev_by_expiry) {
+            slot.next_by_expiry_ = first_by_expiry_;
+            first_by_expiry_ = slot_index;
+        } else {
+            slot.next_by_expiry_ = slots_[prev_by_expiry].next_by_expiry_;
+            slots_[prev_by_expiry].next_by_expiry_ = slot_index;
+        }
+        if (NO_SLOT == slot.next_by_expiry_) {
+            last_by_expiry_ = slot_index;
+        } else {
+            slots_[slot.next_by_expiry_].prev_by_expiry_ = slot_index;
+        }
+
+        size_++;
+    }
+
+    bool PendingAckTable::Remove(uint16_t action_id,
+                                 ActionData::AsyncAckNotificationHandlerPtr *p_async_ack_handler_out) {
+        size_t prev_in_bucket;
+        size_t slot_index = FindSlot(action_id, prev_in_bucket);
+        if (NO_SLOT == slot_index) {
+            return false;
+        }
+
+        if (nullptr != p_async_ack_handler_out) {
+            *p_async_ack_handler_out = std::move(slots_[slot_index].p_async_ack_handler_);
+        }
+        FreeSlot(slot_index, prev_in_bucket);
+        return true;
+    }
+
+    bool PendingAckTable::Contains(uint16_t action_id) {
+        size_t prev_in_bucket;
+        return NO_SLOT != FindSlot(action_id, prev_in_bucket);
+    }
+
+    bool PendingAckTable::PopExpired(std::chrono::steady_clock::time_point now, uint16_t &action_id_out,
+                                     ActionData::AsyncAckNotificationHandlerPtr &p_async_ack_handler_out) {
+        if (NO_SLOT == first_by_expiry_ || slots_[first_by_expiry_].expiry_time_ > now) {
+            return false;
+        }
+
+        action_id_out = slots_[first_by_expiry_].action_id_;
+        return Remove(action_id_out, &p_async_ack_handler_out);
+    }
+
+    std::chrono::steady_clock::time_point PendingAckTable::GetNextExpiryTime() {
+        if (NO_SLOT == first_by_expiry_) {
+            return std::chrono::steady_clock::time_point::max();
+        }
+        return slots_[first_by_expiry_].expiry_time_;
+    }
+}
@@ -232,6 +232,12 @@ namespace awsiotsdk {
             case ResponseCode::MQTT_SUBSCRIBE_FAILED:
                 os << awsiotsdk::ResponseHelper::MQTT_SUBSCRIBE_FAILED_STRING;
                 break;
+            case ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR:
+                os << awsiotsdk::ResponseHelper::MQTT_INFLIGHT_WINDOW_FULL_ERROR_STRING;
+                break;
+            case ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR:
+                os << awsiotsdk::ResponseHelper::MQTT_OFFLINE_STORE_FULL_ERROR_STRING;
+                break;
             case ResponseCode::JSON_PARSE_KEY_NOT_FOUND_ERROR:
                 os << awsiotsdk::ResponseHelper::JSON_PARSE_KEY_NOT_FOUND_ERROR_STRING;
                 break;
@@ -168,8 +168,19 @@ namespace awsiotsdk {
             return ResponseCode::MQTT_INVALID_DATA_ERROR;
         }
         std::shared_ptr<mqtt::PublishPacket> p_publish_packet
-            = std::make_shared<mqtt::PublishPacket>(std::move(p_topic_name), is_retained, is_duplicate, qos,
-                                                    payload);
+            = p_client_state_->AcquirePublishPacket(std::move(p_topic_name), is_retained, is_duplicate, qos, payload);
+        return p_client_core_->PerformAction(ActionType::PUBLISH, p_publish_packet, action_response_timeout);
+    }
+
+    ResponseCode MqttClient::Publish(std::unique_ptr<Utf8String> p_topic_name, bool is_retained, bool is_duplicate,
+                                     mqtt::QoS qos, std::shared_ptr<const util::String> p_payload,
+                                     std::chrono::milliseconds action_response_timeout) {
+        if (nullptr == p_topic_name) {
+            return ResponseCode::MQTT_INVALID_DATA_ERROR;
+        }
+        std::shared_ptr<mqtt::PublishPacket> p_publish_packet
+            = p_client_state_->AcquirePublishPacket(std::move(p_topic_name), is_retained, is_duplicate, qos,
+                                                    std::move(p_payload));
         return p_client_core_->PerformAction(ActionType::PUBLISH, p_publish_packet, action_response_timeout);
     }
 
@@ -211,9 +222,25 @@ namespace awsiotsdk {
         }
 
         std::shared_ptr<mqtt::PublishPacket> p_publish_packet =
-            std::make_shared<mqtt::PublishPacket>(std::move(p_topic_name), is_retained, is_duplicate, qos, payload);
-        p_publish_packet->p_async_ack_handler_ = p_async_ack_handler;
-        return p_client_core_->PerformActionAsync(ActionType::PUBLISH, p_publish_packet, packet_id_out);
+            p_client_state_->AcquirePublishPacket(std::move(p_topic_name), is_retained, is_duplicate, qos, payload);
+        return p_client_state_->EnqueuePublish(p_publish_packet, p_async_ack_handler, packet_id_out);
+    }
+
+    ResponseCode MqttClient::PublishAsync(std::unique_ptr<Utf8String> p_topic_name,
+                                          bool is_retained,
+                                          bool is_duplicate,
+                                          mqtt::QoS qos,
+                                          std::shared_ptr<const util::String> p_payload,
+                                          ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                          uint16_t &packet_id_out) {
+        if (nullptr == p_topic_name) {
+            return ResponseCode::MQTT_INVALID_DATA_ERROR;
+        }
+
+        std::shared_ptr<mqtt::PublishPacket> p_publish_packet =
+            p_client_state_->AcquirePublishPacket(std::move(p_topic_name), is_retained, is_duplicate, qos,
+                                                  std::move(p_payload));
+        return p_client_state_->EnqueuePublish(p_publish_packet, p_async_ack_handler, packet_id_out);
     }
 
     ResponseCode MqttClient::SubscribeAsync(util::Vector<std::shared_ptr<mqtt::Subscription>> subscription_list,
@@ -295,6 +322,9 @@ namespace awsiotsdk {
         // wait for all running threads to finish respective tasks
         p_client_core_->GracefulShutdownAllThreadTasks();
 
+        // Dispatcher is stopped once the application releases it too
+        p_client_state_->SetInboundDispatcher(nullptr);
+
         // p_client_state_.action_map_ and p_client_state_.outbound_action_queue_ retains p_client_state_
         // hence, calling p_client_state_->RegisterAction() or p_client_state_->EnqueueOutboundAction() introduces cyclic references inside p_client_state_
         // make sure that p_client_state_.action_map_ and p_client_state_.outbound_action_queue_ are cleared prior to p_client_state_ destructor
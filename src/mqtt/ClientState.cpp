@@ -19,16 +19,23 @@
  *
  */
 
-#include <regex>
+#include <algorithm>
+#include <cstdint>
+
+#include "util/logging/LogMacros.hpp"
 
 #include "mqtt/ClientState.hpp"
+#include "mqtt/Publish.hpp"
+
+#define CLIENT_STATE_LOG_TAG "[Client State]"
 
 #define MIN_RECONNECT_BACKOFF_DEFAULT_SEC 1
 #define MAX_RECONNECT_BACKOFF_DEFAULT_SEC 128
 
 namespace awsiotsdk {
     namespace mqtt {
-        ClientState::ClientState(std::chrono::milliseconds mqtt_command_timeout) {
+        ClientState::ClientState(std::chrono::milliseconds mqtt_command_timeout)
+            : publish_packet_pool_(DEFAULT_PACKET_POOL_SIZE), puback_packet_pool_(DEFAULT_PACKET_POOL_SIZE) {
             is_session_present_ = false;
             is_connected_ = false;
             is_pingreq_pending_ = false;
@@ -36,56 +43,72 @@ namespace awsiotsdk {
             is_auto_reconnect_enabled_ = true;
             last_sent_packet_id_ = 0;
             mqtt_command_timeout_ = mqtt_command_timeout;
+            SetAckTimeout(mqtt_command_timeout);
             p_connect_data_ = nullptr;
             min_reconnect_backoff_timeout_ = std::chrono::seconds(MIN_RECONNECT_BACKOFF_DEFAULT_SEC);
             max_reconnect_backoff_timeout_ = std::chrono::seconds(MAX_RECONNECT_BACKOFF_DEFAULT_SEC);
+            SetReconnectBackoffStrategy(nullptr);
+            last_resubscribe_duration_ms_ = -1;
+            max_inflight_publishes_ = DEFAULT_MAX_INFLIGHT_PUBLISHES;
+            deferred_resend_count_ = 0;
+            inflight_publishes_.reserve(max_inflight_publishes_);
+            p_offline_publish_store_ = nullptr;
+            SetOfflinePublishDrainRate(DEFAULT_OFFLINE_PUBLISH_DRAIN_RATE_PER_SECOND);
+            last_inbound_activity_time_ = 0;
+            is_keepalive_wakeup_pending_ = false;
+            p_keepalive_wakeup_handler_ = nullptr;
         }
         std::shared_ptr<ClientState> ClientState::Create(std::chrono::milliseconds mqtt_command_timeout) {
             return std::make_shared<ClientState>(mqtt_command_timeout);
         }
 
+        void ClientState::SetReconnectBackoffStrategy(
+            std::shared_ptr<ReconnectBackoffStrategy> p_reconnect_backoff_strategy) {
+            if (nullptr == p_reconnect_backoff_strategy) {
+                // Devices losing their connection at once should not reconnect in lockstep
+                p_reconnect_backoff_strategy = FullJitterBackoffStrategy::Create();
+            }
+            p_reconnect_backoff_strategy_ = p_reconnect_backoff_strategy;
+        }
+
         uint16_t ClientState::GetNextPacketId() {
-            if (UINT16_MAX == last_sent_packet_id_) {
+            uint16_t last_sent_packet_id = last_sent_packet_id_.load();
+            uint16_t next_packet_id;
+            // Called concurrently by enqueuing threads
+            do {
                 // 0 is reserved for CONNACK
-                last_sent_packet_id_ = 1;
-            } else {
-                ++last_sent_packet_id_;
-            }
-            return last_sent_packet_id_;
+                next_packet_id = static_cast<uint16_t>(UINT16_MAX == last_sent_packet_id ? 1 : last_sent_packet_id + 1);
+            } while (!last_sent_packet_id_.compare_exchange_weak(last_sent_packet_id, next_packet_id));
+            return next_packet_id;
         }
 
         std::shared_ptr<Subscription> ClientState::GetSubscription(util::String p_topic_name) {
-            std::shared_ptr<Subscription> p_sub = nullptr;
-
-            util::Map<util::String, std::shared_ptr<Subscription >>::const_iterator find_itr =
-                std::find_if(subscription_map_.begin(),
-                             subscription_map_.end(),
-                             [p_topic_name](const std::pair<util::String, std::shared_ptr<Subscription>> &s) -> bool {
-                                 if (s.first == p_topic_name) {
-                                     return true;
-                                 }
-                                 if (0 < s.second->p_topic_regex_.length()) {
-                                     std::regex wildcard_regex(s.second->p_topic_regex_, std::regex::ECMAScript);
-                                     return std::regex_match(p_topic_name.c_str(),
-                                                             wildcard_regex);
-                                 }
-                                 return false;
-                             });
-            if (find_itr != subscription_map_.end()) {
-                p_sub = find_itr->second;
+            util::Vector<std::shared_ptr<Subscription>> matches;
+            subscription_registry_.GetSnapshot()->GetMatchingSubscriptions(p_topic_name, matches);
+            if (matches.empty()) {
+                return nullptr;
             }
+            return matches.front();
+        }
 
-            return p_sub;
+        void ClientState::GetMatchingSubscriptions(const util::String &topic_name,
+                                                   util::Vector<std::shared_ptr<Subscription>> &matches) {
+            subscription_registry_.GetSnapshot()->GetMatchingSubscriptions(topic_name, matches);
+        }
+
+        ResponseCode ClientState::AddSubscription(std::shared_ptr<Subscription> p_subscription) {
+            if (nullptr == p_subscription) {
+                return ResponseCode::NULL_VALUE_ERROR;
+            }
+            return subscription_registry_.Add(p_subscription) ? ResponseCode::SUCCESS : ResponseCode::FAILURE;
         }
 
         std::shared_ptr<Subscription> ClientState::SetSubscriptionPacketInfo(util::String p_topic_name,
                                                                              uint16_t packet_id,
                                                                              uint8_t index_in_packet) {
-            std::shared_ptr<Subscription> p_sub = nullptr;
-            util::Map<util::String, std::shared_ptr<Subscription >>::const_iterator
-                itr = subscription_map_.find(p_topic_name);
-            if (itr != subscription_map_.end()) {
-                itr->second->SetAckIndex(packet_id, index_in_packet);
+            std::shared_ptr<Subscription> p_sub = subscription_registry_.GetSnapshot()->Find(p_topic_name);
+            if (nullptr != p_sub) {
+                p_sub->SetAckIndex(packet_id, index_in_packet);
             }
 
             return p_sub;
@@ -95,50 +118,390 @@ namespace awsiotsdk {
                                                         uint8_t index_in_sub_packet,
                                                         mqtt::QoS max_qos) {
             ResponseCode rc = ResponseCode::FAILURE;
-            util::Map<util::String, std::shared_ptr<Subscription >>::const_iterator itr = subscription_map_.begin();
-            while (itr != subscription_map_.end()) {
-                if (itr->second->IsInSuback(packet_id, index_in_sub_packet)) {
-                    itr->second->SetActive(true);
-                    itr->second->SetMaxQos(max_qos);
-                    itr->second->SetAckIndex(0, 0); // Reset Packet index to prevent corruptions when packetid cycles back
+            // Subscription state is atomic, updated in place without publishing a new snapshot
+            std::shared_ptr<const SubscriptionRegistry::Snapshot> p_snapshot = subscription_registry_.GetSnapshot();
+            for (auto &itr : p_snapshot->subscription_map_) {
+                if (itr.second->IsInSuback(packet_id, index_in_sub_packet)) {
+                    itr.second->SetMaxQos(max_qos);
+                    itr.second->SetActive(true);
+                    itr.second->SetAckIndex(0, 0); // Reset Packet index to prevent corruptions when packetid cycles back
                     rc = ResponseCode::SUCCESS;
                     break;
                 }
-                itr++;
             }
             return rc;
         }
 
         ResponseCode ClientState::RemoveSubscription(util::String p_topic_name) {
-            subscription_map_.erase(p_topic_name);
+            subscription_registry_.Remove(p_topic_name);
             return ResponseCode::SUCCESS;
         }
 
         ResponseCode ClientState::RemoveSubscription(uint16_t packet_id, uint8_t index_in_sub_packet) {
-            ResponseCode rc = ResponseCode::FAILURE;
-            util::Map<util::String, std::shared_ptr<Subscription >>::const_iterator itr = subscription_map_.begin();
-            while (itr != subscription_map_.end()) {
-                if (itr->second->IsInSuback(packet_id, index_in_sub_packet)) {
-                    itr = subscription_map_.erase(itr);
+            size_t removed_count = subscription_registry_.RemoveIf(
+                [packet_id, index_in_sub_packet](const std::shared_ptr<Subscription> &p_subscription) -> bool {
+                    return p_subscription->IsInSuback(packet_id, index_in_sub_packet);
+                }, 1);
+            return (0 < removed_count) ? ResponseCode::SUCCESS : ResponseCode::FAILURE;
+        }
+
+        ResponseCode ClientState::RemoveAllSubscriptionsForPacketId(uint16_t packet_id) {
+            size_t removed_count = subscription_registry_.RemoveIf(
+                [packet_id](const std::shared_ptr<Subscription> &p_subscription) -> bool {
+                    return p_subscription->GetPacketId() == packet_id;
+                }, SIZE_MAX);
+            return (0 < removed_count) ? ResponseCode::SUCCESS : ResponseCode::FAILURE;
+        }
+    
+        void ClientState::SetMaxInflightPublishes(size_t max_inflight_publishes) {
+            if (0 == max_inflight_publishes) {
+                max_inflight_publishes = 1;
+            }
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            max_inflight_publishes_ = max_inflight_publishes;
+            inflight_publishes_.reserve(max_inflight_publishes_);
+        }
+
+        size_t ClientState::GetMaxInflightPublishes() {
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            return max_inflight_publishes_;
+        }
+
+        size_t ClientState::GetInflightPublishCount() {
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            return inflight_publishes_.size();
+        }
+
+        ResponseCode ClientState::AddInflightPublish(std::shared_ptr<PublishPacket> p_publish_packet) {
+            if (nullptr == p_publish_packet) {
+                return ResponseCode::NULL_VALUE_ERROR;
+            }
+
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            if (inflight_publishes_.size() >= max_inflight_publishes_) {
+                return ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR;
+            }
+
+            InflightPublishData inflight_publish;
+            inflight_publish.p_publish_packet_ = std::move(p_publish_packet);
+            inflight_publish.is_sent_ = false;
+            inflight_publish.is_resend_deferred_ = false;
+            inflight_publish.is_resend_queued_ = false;
+            inflight_publishes_.push_back(std::move(inflight_publish));
+            return ResponseCode::SUCCESS;
+        }
+
+        void ClientState::SetInflightPublishSent(uint16_t packet_id) {
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            for (InflightPublishData &inflight_publish : inflight_publishes_) {
+                if (packet_id == inflight_publish.p_publish_packet_->GetPacketId()) {
+                    inflight_publish.is_sent_ = true;
+                    inflight_publish.is_resend_queued_ = false;
                     break;
                 }
-                itr++;
             }
-            return rc;
         }
 
-        ResponseCode ClientState::RemoveAllSubscriptionsForPacketId(uint16_t packet_id) {
-            ResponseCode rc = ResponseCode::FAILURE;
-            util::Map<util::String, std::shared_ptr<Subscription >>::const_iterator itr = subscription_map_.begin();
-            while (itr != subscription_map_.end()) {
-                if (itr->second->GetPacketId() == packet_id) {
-                    itr = subscription_map_.erase(itr);
-                } else {
-                    itr++;
+        void ClientState::RemoveInflightPublish(uint16_t packet_id) {
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            util::Vector<InflightPublishData>::iterator itr = inflight_publishes_.begin();
+            for (; itr != inflight_publishes_.end(); itr++) {
+                if (packet_id == itr->p_publish_packet_->GetPacketId()) {
+                    if (itr->is_resend_deferred_) {
+                        deferred_resend_count_--;
+                    }
+                    // Erase keeps the remaining publishes in send order, the window is small
+                    inflight_publishes_.erase(itr);
+                    break;
+                }
+            }
+        }
+
+        bool ClientState::KeepInflightPublish(uint16_t packet_id, ResponseCode ack_rc) {
+            // A timeout on a working connection means the broker is not going to acknowledge the publish
+            if (ResponseCode::SUCCESS == ack_rc || (ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR == ack_rc
+                && IsConnected() && !IsAutoReconnectRequired())) {
+                return false;
+            }
+
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            for (InflightPublishData &inflight_publish : inflight_publishes_) {
+                if (packet_id == inflight_publish.p_publish_packet_->GetPacketId()) {
+                    // A resend that failed is no longer queued, it is queued again after the next reconnect
+                    inflight_publish.is_resend_queued_ = false;
+                    return inflight_publish.is_sent_;
+                }
+            }
+            return false;
+        }
+
+        void ClientState::ResendInflightPublishes() {
+            bool is_duplicate = IsSessionPresent();
+
+            {
+                std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+                for (InflightPublishData &inflight_publish : inflight_publishes_) {
+                    // Publishes still waiting to be sent again after an earlier reconnect are not queued twice
+                    if (!inflight_publish.is_sent_ || inflight_publish.is_resend_deferred_
+                        || inflight_publish.is_resend_queued_) {
+                        continue;
+                    }
+
+                    inflight_publish.p_publish_packet_->SetDuplicate(is_duplicate);
+                    inflight_publish.is_resend_deferred_ = true;
+                    deferred_resend_count_++;
+                    // The Ack is registered again when the publish is sent, restarting its timeout
+                    DeletePendingAck(inflight_publish.p_publish_packet_->GetPacketId());
+                }
+            }
+            EnqueueDeferredControlActions();
+        }
+
+        size_t ClientState::EnqueueDeferredControlActions() {
+            if (0 == deferred_resend_count_) {
+                return 0;
+            }
+
+            size_t queued_count = 0;
+            std::lock_guard<std::mutex> inflight_lock(inflight_publish_lock_);
+            for (InflightPublishData &inflight_publish : inflight_publishes_) {
+                if (!inflight_publish.is_resend_deferred_) {
+                    continue;
                 }
+                // The packet ID is kept so a broker with the session present recognizes the duplicate
+                if (ResponseCode::SUCCESS != RequeueControlAction(ActionType::PUBLISH,
+                                                                  inflight_publish.p_publish_packet_)) {
+                    // The control queue is not empty, the rest are queued once it is drained
+                    break;
+                }
+                inflight_publish.is_resend_deferred_ = false;
+                inflight_publish.is_resend_queued_ = true;
+                deferred_resend_count_--;
+                queued_count++;
+            }
+            return queued_count;
+        }
+    
+        ResponseCode ClientState::EnqueuePublish(std::shared_ptr<PublishPacket> p_publish_packet,
+                                                 ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                                 uint16_t &packet_id_out) {
+            if (QoS::QOS0 == p_publish_packet->GetQoS()) {
+                p_publish_packet->p_async_ack_handler_ = p_async_ack_handler;
+                return EnqueueOutboundAction(ActionType::PUBLISH, p_publish_packet, packet_id_out);
+            }
+
+            std::shared_ptr<OfflinePublishStore> p_offline_publish_store = p_offline_publish_store_;
+            // Publishes are stored while earlier stored ones are pending so they are sent in order
+            if (nullptr != p_offline_publish_store
+                && (!IsConnected() || p_offline_publish_store->HasUnsentRecords())) {
+                packet_id_out = 0;
+                return StorePublish(p_publish_packet, p_async_ack_handler);
+            }
+
+            ResponseCode rc = EnqueueInflightPublish(p_publish_packet, p_async_ack_handler, packet_id_out);
+            if (ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR == rc && nullptr != p_offline_publish_store) {
+                packet_id_out = 0;
+                rc = StorePublish(p_publish_packet, p_async_ack_handler);
+            }
+            return rc;
+        }
+
+        std::shared_ptr<PublishPacket> ClientState::AcquirePublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                                                                         bool is_retained,
+                                                                         bool is_duplicate,
+                                                                         QoS qos,
+                                                                         const util::String &payload) {
+            std::shared_ptr<PublishPacket> p_publish_packet = publish_packet_pool_.GetFree();
+            if (nullptr != p_publish_packet) {
+                p_publish_packet->Reset(std::move(p_topic_name), is_retained, is_duplicate, qos, payload);
+            } else {
+                p_publish_packet = std::make_shared<PublishPacket>(std::move(p_topic_name), is_retained,
+                                                                   is_duplicate, qos, payload);
+                publish_packet_pool_.Add(p_publish_packet);
+            }
+            return p_publish_packet;
+        }
+
+        std::shared_ptr<PublishPacket> ClientState::AcquirePublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                                                                         bool is_retained,
+                                                                         bool is_duplicate,
+                                                                         QoS qos,
+                                                                         std::shared_ptr<const util::String> p_payload) {
+            std::shared_ptr<PublishPacket> p_publish_packet = publish_packet_pool_.GetFree();
+            if (nullptr != p_publish_packet) {
+                p_publish_packet->Reset(std::move(p_topic_name), is_retained, is_duplicate, qos, std::move(p_payload));
+            } else {
+                p_publish_packet = std::make_shared<PublishPacket>(std::move(p_topic_name), is_retained,
+                                                                   is_duplicate, qos, std::move(p_payload));
+                publish_packet_pool_.Add(p_publish_packet);
+            }
+            return p_publish_packet;
+        }
+
+        std::shared_ptr<PubackPacket> ClientState::AcquirePubackPacket(uint16_t publish_packet_id) {
+            std::shared_ptr<PubackPacket> p_puback_packet = puback_packet_pool_.GetFree();
+            if (nullptr != p_puback_packet) {
+                p_puback_packet->SetPublishPacketId(publish_packet_id);
+            } else {
+                p_puback_packet = std::make_shared<PubackPacket>(publish_packet_id);
+                puback_packet_pool_.Add(p_puback_packet);
+            }
+            return p_puback_packet;
+        }
+
+        ResponseCode ClientState::EnqueueInflightPublish(std::shared_ptr<PublishPacket> p_publish_packet,
+                                                         ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler,
+                                                         uint16_t &packet_id_out) {
+            // Tracked before it is queued so the acknowledgement cannot arrive first
+            ResponseCode rc = AddInflightPublish(p_publish_packet);
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
+            }
+
+            // Handlers are only run by threads holding a reference to this instance, and the instance holds the
+            // packet, so capturing this avoids a cycle through the handler
+            p_publish_packet->p_async_ack_handler_ =
+                [this, p_async_ack_handler](uint16_t packet_id, ResponseCode ack_rc) {
+                    if (KeepInflightPublish(packet_id, ack_rc)) {
+                        return;
+                    }
+                    RemoveInflightPublish(packet_id);
+                    if (nullptr != p_async_ack_handler) {
+                        p_async_ack_handler(packet_id, ack_rc);
+                    }
+                };
+
+            rc = EnqueueOutboundAction(ActionType::PUBLISH, p_publish_packet, packet_id_out);
+            if (ResponseCode::SUCCESS != rc) {
+                RemoveInflightPublish(p_publish_packet->GetPacketId());
+            }
+            return rc;
+        }
+
+        ResponseCode ClientState::StorePublish(std::shared_ptr<PublishPacket> p_publish_packet,
+                                               ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler) {
+            uint64_t record_id = 0;
+            ResponseCode rc = p_offline_publish_store_->Append(p_publish_packet->GetTopicName(),
+                                                               *p_publish_packet->GetSharedPayload(),
+                                                               p_publish_packet->IsRetained(), record_id);
+            if (ResponseCode::SUCCESS == rc && nullptr != p_async_ack_handler) {
+                std::lock_guard<std::mutex> handler_lock(offline_publish_handler_lock_);
+                offline_publish_handlers_[record_id] = p_async_ack_handler;
+            }
+            if (ResponseCode::SUCCESS == rc && IsConnected()) {
+                // Sent by the keepalive once earlier stored publishes and the in-flight window allow
+                WakeKeepalive();
             }
             return rc;
         }
+
+        void ClientState::SetOfflinePublishDrainRate(double publishes_per_second) {
+            if (1 > publishes_per_second) {
+                publishes_per_second = 1;
+            }
+            std::lock_guard<std::mutex> drain_lock(offline_publish_drain_lock_);
+            offline_publish_drain_rate_.tokens_per_second_ = publishes_per_second;
+            offline_publish_drain_rate_.max_tokens_ = publishes_per_second;
+            offline_publish_drain_rate_.available_tokens_ = publishes_per_second;
+            offline_publish_drain_rate_.last_refill_time_ = std::chrono::steady_clock::now();
+        }
+
+        std::chrono::steady_clock::time_point ClientState::DrainOfflinePublishes() {
+            std::shared_ptr<OfflinePublishStore> p_offline_publish_store = p_offline_publish_store_;
+            if (nullptr == p_offline_publish_store || !IsConnected()) {
+                return std::chrono::steady_clock::time_point::max();
+            }
+
+            std::lock_guard<std::mutex> drain_lock(offline_publish_drain_lock_);
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            std::chrono::duration<double> elapsed = now - offline_publish_drain_rate_.last_refill_time_;
+            offline_publish_drain_rate_.available_tokens_ =
+                std::min(offline_publish_drain_rate_.max_tokens_,
+                         offline_publish_drain_rate_.available_tokens_
+                             + elapsed.count() * offline_publish_drain_rate_.tokens_per_second_);
+            offline_publish_drain_rate_.last_refill_time_ = now;
+
+            // Time until one more publish can be sent at the drain rate
+            std::chrono::duration<double> token_interval(1 / offline_publish_drain_rate_.tokens_per_second_);
+            while (IsConnected()) {
+                if (1 > offline_publish_drain_rate_.available_tokens_) {
+                    return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                        token_interval * (1 - offline_publish_drain_rate_.available_tokens_));
+                }
+
+                OfflinePublishStore::Record record;
+                if (!p_offline_publish_store->GetNextRecord(record)) {
+                    // Publishes that fail later wake up the keepalive to drain them again
+                    break;
+                }
+
+                std::shared_ptr<PublishPacket> p_publish_packet =
+                    AcquirePublishPacket(Utf8String::Create(record.topic_name_), record.is_retained_, false,
+                                         QoS::QOS1, record.p_payload_);
+                uint64_t record_id = record.record_id_;
+                ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler =
+                    [this, p_offline_publish_store, record_id](uint16_t packet_id, ResponseCode ack_rc) {
+                        if (ResponseCode::SUCCESS != ack_rc) {
+                            // Left in the store, sent again by a later drain
+                            p_offline_publish_store->ReleaseRecord(record_id);
+                            WakeKeepalive();
+                            return;
+                        }
+                        p_offline_publish_store->AcknowledgeRecord(record_id);
+
+                        ActionData::AsyncAckNotificationHandlerPtr p_app_handler = nullptr;
+                        {
+                            std::lock_guard<std::mutex> handler_lock(offline_publish_handler_lock_);
+                            util::Map<uint64_t, ActionData::AsyncAckNotificationHandlerPtr>::iterator
+                                itr = offline_publish_handlers_.find(record_id);
+                            if (offline_publish_handlers_.end() != itr) {
+                                p_app_handler = itr->second;
+                                offline_publish_handlers_.erase(itr);
+                            }
+                        }
+                        if (nullptr != p_app_handler) {
+                            p_app_handler(packet_id, ack_rc);
+                        }
+                    };
+
+                uint16_t packet_id = 0;
+                ResponseCode rc = EnqueueInflightPublish(p_publish_packet, p_async_ack_handler, packet_id);
+                if (ResponseCode::SUCCESS != rc) {
+                    // Window or queue is full, try again once the next publish could be sent
+                    p_offline_publish_store->ReleaseRecord(record_id);
+                    return now + std::chrono::duration_cast<std::chrono::steady_clock::duration>(token_interval);
+                }
+                offline_publish_drain_rate_.available_tokens_ -= 1;
+            }
+            return std::chrono::steady_clock::time_point::max();
+        }
+
+        void ClientState::WakeKeepalive() {
+            std::function<void()> p_wakeup_handler;
+            {
+                std::lock_guard<std::mutex> wakeup_lock(keepalive_wakeup_lock_);
+                is_keepalive_wakeup_pending_ = true;
+                keepalive_wakeup_wait_.notify_all();
+                p_wakeup_handler = p_keepalive_wakeup_handler_;
+            }
+            if (nullptr != p_wakeup_handler) {
+                p_wakeup_handler();
+            }
+        }
+
+        void ClientState::WaitForKeepaliveWakeup(std::chrono::steady_clock::time_point deadline) {
+            std::unique_lock<std::mutex> wakeup_lock(keepalive_wakeup_lock_);
+            if (std::chrono::steady_clock::time_point::max() == deadline) {
+                keepalive_wakeup_wait_.wait(wakeup_lock, [this] { return is_keepalive_wakeup_pending_; });
+            } else {
+                keepalive_wakeup_wait_.wait_until(wakeup_lock, deadline, [this] { return is_keepalive_wakeup_pending_; });
+            }
+            is_keepalive_wakeup_pending_ = false;
+        }
+
+        void ClientState::SetKeepaliveWakeupHandler(std::function<void()> p_wakeup_handler) {
+            std::lock_guard<std::mutex> wakeup_lock(keepalive_wakeup_lock_);
+            p_keepalive_wakeup_handler_ = p_wakeup_handler;
+        }
     }
 }
-
@@ -20,6 +20,7 @@
  */
 
 #include "mqtt/Common.hpp"
+#include <cstring>
 #include <iostream>
 
 #define SINGLE_LEVEL_WILDCARD '+'
@@ -87,6 +88,27 @@ namespace awsiotsdk {
             }
         }
 
+        char *WillOptions::WriteToBuffer(char *p_buf) {
+            size_t length = p_topic_name_->Length();
+
+            if (length > 0) {
+                *p_buf++ = (char) (length / 256);
+                *p_buf++ = (char) (length % 256);
+                std::memcpy(p_buf, p_topic_name_->GetString().data(), length);
+                p_buf += length;
+            }
+
+            length = message_.length();
+
+            if (length > 0) {
+                *p_buf++ = (char) (length / 256);
+                *p_buf++ = (char) (length % 256);
+                std::memcpy(p_buf, message_.data(), length);
+                p_buf += length;
+            }
+            return p_buf;
+        }
+
         void WillOptions::SetConnectFlags(unsigned char &p_flag) {
             if (is_retained_) {
                 p_flag |= 0x20;
@@ -157,13 +179,39 @@ namespace awsiotsdk {
                                                                   p_app_handler_data));
         }
 
+        std::shared_ptr<Subscription> Subscription::CreateWithViewHandler(std::unique_ptr<Utf8String> p_topic_name,
+                                                                          QoS max_qos,
+                                                                          ApplicationViewCallbackHandlerPtr p_app_view_handler,
+                                                                          std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data) {
+            if (nullptr == p_topic_name || nullptr == p_app_view_handler) {
+                return nullptr;
+            }
+
+            if (false == IsValidTopicName(p_topic_name->ToStdString())) {
+                return nullptr;
+            }
+
+            std::shared_ptr<Subscription> p_subscription(new Subscription(std::move(p_topic_name),
+                                                                          max_qos,
+                                                                          nullptr,
+                                                                          p_app_handler_data));
+            p_subscription->p_app_view_handler_ = p_app_view_handler;
+            return p_subscription;
+        }
+
+        ResponseCode Subscription::InvokeHandler(const MessageBufferView &topic_name, const MessageBufferView &payload) {
+            if (nullptr != p_app_view_handler_) {
+                return p_app_view_handler_(topic_name, payload, p_app_handler_data_);
+            }
+            return p_app_handler_(topic_name.ToString(), payload.ToString(), p_app_handler_data_);
+        }
+
         Subscription::Subscription(std::unique_ptr<Utf8String> p_topic_name,
                                    QoS max_qos,
                                    ApplicationCallbackHandlerPtr p_app_handler,
                                    std::shared_ptr<SubscriptionHandlerContextData> p_app_handler_data) {
             is_active_ = false;
-            index_in_packet_ = 0;
-            packet_id_ = 0;
+            ack_index_ = 0;
             p_topic_name_ = std::shared_ptr<Utf8String>(std::move(p_topic_name));
             max_qos_ = max_qos;
             p_app_handler_ = p_app_handler;
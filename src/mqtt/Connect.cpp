@@ -19,6 +19,8 @@
  *
  */
 
+#include <algorithm>
+
 #include "util/logging/LogMacros.hpp"
 
 #include "mqtt/ClientState.hpp"
@@ -176,47 +178,42 @@ namespace awsiotsdk {
                           true);
         }
 
-        util::String ConnectPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-
-            fixed_header_.AppendToBuffer(buf);
+        char *ConnectPacket::WriteToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
 
-            AppendUtf8StringToBuffer(buf, p_protocol_id_);
-            char temp = static_cast<char>(mqtt_version_);
-            buf.append(&temp, 1);
-            temp = static_cast<char>(connect_flags_);
-            buf.append(&temp, 1);
+            p_buf = WriteUtf8StringToBuffer(p_buf, *p_protocol_id_);
+            *p_buf++ = static_cast<char>(mqtt_version_);
+            *p_buf++ = static_cast<char>(connect_flags_);
 
             // Ensure the value provided for keep alive is not too large to fit
             // This can happen if the constructor was used directly instead of the Create Factory method
             // Also find out why someone would want to use such a large value
             if (UINT16_MAX < keep_alive_timeout_.count()) {
-                AppendUInt16ToBuffer(buf, static_cast<uint16_t>(UINT16_MAX));
+                p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(UINT16_MAX));
             } else {
-                AppendUInt16ToBuffer(buf, static_cast<uint16_t>(keep_alive_timeout_.count()));
+                p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(keep_alive_timeout_.count()));
             }
 
             if (nullptr == p_client_id_) {
                 // No client id provided, server should assign one
-                AppendUInt16ToBuffer(buf, static_cast<uint16_t>(0));
+                p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(0));
             } else {
-                AppendUtf8StringToBuffer(buf, p_client_id_);
+                p_buf = WriteUtf8StringToBuffer(p_buf, *p_client_id_);
             }
 
             if (nullptr != p_will_msg_) {
-                p_will_msg_->WriteToBuffer(buf);
+                p_buf = p_will_msg_->WriteToBuffer(p_buf);
             }
 
             if (nullptr != p_username_) {
-                AppendUtf8StringToBuffer(buf, p_username_);
+                p_buf = WriteUtf8StringToBuffer(p_buf, *p_username_);
             }
 
             /*if(nullptr != p_password_) {
-                AppendUtf8StringToBuffer(buf, p_password_);;
+                p_buf = WriteUtf8StringToBuffer(p_buf, *p_password_);
             }*/
 
-            return buf;
+            return p_buf;
         }
 
         /***********************************************
@@ -232,13 +229,8 @@ namespace awsiotsdk {
             return std::make_shared<DisconnectPacket>();
         }
 
-        util::String DisconnectPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-
-            fixed_header_.AppendToBuffer(buf);
-
-            return buf;
+        char *DisconnectPacket::WriteToBuffer(char *p_buf) {
+            return fixed_header_.WriteToBuffer(p_buf);
         }
 
         /********************************************
@@ -254,13 +246,8 @@ namespace awsiotsdk {
             return std::make_shared<PingreqPacket>();
         }
 
-        util::String PingreqPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-
-            fixed_header_.AppendToBuffer(buf);
-
-            return buf;
+        char *PingreqPacket::WriteToBuffer(char *p_buf) {
+            return fixed_header_.WriteToBuffer(p_buf);
         }
 
         /***************************************************
@@ -377,9 +364,10 @@ namespace awsiotsdk {
             }
 
             /* convert all subscriptions to inactive */
-            for (auto itr = p_client_state_->subscription_map_.begin(); itr != p_client_state_->subscription_map_.end();
-                 ++itr) {
-                itr->second->SetActive(false);
+            std::shared_ptr<const SubscriptionRegistry::Snapshot>
+                p_subscription_snapshot = p_client_state_->GetSubscriptionSnapshot();
+            for (auto &itr : p_subscription_snapshot->subscription_map_) {
+                itr.second->SetActive(false);
             }
 
             rc = p_network_connection->Disconnect();
@@ -395,6 +383,15 @@ namespace awsiotsdk {
         KeepaliveActionRunner::KeepaliveActionRunner(std::shared_ptr<ClientState> p_client_state)
             : Action(ActionType::KEEP_ALIVE, KEEPALIVE_ACTION_DESCRIPTION) {
             p_client_state_ = p_client_state;
+            is_started_ = false;
+            was_connected_ = false;
+            p_reconnect_backoff_strategy_ = nullptr;
+
+            // Every ping request is identical, serialized once
+            std::shared_ptr<PingreqPacket> p_pingreq_packet = PingreqPacket::Create();
+            if (nullptr != p_pingreq_packet) {
+                pingreq_data_ = p_pingreq_packet->ToString();
+            }
         }
 
         std::unique_ptr<Action> KeepaliveActionRunner::Create(std::shared_ptr<ActionState> p_action_state) {
@@ -407,195 +404,353 @@ namespace awsiotsdk {
             return std::unique_ptr<KeepaliveActionRunner>(new KeepaliveActionRunner(p_client_state));
         }
 
-        ResponseCode KeepaliveActionRunner::PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
-                                                          std::shared_ptr<ActionData> p_action_data) {
-            // TODO : This action needs cleanup in the future
-            std::atomic_bool &_p_thread_continue_ = *p_thread_continue_;
-            std::chrono::milliseconds thread_sleep_duration(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS);
+        void KeepaliveActionRunner::FinishResubscribe(std::shared_ptr<ClientState> p_client_state,
+                                                      const ResubscribeProgress &progress, ResponseCode rc) {
+            std::chrono::milliseconds resubscribe_duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - progress.start_time_);
+            p_client_state->RecordResubscribeDuration(resubscribe_duration);
+            AWS_LOG_INFO(KEEPALIVE_LOG_TAG,
+                         "Resubscribe finished in %ld ms. %s",
+                         static_cast<long>(resubscribe_duration.count()),
+                         ResponseHelper::ToString(rc).c_str());
+
+            if (nullptr != p_client_state->resubscribe_handler_ptr_) {
+                p_client_state->resubscribe_handler_ptr_(progress.client_id_,
+                                                         p_client_state->p_resubscribe_app_handler_data_,
+                                                         rc);
+            }
+        }
 
-            // Wait for first connect, keep alive data will not be available until then
-            while (_p_thread_continue_ && !p_client_state_->IsConnected()) {
-                std::this_thread::sleep_for(thread_sleep_duration);
+        ResponseCode KeepaliveActionRunner::Resubscribe(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                        const util::String &client_id) {
+            // if no subscriptions, skip resubscribe
+            std::shared_ptr<const SubscriptionRegistry::Snapshot>
+                p_subscription_snapshot = p_client_state_->GetSubscriptionSnapshot();
+            if (p_subscription_snapshot->subscription_map_.empty()) {
+                return ResponseCode::SUCCESS;
             }
 
-            std::shared_ptr<PingreqPacket> p_pingreq_packet = PingreqPacket::Create();
-            if (nullptr == p_pingreq_packet) {
-                return ResponseCode::NULL_VALUE_ERROR;
+            std::shared_ptr<ResubscribeProgress> p_progress = std::make_shared<ResubscribeProgress>();
+            p_progress->client_id_ = client_id;
+            p_progress->start_time_ = std::chrono::steady_clock::now();
+            p_progress->pending_packet_count_ = 0;
+            p_progress->has_success_ = false;
+            p_progress->has_failure_ = false;
+            p_progress->has_timeout_ = false;
+            p_progress->is_finished_ = false;
+
+            bool is_session_present = p_client_state_->IsSessionPresent();
+            util::Vector<std::shared_ptr<SubscribePacket>> subscribe_packets;
+            util::Vector<std::shared_ptr<Subscription>> topic_vector;
+            size_t resubscribe_count = 0;
+            for (auto &itr : p_subscription_snapshot->subscription_map_) {
+                // A subscription waiting for a SUBACK might not be part of the session kept by the server
+                if (is_session_present && 0 == itr.second->GetPacketId()) {
+                    itr.second->SetActive(true);
+                    continue;
+                }
+                topic_vector.push_back(itr.second);
+                resubscribe_count++;
+                if (MAX_TOPICS_IN_ONE_SUBSCRIBE_PACKET == topic_vector.size()) {
+                    subscribe_packets.push_back(SubscribePacket::Create(topic_vector));
+                    topic_vector.clear();
+                }
+            }
+            if (!topic_vector.empty()) {
+                subscribe_packets.push_back(SubscribePacket::Create(topic_vector));
             }
 
+            if (subscribe_packets.empty()) {
+                AWS_LOG_INFO(KEEPALIVE_LOG_TAG, "Session is present, skipping resubscribe");
+                FinishResubscribe(p_client_state_, *p_progress, ResponseCode::SUCCESS);
+                return ResponseCode::SUCCESS;
+            }
+
+            std::weak_ptr<ClientState> p_weak_client_state = p_client_state_;
+            ActionData::AsyncAckNotificationHandlerPtr p_suback_handler =
+                [p_weak_client_state, p_progress](uint16_t action_id, ResponseCode rc) {
+                    // Subscriptions were already activated or removed by the network read action
+                    ResponseCode result_rc = ResponseCode::SUCCESS;
+                    {
+                        std::lock_guard<std::mutex> progress_lock(p_progress->progress_lock_);
+                        if (p_progress->is_finished_) {
+                            return;
+                        }
+                        if (ResponseCode::SUCCESS == rc) {
+                            p_progress->has_success_ = true;
+                        } else if (ResponseCode::MQTT_SUBSCRIBE_PARTIALLY_FAILED == rc) {
+                            p_progress->has_success_ = true;
+                            p_progress->has_failure_ = true;
+                        } else if (ResponseCode::MQTT_SUBSCRIBE_FAILED == rc) {
+                            p_progress->has_failure_ = true;
+                        } else {
+                            p_progress->has_timeout_ = true;
+                        }
+                        if (0 < --p_progress->pending_packet_count_) {
+                            return;
+                        }
+                        p_progress->is_finished_ = true;
+
+                        if (p_progress->has_timeout_) {
+                            result_rc = ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR;
+                        } else if (p_progress->has_success_ && p_progress->has_failure_) {
+                            result_rc = ResponseCode::MQTT_SUBSCRIBE_PARTIALLY_FAILED;
+                        } else if (p_progress->has_failure_) {
+                            result_rc = ResponseCode::MQTT_SUBSCRIBE_FAILED;
+                        }
+                    }
+                    std::shared_ptr<ClientState> p_client_state = p_weak_client_state.lock();
+                    if (nullptr != p_client_state) {
+                        FinishResubscribe(p_client_state, *p_progress, result_rc);
+                    }
+                };
+
+            // Every packet is tracked before anything is written, SUBACKs can arrive while the rest is written
+            size_t buffer_size = 0;
+            for (std::shared_ptr<SubscribePacket> &p_subscribe_packet : subscribe_packets) {
+                p_subscribe_packet->SetPacketId(p_client_state_->GetNextPacketId());
+                buffer_size += p_subscribe_packet->Size();
+            }
+            p_progress->pending_packet_count_ = subscribe_packets.size();
             ResponseCode rc = ResponseCode::SUCCESS;
-            p_client_state_->setDisconnectCallbackPending(true);
+            resubscribe_buffer_.resize(buffer_size);
+            size_t buffer_offset = 0;
+            for (std::shared_ptr<SubscribePacket> &p_subscribe_packet : subscribe_packets) {
+                // Serializing also sets the packet ID and index at which each subscription expects its SUBACK
+                size_t serialized_length = 0;
+                p_subscribe_packet->SerializeToBuffer(&resubscribe_buffer_[buffer_offset],
+                                                      buffer_size - buffer_offset, serialized_length);
+                buffer_offset += serialized_length;
+                rc = p_client_state_->RegisterPendingAck(p_subscribe_packet->GetPacketId(), p_suback_handler);
+                if (ResponseCode::SUCCESS != rc) {
+                    break;
+                }
+            }
 
-            std::chrono::seconds reconnect_backoff_timer = p_client_state_->GetMinReconnectBackoffTimeout();
-            std::chrono::seconds max_backoff_value = p_client_state_->GetMaxReconnectBackoffTimeout();
-            std::chrono::seconds keep_alive_interval = p_client_state_->GetKeepAliveTimeout() / 2;
-            auto next = std::chrono::system_clock::now() + std::chrono::seconds(keep_alive_interval);
+            if (ResponseCode::SUCCESS == rc) {
+                AWS_LOG_INFO(KEEPALIVE_LOG_TAG,
+                             "Resubscribing to %u topic filters in %u packets",
+                             static_cast<unsigned int>(resubscribe_count),
+                             static_cast<unsigned int>(subscribe_packets.size()));
+                // Queued actions may be written at the same time by the outbound processing
+                std::lock_guard<std::mutex> perform_action_lock(p_client_state_->GetPerformActionLock());
+                rc = WriteToNetworkBuffer(p_network_connection, resubscribe_buffer_);
+            }
+            if (ResponseCode::SUCCESS != rc) {
+                AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
+                              "Resubscribe attempt returned unhandled error. \n%s",
+                              ResponseHelper::ToString(rc).c_str());
+                {
+                    std::lock_guard<std::mutex> progress_lock(p_progress->progress_lock_);
+                    p_progress->is_finished_ = true;
+                }
+                for (std::shared_ptr<SubscribePacket> &p_subscribe_packet : subscribe_packets) {
+                    p_client_state_->DeletePendingAck(p_subscribe_packet->GetPacketId());
+                }
+                FinishResubscribe(p_client_state_, *p_progress, rc);
+            }
+            return rc;
+        }
 
-            do {
-                if (p_client_state_->IsAutoReconnectEnabled() && p_client_state_->IsAutoReconnectRequired()) {
-                    p_client_state_->SetPingreqPending(false);
-                    if (p_client_state_->isDisconnectCallbackPending()) {
-
-                        std::shared_ptr<ConnectPacket> p_connect_packet =
-                            std::dynamic_pointer_cast<ConnectPacket>(p_client_state_->GetAutoReconnectData());
-
-                        /**
-                         * NOTE: All callbacks used by the keepalive should be non-blocking
-                         */
-                        if (nullptr != p_client_state_->disconnect_handler_ptr_ && nullptr != p_connect_packet) {
-                            p_client_state_->disconnect_handler_ptr_(p_connect_packet->GetClientID(),
-                                                                   p_client_state_->p_disconnect_app_handler_data_);
-                        }
+        std::chrono::steady_clock::time_point KeepaliveActionRunner::RunKeepalive(
+            std::shared_ptr<NetworkConnection> p_network_connection) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            if (!is_started_) {
+                // Wait for first connect, keep alive data will not be available until then
+                if (!p_client_state_->IsConnected()) {
+                    return std::chrono::steady_clock::time_point::max();
+                }
+                is_started_ = true;
+                p_client_state_->setDisconnectCallbackPending(true);
+            }
 
-                        reconnect_backoff_timer = p_client_state_->GetMinReconnectBackoffTimeout();
-                        max_backoff_value = p_client_state_->GetMaxReconnectBackoffTimeout();
-                        AWS_LOG_INFO(KEEPALIVE_LOG_TAG,
-                                     "Initial value of reconnect timer : %ld!!",
-                                     reconnect_backoff_timer.count());
-                        AWS_LOG_INFO(KEEPALIVE_LOG_TAG, "Max backoff value : %ld!!", max_backoff_value.count());
-                    }
-                    AWS_LOG_INFO(KEEPALIVE_LOG_TAG, "Attempting Reconnect");
+            ResponseCode rc = ResponseCode::SUCCESS;
+            if (p_client_state_->IsAutoReconnectEnabled() && p_client_state_->IsAutoReconnectRequired()) {
+                p_client_state_->SetPingreqPending(false);
+                if (p_client_state_->isDisconnectCallbackPending()) {
 
                     std::shared_ptr<ConnectPacket> p_connect_packet =
                         std::dynamic_pointer_cast<ConnectPacket>(p_client_state_->GetAutoReconnectData());
 
-                    rc = p_client_state_->PerformAction(ActionType::CONNECT,
-                                                        p_connect_packet,
-                                                        p_client_state_->GetMqttCommandTimeout());
-
-                    if (nullptr != p_client_state_->reconnect_handler_ptr_) {
-                        p_client_state_->reconnect_handler_ptr_(p_connect_packet->GetClientID(),
-                                                              p_client_state_->p_reconnect_app_handler_data_,
-                                                              rc);
-                    }
-                    if (ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED == rc) {
-                        p_client_state_->SetAutoReconnectRequired(false);
-                        // if no subscriptions, skip resubscribe
-                        if (!p_client_state_->subscription_map_.empty()) {
-
-                            util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
-
-                            util::Map<util::String, std::shared_ptr<Subscription>>::const_iterator
-                                itr = p_client_state_->subscription_map_.begin();
-                            while (itr != p_client_state_->subscription_map_.end()) {
-                                topic_vector.push_back(itr->second);
-                                itr++;
-                                if (topic_vector.size() == MAX_TOPICS_IN_ONE_SUBSCRIBE_PACKET) {
-                                    std::shared_ptr<mqtt::SubscribePacket>
-                                        p_subscribe_packet = mqtt::SubscribePacket::Create(topic_vector);
-                                    p_subscribe_packet->SetPacketId(p_client_state_->GetNextPacketId());
-                                    rc = WriteToNetworkBuffer(p_network_connection, p_subscribe_packet->ToString());
-                                    if (ResponseCode::SUCCESS != rc) {
-                                        AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
-                                                      "Resubscribe attempt returned unhandled error. \n%s",
-                                                      ResponseHelper::ToString(rc).c_str());
-                                        break;
-                                    }
-                                    topic_vector.clear();
-                                }
-                            }
-
-                            if (ResponseCode::SUCCESS == rc || ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED == rc) {
-                                if (!topic_vector.empty()) {
-                                    std::shared_ptr<mqtt::SubscribePacket>
-                                        p_subscribe_packet = mqtt::SubscribePacket::Create(topic_vector);
-                                    p_subscribe_packet->SetPacketId(p_client_state_->GetNextPacketId());
-                                    rc = WriteToNetworkBuffer(p_network_connection, p_subscribe_packet->ToString());
-                                }
-                            }
-
-                            if (nullptr != p_client_state_->resubscribe_handler_ptr_) {
-                                p_client_state_->resubscribe_handler_ptr_(p_connect_packet->GetClientID(),
-                                                                        p_client_state_->p_resubscribe_app_handler_data_,
-                                                                        rc);
-                            }
-                        }
-                        /**
-                         * NOTE :The resubscribe response can be NETWORK_DISCONNECTED_ERROR as the network might have
-                         * disconnected again after the reconnect was successful.
-                         */
-                        if (ResponseCode::NETWORK_DISCONNECTED_ERROR != rc) {
-                            p_client_state_->SetAutoReconnectRequired(false);
-                        } else {
-                            p_client_state_->PerformAction(ActionType::DISCONNECT,
-                                                           DisconnectPacket::Create(),
-                                                           p_client_state_->GetMqttCommandTimeout());
-                            p_client_state_->SetAutoReconnectRequired(true);
-                        }
-                        continue;
+                    /**
+                     * NOTE: All callbacks used by the keepalive should be non-blocking
+                     */
+                    if (nullptr != p_client_state_->disconnect_handler_ptr_ && nullptr != p_connect_packet) {
+                        p_client_state_->disconnect_handler_ptr_(p_connect_packet->GetClientID(),
+                                                               p_client_state_->p_disconnect_app_handler_data_);
                     }
 
                     p_client_state_->setDisconnectCallbackPending(false);
-                    AWS_LOG_ERROR(KEEPALIVE_LOG_TAG, "Reconnect failed. %s", ResponseHelper::ToString(rc).c_str());
 
+                    // The first attempt waits as well, clients that lost the connection together spread their attempts
+                    disconnect_time_ = now;
+                    p_reconnect_backoff_strategy_ = p_client_state_->GetReconnectBackoffStrategy();
+                    p_reconnect_backoff_strategy_->Reset(p_client_state_->GetMinReconnectBackoffTimeout(),
+                                                         p_client_state_->GetMaxReconnectBackoffTimeout());
+                    std::chrono::milliseconds reconnect_backoff = p_reconnect_backoff_strategy_->GetNextBackoff();
                     AWS_LOG_INFO(KEEPALIVE_LOG_TAG,
-                                 "Current value of reconnect timer : %ld!!",
-                                 reconnect_backoff_timer.count());
-                    if (max_backoff_value > reconnect_backoff_timer) {
-                        reconnect_backoff_timer += reconnect_backoff_timer;
+                                 "Initial value of reconnect timer : %ld ms!!",
+                                 static_cast<long>(reconnect_backoff.count()));
+                    next_reconnect_time_ = now + reconnect_backoff;
+                }
+                if (now < next_reconnect_time_) {
+                    return next_reconnect_time_;
+                }
+                AWS_LOG_INFO(KEEPALIVE_LOG_TAG, "Attempting Reconnect");
+
+                std::shared_ptr<ConnectPacket> p_connect_packet =
+                    std::dynamic_pointer_cast<ConnectPacket>(p_client_state_->GetAutoReconnectData());
+
+                rc = p_client_state_->PerformAction(ActionType::CONNECT,
+                                                    p_connect_packet,
+                                                    p_client_state_->GetMqttCommandTimeout());
+
+                if (nullptr != p_client_state_->reconnect_handler_ptr_) {
+                    p_client_state_->reconnect_handler_ptr_(p_connect_packet->GetClientID(),
+                                                          p_client_state_->p_reconnect_app_handler_data_,
+                                                          rc);
+                }
+                if (ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED == rc) {
+                    p_client_state_->GetReconnectTimeHistogram().Record(
+                        std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - disconnect_time_));
+                    // Keep alive timing starts over with the new connection
+                    was_connected_ = false;
+                    rc = Resubscribe(p_network_connection, p_connect_packet->GetClientID());
+                    /**
+                     * NOTE :The resubscribe response can be NETWORK_DISCONNECTED_ERROR as the network might have
+                     * disconnected again after the reconnect was successful.
+                     * The reconnect request was already cleared when the CONNACK was accepted, it is not cleared here
+                     * so that a read error during the resubscribe still requests another reconnect.
+                     */
+                    if (ResponseCode::NETWORK_DISCONNECTED_ERROR == rc) {
+                        p_client_state_->PerformAction(ActionType::DISCONNECT,
+                                                       DisconnectPacket::Create(),
+                                                       p_client_state_->GetMqttCommandTimeout());
+                        p_client_state_->SetAutoReconnectRequired(true);
                     }
+                    return now;
+                }
 
-                    AWS_LOG_INFO(KEEPALIVE_LOG_TAG,
-                                 "Updated value of reconnect timer : %ld!!",
-                                 reconnect_backoff_timer.count());
-                    std::this_thread::sleep_for(reconnect_backoff_timer);
-                    continue;
-                } else if (p_client_state_->IsAutoReconnectRequired()) {
-                    if (p_client_state_->isDisconnectCallbackPending()) {
-                        std::shared_ptr<ConnectPacket> p_connect_packet =
-                            std::dynamic_pointer_cast<ConnectPacket>(p_client_state_->GetAutoReconnectData());
-
-                        if (nullptr != p_client_state_->disconnect_handler_ptr_ && nullptr != p_connect_packet) {
-                            p_client_state_->disconnect_handler_ptr_(p_connect_packet->GetClientID(),
-                                                                   p_client_state_->p_disconnect_app_handler_data_);
-                        }
+                // Set again by the connect action once the connect packet was written
+                p_client_state_->setDisconnectCallbackPending(false);
+                AWS_LOG_ERROR(KEEPALIVE_LOG_TAG, "Reconnect failed. %s", ResponseHelper::ToString(rc).c_str());
+
+                std::chrono::milliseconds reconnect_backoff = p_reconnect_backoff_strategy_->GetNextBackoff();
+                AWS_LOG_INFO(KEEPALIVE_LOG_TAG,
+                             "Updated value of reconnect timer : %ld ms!!",
+                             static_cast<long>(reconnect_backoff.count()));
+                // Wakeups before this only end the wait early on shutdown or a connect made by the application
+                next_reconnect_time_ = std::chrono::steady_clock::now() + reconnect_backoff;
+                return next_reconnect_time_;
+            } else if (p_client_state_->IsAutoReconnectRequired()) {
+                if (p_client_state_->isDisconnectCallbackPending()) {
+                    std::shared_ptr<ConnectPacket> p_connect_packet =
+                        std::dynamic_pointer_cast<ConnectPacket>(p_client_state_->GetAutoReconnectData());
 
-                        p_client_state_->setDisconnectCallbackPending(false);
+                    if (nullptr != p_client_state_->disconnect_handler_ptr_ && nullptr != p_connect_packet) {
+                        p_client_state_->disconnect_handler_ptr_(p_connect_packet->GetClientID(),
+                                                               p_client_state_->p_disconnect_app_handler_data_);
                     }
+
+                    p_client_state_->setDisconnectCallbackPending(false);
                 }
+            }
 
-                if (std::chrono::system_clock::now() > next) {
-                    if (p_client_state_->IsPingreqPending()) {
-                        if (p_client_state_->IsConnected()) {
-                            rc = p_client_state_->PerformAction(ActionType::DISCONNECT,
-                                                                DisconnectPacket::Create(),
-                                                                p_client_state_->GetMqttCommandTimeout());
-                            if (ResponseCode::SUCCESS != rc && ResponseCode::NETWORK_DISCONNECTED_ERROR != rc) {
-                                AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
-                                              "Network Disconnect attempt returned unhandled error. \n%s",
-                                              ResponseHelper::ToString(rc).c_str());
-                            }
-                        }
-                        p_client_state_->SetAutoReconnectRequired(true);
-                        continue;
-                    } else if (p_client_state_->IsConnected()) {
-                        rc = WriteToNetworkBuffer(p_network_connection, p_pingreq_packet->ToString());
+            if (!p_client_state_->IsConnected()) {
+                // Woken up once the connection state changes
+                was_connected_ = false;
+                return std::chrono::steady_clock::time_point::max();
+            }
+            if (!was_connected_) {
+                was_connected_ = true;
+                keepalive_reference_time_ = now;
+            }
 
+            // Publishes stored while offline are handed to the outbound queue at the configured rate
+            std::chrono::steady_clock::time_point next_run_time = p_client_state_->DrainOfflinePublishes();
+
+            std::chrono::seconds keep_alive_interval = p_client_state_->GetKeepAliveTimeout() / 2;
+            std::chrono::steady_clock::time_point next_ping_check_time;
+            if (p_client_state_->IsPingreqPending()) {
+                next_ping_check_time = keepalive_reference_time_ + keep_alive_interval;
+                if (now >= next_ping_check_time) {
+                    rc = p_client_state_->PerformAction(ActionType::DISCONNECT,
+                                                        DisconnectPacket::Create(),
+                                                        p_client_state_->GetMqttCommandTimeout());
+                    if (ResponseCode::SUCCESS != rc && ResponseCode::NETWORK_DISCONNECTED_ERROR != rc) {
+                        AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
+                                      "Network Disconnect attempt returned unhandled error. \n%s",
+                                      ResponseHelper::ToString(rc).c_str());
+                    }
+                    p_client_state_->SetAutoReconnectRequired(true);
+                    return now;
+                }
+            } else {
+                // Traffic in both directions since the last ping shows the connection is alive
+                std::chrono::steady_clock::time_point last_traffic_time =
+                    std::min(p_client_state_->GetLastInboundActivityTime(),
+                             p_client_state_->GetLastOutboundActionTime());
+                next_ping_check_time = std::max(keepalive_reference_time_, last_traffic_time) + keep_alive_interval;
+                if (now >= next_ping_check_time) {
+                    {
+                        std::lock_guard<std::mutex> perform_action_lock(p_client_state_->GetPerformActionLock());
+                        rc = WriteToNetworkBuffer(p_network_connection, pingreq_data_);
+                    }
+
+                    if (ResponseCode::SUCCESS != rc) {
+                        AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
+                                      "Writing PingReq to Network Failed. \n%s. \nDisconnecting!",
+                                      ResponseHelper::ToString(rc).c_str());
+                        rc = p_client_state_->PerformAction(ActionType::DISCONNECT,
+                                                            DisconnectPacket::Create(),
+                                                            p_client_state_->GetMqttCommandTimeout());
                         if (ResponseCode::SUCCESS != rc) {
                             AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
-                                          "Writing PingReq to Network Failed. \n%s. \nDisconnecting!",
+                                          "Network Disconnect attempt returned unhandled error. \n%s",
                                           ResponseHelper::ToString(rc).c_str());
-                            rc = p_client_state_->PerformAction(ActionType::DISCONNECT,
-                                                                DisconnectPacket::Create(),
-                                                                p_client_state_->GetMqttCommandTimeout());
-                            if (ResponseCode::SUCCESS != rc) {
-                                AWS_LOG_ERROR(KEEPALIVE_LOG_TAG,
-                                              "Network Disconnect attempt returned unhandled error. \n%s",
-                                              ResponseHelper::ToString(rc).c_str());
-                            }
-                            p_client_state_->SetAutoReconnectRequired(true);
-                            continue;
                         }
-
-                        p_client_state_->SetPingreqPending(true);
-                        next = std::chrono::system_clock::now() + std::chrono::seconds(keep_alive_interval);
+                        p_client_state_->SetAutoReconnectRequired(true);
+                        return now;
                     }
+
+                    p_client_state_->SetPingreqPending(true);
+                    keepalive_reference_time_ = now;
+                    next_ping_check_time = now + keep_alive_interval;
+                }
+            }
+
+            // Keep alive intervals below a second are checked at most as often as the core threads poll
+            next_ping_check_time = std::max(next_ping_check_time,
+                                            now + std::chrono::milliseconds(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS));
+            return std::min(next_run_time, next_ping_check_time);
+        }
+
+        ResponseCode KeepaliveActionRunner::PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                          std::shared_ptr<ActionData> p_action_data) {
+            std::atomic_bool &_p_thread_continue_ = *p_thread_continue_;
+            if (pingreq_data_.empty()) {
+                return ResponseCode::NULL_VALUE_ERROR;
+            }
+
+            do {
+                std::chrono::steady_clock::time_point next_run_time = RunKeepalive(p_network_connection);
+                if (!_p_thread_continue_) {
+                    break;
                 }
-                std::this_thread::sleep_for(thread_sleep_duration);
+                // Woken up early by state changes and by ClientCore when stopping
+                p_client_state_->WaitForKeepaliveWakeup(next_run_time);
             } while (_p_thread_continue_);
 
-            return rc;
+            return ResponseCode::SUCCESS;
+        }
+
+        std::chrono::steady_clock::time_point KeepaliveActionRunner::PerformTimedAction(
+            std::shared_ptr<NetworkConnection> p_network_connection, std::shared_ptr<ActionData> p_action_data) {
+            if (pingreq_data_.empty()) {
+                return std::chrono::steady_clock::time_point::max();
+            }
+            return RunKeepalive(p_network_connection);
         }
     }
 }
- 
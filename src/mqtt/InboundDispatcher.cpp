@@ -0,0 +1,196 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file InboundDispatcher.cpp
+ * @brief
+ *
+ */
+
+#include <functional>
+
+#include "util/logging/LogMacros.hpp"
+
+#include "mqtt/InboundDispatcher.hpp"
+
+#define INBOUND_DISPATCHER_LOG_TAG "[Inbound Dispatcher]"
+
+namespace awsiotsdk {
+    namespace mqtt {
+        InboundMessageDispatcher::InboundMessageDispatcher(size_t worker_count, size_t max_queue_size,
+                                                           ActionQueueOverflowPolicy overflow_policy,
+                                                           std::chrono::milliseconds block_timeout) {
+            max_queue_size_ = (0 == max_queue_size) ? 1 : max_queue_size;
+            overflow_policy_ = overflow_policy;
+            block_timeout_ = block_timeout;
+            is_running_ = true;
+            messages_queued_ = 0;
+            messages_delivered_ = 0;
+            messages_dropped_ = 0;
+            blocked_dispatch_count_ = 0;
+            max_queue_depth_ = 0;
+
+            if (0 == worker_count) {
+                worker_count = 1;
+            }
+            // Create all workers before starting any thread, workers_ is not modified after this
+            for (size_t itr = 0; itr < worker_count; itr++) {
+                std::shared_ptr<Worker> p_worker = std::make_shared<Worker>();
+                p_worker->is_detached_ = false;
+                workers_.push_back(p_worker);
+            }
+            for (std::shared_ptr<Worker> &p_worker : workers_) {
+                p_worker->thread_ = std::thread(&InboundMessageDispatcher::RunWorker, this, p_worker);
+            }
+        }
+
+        InboundMessageDispatcher::~InboundMessageDispatcher() {
+            Stop();
+        }
+
+        std::shared_ptr<InboundMessageDispatcher> InboundMessageDispatcher::Create(size_t worker_count,
+                                                                                   size_t max_queue_size,
+                                                                                   ActionQueueOverflowPolicy overflow_policy,
+                                                                                   std::chrono::milliseconds block_timeout) {
+            return std::shared_ptr<InboundMessageDispatcher>(new InboundMessageDispatcher(worker_count,
+                                                                                          max_queue_size,
+                                                                                          overflow_policy,
+                                                                                          block_timeout));
+        }
+
+        ResponseCode InboundMessageDispatcher::Dispatch(std::shared_ptr<Subscription> p_subscription,
+                                                        util::String topic_name, util::String payload) {
+            return Dispatch(std::move(p_subscription), std::move(topic_name),
+                            std::make_shared<const util::String>(std::move(payload)));
+        }
+
+        ResponseCode InboundMessageDispatcher::Dispatch(std::shared_ptr<Subscription> p_subscription,
+                                                        util::String topic_name,
+                                                        std::shared_ptr<const util::String> p_payload) {
+            if (nullptr == p_subscription || nullptr == p_payload) {
+                return ResponseCode::NULL_VALUE_ERROR;
+            }
+
+            // Same subscription always goes to the same worker to preserve delivery order
+            Worker *p_worker = workers_[std::hash<Subscription *>()(p_subscription.get()) % workers_.size()].get();
+            std::unique_lock<std::mutex> queue_lock(p_worker->queue_lock_);
+            if (!is_running_) {
+                return ResponseCode::FAILURE;
+            }
+
+            if (max_queue_size_ <= p_worker->queue_.size()) {
+                if (ActionQueueOverflowPolicy::OVERWRITE_OLDEST == overflow_policy_) {
+                    p_worker->queue_.pop();
+                    messages_dropped_++;
+                    AWS_LOG_WARN(INBOUND_DISPATCHER_LOG_TAG,
+                                 "Dispatch queue full, dropping oldest message. Topic : %s", topic_name.c_str());
+                } else if (ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT == overflow_policy_) {
+                    blocked_dispatch_count_++;
+                    p_worker->space_wait_.wait_for(queue_lock, block_timeout_, [this, p_worker] {
+                        return !is_running_ || max_queue_size_ > p_worker->queue_.size();
+                    });
+                }
+
+                if (!is_running_) {
+                    return ResponseCode::FAILURE;
+                }
+                if (max_queue_size_ <= p_worker->queue_.size()) {
+                    messages_dropped_++;
+                    AWS_LOG_WARN(INBOUND_DISPATCHER_LOG_TAG,
+                                 "Dispatch queue full, dropping message. Topic : %s", topic_name.c_str());
+                    return ResponseCode::ACTION_QUEUE_FULL;
+                }
+            }
+
+            InboundMessage message;
+            message.p_subscription_ = std::move(p_subscription);
+            message.topic_name_ = std::move(topic_name);
+            message.p_payload_ = std::move(p_payload);
+            p_worker->queue_.push(std::move(message));
+            messages_queued_++;
+
+            size_t queue_depth = p_worker->queue_.size();
+            size_t max_queue_depth = max_queue_depth_;
+            while (queue_depth > max_queue_depth && !max_queue_depth_.compare_exchange_weak(max_queue_depth,
+                                                                                            queue_depth)) {
+            }
+            p_worker->message_wait_.notify_one();
+            return ResponseCode::SUCCESS;
+        }
+
+        void InboundMessageDispatcher::RunWorker(std::shared_ptr<Worker> p_worker) {
+            std::unique_lock<std::mutex> queue_lock(p_worker->queue_lock_);
+            for (;;) {
+                p_worker->message_wait_.wait(queue_lock, [this, p_worker] {
+                    return !is_running_ || !p_worker->queue_.empty();
+                });
+                if (p_worker->queue_.empty()) {
+                    // Stopped and nothing left to deliver
+                    break;
+                }
+
+                InboundMessage message = std::move(p_worker->queue_.front());
+                p_worker->queue_.pop();
+                p_worker->space_wait_.notify_one();
+
+                // Callbacks run without the lock so the read thread can keep queuing
+                queue_lock.unlock();
+                MessageBufferView topic_name_view = {message.topic_name_.data(), message.topic_name_.length()};
+                MessageBufferView payload_view = {message.p_payload_->data(), message.p_payload_->length()};
+                message.p_subscription_->InvokeHandler(topic_name_view, payload_view);
+                queue_lock.lock();
+                if (p_worker->is_detached_) {
+                    // The callback stopped the dispatcher, which may already be destroyed
+                    break;
+                }
+                messages_delivered_++;
+            }
+        }
+
+        void InboundMessageDispatcher::Stop() {
+            for (std::shared_ptr<Worker> &p_worker : workers_) {
+                std::lock_guard<std::mutex> queue_lock(p_worker->queue_lock_);
+                is_running_ = false;
+                if (std::this_thread::get_id() == p_worker->thread_.get_id()) {
+                    // Called from a callback on this worker, joining would wait for itself
+                    p_worker->is_detached_ = true;
+                    p_worker->thread_.detach();
+                }
+                p_worker->message_wait_.notify_all();
+                p_worker->space_wait_.notify_all();
+            }
+            for (std::shared_ptr<Worker> &p_worker : workers_) {
+                if (p_worker->thread_.joinable()) {
+                    p_worker->thread_.join();
+                }
+            }
+        }
+
+        InboundDispatchStatistics InboundMessageDispatcher::GetStatistics() {
+            InboundDispatchStatistics statistics;
+            statistics.messages_queued_ = messages_queued_;
+            statistics.messages_delivered_ = messages_delivered_;
+            statistics.messages_dropped_ = messages_dropped_;
+            statistics.blocked_dispatch_count_ = blocked_dispatch_count_;
+            statistics.max_queue_depth_ = max_queue_depth_;
+            statistics.queued_message_count_ = 0;
+            for (std::shared_ptr<Worker> &p_worker : workers_) {
+                std::lock_guard<std::mutex> queue_lock(p_worker->queue_lock_);
+                statistics.queued_message_count_ += p_worker->queue_.size();
+            }
+            return statistics;
+        }
+    }
+}
@@ -19,6 +19,7 @@
  *
  */
 
+#include <algorithm>
 #include <iostream>
 #include <chrono>
 #include <thread>
@@ -41,6 +42,9 @@ namespace awsiotsdk {
             : Action(ActionType::READ_INCOMING, "TLS Read Action Runner") {
             p_client_state_ = p_client_state;
             is_waiting_for_connack_ = true;
+            receive_buf_.resize(NETWORK_READ_BUFFER_INITIAL_SIZE_BYTES);
+            receive_buf_start_ = 0;
+            receive_buf_end_ = 0;
         }
 
         std::unique_ptr<Action> NetworkReadActionRunner::Create(std::shared_ptr<ActionState> p_action_state) {
@@ -53,52 +57,165 @@ namespace awsiotsdk {
             return std::unique_ptr<NetworkReadActionRunner>(new NetworkReadActionRunner(p_client_state));
         }
 
-        ResponseCode NetworkReadActionRunner::DecodeRemainingLength(size_t &rem_len) {
-            util::String encoded_byte_str;
-            encoded_byte_str.reserve(1);
+        ResponseCode NetworkReadActionRunner::DecodeRemainingLength(size_t &rem_len, size_t &rem_len_bytes) {
             size_t multiplier = 1;
             size_t len = 0;
-            ResponseCode rc;
+            // Remaining length starts after the fixed header byte
+            size_t itr = receive_buf_start_ + 1;
+            unsigned char encoded_byte;
             rem_len = 0;
-            util::Vector<unsigned char> temp_buf;
+            rem_len_bytes = 0;
 
             do {
-                temp_buf.clear();
                 if (++len > MAX_NO_OF_REMAINING_LENGTH_BYTES) {
                     /* bad data */
-                    rc = ResponseCode::FAILURE;
-                    break;
+                    return ResponseCode::FAILURE;
                 }
 
-                rc = ReadFromNetworkBuffer(p_network_connection_, temp_buf, 1);
-                if (ResponseCode::SUCCESS != rc) {
-                    break;
+                if (itr >= receive_buf_end_) {
+                    // Rest of the length has not been received yet
+                    return ResponseCode::SUCCESS;
                 }
-                rem_len += (size_t) ((temp_buf[0] & 127) * multiplier);
+                encoded_byte = receive_buf_[itr++];
+                rem_len += (size_t) ((encoded_byte & 127) * multiplier);
                 multiplier *= 128;
-            } while (0 != (temp_buf[0] & 128));
+            } while (0 != (encoded_byte & 128));
 
+            rem_len_bytes = len;
+            return ResponseCode::SUCCESS;
+        }
+
+        ResponseCode NetworkReadActionRunner::GetBufferedPacketLength(size_t &required_bytes,
+                                                                      size_t &rem_len_bytes) {
+            size_t buffered_bytes = receive_buf_end_ - receive_buf_start_;
+            // Fixed header byte and at least one remaining length byte
+            required_bytes = 2;
+            rem_len_bytes = 0;
+            if (required_bytes > buffered_bytes) {
+                return ResponseCode::SUCCESS;
+            }
+
+            size_t rem_len = 0;
+            ResponseCode rc = DecodeRemainingLength(rem_len, rem_len_bytes);
+            if (ResponseCode::SUCCESS == rc) {
+                required_bytes = (0 == rem_len_bytes) ? buffered_bytes + 1 : 1 + rem_len_bytes + rem_len;
+            }
+            return rc;
+        }
+
+        ResponseCode NetworkReadActionRunner::FillReceiveBuffer(size_t required_bytes, size_t min_bytes_to_read) {
+            // Move the partial packet to the front so the rest of it is read in right after it
+            if (0 < receive_buf_start_) {
+                std::move(receive_buf_.begin() + receive_buf_start_, receive_buf_.begin() + receive_buf_end_,
+                          receive_buf_.begin());
+                receive_buf_end_ -= receive_buf_start_;
+                receive_buf_start_ = 0;
+            }
+            if (receive_buf_.size() < required_bytes) {
+                receive_buf_.resize(required_bytes);
+            }
+
+            size_t read_bytes = 0;
+            ResponseCode rc = p_network_connection_->ReadAvailable(receive_buf_, receive_buf_end_, min_bytes_to_read,
+                                                                   receive_buf_.size() - receive_buf_end_,
+                                                                   read_bytes);
+            if (ResponseCode::SUCCESS == rc && 0 == read_bytes) {
+                rc = ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
+            }
+            receive_buf_end_ += (ResponseCode::SUCCESS == rc) ? read_bytes : 0;
             return rc;
         }
 
         ResponseCode NetworkReadActionRunner::ReadPacketFromNetwork(unsigned char &fixed_header_byte,
                                                                     util::Vector<unsigned char> &read_buf) {
+            ResponseCode rc = ResponseCode::SUCCESS;
             read_buf.clear();
-            ResponseCode rc = ReadFromNetworkBuffer(p_network_connection_, read_buf, 1);
-            if (ResponseCode::SUCCESS != rc) {
-                return rc;
+
+            do {
+                size_t required_bytes = 0;
+                size_t rem_len_bytes = 0;
+                rc = GetBufferedPacketLength(required_bytes, rem_len_bytes);
+                if (ResponseCode::SUCCESS != rc) {
+                    break;
+                }
+
+                size_t buffered_bytes = receive_buf_end_ - receive_buf_start_;
+                if (0 != rem_len_bytes && required_bytes <= buffered_bytes) {
+                    util::Vector<unsigned char>::iterator packet_itr = receive_buf_.begin() + receive_buf_start_;
+                    fixed_header_byte = *packet_itr;
+                    read_buf.assign(packet_itr + 1 + rem_len_bytes, packet_itr + required_bytes);
+                    receive_buf_start_ += required_bytes;
+                    return ResponseCode::SUCCESS;
+                }
+
+                rc = FillReceiveBuffer(required_bytes, required_bytes - buffered_bytes);
+            } while (ResponseCode::SUCCESS == rc);
+
+            if (ResponseCode::NETWORK_SSL_NOTHING_TO_READ != rc) {
+                // Partially received data can't be continued after an error
+                receive_buf_start_ = 0;
+                receive_buf_end_ = 0;
             }
+            return rc;
+        }
 
-            fixed_header_byte = read_buf[0];
-            read_buf.clear();
-            size_t rem_len = 0;
-            rc = DecodeRemainingLength(rem_len);
-            if (ResponseCode::SUCCESS != rc) {
-                return rc;
+        ResponseCode NetworkReadActionRunner::HandlePacket(unsigned char fixed_header_byte,
+                                                           const util::Vector<unsigned char> &read_buf) {
+            ResponseCode rc = ResponseCode::SUCCESS;
+            unsigned char message_type_byte = fixed_header_byte;
+            message_type_byte >>= 4; // Packet type is in first 4 bits
+            message_type_byte &= 0x0F; // Only keep the least significant 4 bits
+            MessageTypes messageType = (MessageTypes) message_type_byte;
+            // Any packet from the broker shows the connection is alive, see KeepaliveActionRunner
+            p_client_state_->RecordInboundActivity();
+            switch (messageType) {
+                case MessageTypes::CONNACK:
+                    rc = HandleConnack(read_buf);
+                    break;
+                case MessageTypes::PUBLISH: {
+                    bool is_retained = ((fixed_header_byte & 0x01) == 0x01);
+                    bool is_duplicate = ((fixed_header_byte & 0x08) == 0x08);
+                    QoS qos = ((fixed_header_byte & 0x02) == 0x02) ? QoS::QOS1 : QoS::QOS0;
+                    rc = HandlePublish(read_buf, is_duplicate, is_retained, qos);
+                }
+                    break;
+                case MessageTypes::PUBACK:
+                    rc = HandlePuback(read_buf);
+                    break;
+                case MessageTypes::SUBACK:
+                    rc = HandleSuback(read_buf);
+                    break;
+                case MessageTypes::UNSUBACK:
+                    rc = HandleUnsuback(read_buf);
+                    break;
+                case MessageTypes::PINGRESP:
+                    p_client_state_->SetPingreqPending(false);
+                    rc = ResponseCode::SUCCESS;
+                    break;
+                default:
+                    // Any type values other than above are either unsupported or invalid
+                    // Packet types used for QoS2 are currently unsupported
+                    break;
             }
+            return rc;
+        }
 
-            if (0 < rem_len) {
-                rc = ReadFromNetworkBuffer(p_network_connection_, read_buf, rem_len);
+        ResponseCode NetworkReadActionRunner::HandleReadError(ResponseCode rc) {
+            is_waiting_for_connack_ = true;
+            if (*p_thread_continue_ && p_client_state_->IsConnected()) {
+                AWS_LOG_ERROR(NETWORK_READ_LOG_TAG,
+                              "Network Read attempt returned unhandled error. %s Requesting  Network Reconnect.",
+                              ResponseHelper::ToString(rc).c_str());
+                rc = p_client_state_->PerformAction(ActionType::DISCONNECT,
+                                                    DisconnectPacket::Create(),
+                                                    p_client_state_->GetMqttCommandTimeout());
+                if (ResponseCode::SUCCESS != rc) {
+                    AWS_LOG_ERROR(NETWORK_READ_LOG_TAG,
+                                  "Network Disconnect attempt returned unhandled error. %s",
+                                  ResponseHelper::ToString(rc).c_str());
+                    // No further action being taken. Assumption is that reconnect logic should bring SDK back to working state
+                }
+                p_client_state_->SetAutoReconnectRequired(true);
             }
             return rc;
         }
@@ -109,11 +226,7 @@ namespace awsiotsdk {
                 return ResponseCode::NULL_VALUE_ERROR;
             }
 
-            bool is_duplicate;
-            bool is_retained;
-            QoS qos;
             unsigned char fixed_header_byte;
-            unsigned char message_type_byte;
             util::Vector<unsigned char> read_buf;
             ResponseCode rc = ResponseCode::SUCCESS;
             p_network_connection_ = p_network_connection;
@@ -131,61 +244,69 @@ namespace awsiotsdk {
                 read_buf.clear();
                 rc = ReadPacketFromNetwork(fixed_header_byte, read_buf);
                 if (ResponseCode::NETWORK_SSL_NOTHING_TO_READ == rc) {
-                    std::this_thread::sleep_for(thread_sleep_duration);
+                    // Block until data arrives. The timeout bounds how long it takes to notice a stop request
+                    ResponseCode wait_rc = p_network_connection->WaitForReadable(thread_sleep_duration);
+                    if (ResponseCode::SUCCESS != wait_rc && ResponseCode::NETWORK_SSL_NOTHING_TO_READ != wait_rc) {
+                        std::this_thread::sleep_for(thread_sleep_duration);
+                    }
                     continue;
                 } else if (ResponseCode::SUCCESS == rc) {
-                    message_type_byte = fixed_header_byte;
-                    message_type_byte >>= 4; // Packet type is in first 4 bits
-                    message_type_byte &= 0x0F; // Only keep the least significant 4 bits
-                    MessageTypes messageType = (MessageTypes) message_type_byte;
-                    switch (messageType) {
-                        case MessageTypes::CONNACK:
-                            rc = HandleConnack(read_buf);
-                            break;
-                        case MessageTypes::PUBLISH: {
-                            is_retained = ((fixed_header_byte & 0x01) == 0x01);
-                            is_duplicate = ((fixed_header_byte & 0x08) == 0x08);
-                            qos = ((fixed_header_byte & 0x02) == 0x02) ? QoS::QOS1 : QoS::QOS0;
-                            rc = HandlePublish(read_buf, is_duplicate, is_retained, qos);
-                        }
-                            break;
-                        case MessageTypes::PUBACK:
-                            rc = HandlePuback(read_buf);
-                            break;
-                        case MessageTypes::SUBACK:
-                            rc = HandleSuback(read_buf);
-                            break;
-                        case MessageTypes::UNSUBACK:
-                            rc = HandleUnsuback(read_buf);
-                            break;
-                        case MessageTypes::PINGRESP:
-                            p_client_state_->SetPingreqPending(false);
-                            rc = ResponseCode::SUCCESS;
-                            break;
-                        default:
-                            // Any type values other than above are either unsupported or invalid
-                            // Packet types used for QoS2 are currently unsupported
-                            break;
-                    }
+                    rc = HandlePacket(fixed_header_byte, read_buf);
                 } else if (!is_waiting_for_connack_) {
-                    is_waiting_for_connack_ = true;
-                    if (_p_thread_continue_ && p_client_state_->IsConnected()) {
-                        AWS_LOG_ERROR(NETWORK_READ_LOG_TAG,
-                                      "Network Read attempt returned unhandled error. %s Requesting  Network Reconnect.",
-                                      ResponseHelper::ToString(rc).c_str());
-                        rc = p_client_state_->PerformAction(ActionType::DISCONNECT,
-                                                            DisconnectPacket::Create(),
-                                                            p_client_state_->GetMqttCommandTimeout());
-                        if (ResponseCode::SUCCESS != rc) {
-                            AWS_LOG_ERROR(NETWORK_READ_LOG_TAG,
-                                          "Network Disconnect attempt returned unhandled error. %s",
-                                          ResponseHelper::ToString(rc).c_str());
-                            // No further action being taken. Assumption is that reconnect logic should bring SDK back to working state
-                        }
-                        p_client_state_->SetAutoReconnectRequired(true);
+                    rc = HandleReadError(rc);
+                } else {
+                    // Reads fail until the connection is reestablished
+                    std::this_thread::sleep_for(thread_sleep_duration);
+                }
+                // Packets already received are decoded even if this is a one time operation
+            } while (_p_thread_continue_ || (ResponseCode::SUCCESS == rc && receive_buf_start_ < receive_buf_end_));
+            return rc;
+        }
+
+        ResponseCode NetworkReadActionRunner::PerformReadyAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                                 std::shared_ptr<ActionData> p_action_data) {
+            if (nullptr == p_network_connection) {
+                return ResponseCode::NULL_VALUE_ERROR;
+            }
+
+            unsigned char fixed_header_byte = 0x00;
+            ResponseCode rc = ResponseCode::SUCCESS;
+            p_network_connection_ = p_network_connection;
+
+            for (;;) {
+                size_t required_bytes = 0;
+                size_t rem_len_bytes = 0;
+                rc = GetBufferedPacketLength(required_bytes, rem_len_bytes);
+                if (ResponseCode::SUCCESS == rc
+                    && (0 == rem_len_bytes || required_bytes > receive_buf_end_ - receive_buf_start_)) {
+                    // Only bytes that already arrived are read, the rest of a packet is read when it arrives.
+                    // Data the connection has buffered internally does not make the socket readable again
+                    rc = p_network_connection->WaitForReadable(std::chrono::milliseconds(0));
+                    if (ResponseCode::SUCCESS == rc) {
+                        rc = FillReceiveBuffer(required_bytes, 1);
+                    }
+                    if (ResponseCode::SUCCESS == rc) {
+                        continue;
+                    } else if (ResponseCode::NETWORK_SSL_NOTHING_TO_READ == rc) {
+                        return ResponseCode::SUCCESS;
+                    }
+                } else if (ResponseCode::SUCCESS == rc) {
+                    // The packet is complete, this only decodes it
+                    rc = ReadPacketFromNetwork(fixed_header_byte, packet_buf_);
+                    if (ResponseCode::SUCCESS == rc) {
+                        HandlePacket(fixed_header_byte, packet_buf_);
+                        continue;
                     }
                 }
-            } while (_p_thread_continue_);
+                break;
+            }
+
+            // Partially received data can't be continued after an error
+            receive_buf_start_ = 0;
+            receive_buf_end_ = 0;
+            if (!is_waiting_for_connack_) {
+                rc = HandleReadError(rc);
+            }
             return rc;
         }
 
@@ -203,6 +324,11 @@ namespace awsiotsdk {
                 ConnackReturnCode connack_rc = static_cast<ConnackReturnCode>(connack_rc_byte);
                 switch (connack_rc) {
                     case ConnackReturnCode::CONNECTION_ACCEPTED:
+                        // Read errors request a reconnect again from now on
+                        is_waiting_for_connack_ = false;
+                        // Unacknowledged publishes go out before anything queued while the client was disconnected.
+                        // Only queued here, the outbound processing thread writes them once the client is connected
+                        p_client_state_->ResendInflightPublishes();
                         p_client_state_->SetConnected(true);
                         p_client_state_->ForwardReceivedAck(CONNACK_RESERVED_PACKET_ID,
                                                             ResponseCode::MQTT_CONNACK_CONNECTION_ACCEPTED);
@@ -233,31 +359,72 @@ namespace awsiotsdk {
                                                             bool is_retained,
                                                             bool is_duplicate,
                                                             QoS qos) {
-            ResponseCode rc = ResponseCode::FAILURE;
-            std::shared_ptr<mqtt::PublishPacket>
-                p_publish_packet = PublishPacket::Create(read_buf, is_retained, is_duplicate, qos);
+            // Topic length, topic and packet ID for QoS1 must be present, the payload can be empty
+            size_t extract_index = 0;
+            size_t topic_name_len = (2 <= read_buf.size()) ? Packet::ReadUInt16FromBuffer(read_buf, extract_index) : 0;
+            size_t header_len = 2 + topic_name_len + ((QoS::QOS0 != qos) ? 2 : 0);
+            if (0 == topic_name_len || read_buf.size() < header_len) {
+                return ResponseCode::MQTT_UNEXPECTED_PACKET_FORMAT_ERROR;
+            }
+
+            const char *p_read_buf_data = reinterpret_cast<const char *>(read_buf.data());
+            MessageBufferView topic_name_view = {p_read_buf_data + extract_index, topic_name_len};
+            extract_index += topic_name_len;
+            uint16_t packet_id = (QoS::QOS0 != qos) ? Packet::ReadUInt16FromBuffer(read_buf, extract_index) : 0;
+            MessageBufferView payload_view = {p_read_buf_data + extract_index, read_buf.size() - extract_index};
 
-            util::String topic_name = p_publish_packet->GetTopicName();
-            std::shared_ptr<Subscription> p_sub = p_client_state_->GetSubscription(topic_name);
+            // Reuses the capacity of earlier topic names
+            topic_name_.assign(topic_name_view.p_data_, topic_name_view.length_);
 
-            if (nullptr != p_sub) {
-                if (p_sub->IsActive()) {
-                    p_sub->p_app_handler_(topic_name, p_publish_packet->GetPayload(), p_sub->p_app_handler_data_);
+            ResponseCode rc = ResponseCode::FAILURE;
+            // Overlapping topic filters are all notified, same as the server delivers to each of them
+            // Lock free unless subscriptions changed since the last publish
+            p_client_state_->RefreshSubscriptionSnapshot(p_subscription_snapshot_);
+            matching_subscriptions_.clear();
+            p_subscription_snapshot_->GetMatchingSubscriptions(topic_name_, matching_subscriptions_);
+
+            if (!matching_subscriptions_.empty()) {
+                std::shared_ptr<InboundMessageDispatcher> p_dispatcher = p_client_state_->GetInboundDispatcher();
+                // Queued messages outlive read_buf, the copy is shared by all matching subscriptions
+                std::shared_ptr<const util::String> p_payload;
+                bool is_delivered = false;
+                rc = ResponseCode::MQTT_SUBSCRIPTION_NOT_ACTIVE;
+                for (auto &p_sub : matching_subscriptions_) {
+                    if (!p_sub->IsActive()) {
+                        continue;
+                    }
+                    if (nullptr == p_dispatcher) {
+                        p_sub->InvokeHandler(topic_name_view, payload_view);
+                        is_delivered = true;
+                    } else {
+                        if (nullptr == p_payload) {
+                            p_payload = std::make_shared<const util::String>(payload_view.ToString());
+                        }
+                        ResponseCode dispatch_rc = p_dispatcher->Dispatch(p_sub, topic_name_, p_payload);
+                        if (ResponseCode::SUCCESS == dispatch_rc) {
+                            is_delivered = true;
+                        } else {
+                            rc = dispatch_rc;
+                        }
+                    }
+                }
+                // Ack as long as at least one subscription took the message
+                if (is_delivered) {
                     rc = ResponseCode::SUCCESS;
-                } else {
-                    rc = ResponseCode::MQTT_SUBSCRIPTION_NOT_ACTIVE;
                 }
+                matching_subscriptions_.clear();
             } else {
                 rc = ResponseCode::MQTT_NO_SUBSCRIPTION_FOUND;
             }
 
             if (ResponseCode::SUCCESS == rc && QoS::QOS0 != qos) {
                 std::shared_ptr<mqtt::PubackPacket>
-                    p_puback_packet = PubackPacket::Create(p_publish_packet->GetPacketId());
+                    p_puback_packet = p_client_state_->AcquirePubackPacket(packet_id);
                 uint16_t action_id = 0;
                 /* TODO: nullchecks */
                 //Ignore action_id, we don't support QoS2 at the moment
-                rc = p_client_state_->EnqueueOutboundAction(ActionType::PUBACK, p_puback_packet, action_id);
+                // Sent ahead of queued publishes so the broker does not redeliver while the ack waits in the queue
+                rc = p_client_state_->EnqueueControlAction(ActionType::PUBACK, p_puback_packet, action_id);
             }
 
             return rc;
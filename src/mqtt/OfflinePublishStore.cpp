@@ -0,0 +1,560 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file OfflinePublishStore.cpp
+ * @brief
+ *
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#ifndef WIN32
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "util/logging/LogMacros.hpp"
+
+#include "mqtt/OfflinePublishStore.hpp"
+
+#define OFFLINE_PUBLISH_STORE_LOG_TAG "[Offline Publish Store]"
+
+#define SEGMENT_FILE_PREFIX "publish-"
+#define SEGMENT_FILE_SUFFIX ".log"
+
+#define RECORD_MAGIC 0x31425550U
+#define RECORD_STATE_LIVE 1
+#define RECORD_STATE_ACKNOWLEDGED 2
+#define RECORD_FLAG_RETAINED 0x01
+#define RECORD_ALIGNMENT 8
+
+#define MIN_SEGMENT_SIZE_BYTES 4096
+#define MIN_SEGMENT_COUNT 2
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /**
+         * Header written in front of each record. The magic is written last, so a record whose magic is set was
+         * copied completely. The checksum catches records torn by a power loss
+         */
+        struct RecordHeader {
+            uint32_t magic_;
+            uint8_t state_;
+            uint8_t flags_;
+            uint16_t topic_name_length_;
+            uint32_t payload_length_;
+            uint32_t checksum_;
+        };
+
+        static_assert(sizeof(RecordHeader) == 16, "Record header must not contain padding");
+
+        static size_t GetRecordSize(size_t topic_name_length, size_t payload_length) {
+            size_t record_size = sizeof(RecordHeader) + topic_name_length + payload_length;
+            return (record_size + RECORD_ALIGNMENT - 1) & ~static_cast<size_t>(RECORD_ALIGNMENT - 1);
+        }
+
+        static uint32_t GetRecordChecksum(const RecordHeader &header, const char *p_body) {
+            // FNV-1a over the immutable part of the header and the body
+            uint32_t checksum = 2166136261U;
+            const unsigned char fields[7] = {
+                header.flags_,
+                static_cast<unsigned char>(header.topic_name_length_ & 0xFF),
+                static_cast<unsigned char>(header.topic_name_length_ >> 8),
+                static_cast<unsigned char>(header.payload_length_ & 0xFF),
+                static_cast<unsigned char>((header.payload_length_ >> 8) & 0xFF),
+                static_cast<unsigned char>((header.payload_length_ >> 16) & 0xFF),
+                static_cast<unsigned char>(header.payload_length_ >> 24)
+            };
+            for (unsigned char field : fields) {
+                checksum = (checksum ^ field) * 16777619U;
+            }
+            size_t body_length = header.topic_name_length_ + static_cast<size_t>(header.payload_length_);
+            for (size_t i = 0; i < body_length; i++) {
+                checksum = (checksum ^ static_cast<unsigned char>(p_body[i])) * 16777619U;
+            }
+            return checksum;
+        }
+
+        /**
+         * @brief Check if a valid record starts at the offset
+         */
+        static bool IsValidRecord(const char *p_data, size_t size_bytes, size_t offset, RecordHeader &header_out) {
+            if (offset + sizeof(RecordHeader) > size_bytes) {
+                return false;
+            }
+            std::memcpy(&header_out, p_data + offset, sizeof(RecordHeader));
+            if (RECORD_MAGIC != header_out.magic_
+                || (RECORD_STATE_LIVE != header_out.state_ && RECORD_STATE_ACKNOWLEDGED != header_out.state_)
+                || offset + GetRecordSize(header_out.topic_name_length_, header_out.payload_length_) > size_bytes) {
+                return false;
+            }
+            return header_out.checksum_ == GetRecordChecksum(header_out, p_data + offset + sizeof(RecordHeader));
+        }
+
+        static uint64_t GetRecordId(uint64_t sequence_number, size_t offset) {
+            return (sequence_number << 32) | static_cast<uint64_t>(offset);
+        }
+
+        static uint64_t GetSequenceNumber(uint64_t record_id) {
+            return record_id >> 32;
+        }
+
+        static size_t GetOffset(uint64_t record_id) {
+            return static_cast<size_t>(record_id & 0xFFFFFFFFU);
+        }
+
+#ifndef WIN32
+        /**
+         * @brief Allocate the blocks of a new segment file, extending it with zeroes
+         *
+         * A sparse file would only fail once a write through the mapping needs a block, which raises SIGBUS
+         *
+         * @return int - 0 on success, error number otherwise
+         */
+        static int ReserveSegmentFile(int fd, size_t size_bytes) {
+#ifdef __APPLE__
+            fstore_t store = {F_ALLOCATECONTIG, F_PEOFPOSMODE, 0, static_cast<off_t>(size_bytes), 0};
+            if (-1 == fcntl(fd, F_PREALLOCATE, &store)) {
+                store.fst_flags = F_ALLOCATEALL;
+                if (-1 == fcntl(fd, F_PREALLOCATE, &store)) {
+                    return errno;
+                }
+            }
+            return 0 == ftruncate(fd, static_cast<off_t>(size_bytes)) ? 0 : errno;
+#else
+            return posix_fallocate(fd, 0, static_cast<off_t>(size_bytes));
+#endif
+        }
+
+        static ResponseCode MapSegmentFile(const util::String &path, bool is_new, size_t new_size_bytes,
+                                           int &fd_out, char *&p_data_out, size_t &size_bytes_out) {
+            int fd = open(path.c_str(), is_new ? (O_RDWR | O_CREAT | O_EXCL) : O_RDWR, 0600);
+            if (0 > fd) {
+                return ResponseCode::FILE_OPEN_ERROR;
+            }
+
+            size_t size_bytes = new_size_bytes;
+            if (is_new) {
+                // A zero magic marks the end of the records
+                int error = ReserveSegmentFile(fd, new_size_bytes);
+                if (0 != error) {
+                    AWS_LOG_ERROR(OFFLINE_PUBLISH_STORE_LOG_TAG, "Unable to allocate %s - %s", path.c_str(),
+                                  strerror(error));
+                    close(fd);
+                    // An empty segment file would fail to open after a restart
+                    std::remove(path.c_str());
+                    return (ENOSPC == error || EDQUOT == error || EFBIG == error)
+                           ? ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR : ResponseCode::FAILURE;
+                }
+            } else {
+                struct stat file_stat;
+                if (0 != fstat(fd, &file_stat) || 0 >= file_stat.st_size) {
+                    close(fd);
+                    return ResponseCode::FAILURE;
+                }
+                size_bytes = static_cast<size_t>(file_stat.st_size);
+            }
+
+            void *p_mapping = mmap(nullptr, size_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            if (MAP_FAILED == p_mapping) {
+                close(fd);
+                return ResponseCode::FAILURE;
+            }
+
+            fd_out = fd;
+            p_data_out = static_cast<char *>(p_mapping);
+            size_bytes_out = size_bytes;
+            return ResponseCode::SUCCESS;
+        }
+
+        static void UnmapSegmentFile(int fd, char *p_data, size_t size_bytes) {
+            munmap(p_data, size_bytes);
+            close(fd);
+        }
+
+        /**
+         * @brief Write a range of a mapped segment to the disk, msync requires a page aligned start
+         */
+        static bool SyncSegmentFile(char *p_data, size_t offset, size_t length) {
+            size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+            size_t aligned_offset = offset - (offset % page_size);
+            return 0 == msync(p_data + aligned_offset, length + (offset - aligned_offset), MS_SYNC);
+        }
+
+        static bool ListSegmentFiles(const util::String &directory_path, util::Vector<uint64_t> &sequence_numbers) {
+            DIR *p_dir = opendir(directory_path.c_str());
+            if (nullptr == p_dir) {
+                return false;
+            }
+
+            const size_t prefix_length = strlen(SEGMENT_FILE_PREFIX);
+            const size_t suffix_length = strlen(SEGMENT_FILE_SUFFIX);
+            struct dirent *p_entry;
+            while (nullptr != (p_entry = readdir(p_dir))) {
+                util::String file_name(p_entry->d_name);
+                if (file_name.length() <= prefix_length + suffix_length
+                    || 0 != file_name.compare(0, prefix_length, SEGMENT_FILE_PREFIX)
+                    || 0 != file_name.compare(file_name.length() - suffix_length, suffix_length,
+                                              SEGMENT_FILE_SUFFIX)) {
+                    continue;
+                }
+                char *p_end = nullptr;
+                unsigned long long sequence_number = strtoull(file_name.c_str() + prefix_length, &p_end, 10);
+                if (p_end == file_name.c_str() + file_name.length() - suffix_length && 0 < sequence_number) {
+                    sequence_numbers.push_back(static_cast<uint64_t>(sequence_number));
+                }
+            }
+            closedir(p_dir);
+            return true;
+        }
+#else
+        // Memory mapped segments are not implemented for this platform
+        static ResponseCode MapSegmentFile(const util::String &path, bool is_new, size_t new_size_bytes,
+                                           int &fd_out, char *&p_data_out, size_t &size_bytes_out) {
+            (void) path;
+            (void) is_new;
+            (void) new_size_bytes;
+            (void) fd_out;
+            (void) p_data_out;
+            (void) size_bytes_out;
+            return ResponseCode::FAILURE;
+        }
+
+        static void UnmapSegmentFile(int fd, char *p_data, size_t size_bytes) {
+            (void) fd;
+            (void) p_data;
+            (void) size_bytes;
+        }
+
+        static bool SyncSegmentFile(char *p_data, size_t offset, size_t length) {
+            (void) p_data;
+            (void) offset;
+            (void) length;
+            return false;
+        }
+
+        static bool ListSegmentFiles(const util::String &directory_path, util::Vector<uint64_t> &sequence_numbers) {
+            (void) directory_path;
+            (void) sequence_numbers;
+            return false;
+        }
+#endif
+
+        OfflinePublishStore::OfflinePublishStore(util::String directory_path,
+                                                 size_t segment_size_bytes,
+                                                 size_t max_segment_count,
+                                                 OfflineStoreOverflowPolicy overflow_policy)
+            : directory_path_(directory_path), segment_size_bytes_(segment_size_bytes),
+              max_segment_count_(std::max<size_t>(max_segment_count, MIN_SEGMENT_COUNT)),
+              overflow_policy_(overflow_policy), pending_record_count_(0) {
+        }
+
+        OfflinePublishStore::~OfflinePublishStore() {
+            for (auto &itr : segments_) {
+                SyncSegmentFile(itr.second.p_data_, 0, itr.second.write_offset_);
+                UnmapSegmentFile(itr.second.fd_, itr.second.p_data_, itr.second.size_bytes_);
+            }
+        }
+
+        std::unique_ptr<OfflinePublishStore> OfflinePublishStore::Create(util::String directory_path,
+                                                                         size_t segment_size_bytes,
+                                                                         size_t max_segment_count,
+                                                                         OfflineStoreOverflowPolicy overflow_policy) {
+            // Record offsets are stored in 32 bits of the record ID
+            if (directory_path.empty() || MIN_SEGMENT_SIZE_BYTES > segment_size_bytes
+                || UINT32_MAX < static_cast<uint64_t>(segment_size_bytes)) {
+                return nullptr;
+            }
+
+            util::Vector<uint64_t> sequence_numbers;
+            if (!ListSegmentFiles(directory_path, sequence_numbers)) {
+                AWS_LOG_ERROR(OFFLINE_PUBLISH_STORE_LOG_TAG, "Unable to open offline publish store directory %s",
+                              directory_path.c_str());
+                return nullptr;
+            }
+
+            std::unique_ptr<OfflinePublishStore> p_store = std::unique_ptr<OfflinePublishStore>(
+                new OfflinePublishStore(directory_path, segment_size_bytes, max_segment_count, overflow_policy));
+            std::sort(sequence_numbers.begin(), sequence_numbers.end());
+            for (uint64_t sequence_number : sequence_numbers) {
+                if (ResponseCode::SUCCESS != p_store->OpenSegment(sequence_number, false)) {
+                    AWS_LOG_ERROR(OFFLINE_PUBLISH_STORE_LOG_TAG, "Unable to open offline publish store segment %s",
+                                  p_store->GetSegmentPath(sequence_number).c_str());
+                    return nullptr;
+                }
+            }
+
+            // Compact segments left without publishes, keeping the last one to append to
+            auto itr = p_store->segments_.begin();
+            while (p_store->segments_.size() > 1 && itr != std::prev(p_store->segments_.end())) {
+                auto next_itr = std::next(itr);
+                if (0 == itr->second.live_record_count_) {
+                    p_store->DeleteSegment(itr);
+                }
+                itr = next_itr;
+            }
+            return p_store;
+        }
+
+        util::String OfflinePublishStore::GetSegmentPath(uint64_t sequence_number) {
+            char file_name[64];
+            snprintf(file_name, sizeof(file_name), SEGMENT_FILE_PREFIX "%020llu" SEGMENT_FILE_SUFFIX,
+                     static_cast<unsigned long long>(sequence_number));
+            util::String path = directory_path_;
+            if ('/' != path.back()) {
+                path.append("/");
+            }
+            path.append(file_name);
+            return path;
+        }
+
+        ResponseCode OfflinePublishStore::OpenSegment(uint64_t sequence_number, bool is_new) {
+            Segment segment;
+            ResponseCode rc = MapSegmentFile(GetSegmentPath(sequence_number), is_new, segment_size_bytes_,
+                                             segment.fd_, segment.p_data_, segment.size_bytes_);
+            if (ResponseCode::SUCCESS != rc) {
+                return rc;
+            }
+            segment.write_offset_ = 0;
+            segment.read_offset_ = 0;
+            segment.live_record_count_ = 0;
+
+            // Records end at the first invalid header, a torn record is overwritten by the next append
+            RecordHeader header;
+            bool is_read_offset_set = false;
+            while (IsValidRecord(segment.p_data_, segment.size_bytes_, segment.write_offset_, header)) {
+                if (RECORD_STATE_LIVE == header.state_) {
+                    segment.live_record_count_++;
+                    if (!is_read_offset_set) {
+                        segment.read_offset_ = segment.write_offset_;
+                        is_read_offset_set = true;
+                    }
+                }
+                segment.write_offset_ += GetRecordSize(header.topic_name_length_, header.payload_length_);
+            }
+            if (!is_read_offset_set) {
+                segment.read_offset_ = segment.write_offset_;
+            }
+
+            pending_record_count_ += segment.live_record_count_;
+            segments_.insert(std::make_pair(sequence_number, segment));
+            return ResponseCode::SUCCESS;
+        }
+
+        util::Map<uint64_t, OfflinePublishStore::Segment>::iterator OfflinePublishStore::FindSegment(uint64_t record_id) {
+            return segments_.find(GetSequenceNumber(record_id));
+        }
+
+        void OfflinePublishStore::DeleteSegment(util::Map<uint64_t, Segment>::iterator segment_itr) {
+            uint64_t sequence_number = segment_itr->first;
+            Segment &segment = segment_itr->second;
+            if (0 < segment.live_record_count_) {
+                AWS_LOG_WARN(OFFLINE_PUBLISH_STORE_LOG_TAG, "Dropping %zu stored publishes, the store is full",
+                             segment.live_record_count_);
+            }
+            pending_record_count_ -= segment.live_record_count_;
+            UnmapSegmentFile(segment.fd_, segment.p_data_, segment.size_bytes_);
+            std::remove(GetSegmentPath(sequence_number).c_str());
+            segments_.erase(segment_itr);
+
+            released_record_ids_.erase(
+                std::remove_if(released_record_ids_.begin(), released_record_ids_.end(),
+                               [sequence_number](uint64_t record_id) -> bool {
+                                   return GetSequenceNumber(record_id) == sequence_number;
+                               }), released_record_ids_.end());
+        }
+
+        void OfflinePublishStore::ReadRecord(const Segment &segment, uint64_t sequence_number, size_t offset,
+                                             Record &record_out) {
+            RecordHeader header;
+            std::memcpy(&header, segment.p_data_ + offset, sizeof(RecordHeader));
+            const char *p_body = segment.p_data_ + offset + sizeof(RecordHeader);
+            record_out.record_id_ = GetRecordId(sequence_number, offset);
+            record_out.topic_name_.assign(p_body, header.topic_name_length_);
+            record_out.p_payload_ = std::make_shared<const util::String>(p_body + header.topic_name_length_,
+                                                                         header.payload_length_);
+            record_out.is_retained_ = (0 != (header.flags_ & RECORD_FLAG_RETAINED));
+        }
+
+        ResponseCode OfflinePublishStore::Append(const util::String &topic_name, const util::String &payload,
+                                                 bool is_retained, uint64_t &record_id_out) {
+            size_t record_size = GetRecordSize(topic_name.length(), payload.length());
+            if (UINT16_MAX < topic_name.length() || segment_size_bytes_ < record_size) {
+                return ResponseCode::MQTT_INVALID_DATA_ERROR;
+            }
+
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            if (segments_.empty()
+                || segments_.rbegin()->second.write_offset_ + record_size > segments_.rbegin()->second.size_bytes_) {
+                if (segments_.size() >= max_segment_count_) {
+                    if (OfflineStoreOverflowPolicy::REJECT_NEW == overflow_policy_) {
+                        return ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR;
+                    }
+                    DeleteSegment(segments_.begin());
+                }
+
+                uint64_t sequence_number = segments_.empty() ? 1 : segments_.rbegin()->first + 1;
+                ResponseCode rc = OpenSegment(sequence_number, true);
+                if (ResponseCode::SUCCESS != rc) {
+                    AWS_LOG_ERROR(OFFLINE_PUBLISH_STORE_LOG_TAG, "Unable to create offline publish store segment %s",
+                                  GetSegmentPath(sequence_number).c_str());
+                    return rc;
+                }
+
+                // The previous segment is no longer written, delete it if all its publishes were acknowledged
+                if (1 < segments_.size()) {
+                    auto previous_itr = std::prev(segments_.end(), 2);
+                    if (0 == previous_itr->second.live_record_count_) {
+                        DeleteSegment(previous_itr);
+                    }
+                }
+            }
+
+            uint64_t sequence_number = segments_.rbegin()->first;
+            Segment &segment = segments_.rbegin()->second;
+            char *p_record = segment.p_data_ + segment.write_offset_;
+
+            RecordHeader header;
+            header.magic_ = 0;
+            header.state_ = RECORD_STATE_LIVE;
+            header.flags_ = static_cast<uint8_t>(is_retained ? RECORD_FLAG_RETAINED : 0);
+            header.topic_name_length_ = static_cast<uint16_t>(topic_name.length());
+            header.payload_length_ = static_cast<uint32_t>(payload.length());
+
+            char *p_body = p_record + sizeof(RecordHeader);
+            std::memcpy(p_body, topic_name.data(), topic_name.length());
+            std::memcpy(p_body + topic_name.length(), payload.data(), payload.length());
+            header.checksum_ = GetRecordChecksum(header, p_body);
+            std::memcpy(p_record, &header, sizeof(RecordHeader));
+            header.magic_ = RECORD_MAGIC;
+            std::memcpy(p_record, &header.magic_, sizeof(header.magic_));
+            if (!SyncSegmentFile(segment.p_data_, segment.write_offset_, record_size)) {
+                // Without the magic the record ends the segment and is overwritten by the next append
+                std::memset(p_record, 0, sizeof(header.magic_));
+                AWS_LOG_ERROR(OFFLINE_PUBLISH_STORE_LOG_TAG, "Unable to write publish to %s",
+                              GetSegmentPath(sequence_number).c_str());
+                return ResponseCode::FAILURE;
+            }
+
+            record_id_out = GetRecordId(sequence_number, segment.write_offset_);
+            segment.write_offset_ += record_size;
+            segment.live_record_count_++;
+            pending_record_count_++;
+            return ResponseCode::SUCCESS;
+        }
+
+        bool OfflinePublishStore::GetNextRecord(Record &record_out) {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            if (!released_record_ids_.empty()) {
+                uint64_t record_id = released_record_ids_.front();
+                released_record_ids_.erase(released_record_ids_.begin());
+                auto segment_itr = FindSegment(record_id);
+                ReadRecord(segment_itr->second, segment_itr->first, GetOffset(record_id), record_out);
+                return true;
+            }
+
+            RecordHeader header;
+            for (auto &itr : segments_) {
+                Segment &segment = itr.second;
+                while (segment.read_offset_ < segment.write_offset_) {
+                    size_t offset = segment.read_offset_;
+                    std::memcpy(&header, segment.p_data_ + offset, sizeof(RecordHeader));
+                    segment.read_offset_ += GetRecordSize(header.topic_name_length_, header.payload_length_);
+                    // Records acknowledged before a restart are skipped
+                    if (RECORD_STATE_LIVE == header.state_) {
+                        ReadRecord(segment, itr.first, offset, record_out);
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        void OfflinePublishStore::AcknowledgeRecord(uint64_t record_id) {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            auto segment_itr = FindSegment(record_id);
+            if (segments_.end() == segment_itr) {
+                // Segment was dropped while the publish was in flight
+                return;
+            }
+
+            Segment &segment = segment_itr->second;
+            char *p_state = segment.p_data_ + GetOffset(record_id) + offsetof(RecordHeader, state_);
+            if (RECORD_STATE_LIVE != *p_state) {
+                return;
+            }
+            *p_state = RECORD_STATE_ACKNOWLEDGED;
+            segment.live_record_count_--;
+            pending_record_count_--;
+
+            if (0 == segment.live_record_count_ && segment_itr != std::prev(segments_.end())) {
+                DeleteSegment(segment_itr);
+            }
+        }
+
+        void OfflinePublishStore::ReleaseRecord(uint64_t record_id) {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            if (segments_.end() == FindSegment(record_id)) {
+                return;
+            }
+            // Record IDs increase in the order publishes were stored
+            auto itr = std::lower_bound(released_record_ids_.begin(), released_record_ids_.end(), record_id);
+            if (released_record_ids_.end() == itr || record_id != *itr) {
+                released_record_ids_.insert(itr, record_id);
+            }
+        }
+
+        bool OfflinePublishStore::HasUnsentRecords() {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            if (!released_record_ids_.empty()) {
+                return true;
+            }
+            for (auto &itr : segments_) {
+                if (itr.second.read_offset_ < itr.second.write_offset_) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t OfflinePublishStore::GetPendingRecordCount() {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            return pending_record_count_;
+        }
+
+        size_t OfflinePublishStore::GetSegmentCount() {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            return segments_.size();
+        }
+
+        ResponseCode OfflinePublishStore::Flush() {
+            std::lock_guard<std::mutex> store_lock(store_lock_);
+            for (auto &itr : segments_) {
+                if (!SyncSegmentFile(itr.second.p_data_, 0, itr.second.size_bytes_)) {
+                    return ResponseCode::FAILURE;
+                }
+            }
+            return ResponseCode::SUCCESS;
+        }
+    }
+}
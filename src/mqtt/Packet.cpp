@@ -20,12 +20,15 @@
  */
 
 #include <algorithm>
+#include <cstring>
 
 #include "ResponseCode.hpp"
 #include "mqtt/Packet.hpp"
 #include <cstdio>
 
 #define MAX_MQTT_PACKET_REM_LEN_BYTES 268435455
+// One type byte and up to four remaining length bytes
+#define MAX_MQTT_FIXED_HEADER_LENGTH 5
 
 // Fixed header first bytes as per MQTT spec
 // CONNECT - 0001 0000
@@ -166,23 +169,26 @@ namespace awsiotsdk {
         }
 
         void PacketFixedHeader::AppendToBuffer(util::String &p_buf) {
-            unsigned char encoded_byte = (unsigned char) 0;
+            char header_buf[MAX_MQTT_FIXED_HEADER_LENGTH];
+            char *p_header_end = WriteToBuffer(header_buf);
+            p_buf.append(header_buf, static_cast<size_t>(p_header_end - header_buf));
+        }
+
+        char *PacketFixedHeader::WriteToBuffer(char *p_buf) {
+            unsigned char encoded_byte;
             size_t length = remaining_length_;
 
-            p_buf.append((char *) &fixed_header_byte_, 1);
+            *p_buf++ = (char) fixed_header_byte_;
+            do {
+                encoded_byte = (unsigned char) (length % 128);
+                length /= 128;
+                if (length > 0) {
+                    encoded_byte |= 0x80;
+                }
+                *p_buf++ = (char) encoded_byte;
+            } while (length > 0);
 
-            if (0 < remaining_length_) {
-                do {
-                    encoded_byte = (unsigned char) (length % 128);
-                    length /= 128;
-                    if (length > 0) {
-                        encoded_byte |= 0x80;
-                    }
-                    p_buf.append((char *) &encoded_byte, 1);
-                } while (length > 0);
-            } else {
-                p_buf.append((char *) &encoded_byte, 1);
-            }
+            return p_buf;
         }
 
         void Packet::AppendUInt16ToBuffer(util::String &buf, uint16_t value) {
@@ -192,6 +198,12 @@ namespace awsiotsdk {
             buf.append(&second_byte, 1);
         }
 
+        char *Packet::WriteUInt16ToBuffer(char *p_buf, uint16_t value) {
+            *p_buf++ = (char) (value / 256);
+            *p_buf++ = (char) (value % 256);
+            return p_buf;
+        }
+
         uint16_t Packet::ReadUInt16FromBuffer(const util::Vector<unsigned char> &buf, size_t &extract_index) {
             uint8_t first_byte = (uint8_t) buf[extract_index++];
             uint8_t second_byte = (uint8_t) buf[extract_index++];
@@ -223,7 +235,7 @@ namespace awsiotsdk {
                 temp_byte = (char) (length % 256);
                 buf.append(&temp_byte, 1);
 
-                buf.append(utf8_str->ToStdString());
+                buf.append(utf8_str->GetString());
             }
         }
 
@@ -236,8 +248,40 @@ namespace awsiotsdk {
                 temp_byte = (char) (length % 256);
                 buf.append(&temp_byte, 1);
 
-                buf.append(utf8_str->ToStdString());
+                buf.append(utf8_str->GetString());
+            }
+        }
+   
+        char *Packet::WriteUtf8StringToBuffer(char *p_buf, Utf8String &utf8_str) {
+            size_t length = utf8_str.Length();
+
+            if (length > 0) {
+                p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(length));
+                std::memcpy(p_buf, utf8_str.GetString().data(), length);
+                p_buf += length;
+            }
+            return p_buf;
+        }
+
+        ResponseCode Packet::SerializeToBuffer(char *p_buf, size_t buf_len, size_t &serialized_length_out) {
+            serialized_length_out = 0;
+            if (nullptr == p_buf || buf_len < serialized_packet_length_) {
+                return ResponseCode::FAILURE;
             }
+            serialized_length_out = static_cast<size_t>(WriteToBuffer(p_buf) - p_buf);
+            return ResponseCode::SUCCESS;
+        }
+
+        void Packet::SerializeToBuffer(util::String &buf) {
+            // Every packet has a fixed header, so Size() is never zero
+            buf.resize(serialized_packet_length_);
+            buf.resize(static_cast<size_t>(WriteToBuffer(&buf[0]) - &buf[0]));
+        }
+
+        util::String Packet::ToString() {
+            util::String buf;
+            SerializeToBuffer(buf);
+            return buf;
         }
     }
 }
@@ -21,6 +21,8 @@
  * Also defines the packet types used by these actions.
  */
 
+#include <cstring>
+
 #include "util/logging/LogMacros.hpp"
 
 #include "mqtt/ClientState.hpp"
@@ -42,20 +44,68 @@ namespace awsiotsdk {
                                      bool is_retained,
                                      bool is_duplicate,
                                      QoS qos,
-                                     const util::String &payload) {
-            packet_size_ = p_topic_name->Length() + 2 + payload.length(); // length of topic name requires 2 bytes
+                                     const util::String &payload)
+            : PublishPacket(std::move(p_topic_name), is_retained, is_duplicate, qos,
+                            std::make_shared<util::String>(payload)) {
+            is_payload_owned_ = true;
+        }
+
+        PublishPacket::PublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                                     bool is_retained,
+                                     bool is_duplicate,
+                                     QoS qos,
+                                     util::String &&payload)
+            : PublishPacket(std::move(p_topic_name), is_retained, is_duplicate, qos,
+                            std::make_shared<util::String>(std::move(payload))) {
+            is_payload_owned_ = true;
+        }
+
+        PublishPacket::PublishPacket(std::unique_ptr<Utf8String> p_topic_name,
+                                     bool is_retained,
+                                     bool is_duplicate,
+                                     QoS qos,
+                                     std::shared_ptr<const util::String> p_payload) {
+            Reset(std::move(p_topic_name), is_retained, is_duplicate, qos, std::move(p_payload));
+        }
+
+        void PublishPacket::Reset(std::unique_ptr<Utf8String> p_topic_name,
+                                  bool is_retained,
+                                  bool is_duplicate,
+                                  QoS qos,
+                                  const util::String &payload) {
+            std::shared_ptr<const util::String> p_payload;
+            if (is_payload_owned_ && 1 == p_payload_.use_count()) {
+                // use_count is a relaxed load, order it after the last release of the payload
+                std::atomic_thread_fence(std::memory_order_acquire);
+                // Allocated as a non-const String by this packet, so it can be modified once nothing else holds it
+                const_cast<util::String &>(*p_payload_).assign(payload);
+                p_payload = std::move(p_payload_);
+            } else {
+                p_payload = std::make_shared<util::String>(payload);
+            }
+            Reset(std::move(p_topic_name), is_retained, is_duplicate, qos, std::move(p_payload));
+            is_payload_owned_ = true;
+        }
+
+        void PublishPacket::Reset(std::unique_ptr<Utf8String> p_topic_name,
+                                  bool is_retained,
+                                  bool is_duplicate,
+                                  QoS qos,
+                                  std::shared_ptr<const util::String> p_payload) {
+            if (nullptr == p_payload) {
+                p_payload = std::make_shared<const util::String>();
+            }
+
+            packet_size_ = p_topic_name->Length() + 2 + p_payload->length(); // length of topic name requires 2 bytes
 
             if (QoS::QOS0 != qos) {
                 packet_size_ += 2; // Packet ID requires 2 bytes in case of QoS1 and QoS2
             }
 
             p_topic_name_ = std::move(p_topic_name);
-            payload_.clear();
-
-            // If payload is not zero length, add it to the packet
-            if (0 != payload.length()) {
-                payload_ = payload;
-            }
+            p_payload_ = std::move(p_payload);
+            is_payload_owned_ = false;
+            p_async_ack_handler_ = nullptr;
 
             is_retained_ = is_retained;
             is_duplicate_ = is_duplicate;
@@ -80,6 +130,7 @@ namespace awsiotsdk {
             is_retained_ = is_retained;
             is_duplicate_ = is_duplicate;
             qos_ = qos;
+            is_payload_owned_ = false;
 
             p_topic_name_ = std::unique_ptr<Utf8String>(ReadUtf8StringFromBuffer(buf, extract_index));
 
@@ -89,12 +140,12 @@ namespace awsiotsdk {
 
             if (extract_index == buf.size()) {
                 // Zero length payload
-                payload_.clear();
+                p_payload_ = std::make_shared<const util::String>();
             } else {
-                payload_ = util::String(buf.begin() + extract_index, buf.end());
+                p_payload_ = std::make_shared<const util::String>(buf.begin() + extract_index, buf.end());
             }
 
-            packet_size_ = p_topic_name_->Length() + 2 + payload_.length(); // length of topic name requires 2 bytes
+            packet_size_ = p_topic_name_->Length() + 2 + p_payload_->length(); // length of topic name requires 2 bytes
 
             fixed_header_.Initialize(MessageTypes::PUBLISH, is_duplicate, qos, is_retained, packet_size_);
 
@@ -112,6 +163,30 @@ namespace awsiotsdk {
             return std::make_shared<PublishPacket>(std::move(p_topic_name), is_retained, is_duplicate, qos, payload);
         }
 
+        std::shared_ptr<PublishPacket> PublishPacket::Create(std::unique_ptr<Utf8String> p_topic_name,
+                                                             bool is_retained,
+                                                             bool is_duplicate,
+                                                             QoS qos,
+                                                             util::String &&payload) {
+            if (nullptr == p_topic_name) {
+                return nullptr;
+            }
+            return std::make_shared<PublishPacket>(std::move(p_topic_name), is_retained, is_duplicate, qos,
+                                                   std::move(payload));
+        }
+
+        std::shared_ptr<PublishPacket> PublishPacket::Create(std::unique_ptr<Utf8String> p_topic_name,
+                                                             bool is_retained,
+                                                             bool is_duplicate,
+                                                             QoS qos,
+                                                             std::shared_ptr<const util::String> p_payload) {
+            if (nullptr == p_topic_name) {
+                return nullptr;
+            }
+            return std::make_shared<PublishPacket>(std::move(p_topic_name), is_retained, is_duplicate, qos,
+                                                   std::move(p_payload));
+        }
+
         std::shared_ptr<PublishPacket> PublishPacket::Create(const util::Vector<unsigned char> &buf,
                                                              bool is_retained,
                                                              bool is_duplicate,
@@ -123,21 +198,41 @@ namespace awsiotsdk {
             return std::make_shared<PublishPacket>(buf, is_retained, is_duplicate, qos);
         }
 
-        util::String PublishPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
+        void PublishPacket::SetDuplicate(bool is_duplicate) {
+            if (QoS::QOS0 == qos_) {
+                return;
+            }
+            is_duplicate_ = is_duplicate;
+            fixed_header_.Initialize(MessageTypes::PUBLISH, is_duplicate_, qos_, is_retained_, packet_size_);
+        }
 
-            fixed_header_.AppendToBuffer(buf);
-            AppendUtf8StringToBuffer(buf, p_topic_name_);
+        char *PublishPacket::WriteHeaderToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
+            p_buf = WriteUtf8StringToBuffer(p_buf, *p_topic_name_);
 
             if (QoS::QOS0 != qos_) {
-                AppendUInt16ToBuffer(buf, GetPacketId());
+                p_buf = WriteUInt16ToBuffer(p_buf, GetPacketId());
             }
+            return p_buf;
+        }
+
+        char *PublishPacket::WriteToBuffer(char *p_buf) {
+            p_buf = WriteHeaderToBuffer(p_buf);
+            std::memcpy(p_buf, p_payload_->data(), p_payload_->length());
+            return p_buf + p_payload_->length();
+        }
 
-            buf.append(payload_);
+        util::String PublishPacket::HeaderToString() {
+            util::String buf;
+            SerializeHeaderToBuffer(buf);
             return buf;
         }
 
+        void PublishPacket::SerializeHeaderToBuffer(util::String &buf) {
+            buf.resize(serialized_packet_length_ - p_payload_->length());
+            buf.resize(static_cast<size_t>(WriteHeaderToBuffer(&buf[0]) - &buf[0]));
+        }
+
         /*******************************************
          * PubackPacket class function definitions *
          ******************************************/
@@ -152,13 +247,9 @@ namespace awsiotsdk {
             return std::make_shared<PubackPacket>(packet_id);
         }
 
-        util::String PubackPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-            fixed_header_.AppendToBuffer(buf);
-            AppendUInt16ToBuffer(buf, publish_packet_id_.load(std::memory_order_relaxed));
-
-            return buf;
+        char *PubackPacket::WriteToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
+            return WriteUInt16ToBuffer(p_buf, publish_packet_id_.load(std::memory_order_relaxed));
         }
 
         /*************************************************
@@ -181,6 +272,17 @@ namespace awsiotsdk {
 
         ResponseCode PublishActionAsync::PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                                        std::shared_ptr<ActionData> p_action_data) {
+            return PerformRequest(p_network_connection, p_action_data, true);
+        }
+
+        ResponseCode PublishActionAsync::PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                             std::shared_ptr<ActionData> p_action_data) {
+            return PerformRequest(p_network_connection, p_action_data, false);
+        }
+
+        ResponseCode PublishActionAsync::PerformRequest(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                        std::shared_ptr<ActionData> p_action_data,
+                                                        bool should_register_ack) {
             std::shared_ptr<PublishPacket> p_publish_packet = std::dynamic_pointer_cast<PublishPacket>(p_action_data);
             if (nullptr == p_publish_packet) {
                 return ResponseCode::NULL_VALUE_ERROR;
@@ -189,7 +291,8 @@ namespace awsiotsdk {
             bool is_ack_registered = false;
             ResponseCode rc = ResponseCode::SUCCESS;
             uint16_t packet_id = p_publish_packet->GetPacketId();
-            if (QoS::QOS0 != p_publish_packet->GetQoS() && nullptr != p_publish_packet->p_async_ack_handler_) {
+            if (should_register_ack && QoS::QOS0 != p_publish_packet->GetQoS()
+                && nullptr != p_publish_packet->p_async_ack_handler_) {
                 rc = p_client_state_->RegisterPendingAck(packet_id, p_publish_packet->p_async_ack_handler_);
                 if (ResponseCode::SUCCESS != rc) {
                     AWS_LOG_ERROR(PUBLISH_ACTION_LOG_TAG,
@@ -200,14 +303,27 @@ namespace awsiotsdk {
                 }
             }
 
-            const util::String packet_data = p_publish_packet->ToString();
-            rc = WriteToNetworkBuffer(p_network_connection, packet_data);
+            // Header and payload are sent as one gathered write, the shared payload is not copied here
+            p_publish_packet->SerializeHeaderToBuffer(packet_buffer_);
+            write_segments_.resize(2);
+            write_segments_[0].p_data_ = packet_buffer_.data();
+            write_segments_[0].length_ = packet_buffer_.length();
+            write_segments_[1].p_owner_ = p_publish_packet->GetSharedPayload();
+            write_segments_[1].p_data_ = write_segments_[1].p_owner_->data();
+            write_segments_[1].length_ = write_segments_[1].p_owner_->length();
+
+            rc = WriteToNetworkBuffer(p_network_connection, write_segments_);
+            // Only the buffer is kept for the next publish
+            write_segments_[1].p_owner_ = nullptr;
             if (ResponseCode::SUCCESS != rc) {
                 if (is_ack_registered) {
                     p_client_state_->DeletePendingAck(packet_id);
                 }
                 AWS_LOG_ERROR(PUBLISH_ACTION_LOG_TAG, "Publish Write to Network Failed. %s",
                               ResponseHelper::ToString(rc).c_str());
+            } else if (QoS::QOS0 != p_publish_packet->GetQoS()) {
+                // Sent publishes are sent again if the connection drops before they are acknowledged
+                p_client_state_->SetInflightPublishSent(packet_id);
             }
             return rc;
         }
@@ -237,8 +353,8 @@ namespace awsiotsdk {
                 return ResponseCode::NULL_VALUE_ERROR;
             }
 
-            const util::String packet_data = p_puback_packet->ToString();
-            ResponseCode rc = WriteToNetworkBuffer(p_network_connection, packet_data);
+            p_puback_packet->SerializeToBuffer(packet_buffer_);
+            ResponseCode rc = WriteToNetworkBuffer(p_network_connection, packet_buffer_);
             if (ResponseCode::SUCCESS != rc) {
                 AWS_LOG_ERROR(PUBACK_ACTION_LOG_TAG, "Puback Write to Network Failed. %s",
                               ResponseHelper::ToString(rc).c_str());
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file ReconnectBackoff.cpp
+ * @brief
+ *
+ */
+
+#include <algorithm>
+
+#include "mqtt/ReconnectBackoff.hpp"
+
+namespace awsiotsdk {
+    namespace mqtt {
+        /*********************************************************
+         * ExponentialBackoffStrategy class function definitions *
+         ********************************************************/
+        ExponentialBackoffStrategy::ExponentialBackoffStrategy() {
+            current_backoff_ = std::chrono::milliseconds(0);
+            max_backoff_ = std::chrono::milliseconds(0);
+            is_first_attempt_ = true;
+        }
+
+        std::shared_ptr<ExponentialBackoffStrategy> ExponentialBackoffStrategy::Create() {
+            return std::make_shared<ExponentialBackoffStrategy>();
+        }
+
+        void ExponentialBackoffStrategy::Reset(std::chrono::milliseconds min_backoff,
+                                               std::chrono::milliseconds max_backoff) {
+            current_backoff_ = min_backoff;
+            max_backoff_ = max_backoff;
+            is_first_attempt_ = true;
+        }
+
+        std::chrono::milliseconds ExponentialBackoffStrategy::GetNextBackoff() {
+            if (is_first_attempt_) {
+                is_first_attempt_ = false;
+                return std::chrono::milliseconds(0);
+            }
+            if (max_backoff_ > current_backoff_) {
+                current_backoff_ += current_backoff_;
+            }
+            return current_backoff_;
+        }
+
+        /********************************************************
+         * FullJitterBackoffStrategy class function definitions *
+         *******************************************************/
+        FullJitterBackoffStrategy::FullJitterBackoffStrategy(uint32_t seed) : random_engine_(seed) {
+            min_backoff_ = std::chrono::milliseconds(0);
+            max_backoff_ = std::chrono::milliseconds(0);
+            current_ceiling_ = std::chrono::milliseconds(0);
+        }
+
+        std::shared_ptr<FullJitterBackoffStrategy> FullJitterBackoffStrategy::Create() {
+            std::random_device random_device;
+            return std::make_shared<FullJitterBackoffStrategy>(random_device());
+        }
+
+        std::shared_ptr<FullJitterBackoffStrategy> FullJitterBackoffStrategy::Create(uint32_t seed) {
+            return std::make_shared<FullJitterBackoffStrategy>(seed);
+        }
+
+        void FullJitterBackoffStrategy::Reset(std::chrono::milliseconds min_backoff,
+                                              std::chrono::milliseconds max_backoff) {
+            min_backoff_ = std::max(min_backoff, std::chrono::milliseconds(0));
+            max_backoff_ = std::max(max_backoff, min_backoff_);
+            current_ceiling_ = min_backoff_;
+        }
+
+        std::chrono::milliseconds FullJitterBackoffStrategy::GetNextBackoff() {
+            std::uniform_int_distribution<std::chrono::milliseconds::rep> distribution(0, current_ceiling_.count());
+            std::chrono::milliseconds backoff(distribution(random_engine_));
+            current_ceiling_ = std::min(current_ceiling_ + current_ceiling_, max_backoff_);
+            return backoff;
+        }
+
+        /****************************************************************
+         * DecorrelatedJitterBackoffStrategy class function definitions *
+         ***************************************************************/
+        DecorrelatedJitterBackoffStrategy::DecorrelatedJitterBackoffStrategy(uint32_t seed) : random_engine_(seed) {
+            min_backoff_ = std::chrono::milliseconds(0);
+            max_backoff_ = std::chrono::milliseconds(0);
+            last_backoff_ = std::chrono::milliseconds(0);
+        }
+
+        std::shared_ptr<DecorrelatedJitterBackoffStrategy> DecorrelatedJitterBackoffStrategy::Create() {
+            std::random_device random_device;
+            return std::make_shared<DecorrelatedJitterBackoffStrategy>(random_device());
+        }
+
+        std::shared_ptr<DecorrelatedJitterBackoffStrategy> DecorrelatedJitterBackoffStrategy::Create(uint32_t seed) {
+            return std::make_shared<DecorrelatedJitterBackoffStrategy>(seed);
+        }
+
+        void DecorrelatedJitterBackoffStrategy::Reset(std::chrono::milliseconds min_backoff,
+                                                      std::chrono::milliseconds max_backoff) {
+            min_backoff_ = std::max(min_backoff, std::chrono::milliseconds(0));
+            max_backoff_ = std::max(max_backoff, min_backoff_);
+            last_backoff_ = min_backoff_;
+        }
+
+        std::chrono::milliseconds DecorrelatedJitterBackoffStrategy::GetNextBackoff() {
+            std::uniform_int_distribution<std::chrono::milliseconds::rep>
+                distribution(min_backoff_.count(), std::max(min_backoff_, last_backoff_ * 3).count());
+            last_backoff_ = std::min(std::chrono::milliseconds(distribution(random_engine_)), max_backoff_);
+            return last_backoff_;
+        }
+
+        /***********************************************************
+         * FixedScheduleBackoffStrategy class function definitions *
+         **********************************************************/
+        FixedScheduleBackoffStrategy::FixedScheduleBackoffStrategy(util::Vector<std::chrono::milliseconds> schedule)
+            : schedule_(std::move(schedule)) {
+            next_index_ = 0;
+        }
+
+        std::shared_ptr<FixedScheduleBackoffStrategy> FixedScheduleBackoffStrategy::Create(
+            util::Vector<std::chrono::milliseconds> schedule) {
+            if (schedule.empty()) {
+                return nullptr;
+            }
+            return std::make_shared<FixedScheduleBackoffStrategy>(std::move(schedule));
+        }
+
+        void FixedScheduleBackoffStrategy::Reset(std::chrono::milliseconds min_backoff,
+                                                 std::chrono::milliseconds max_backoff) {
+            next_index_ = 0;
+        }
+
+        std::chrono::milliseconds FixedScheduleBackoffStrategy::GetNextBackoff() {
+            if (schedule_.empty()) {
+                return std::chrono::milliseconds(0);
+            }
+            std::chrono::milliseconds backoff = schedule_[next_index_];
+            if (schedule_.size() > next_index_ + 1) {
+                next_index_++;
+            }
+            return backoff;
+        }
+
+        /*****************************************************
+         * ReconnectTimeHistogram class function definitions *
+         ****************************************************/
+        ReconnectTimeHistogram::ReconnectTimeHistogram() {
+            Reset();
+        }
+
+        std::chrono::milliseconds ReconnectTimeHistogram::GetBucketUpperBound(size_t bucket_index) {
+            if (RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT <= bucket_index + 1) {
+                return std::chrono::milliseconds::max();
+            }
+            return std::chrono::milliseconds(RECONNECT_TIME_HISTOGRAM_FIRST_BUCKET_MS) * (1LL << bucket_index);
+        }
+
+        void ReconnectTimeHistogram::Record(std::chrono::milliseconds reconnect_time) {
+            size_t bucket_index = 0;
+            while (GetBucketUpperBound(bucket_index) < reconnect_time) {
+                bucket_index++;
+            }
+
+            std::lock_guard<std::mutex> histogram_lock(histogram_lock_);
+            bucket_counts_[bucket_index]++;
+            total_count_++;
+            max_reconnect_time_ = std::max(max_reconnect_time_, reconnect_time);
+        }
+
+        uint64_t ReconnectTimeHistogram::GetBucketCount(size_t bucket_index) {
+            if (RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT <= bucket_index) {
+                return 0;
+            }
+            std::lock_guard<std::mutex> histogram_lock(histogram_lock_);
+            return bucket_counts_[bucket_index];
+        }
+
+        uint64_t ReconnectTimeHistogram::GetCount() {
+            std::lock_guard<std::mutex> histogram_lock(histogram_lock_);
+            return total_count_;
+        }
+
+        std::chrono::milliseconds ReconnectTimeHistogram::GetMax() {
+            std::lock_guard<std::mutex> histogram_lock(histogram_lock_);
+            return max_reconnect_time_;
+        }
+
+        std::chrono::milliseconds ReconnectTimeHistogram::GetPercentile(double percentile) {
+            std::lock_guard<std::mutex> histogram_lock(histogram_lock_);
+            if (0 == total_count_) {
+                return std::chrono::milliseconds(0);
+            }
+
+            // Rank of the reconnect at the percentile, counted from one
+            double rank = std::max(1.0, std::min(percentile, 100.0) * total_count_ / 100.0);
+            uint64_t counted = 0;
+            for (size_t bucket_index = 0; RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT > bucket_index; bucket_index++) {
+                counted += bucket_counts_[bucket_index];
+                if (counted >= rank) {
+                    return std::min(GetBucketUpperBound(bucket_index), max_reconnect_time_);
+                }
+            }
+            return max_reconnect_time_;
+        }
+
+        void ReconnectTimeHistogram::Reset() {
+            std::lock_guard<std::mutex> histogram_lock(histogram_lock_);
+            std::fill(bucket_counts_, bucket_counts_ + RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT, 0);
+            total_count_ = 0;
+            max_reconnect_time_ = std::chrono::milliseconds(0);
+        }
+    }
+}
@@ -63,32 +63,27 @@ namespace awsiotsdk {
             return std::make_shared<SubscribePacket>(subscription_list);
         }
 
-        util::String SubscribePacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-            char temp_qos_byte;
-
-            fixed_header_.AppendToBuffer(buf);
-            AppendUInt16ToBuffer(buf, static_cast<uint16_t>(packet_id_));
+        char *SubscribePacket::WriteToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
+            p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(packet_id_));
 
             uint8_t itr_index;
             util::Vector<std::shared_ptr<Subscription>>::iterator itr;
             for (itr = subscription_list_.begin(), itr_index = 1; itr < subscription_list_.end(); ++itr, ++itr_index) {
                 std::shared_ptr<Utf8String> utf8_str = (*itr)->GetTopicName();
-                AppendUtf8StringToBuffer(buf, utf8_str);
+                p_buf = WriteUtf8StringToBuffer(p_buf, *utf8_str);
                 switch ((*itr)->GetMaxQos()) {
                     case QoS::QOS0:
-                        temp_qos_byte = 0x00;
+                        *p_buf++ = 0x00;
                         break;
                     case QoS::QOS1:
-                        temp_qos_byte = 0x01;
+                        *p_buf++ = 0x01;
                         break;
                 }
-                buf.append(&temp_qos_byte, 1);
                 (*itr)->SetAckIndex(static_cast<uint16_t>(packet_id_), itr_index);
             }
 
-            return buf;
+            return p_buf;
         }
 
         /*******************************************
@@ -115,20 +110,15 @@ namespace awsiotsdk {
             return std::make_shared<SubackPacket>(buf);
         }
 
-        util::String SubackPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-
-            fixed_header_.AppendToBuffer(buf);
-            AppendUInt16ToBuffer(buf, static_cast<uint16_t>(packet_id_));
+        char *SubackPacket::WriteToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
+            p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(packet_id_));
 
-            char temp;
             for (uint8_t suback_info : suback_list_) {
-                temp = static_cast<char>(suback_info);
-                buf.append(&temp, 1);
+                *p_buf++ = static_cast<char>(suback_info);
             }
 
-            return buf;
+            return p_buf;
         }
 
         /************************************************
@@ -156,19 +146,16 @@ namespace awsiotsdk {
             return std::make_shared<UnsubscribePacket>(std::move(topic_list));
         }
 
-        util::String UnsubscribePacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-
-            fixed_header_.AppendToBuffer(buf);
-            AppendUInt16ToBuffer(buf, static_cast<uint16_t>(packet_id_));
+        char *UnsubscribePacket::WriteToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
+            p_buf = WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(packet_id_));
 
             util::Vector<std::unique_ptr<Utf8String>>::iterator itr;
             for (itr = topic_list_.begin(); itr < topic_list_.end(); ++itr) {
-                AppendUtf8StringToBuffer(buf, (*itr));
+                p_buf = WriteUtf8StringToBuffer(p_buf, *(*itr));
             }
 
-            return buf;
+            return p_buf;
         }
 
         /*********************************************
@@ -191,14 +178,9 @@ namespace awsiotsdk {
             return std::make_shared<UnsubackPacket>(buf);
         }
 
-        util::String UnsubackPacket::ToString() {
-            util::String buf;
-            buf.reserve(serialized_packet_length_);
-
-            fixed_header_.AppendToBuffer(buf);
-            AppendUInt16ToBuffer(buf, static_cast<uint16_t>(packet_id_));
-
-            return buf;
+        char *UnsubackPacket::WriteToBuffer(char *p_buf) {
+            p_buf = fixed_header_.WriteToBuffer(p_buf);
+            return WriteUInt16ToBuffer(p_buf, static_cast<uint16_t>(packet_id_));
         }
 
         /***************************************************
@@ -221,6 +203,17 @@ namespace awsiotsdk {
 
         ResponseCode SubscribeActionAsync::PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                                          std::shared_ptr<ActionData> p_action_data) {
+            return PerformRequest(p_network_connection, p_action_data, true);
+        }
+
+        ResponseCode SubscribeActionAsync::PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                               std::shared_ptr<ActionData> p_action_data) {
+            return PerformRequest(p_network_connection, p_action_data, false);
+        }
+
+        ResponseCode SubscribeActionAsync::PerformRequest(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                          std::shared_ptr<ActionData> p_action_data,
+                                                          bool should_register_ack) {
             if (nullptr == p_network_connection) {
                 return ResponseCode::NULL_VALUE_ERROR;
             }
@@ -234,7 +227,7 @@ namespace awsiotsdk {
             }
 
             uint16_t packet_id = p_subscribe_packet->GetPacketId();
-            if (nullptr != p_subscribe_packet->p_async_ack_handler_) {
+            if (should_register_ack && nullptr != p_subscribe_packet->p_async_ack_handler_) {
                 rc = p_client_state_->RegisterPendingAck(packet_id, p_subscribe_packet->p_async_ack_handler_);
                 if (ResponseCode::SUCCESS != rc) {
                     AWS_LOG_ERROR(SUBSCRIBE_ACTION_LOG_TAG,
@@ -248,30 +241,22 @@ namespace awsiotsdk {
             // Read running in separate thread, Insert before sending request to avoid situations where response arrives early
             util::Vector<std::shared_ptr<Subscription>>::iterator itr = p_subscribe_packet->subscription_list_.begin();
             while (itr != p_subscribe_packet->subscription_list_.end()) {
-                util::String topic_name = (*itr)->GetTopicName()->ToStdString();
-                auto existing_itr = p_client_state_->subscription_map_.find(topic_name);
-                if (p_client_state_->subscription_map_.end() != existing_itr) {
-                    if (existing_itr->second->IsActive()) {
-                        itr = p_subscribe_packet->subscription_list_.erase(itr);
-                        if (is_ack_registered) {
-                            p_client_state_->DeletePendingAck(packet_id);
-                        }
-                        // TODO: This needs to be reworked
-                        continue;
-                    } else {
-                        p_client_state_->subscription_map_.erase(existing_itr);
-                        p_client_state_->subscription_map_.insert(std::make_pair(topic_name, (*itr)));
+                // Not added if an active subscription already exists for this topic
+                if (ResponseCode::SUCCESS != p_client_state_->AddSubscription(*itr)) {
+                    itr = p_subscribe_packet->subscription_list_.erase(itr);
+                    if (is_ack_registered) {
+                        p_client_state_->DeletePendingAck(packet_id);
                     }
-                } else {
-                    p_client_state_->subscription_map_.insert(std::make_pair(topic_name, (*itr)));
+                    // TODO: This needs to be reworked
+                    continue;
                 }
 
                 itr++;
             }
 
-            const util::String packet_data = p_subscribe_packet->ToString();
+            p_subscribe_packet->SerializeToBuffer(packet_buffer_);
             if (p_subscribe_packet->subscription_list_.size() > 0) {
-                rc = WriteToNetworkBuffer(p_network_connection, packet_data);
+                rc = WriteToNetworkBuffer(p_network_connection, packet_buffer_);
             }
             if (ResponseCode::SUCCESS != rc) {
                 AWS_LOG_ERROR(SUBSCRIBE_ACTION_LOG_TAG, "Subscribe Write to Network Failed. %s",
@@ -280,7 +265,7 @@ namespace awsiotsdk {
                 for (itr = p_subscribe_packet->subscription_list_.begin();
                      itr < p_subscribe_packet->subscription_list_.end(); ++itr) {
                     util::String topic_name = (*itr)->GetTopicName()->ToStdString();
-                    p_client_state_->subscription_map_.erase(topic_name);
+                    p_client_state_->RemoveSubscription(topic_name);
                 }
                 if (is_ack_registered) {
                     p_client_state_->DeletePendingAck(packet_id);
@@ -311,6 +296,18 @@ namespace awsiotsdk {
 
         ResponseCode UnsubscribeActionAsync::PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
                                                            std::shared_ptr<ActionData> p_action_data) {
+            return PerformRequest(p_network_connection, p_action_data, true);
+        }
+
+        ResponseCode
+        UnsubscribeActionAsync::PerformQueuedAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                    std::shared_ptr<ActionData> p_action_data) {
+            return PerformRequest(p_network_connection, p_action_data, false);
+        }
+
+        ResponseCode UnsubscribeActionAsync::PerformRequest(std::shared_ptr<NetworkConnection> p_network_connection,
+                                                            std::shared_ptr<ActionData> p_action_data,
+                                                            bool should_register_ack) {
             std::shared_ptr<UnsubscribePacket>
                 p_unsubscribe_packet = std::dynamic_pointer_cast<UnsubscribePacket>(p_action_data);
             if (nullptr == p_unsubscribe_packet) {
@@ -320,7 +317,7 @@ namespace awsiotsdk {
             ResponseCode rc = ResponseCode::SUCCESS;
             bool is_ack_registered = false;
 
-            if (nullptr != p_unsubscribe_packet->p_async_ack_handler_) {
+            if (should_register_ack && nullptr != p_unsubscribe_packet->p_async_ack_handler_) {
                 rc = p_client_state_->RegisterPendingAck(p_unsubscribe_packet->GetPacketId(),
                                                          p_unsubscribe_packet->p_async_ack_handler_);
                 if (ResponseCode::SUCCESS != rc) {
@@ -337,8 +334,8 @@ namespace awsiotsdk {
                 p_client_state_->SetSubscriptionPacketInfo(itr->ToStdString(), packet_id, 0);
             }
 
-            const util::String packet_data = p_unsubscribe_packet->ToString();
-            rc = WriteToNetworkBuffer(p_network_connection, packet_data);
+            p_unsubscribe_packet->SerializeToBuffer(packet_buffer_);
+            rc = WriteToNetworkBuffer(p_network_connection, packet_buffer_);
             if (ResponseCode::SUCCESS != rc) {
                 AWS_LOG_ERROR(UNSUBSCRIBE_ACTION_LOG_TAG, "Publish Write to Network Failed. %s",
                               ResponseHelper::ToString(rc).c_str());
@@ -0,0 +1,114 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file SubscriptionRegistry.cpp
+ * @brief
+ *
+ */
+
+#include "mqtt/SubscriptionRegistry.hpp"
+
+namespace awsiotsdk {
+    namespace mqtt {
+        std::shared_ptr<Subscription> SubscriptionRegistry::Snapshot::Find(const util::String &topic_filter) const {
+            auto itr = subscription_map_.find(topic_filter);
+            if (subscription_map_.end() == itr) {
+                return nullptr;
+            }
+            return itr->second;
+        }
+
+        SubscriptionRegistry::SubscriptionRegistry() {
+            version_ = 0;
+            std::shared_ptr<Snapshot> p_snapshot = std::make_shared<Snapshot>();
+            p_snapshot->version_ = 0;
+            p_snapshot_ = p_snapshot;
+        }
+
+        std::shared_ptr<const SubscriptionRegistry::Snapshot> SubscriptionRegistry::GetSnapshot() {
+            std::lock_guard<std::mutex> write_guard(write_lock_);
+            return p_snapshot_;
+        }
+
+        void SubscriptionRegistry::RefreshSnapshot(std::shared_ptr<const Snapshot> &p_snapshot) {
+            // Snapshots are immutable, a matching version means the caller already holds the current one
+            if (nullptr != p_snapshot && p_snapshot->version_ == version_.load(std::memory_order_acquire)) {
+                return;
+            }
+            p_snapshot = GetSnapshot();
+        }
+
+        void SubscriptionRegistry::PublishSnapshot(util::Map<util::String,
+                                                             std::shared_ptr<Subscription>> subscription_map) {
+            std::shared_ptr<Snapshot> p_snapshot = std::make_shared<Snapshot>();
+            for (auto &itr : subscription_map) {
+                p_snapshot->subscription_trie_.Insert(itr.second);
+            }
+            p_snapshot->subscription_map_ = std::move(subscription_map);
+            p_snapshot->version_ = p_snapshot_->version_ + 1;
+            p_snapshot_ = p_snapshot;
+            version_.store(p_snapshot->version_, std::memory_order_release);
+        }
+
+        bool SubscriptionRegistry::Add(std::shared_ptr<Subscription> p_subscription) {
+            if (nullptr == p_subscription) {
+                return false;
+            }
+
+            util::String topic_filter = p_subscription->GetTopicName()->ToStdString();
+            std::lock_guard<std::mutex> write_guard(write_lock_);
+            std::shared_ptr<Subscription> p_existing = p_snapshot_->Find(topic_filter);
+            if (nullptr != p_existing && p_existing->IsActive()) {
+                return false;
+            }
+
+            util::Map<util::String, std::shared_ptr<Subscription>> subscription_map = p_snapshot_->subscription_map_;
+            subscription_map[topic_filter] = p_subscription;
+            PublishSnapshot(std::move(subscription_map));
+            return true;
+        }
+
+        bool SubscriptionRegistry::Remove(const util::String &topic_filter) {
+            std::lock_guard<std::mutex> write_guard(write_lock_);
+            if (nullptr == p_snapshot_->Find(topic_filter)) {
+                return false;
+            }
+
+            util::Map<util::String, std::shared_ptr<Subscription>> subscription_map = p_snapshot_->subscription_map_;
+            subscription_map.erase(topic_filter);
+            PublishSnapshot(std::move(subscription_map));
+            return true;
+        }
+
+        size_t SubscriptionRegistry::RemoveIf(const SubscriptionFilter &filter, size_t max_count) {
+            std::lock_guard<std::mutex> write_guard(write_lock_);
+            util::Map<util::String, std::shared_ptr<Subscription>> subscription_map;
+            size_t removed_count = 0;
+            for (auto &itr : p_snapshot_->subscription_map_) {
+                if (removed_count < max_count && filter(itr.second)) {
+                    removed_count++;
+                } else {
+                    subscription_map.insert(itr);
+                }
+            }
+
+            if (0 < removed_count) {
+                PublishSnapshot(std::move(subscription_map));
+            }
+            return removed_count;
+        }
+    }
+}
@@ -0,0 +1,242 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file SubscriptionTopicTrie.cpp
+ * @brief
+ *
+ */
+
+#include <algorithm>
+#include <cstring>
+
+#include "mqtt/SubscriptionTopicTrie.hpp"
+
+#define TOPIC_LEVEL_SEPARATOR '/'
+#define SINGLE_LEVEL_WILDCARD_LEVEL "+"
+#define MULTI_LEVEL_WILDCARD_LEVEL "#"
+#define RESERVED_TOPIC '$'
+
+namespace awsiotsdk {
+    namespace mqtt {
+        namespace {
+            /**
+             * @brief Reference to one level inside a topic string, avoids copying the level for lookups
+             */
+            class TopicLevel {
+            public:
+                const char *p_data_;  ///< Start of the level
+                size_t length_;       ///< Length of the level in bytes
+            };
+
+            /**
+             * @brief Orders literal children by level name, usable against both stored levels and TopicLevel refs
+             */
+            class TopicLevelCompare {
+            public:
+                template<typename Child>
+                bool operator()(const Child &child, const TopicLevel &level) const {
+                    return child.first.compare(0, util::String::npos, level.p_data_, level.length_) < 0;
+                }
+            };
+
+            /**
+             * @brief Get the topic level starting at level_start
+             *
+             * @param topic - Topic name or filter
+             * @param level_start - Offset of the first character of the level
+             * @param level[out] - Level found
+             * @return size_t offset of the next level, npos if this was the last level
+             */
+            size_t NextTopicLevel(const util::String &topic, size_t level_start, TopicLevel &level) {
+                size_t level_end = topic.find(TOPIC_LEVEL_SEPARATOR, level_start);
+                level.p_data_ = topic.data() + level_start;
+                if (util::String::npos == level_end) {
+                    level.length_ = topic.length() - level_start;
+                    return util::String::npos;
+                }
+                level.length_ = level_end - level_start;
+                return level_end + 1;
+            }
+
+            bool IsLevel(const TopicLevel &level, const char *p_expected) {
+                return (strlen(p_expected) == level.length_ && 0 == strncmp(level.p_data_, p_expected, level.length_));
+            }
+        }
+
+        bool SubscriptionTopicTrie::Node::IsEmpty() const {
+            return (children_.empty() && nullptr == p_single_level_child_
+                && nullptr == p_subscription_ && nullptr == p_multi_level_subscription_);
+        }
+
+        SubscriptionTopicTrie::SubscriptionTopicTrie() {
+            subscription_count_ = 0;
+        }
+
+        void SubscriptionTopicTrie::Insert(std::shared_ptr<Subscription> p_subscription) {
+            if (nullptr == p_subscription) {
+                return;
+            }
+
+            util::String topic_filter = p_subscription->GetTopicName()->ToStdString();
+            Node *p_node = &root_;
+            std::shared_ptr<Subscription> *p_slot = nullptr;
+            size_t level_start = 0;
+            TopicLevel level;
+            while (nullptr == p_slot) {
+                size_t next_level_start = NextTopicLevel(topic_filter, level_start, level);
+                if (IsLevel(level, MULTI_LEVEL_WILDCARD_LEVEL)) {
+                    // Topic filters are validated on creation, # is always the last level
+                    p_slot = &p_node->p_multi_level_subscription_;
+                    break;
+                }
+
+                if (IsLevel(level, SINGLE_LEVEL_WILDCARD_LEVEL)) {
+                    if (nullptr == p_node->p_single_level_child_) {
+                        p_node->p_single_level_child_ = std::unique_ptr<Node>(new Node());
+                    }
+                    p_node = p_node->p_single_level_child_.get();
+                } else {
+                    auto child_itr = std::lower_bound(p_node->children_.begin(), p_node->children_.end(), level,
+                                                      TopicLevelCompare());
+                    if (p_node->children_.end() == child_itr
+                        || 0 != child_itr->first.compare(0, util::String::npos, level.p_data_, level.length_)) {
+                        child_itr = p_node->children_.insert(child_itr,
+                                                             std::make_pair(util::String(level.p_data_, level.length_),
+                                                                            std::unique_ptr<Node>(new Node())));
+                    }
+                    p_node = child_itr->second.get();
+                }
+
+                if (util::String::npos == next_level_start) {
+                    p_slot = &p_node->p_subscription_;
+                }
+                level_start = next_level_start;
+            }
+
+            if (nullptr == *p_slot) {
+                subscription_count_++;
+            }
+            *p_slot = p_subscription;
+        }
+
+        bool SubscriptionTopicTrie::Remove(const util::String &topic_filter) {
+            return Remove(root_, topic_filter, 0);
+        }
+
+        bool SubscriptionTopicTrie::Remove(Node &node, const util::String &topic_filter, size_t level_start) {
+            TopicLevel level;
+            size_t next_level_start = NextTopicLevel(topic_filter, level_start, level);
+
+            if (IsLevel(level, MULTI_LEVEL_WILDCARD_LEVEL)) {
+                if (nullptr == node.p_multi_level_subscription_) {
+                    return false;
+                }
+                node.p_multi_level_subscription_ = nullptr;
+                subscription_count_--;
+                return true;
+            }
+
+            bool is_removed = false;
+            if (IsLevel(level, SINGLE_LEVEL_WILDCARD_LEVEL)) {
+                Node *p_child = node.p_single_level_child_.get();
+                if (nullptr == p_child) {
+                    return false;
+                }
+                if (util::String::npos == next_level_start) {
+                    is_removed = (nullptr != p_child->p_subscription_);
+                    p_child->p_subscription_ = nullptr;
+                } else {
+                    is_removed = Remove(*p_child, topic_filter, next_level_start);
+                }
+                if (p_child->IsEmpty()) {
+                    node.p_single_level_child_ = nullptr;
+                }
+            } else {
+                auto child_itr = std::lower_bound(node.children_.begin(), node.children_.end(), level,
+                                                  TopicLevelCompare());
+                if (node.children_.end() == child_itr
+                    || 0 != child_itr->first.compare(0, util::String::npos, level.p_data_, level.length_)) {
+                    return false;
+                }
+                Node *p_child = child_itr->second.get();
+                if (util::String::npos == next_level_start) {
+                    is_removed = (nullptr != p_child->p_subscription_);
+                    p_child->p_subscription_ = nullptr;
+                } else {
+                    is_removed = Remove(*p_child, topic_filter, next_level_start);
+                }
+                if (p_child->IsEmpty()) {
+                    node.children_.erase(child_itr);
+                }
+            }
+
+            if (is_removed && util::String::npos == next_level_start) {
+                subscription_count_--;
+            }
+            return is_removed;
+        }
+
+        void SubscriptionTopicTrie::GetMatchingSubscriptions(const util::String &topic_name,
+                                                             util::Vector<std::shared_ptr<Subscription>> &matches) const {
+            Match(root_, topic_name, 0, true, matches);
+        }
+
+        void SubscriptionTopicTrie::Match(const Node &node, const util::String &topic_name, size_t level_start,
+                                          bool is_first_level,
+                                          util::Vector<std::shared_ptr<Subscription>> &matches) const {
+            // Wildcards in the first level never match reserved topics such as $aws/...
+            bool is_wildcard_allowed = !(is_first_level && 0 < topic_name.length() && RESERVED_TOPIC == topic_name[0]);
+
+            if (util::String::npos == level_start) {
+                if (nullptr != node.p_subscription_) {
+                    matches.push_back(node.p_subscription_);
+                }
+                // # also matches the parent level
+                if (nullptr != node.p_multi_level_subscription_) {
+                    matches.push_back(node.p_multi_level_subscription_);
+                }
+                return;
+            }
+
+            TopicLevel level;
+            size_t next_level_start = NextTopicLevel(topic_name, level_start, level);
+
+            auto child_itr = std::lower_bound(node.children_.begin(), node.children_.end(), level,
+                                              TopicLevelCompare());
+            if (node.children_.end() != child_itr
+                && 0 == child_itr->first.compare(0, util::String::npos, level.p_data_, level.length_)) {
+                Match(*child_itr->second, topic_name, next_level_start, false, matches);
+            }
+
+            if (is_wildcard_allowed) {
+                if (nullptr != node.p_single_level_child_) {
+                    Match(*node.p_single_level_child_, topic_name, next_level_start, false, matches);
+                }
+                if (nullptr != node.p_multi_level_subscription_) {
+                    matches.push_back(node.p_multi_level_subscription_);
+                }
+            }
+        }
+
+        void SubscriptionTopicTrie::Clear() {
+            root_.children_.clear();
+            root_.p_single_level_child_ = nullptr;
+            root_.p_subscription_ = nullptr;
+            root_.p_multi_level_subscription_ = nullptr;
+            subscription_count_ = 0;
+        }
+    }
+}
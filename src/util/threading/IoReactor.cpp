@@ -0,0 +1,294 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file IoReactor.cpp
+ * @brief
+ *
+ */
+
+#include <cerrno>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+
+#include "util/logging/LogMacros.hpp"
+
+#include "util/threading/IoReactor.hpp"
+
+#define IO_REACTOR_LOG_TAG "[IO Reactor]"
+
+// Registration IDs start at one, zero identifies the wakeup descriptor
+#define IO_REACTOR_WAKEUP_ID 0
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            IoReactor::IoReactor(std::chrono::milliseconds poll_interval) {
+                next_registration_id_ = IO_REACTOR_WAKEUP_ID + 1;
+                poll_interval_ = poll_interval;
+                is_running_ = false;
+                epoll_fd_ = -1;
+                wakeup_fd_ = -1;
+            }
+
+            IoReactor::~IoReactor() {
+                Stop();
+            }
+
+            std::shared_ptr<IoReactor> IoReactor::Create(size_t worker_count,
+                                                         std::chrono::milliseconds poll_interval) {
+                std::shared_ptr<IoReactor> p_io_reactor = std::shared_ptr<IoReactor>(new IoReactor(poll_interval));
+                if (ResponseCode::SUCCESS != p_io_reactor->Start((0 == worker_count) ? 1 : worker_count)) {
+                    return nullptr;
+                }
+                return p_io_reactor;
+            }
+
+            ResponseCode IoReactor::Start(size_t worker_count) {
+#ifdef __linux__
+                epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+                wakeup_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+                if (-1 == epoll_fd_ || -1 == wakeup_fd_) {
+                    AWS_LOG_ERROR(IO_REACTOR_LOG_TAG, "Unable to create epoll set. errno : %d", errno);
+                    return ResponseCode::FAILURE;
+                }
+
+                struct epoll_event wakeup_event;
+                wakeup_event.events = EPOLLIN;
+                wakeup_event.data.u64 = IO_REACTOR_WAKEUP_ID;
+                if (0 != epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wakeup_fd_, &wakeup_event)) {
+                    AWS_LOG_ERROR(IO_REACTOR_LOG_TAG, "Unable to watch wakeup descriptor. errno : %d", errno);
+                    return ResponseCode::FAILURE;
+                }
+
+                is_running_ = true;
+                for (size_t itr = 0; itr < worker_count; itr++) {
+                    workers_.push_back(std::thread(&IoReactor::RunWorker, this));
+                }
+                reactor_thread_ = std::thread(&IoReactor::RunReactor, this);
+                return ResponseCode::SUCCESS;
+#else
+                return ResponseCode::FAILURE;
+#endif
+            }
+
+            void IoReactor::Arm(Registration &registration) {
+#ifdef __linux__
+                // A descriptor that was closed has already been removed from the epoll set by the kernel
+                int fd = registration.p_source_->GetDescriptor();
+                registration.armed_fd_ = fd;
+                if (-1 == fd) {
+                    return;
+                }
+
+                struct epoll_event event;
+                event.events = EPOLLIN | EPOLLONESHOT;
+                event.data.u64 = registration.registration_id_;
+                if (0 != epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, fd, &event)
+                    && (ENOENT != errno || 0 != epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &event))) {
+                    AWS_LOG_WARN(IO_REACTOR_LOG_TAG, "Unable to watch descriptor %d. errno : %d", fd, errno);
+                    registration.armed_fd_ = -1;
+                }
+#endif
+            }
+
+            void IoReactor::RunReactor() {
+#ifdef __linux__
+                struct epoll_event events[IO_REACTOR_MAX_EVENTS_PER_WAIT];
+                std::chrono::steady_clock::time_point next_poll_time = std::chrono::steady_clock::now();
+                while (is_running_) {
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    int wait_ms = 0;
+                    if (next_poll_time > now) {
+                        wait_ms = static_cast<int>(
+                            std::chrono::duration_cast<std::chrono::milliseconds>(next_poll_time - now).count());
+                    }
+                    int event_count = epoll_wait(epoll_fd_, events, IO_REACTOR_MAX_EVENTS_PER_WAIT, wait_ms);
+                    if (0 > event_count) {
+                        if (EINTR != errno) {
+                            AWS_LOG_ERROR(IO_REACTOR_LOG_TAG, "Wait on epoll set failed. errno : %d", errno);
+                            std::this_thread::sleep_for(poll_interval_);
+                        }
+                        event_count = 0;
+                    }
+
+                    std::lock_guard<std::mutex> reactor_lock(reactor_lock_);
+                    for (int itr = 0; itr < event_count; itr++) {
+                        if (IO_REACTOR_WAKEUP_ID == events[itr].data.u64) {
+                            uint64_t wakeup_count;
+                            ssize_t read_bytes = read(wakeup_fd_, &wakeup_count, sizeof(wakeup_count));
+                            (void) read_bytes;
+                            continue;
+                        }
+
+                        // The source may have been unregistered after the event was reported
+                        util::Map<uint64_t, std::shared_ptr<Registration>>::iterator registration_itr
+                            = registrations_.find(events[itr].data.u64);
+                        if (registrations_.end() == registration_itr || registration_itr->second->is_busy_) {
+                            continue;
+                        }
+                        registration_itr->second->is_busy_ = true;
+                        ready_queue_.push(registration_itr->second);
+                        ready_wait_.notify_one();
+                    }
+
+                    // Picks up descriptors that changed, for example after a reconnect
+                    now = std::chrono::steady_clock::now();
+                    if (now >= next_poll_time) {
+                        for (auto &registration : registrations_) {
+                            if (!registration.second->is_busy_) {
+                                Arm(*registration.second);
+                            }
+                        }
+                        next_poll_time = now + poll_interval_;
+                    }
+                }
+#endif
+            }
+
+            void IoReactor::RunWorker() {
+                std::unique_lock<std::mutex> reactor_lock(reactor_lock_);
+                for (;;) {
+                    ready_wait_.wait(reactor_lock, [this] {
+                        return !is_running_ || !ready_queue_.empty();
+                    });
+                    if (!is_running_) {
+                        break;
+                    }
+
+                    std::shared_ptr<Registration> p_registration = ready_queue_.front();
+                    ready_queue_.pop();
+                    if (!p_registration->is_removed_) {
+                        // Handlers run without the lock so other sources can be queued and handled
+                        p_registration->handler_thread_id_ = std::this_thread::get_id();
+                        reactor_lock.unlock();
+                        p_registration->p_source_->OnReadable();
+                        reactor_lock.lock();
+                        p_registration->handler_thread_id_ = std::thread::id();
+                    }
+
+                    p_registration->is_busy_ = false;
+                    if (!p_registration->is_removed_) {
+                        Arm(*p_registration);
+                    }
+                    idle_wait_.notify_all();
+                }
+            }
+
+            ResponseCode IoReactor::Register(std::shared_ptr<EventSource> p_source) {
+                if (nullptr == p_source) {
+                    return ResponseCode::NULL_VALUE_ERROR;
+                }
+
+                std::lock_guard<std::mutex> reactor_lock(reactor_lock_);
+                if (!is_running_) {
+                    return ResponseCode::FAILURE;
+                }
+
+                std::shared_ptr<Registration> p_registration = std::make_shared<Registration>();
+                p_registration->registration_id_ = next_registration_id_++;
+                p_registration->p_source_ = std::move(p_source);
+                p_registration->armed_fd_ = -1;
+                p_registration->is_busy_ = false;
+                p_registration->is_removed_ = false;
+                registrations_.insert(std::make_pair(p_registration->registration_id_, p_registration));
+                Arm(*p_registration);
+                return ResponseCode::SUCCESS;
+            }
+
+            ResponseCode IoReactor::Unregister(const std::shared_ptr<EventSource> &p_source) {
+                std::unique_lock<std::mutex> reactor_lock(reactor_lock_);
+                util::Map<uint64_t, std::shared_ptr<Registration>>::iterator registration_itr = registrations_.begin();
+                while (registrations_.end() != registration_itr && registration_itr->second->p_source_ != p_source) {
+                    registration_itr++;
+                }
+                if (nullptr == p_source || registrations_.end() == registration_itr) {
+                    return ResponseCode::NULL_VALUE_ERROR;
+                }
+
+                std::shared_ptr<Registration> p_registration = registration_itr->second;
+                registrations_.erase(registration_itr);
+                p_registration->is_removed_ = true;
+#ifdef __linux__
+                // Only remove the descriptor if it still belongs to the source and was not reused by another one
+                if (-1 != p_registration->armed_fd_
+                    && p_registration->armed_fd_ == p_registration->p_source_->GetDescriptor()) {
+                    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, p_registration->armed_fd_, nullptr);
+                }
+#endif
+
+                // A handler unregistering its own source can't wait for itself
+                if (std::this_thread::get_id() != p_registration->handler_thread_id_) {
+                    idle_wait_.wait(reactor_lock, [p_registration] {
+                        return !p_registration->is_busy_;
+                    });
+                }
+                return ResponseCode::SUCCESS;
+            }
+
+            void IoReactor::Stop() {
+                {
+                    std::lock_guard<std::mutex> reactor_lock(reactor_lock_);
+                    is_running_ = false;
+                    ready_wait_.notify_all();
+                }
+#ifdef __linux__
+                if (-1 != wakeup_fd_) {
+                    uint64_t wakeup_count = 1;
+                    ssize_t written_bytes = write(wakeup_fd_, &wakeup_count, sizeof(wakeup_count));
+                    (void) written_bytes;
+                }
+#endif
+                if (reactor_thread_.joinable()) {
+                    reactor_thread_.join();
+                }
+                for (std::thread &worker : workers_) {
+                    if (worker.joinable()) {
+                        worker.join();
+                    }
+                }
+
+                {
+                    // Sources that were queued but not handled are no longer busy
+                    std::lock_guard<std::mutex> reactor_lock(reactor_lock_);
+                    while (!ready_queue_.empty()) {
+                        ready_queue_.front()->is_busy_ = false;
+                        ready_queue_.pop();
+                    }
+                    idle_wait_.notify_all();
+                }
+#ifdef __linux__
+                if (-1 != epoll_fd_) {
+                    close(epoll_fd_);
+                    epoll_fd_ = -1;
+                }
+                if (-1 != wakeup_fd_) {
+                    close(wakeup_fd_);
+                    wakeup_fd_ = -1;
+                }
+#endif
+            }
+
+            size_t IoReactor::GetRegisteredCount() {
+                std::lock_guard<std::mutex> reactor_lock(reactor_lock_);
+                return registrations_.size();
+            }
+        }
+    }
+}
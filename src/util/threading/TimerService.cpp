@@ -0,0 +1,194 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file TimerService.cpp
+ * @brief
+ *
+ */
+
+#include "util/threading/TimerService.hpp"
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            TimerService::TimerService(std::shared_ptr<Executor> p_executor) {
+                p_executor_ = p_executor;
+                next_timer_id_ = 1;
+                is_running_ = false;
+            }
+
+            TimerService::~TimerService() {
+                Stop();
+            }
+
+            std::shared_ptr<TimerService> TimerService::Create(std::shared_ptr<Executor> p_executor) {
+                std::shared_ptr<TimerService> p_timer_service
+                    = std::shared_ptr<TimerService>(new TimerService(p_executor));
+                {
+                    std::lock_guard<std::mutex> timer_lock(p_timer_service->timer_lock_);
+                    p_timer_service->is_running_ = true;
+                }
+                p_timer_service->timer_thread_ = std::thread(&TimerService::RunTimers, p_timer_service.get());
+                return p_timer_service;
+            }
+
+            TimerService::TimerId TimerService::Schedule(std::chrono::steady_clock::time_point deadline,
+                                                         Callback callback) {
+                if (nullptr == callback) {
+                    return 0;
+                }
+
+                std::lock_guard<std::mutex> timer_lock(timer_lock_);
+                if (!is_running_) {
+                    return 0;
+                }
+                DeadlineEntry entry;
+                entry.deadline_ = deadline;
+                entry.timer_id_ = next_timer_id_++;
+                bool is_earliest = deadline_heap_.empty() || deadline < deadline_heap_.top().deadline_;
+                deadline_heap_.push(entry);
+                pending_timers_.insert(std::make_pair(entry.timer_id_, std::move(callback)));
+                if (is_earliest) {
+                    timer_wait_.notify_one();
+                }
+                return entry.timer_id_;
+            }
+
+            bool TimerService::Cancel(TimerId timer_id) {
+                Callback cancelled_callback;
+                {
+                    std::unique_lock<std::mutex> timer_lock(timer_lock_);
+                    util::Map<TimerId, Callback>::iterator itr = pending_timers_.find(timer_id);
+                    if (pending_timers_.end() != itr) {
+                        // The heap entry is skipped once it reaches the top
+                        cancelled_callback = std::move(itr->second);
+                        pending_timers_.erase(itr);
+                        PurgeCancelledEntries();
+                    } else {
+                        std::thread::id thread_id = std::this_thread::get_id();
+                        running_wait_.wait(timer_lock, [this, timer_id, thread_id] {
+                            util::Map<TimerId, std::thread::id>::iterator running_itr = running_timers_.find(timer_id);
+                            return running_timers_.end() == running_itr || thread_id == running_itr->second;
+                        });
+                        return false;
+                    }
+                }
+                // Released without the lock, in case it holds something that cancels other timers
+                cancelled_callback = nullptr;
+                return true;
+            }
+
+            size_t TimerService::GetPendingTimerCount() {
+                std::lock_guard<std::mutex> timer_lock(timer_lock_);
+                return pending_timers_.size();
+            }
+
+            void TimerService::PurgeCancelledEntries() {
+                if (TIMER_SERVICE_MIN_HEAP_PURGE_SIZE > deadline_heap_.size()
+                    || deadline_heap_.size() < 2 * pending_timers_.size()) {
+                    return;
+                }
+                util::Vector<DeadlineEntry> entries;
+                entries.reserve(pending_timers_.size());
+                while (!deadline_heap_.empty()) {
+                    if (pending_timers_.end() != pending_timers_.find(deadline_heap_.top().timer_id_)) {
+                        entries.push_back(deadline_heap_.top());
+                    }
+                    deadline_heap_.pop();
+                }
+                deadline_heap_ = std::priority_queue<DeadlineEntry, util::Vector<DeadlineEntry>,
+                                                     std::greater<DeadlineEntry>>(std::greater<DeadlineEntry>(),
+                                                                                  std::move(entries));
+            }
+
+            void TimerService::RunCallback(TimerId timer_id, Callback &callback) {
+                {
+                    std::lock_guard<std::mutex> timer_lock(timer_lock_);
+                    running_timers_[timer_id] = std::this_thread::get_id();
+                }
+                callback();
+                callback = nullptr;
+            }
+
+            void TimerService::RunTimers() {
+                std::unique_lock<std::mutex> timer_lock(timer_lock_);
+                while (is_running_) {
+                    if (deadline_heap_.empty()) {
+                        timer_wait_.wait(timer_lock);
+                        continue;
+                    }
+
+                    DeadlineEntry entry = deadline_heap_.top();
+                    util::Map<TimerId, Callback>::iterator itr = pending_timers_.find(entry.timer_id_);
+                    if (pending_timers_.end() == itr) {
+                        deadline_heap_.pop();
+                        continue;
+                    }
+                    if (std::chrono::steady_clock::now() < entry.deadline_) {
+                        timer_wait_.wait_until(timer_lock, entry.deadline_);
+                        continue;
+                    }
+
+                    deadline_heap_.pop();
+                    TimerId timer_id = entry.timer_id_;
+                    Callback callback = std::move(itr->second);
+                    pending_timers_.erase(itr);
+                    running_timers_[timer_id] = std::thread::id();
+                    timer_lock.unlock();
+
+                    // Marks the timer as done once the task is released, even if the executor drops it unrun
+                    std::shared_ptr<void> p_done(nullptr, [this, timer_id](void *) {
+                        std::lock_guard<std::mutex> done_lock(timer_lock_);
+                        running_timers_.erase(timer_id);
+                        running_wait_.notify_all();
+                    });
+                    if (nullptr != p_executor_) {
+                        p_executor_->Submit([this, timer_id, callback, p_done]() mutable {
+                            RunCallback(timer_id, callback);
+                        });
+                    } else {
+                        RunCallback(timer_id, callback);
+                    }
+                    p_done = nullptr;
+                    callback = nullptr;
+
+                    timer_lock.lock();
+                }
+            }
+
+            void TimerService::Stop() {
+                {
+                    std::lock_guard<std::mutex> timer_lock(timer_lock_);
+                    is_running_ = false;
+                    timer_wait_.notify_all();
+                }
+                if (timer_thread_.joinable()) {
+                    timer_thread_.join();
+                }
+
+                util::Map<TimerId, Callback> dropped_timers;
+                {
+                    std::unique_lock<std::mutex> timer_lock(timer_lock_);
+                    dropped_timers.swap(pending_timers_);
+                    while (!deadline_heap_.empty()) {
+                        deadline_heap_.pop();
+                    }
+                    running_wait_.wait(timer_lock, [this] { return running_timers_.empty(); });
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,231 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file WorkStealingExecutor.cpp
+ * @brief
+ *
+ */
+
+#include "util/threading/WorkStealingExecutor.hpp"
+
+namespace awsiotsdk {
+    namespace util {
+        namespace Threading {
+            WorkStealingExecutor::WorkStealingExecutor() {
+                next_delayed_task_time_ = std::chrono::steady_clock::time_point::max().time_since_epoch().count();
+                queued_task_count_ = 0;
+                idle_worker_count_ = 0;
+                next_worker_index_ = 0;
+                stolen_task_count_ = 0;
+                is_running_ = false;
+            }
+
+            WorkStealingExecutor::~WorkStealingExecutor() {
+                Stop();
+            }
+
+            std::shared_ptr<WorkStealingExecutor> WorkStealingExecutor::Create(size_t worker_count) {
+                if (0 == worker_count) {
+                    worker_count = std::thread::hardware_concurrency();
+                }
+                std::shared_ptr<WorkStealingExecutor> p_executor
+                    = std::shared_ptr<WorkStealingExecutor>(new WorkStealingExecutor());
+                p_executor->Start((0 == worker_count) ? 1 : worker_count);
+                return p_executor;
+            }
+
+            void WorkStealingExecutor::Start(size_t worker_count) {
+                // Workers wait for this lock before running tasks, so all thread IDs are set by then
+                std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                for (size_t itr = 0; itr < worker_count; itr++) {
+                    workers_.push_back(std::unique_ptr<Worker>(new Worker()));
+                }
+                is_running_ = true;
+                for (size_t itr = 0; itr < worker_count; itr++) {
+                    workers_[itr]->thread_ = std::thread(&WorkStealingExecutor::RunWorker, this, itr);
+                    workers_[itr]->thread_id_ = workers_[itr]->thread_.get_id();
+                }
+            }
+
+            size_t WorkStealingExecutor::GetCurrentWorkerIndex() {
+                std::thread::id thread_id = std::this_thread::get_id();
+                size_t worker_index = 0;
+                while (worker_index < workers_.size() && workers_[worker_index]->thread_id_ != thread_id) {
+                    worker_index++;
+                }
+                return worker_index;
+            }
+
+            bool WorkStealingExecutor::PopTask(size_t worker_index, Task &task) {
+                {
+                    Worker &worker = *workers_[worker_index];
+                    std::lock_guard<std::mutex> task_lock(worker.task_lock_);
+                    if (!worker.tasks_.empty()) {
+                        task = std::move(worker.tasks_.front());
+                        worker.tasks_.pop_front();
+                        queued_task_count_--;
+                        return true;
+                    }
+                }
+
+                size_t worker_count = workers_.size();
+                for (size_t offset = 1; offset < worker_count && 0 < queued_task_count_; offset++) {
+                    Worker &victim = *workers_[(worker_index + offset) % worker_count];
+                    std::lock_guard<std::mutex> task_lock(victim.task_lock_);
+                    if (!victim.tasks_.empty()) {
+                        task = std::move(victim.tasks_.back());
+                        victim.tasks_.pop_back();
+                        queued_task_count_--;
+                        stolen_task_count_++;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            bool WorkStealingExecutor::MoveDueTasks(size_t worker_index, std::chrono::steady_clock::time_point now) {
+                bool is_moved = false;
+                std::multimap<std::chrono::steady_clock::time_point, Task>::iterator itr = delayed_tasks_.begin();
+                while (delayed_tasks_.end() != itr && itr->first <= now) {
+                    {
+                        Worker &worker = *workers_[worker_index];
+                        std::lock_guard<std::mutex> task_lock(worker.task_lock_);
+                        worker.tasks_.push_back(std::move(itr->second));
+                    }
+                    queued_task_count_++;
+                    itr = delayed_tasks_.erase(itr);
+                    is_moved = true;
+                }
+
+                next_delayed_task_time_ = delayed_tasks_.empty()
+                                          ? std::chrono::steady_clock::time_point::max().time_since_epoch().count()
+                                          : delayed_tasks_.begin()->first.time_since_epoch().count();
+                if (is_moved && 0 < idle_worker_count_) {
+                    // Tasks that became due together can be taken by idle workers
+                    task_wait_.notify_all();
+                }
+                return is_moved;
+            }
+
+            void WorkStealingExecutor::RunWorker(size_t worker_index) {
+                {
+                    std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                }
+
+                Task task;
+                while (is_running_) {
+                    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                    if (now.time_since_epoch().count() >= next_delayed_task_time_) {
+                        std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                        MoveDueTasks(worker_index, now);
+                    }
+
+                    if (PopTask(worker_index, task)) {
+                        task();
+                        // Release anything the task holds before waiting for the next one
+                        task = nullptr;
+                        continue;
+                    }
+
+                    std::unique_lock<std::mutex> schedule_lock(schedule_lock_);
+                    // Submit increments the task count before checking for idle workers, so a task queued after this
+                    // check is always signaled
+                    idle_worker_count_++;
+                    if (is_running_ && 0 == queued_task_count_) {
+                        if (delayed_tasks_.empty()) {
+                            task_wait_.wait(schedule_lock);
+                        } else {
+                            task_wait_.wait_until(schedule_lock, delayed_tasks_.begin()->first);
+                        }
+                    }
+                    idle_worker_count_--;
+                }
+            }
+
+            ResponseCode WorkStealingExecutor::Submit(Task task) {
+                if (nullptr == task) {
+                    return ResponseCode::NULL_VALUE_ERROR;
+                }
+                if (!is_running_) {
+                    return ResponseCode::FAILURE;
+                }
+
+                size_t worker_index = GetCurrentWorkerIndex();
+                if (workers_.size() == worker_index) {
+                    worker_index = (next_worker_index_++) % workers_.size();
+                }
+                {
+                    Worker &worker = *workers_[worker_index];
+                    std::lock_guard<std::mutex> task_lock(worker.task_lock_);
+                    worker.tasks_.push_back(std::move(task));
+                }
+                queued_task_count_++;
+
+                if (0 < idle_worker_count_) {
+                    std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                    task_wait_.notify_one();
+                }
+                return ResponseCode::SUCCESS;
+            }
+
+            ResponseCode WorkStealingExecutor::SubmitAfter(std::chrono::milliseconds delay, Task task) {
+                if (0 >= delay.count()) {
+                    return Submit(std::move(task));
+                }
+                if (nullptr == task) {
+                    return ResponseCode::NULL_VALUE_ERROR;
+                }
+
+                std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                if (!is_running_) {
+                    return ResponseCode::FAILURE;
+                }
+                std::chrono::steady_clock::time_point due_time = std::chrono::steady_clock::now() + delay;
+                delayed_tasks_.insert(std::make_pair(due_time, std::move(task)));
+                if (due_time.time_since_epoch().count() < next_delayed_task_time_) {
+                    next_delayed_task_time_ = due_time.time_since_epoch().count();
+                    // An idle worker may be waiting for a later task
+                    task_wait_.notify_one();
+                }
+                return ResponseCode::SUCCESS;
+            }
+
+            void WorkStealingExecutor::Stop() {
+                {
+                    std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                    is_running_ = false;
+                    task_wait_.notify_all();
+                }
+                for (std::unique_ptr<Worker> &p_worker : workers_) {
+                    if (p_worker->thread_.joinable()) {
+                        p_worker->thread_.join();
+                    }
+                }
+
+                // Tasks that were not run are released here
+                {
+                    std::lock_guard<std::mutex> schedule_lock(schedule_lock_);
+                    delayed_tasks_.clear();
+                }
+                for (std::unique_ptr<Worker> &p_worker : workers_) {
+                    std::lock_guard<std::mutex> task_lock(p_worker->task_lock_);
+                    p_worker->tasks_.clear();
+                }
+                queued_task_count_ = 0;
+            }
+        }
+    }
+}
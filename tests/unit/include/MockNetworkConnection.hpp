@@ -23,6 +23,7 @@
 #pragma once
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <memory>
 
@@ -40,10 +41,16 @@ namespace awsiotsdk {
             protected:
                 util::Vector<unsigned char> next_read_buf_;
                 std::atomic_bool has_read_buf_;
+                std::mutex next_read_buf_lock_;
+                std::condition_variable next_read_buf_wait_;
+
+                ResponseCode ReadFromNextReadBuf(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                                 size_t max_bytes_to_read, size_t &size_read_bytes_out);
 
             public:
                 std::atomic_bool was_read_called_;
                 std::atomic_bool was_write_called_;
+                std::atomic_int read_available_call_count_;
                 util::String last_write_buf_;
 
                 void ClearNextReadBuf();
@@ -56,6 +63,12 @@ namespace awsiotsdk {
                 virtual ResponseCode ReadInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
                                                   size_t size_bytes_to_read, size_t &size_read_bytes_out);
 
+                virtual ResponseCode WaitForReadableInternal(std::chrono::milliseconds timeout);
+
+                virtual ResponseCode ReadAvailableInternal(util::Vector<unsigned char> &buf, size_t buf_read_offset,
+                                                           size_t min_bytes_to_read, size_t max_bytes_to_read,
+                                                           size_t &size_read_bytes_out);
+
                 MOCK_METHOD0(ConnectInternal, ResponseCode());
                 MOCK_METHOD2(WriteInternalProxy, ResponseCode(
                     const util::String &, size_t &));
@@ -19,12 +19,14 @@
  *
  */
 
+#include <algorithm>
 #include <atomic>
 #include <gtest/gtest.h>
 
 #include "MockNetworkConnection.hpp"
 
 #include "ClientCore.hpp"
+#include "util/threading/WorkStealingExecutor.hpp"
 
 namespace awsiotsdk {
     namespace tests {
@@ -74,7 +76,44 @@ namespace awsiotsdk {
                     }
                 };
 
+                class TestWriteAction : public Action {
+                public:
+                    TestWriteAction() : Action(ActionType::PUBLISH, "Test Write Action") {}
+
+                    static std::unique_ptr<Action> Create(std::shared_ptr<ActionState> p_action_state);
+                    ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                               std::shared_ptr<ActionData> p_action_data);
+                };
+
+                class TestControlWriteAction : public Action {
+                public:
+                    TestControlWriteAction() : Action(ActionType::PUBACK, "Test Control Write Action") {}
+
+                    static std::unique_ptr<Action> Create(std::shared_ptr<ActionState> p_action_state);
+                    ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                               std::shared_ptr<ActionData> p_action_data);
+                };
+
+                class TestDeferredAckAction : public Action {
+                protected:
+                    std::shared_ptr<ClientCoreState> p_client_state_;
+
+                public:
+                    static std::mutex pending_action_ids_lock_;
+                    static util::Vector<uint16_t> pending_action_ids_;
+
+                    TestDeferredAckAction(std::shared_ptr<ClientCoreState> p_client_state)
+                        : Action(ActionType::SUBSCRIBE, "Test Deferred Ack Action") {
+                        p_client_state_ = p_client_state;
+                    }
+
+                    static std::unique_ptr<Action> Create(std::shared_ptr<ActionState> p_action_state);
+                    ResponseCode PerformAction(std::shared_ptr<NetworkConnection> p_network_connection,
+                                               std::shared_ptr<ActionData> p_action_data);
+                };
+
                 std::shared_ptr<ClientCoreState> p_core_state_;
+                std::shared_ptr<tests::mocks::MockNetworkConnection> p_network_mock_;
                 std::unique_ptr<ClientCore> p_client_core_;
                 std::mutex sync_action_response_lock_;
                 std::condition_variable sync_action_response_wait_;
@@ -82,9 +121,8 @@ namespace awsiotsdk {
 
                 ClientCoreTester() {
                     p_core_state_ = std::make_shared<ClientCoreState>();
-                    std::shared_ptr<NetworkConnection>
-                        p_network_connection = std::make_shared<tests::mocks::MockNetworkConnection>();
-                    p_client_core_ = ClientCore::Create(p_network_connection, p_core_state_);
+                    p_network_mock_ = std::make_shared<tests::mocks::MockNetworkConnection>();
+                    p_client_core_ = ClientCore::Create(p_network_mock_, p_core_state_);
                 }
 
             public:
@@ -119,6 +157,63 @@ namespace awsiotsdk {
                 return ResponseCode::SUCCESS;
             }
 
+            std::mutex ClientCoreTester::TestDeferredAckAction::pending_action_ids_lock_;
+            util::Vector<uint16_t> ClientCoreTester::TestDeferredAckAction::pending_action_ids_;
+
+            std::unique_ptr<Action> ClientCoreTester::TestDeferredAckAction::Create(
+                std::shared_ptr<ActionState> p_action_state) {
+                std::shared_ptr<ClientCoreState>
+                    p_client_state = std::dynamic_pointer_cast<ClientCoreState>(p_action_state);
+                if (nullptr == p_client_state) {
+                    return nullptr;
+                }
+
+                return std::unique_ptr<ClientCoreTester::TestDeferredAckAction>(
+                    new ClientCoreTester::TestDeferredAckAction(p_client_state));
+            }
+
+            ResponseCode ClientCoreTester::TestDeferredAckAction::PerformAction(
+                std::shared_ptr<NetworkConnection> p_network_connection, std::shared_ptr<ActionData> p_action_data) {
+                // The response is forwarded later by the test
+                ResponseCode rc = p_client_state_->RegisterPendingAck(p_action_data->GetActionId(),
+                                                                      p_action_data->p_async_ack_handler_);
+                if (ResponseCode::SUCCESS == rc) {
+                    std::lock_guard<std::mutex> pending_lock(pending_action_ids_lock_);
+                    pending_action_ids_.push_back(p_action_data->GetActionId());
+                }
+                return rc;
+            }
+
+            std::unique_ptr<Action> ClientCoreTester::TestWriteAction::Create(std::shared_ptr<ActionState> p_action_state) {
+                return std::unique_ptr<ClientCoreTester::TestWriteAction>(new ClientCoreTester::TestWriteAction());
+            }
+
+            ResponseCode ClientCoreTester::TestWriteAction::PerformAction(
+                std::shared_ptr<NetworkConnection> p_network_connection, std::shared_ptr<ActionData> p_action_data) {
+                std::shared_ptr<TestActionData>
+                    p_test_action_data = std::dynamic_pointer_cast<TestActionData>(p_action_data);
+                if (nullptr == p_test_action_data) {
+                    return ResponseCode::NULL_VALUE_ERROR;
+                }
+
+                size_t size_written_bytes = 0;
+                ResponseCode rc = p_network_connection->Write("packet", size_written_bytes);
+                p_test_action_data->perform_action_count_++;
+                return rc;
+            }
+
+            std::unique_ptr<Action> ClientCoreTester::TestControlWriteAction::Create(
+                std::shared_ptr<ActionState> p_action_state) {
+                return std::unique_ptr<ClientCoreTester::TestControlWriteAction>(
+                    new ClientCoreTester::TestControlWriteAction());
+            }
+
+            ResponseCode ClientCoreTester::TestControlWriteAction::PerformAction(
+                std::shared_ptr<NetworkConnection> p_network_connection, std::shared_ptr<ActionData> p_action_data) {
+                size_t size_written_bytes = 0;
+                return p_network_connection->Write("ack", size_written_bytes);
+            }
+
             void ClientCoreTester::SyncActionHandler(uint16_t action_id, ResponseCode rc) {
                 std::lock_guard<std::mutex> block_handler_lock(sync_action_response_lock_);
                 std::cout << std::endl << "Sync Action Handler called" << std::endl;
@@ -358,6 +453,558 @@ namespace awsiotsdk {
                 p_core_state_->SetMaxActionQueueSize(cur_max_queue_size);
             }
 
+            // Test Action queue overwrite oldest policy, oldest action is dropped and its Ack handler notified
+            TEST_F(ClientCoreTester, ActionQueueOverwriteOldest) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+                uint16_t dropped_action_id = 0;
+                ResponseCode dropped_action_rc = ResponseCode::SUCCESS;
+
+                TestAction::Reset();
+
+                size_t cur_max_queue_size = p_core_state_->GetMaxActionQueueSize();
+
+                p_core_state_->SetMaxActionQueueSize(2);
+                p_core_state_->SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy::OVERWRITE_OLDEST);
+                p_client_core_->SetProcessQueuedActions(false);
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::RESERVED_ACTION, TestAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::shared_ptr<TestActionData> p_oldest_action_data = std::make_shared<TestActionData>();
+                p_oldest_action_data->p_async_ack_handler_ = [&](uint16_t ack_action_id, ResponseCode ack_rc) {
+                    dropped_action_id = ack_action_id;
+                    dropped_action_rc = ack_rc;
+                };
+                rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_oldest_action_data, action_id);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                uint16_t oldest_action_id = action_id;
+
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                for (size_t itr = 0; itr < 2; itr++) {
+                    rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+                EXPECT_EQ(oldest_action_id, dropped_action_id);
+                EXPECT_EQ(ResponseCode::ACTION_QUEUE_FULL, dropped_action_rc);
+
+                p_client_core_->SetProcessQueuedActions(true);
+                for (size_t itr = 0; itr < 100; itr++) {
+                    if (2 == p_test_action_data->perform_action_count_) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(2, p_test_action_data->perform_action_count_);
+                EXPECT_EQ(0, p_oldest_action_data->perform_action_count_);
+
+                p_core_state_->SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy::REJECT);
+                p_core_state_->SetMaxActionQueueSize(cur_max_queue_size);
+            }
+
+            // Test Action queue block with timeout policy, enqueue waits for space and fails after the timeout
+            TEST_F(ClientCoreTester, ActionQueueBlockWithTimeout) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+
+                TestAction::Reset();
+
+                size_t cur_max_queue_size = p_core_state_->GetMaxActionQueueSize();
+
+                p_core_state_->SetMaxActionQueueSize(1);
+                p_core_state_->SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT,
+                                                            std::chrono::milliseconds(200));
+                p_client_core_->SetProcessQueuedActions(false);
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::RESERVED_ACTION, TestAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                EXPECT_EQ(ResponseCode::ACTION_QUEUE_FULL, rc);
+                EXPECT_LE(std::chrono::milliseconds(200), std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start));
+
+                // Blocked request should succeed once the queue is processed
+                std::thread process_thread([this] {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                    p_client_core_->SetProcessQueuedActions(true);
+                });
+                rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                process_thread.join();
+
+                for (size_t itr = 0; itr < 100; itr++) {
+                    if (2 == p_test_action_data->perform_action_count_) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(2, p_test_action_data->perform_action_count_);
+
+                p_core_state_->SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy::REJECT);
+                p_core_state_->SetMaxActionQueueSize(cur_max_queue_size);
+            }
+
+            // Test concurrent enqueue from multiple threads, every action is processed exactly once
+            TEST_F(ClientCoreTester, ConcurrentEnqueue) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                const int thread_count = 4;
+                const int actions_per_thread = 200;
+
+                TestAction::Reset();
+
+                size_t cur_max_queue_size = p_core_state_->GetMaxActionQueueSize();
+
+                p_core_state_->SetMaxActionQueueSize(8);
+                p_core_state_->SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT,
+                                                            std::chrono::milliseconds(5000));
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::RESERVED_ACTION, TestAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_client_core_->SetProcessQueuedActions(true);
+
+                std::atomic_int success_count(0);
+                util::Vector<std::thread> producers;
+                for (int thread_itr = 0; thread_itr < thread_count; thread_itr++) {
+                    producers.push_back(std::thread([&] {
+                        uint16_t action_id = 0;
+                        for (int itr = 0; itr < actions_per_thread; itr++) {
+                            std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                            if (ResponseCode::SUCCESS == p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION,
+                                                                                            p_test_action_data,
+                                                                                            action_id)) {
+                                success_count++;
+                            }
+                        }
+                    }));
+                }
+                for (std::thread &producer : producers) {
+                    producer.join();
+                }
+
+                for (size_t itr = 0; itr < 200; itr++) {
+                    if (thread_count * actions_per_thread == TestAction::total_perform_action_call_count_) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(thread_count * actions_per_thread, success_count);
+                EXPECT_EQ(thread_count * actions_per_thread, TestAction::total_perform_action_call_count_);
+
+                p_core_state_->SetActionQueueOverflowPolicy(ActionQueueOverflowPolicy::REJECT);
+                p_core_state_->SetMaxActionQueueSize(cur_max_queue_size);
+            }
+
+            // Test Outbound queue is drained back-to-back without any fixed delay between actions
+            TEST_F(ClientCoreTester, ActionQueueDrainedWithoutDelay) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+
+                TestAction::Reset();
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::RESERVED_ACTION, TestAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_client_core_->SetProcessQueuedActions(true);
+
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (size_t itr = 0; itr < 10; itr++) {
+                    rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+
+                for (size_t itr = 0; itr < 100; itr++) {
+                    if (10 == p_test_action_data->perform_action_count_) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                EXPECT_EQ(10, p_test_action_data->perform_action_count_);
+                EXPECT_GT(std::chrono::milliseconds(500), elapsed);
+            }
+
+            // Test per Action Type rate limit, actions beyond the burst size are spaced out by the configured rate
+            TEST_F(ClientCoreTester, ActionRateLimit) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+
+                TestAction::Reset();
+
+                EXPECT_EQ(ResponseCode::FAILURE, p_core_state_->SetActionRateLimit(ActionType::RESERVED_ACTION, 0, 1));
+                EXPECT_EQ(ResponseCode::FAILURE, p_core_state_->SetActionRateLimit(ActionType::RESERVED_ACTION, 10, 0));
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::RESERVED_ACTION, TestAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                rc = p_core_state_->SetActionRateLimit(ActionType::RESERVED_ACTION, 10, 2);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_client_core_->SetProcessQueuedActions(true);
+
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                for (size_t itr = 0; itr < 5; itr++) {
+                    rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+
+                for (size_t itr = 0; itr < 200; itr++) {
+                    if (5 == p_test_action_data->perform_action_count_) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                EXPECT_EQ(5, p_test_action_data->perform_action_count_);
+                // Burst of 2, remaining 3 actions at 10 per second
+                EXPECT_LE(std::chrono::milliseconds(250), elapsed);
+
+                p_core_state_->ClearActionRateLimit(ActionType::RESERVED_ACTION);
+            }
+
+            // Test queued actions are sent in one network write, one failed write fails every action in the batch
+            TEST_F(ClientCoreTester, BatchedWrites) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+                std::atomic_int failed_ack_count(0);
+                ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler =
+                    [&failed_ack_count](uint16_t action_id, ResponseCode rc) {
+                        if (ResponseCode::NETWORK_SSL_WRITE_ERROR == rc) {
+                            failed_ack_count++;
+                        }
+                    };
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::PUBLISH, TestWriteAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_core_state_->SetWriteBatchLimits(1024, std::chrono::milliseconds(0));
+
+                util::String written_buf;
+                std::atomic_int write_count(0);
+                EXPECT_CALL(*p_network_mock_, IsConnected()).WillRepeatedly(::testing::Return(true));
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_))
+                    .WillOnce(::testing::Invoke([&written_buf, &write_count](const util::String &buf,
+                                                                             size_t &size_written_bytes_out) {
+                        written_buf = buf;
+                        size_written_bytes_out = buf.length();
+                        write_count++;
+                        return ResponseCode::SUCCESS;
+                    }))
+                    .WillOnce(::testing::Return(ResponseCode::NETWORK_SSL_WRITE_ERROR));
+
+                p_client_core_->SetProcessQueuedActions(false);
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                for (size_t itr = 0; itr < 5; itr++) {
+                    p_test_action_data = std::make_shared<TestActionData>();
+                    rc = p_client_core_->PerformActionAsync(ActionType::PUBLISH, p_test_action_data, action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+                p_client_core_->SetProcessQueuedActions(true);
+
+                for (size_t itr = 0; itr < 100; itr++) {
+                    if (1 == write_count) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(1, write_count);
+                EXPECT_EQ("packetpacketpacketpacketpacket", written_buf);
+
+                p_client_core_->SetProcessQueuedActions(false);
+                for (size_t itr = 0; itr < 3; itr++) {
+                    p_test_action_data = std::make_shared<TestActionData>();
+                    p_test_action_data->p_async_ack_handler_ = p_async_ack_handler;
+                    rc = p_client_core_->PerformActionAsync(ActionType::PUBLISH, p_test_action_data, action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+                p_client_core_->SetProcessQueuedActions(true);
+
+                for (size_t itr = 0; itr < 100; itr++) {
+                    if (3 == failed_ack_count) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(3, failed_ack_count);
+            }
+
+            // Test control actions are written ahead of queued actions, combined into one write and not held back by the
+            // rate limit of the next queued action
+            TEST_F(ClientCoreTester, ControlActionsBypassQueue) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::PUBLISH, TestWriteAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                rc = p_client_core_->RegisterAction(ActionType::PUBACK, TestControlWriteAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_core_state_->SetWriteBatchLimits(1024, std::chrono::milliseconds(0));
+                rc = p_core_state_->SetActionRateLimit(ActionType::PUBLISH, 1, 1);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::mutex written_bufs_lock;
+                util::Vector<util::String> written_bufs;
+                EXPECT_CALL(*p_network_mock_, IsConnected()).WillRepeatedly(::testing::Return(true));
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_))
+                    .WillRepeatedly(::testing::Invoke([&written_bufs_lock, &written_bufs](const util::String &buf,
+                                                                                          size_t &size_written_bytes_out) {
+                        std::lock_guard<std::mutex> written_bufs_guard(written_bufs_lock);
+                        written_bufs.push_back(buf);
+                        size_written_bytes_out = buf.length();
+                        return ResponseCode::SUCCESS;
+                    }));
+                auto wait_for_write_count = [&written_bufs_lock, &written_bufs](size_t write_count) {
+                    for (size_t itr = 0; itr < 200; itr++) {
+                        {
+                            std::lock_guard<std::mutex> written_bufs_guard(written_bufs_lock);
+                            if (write_count <= written_bufs.size()) {
+                                return;
+                            }
+                        }
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                };
+
+                p_client_core_->SetProcessQueuedActions(false);
+                for (size_t itr = 0; itr < 2; itr++) {
+                    rc = p_client_core_->PerformActionAsync(ActionType::PUBLISH, std::make_shared<TestActionData>(),
+                                                            action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+                for (size_t itr = 0; itr < 2; itr++) {
+                    rc = p_core_state_->EnqueueControlAction(ActionType::PUBACK, std::make_shared<TestActionData>(),
+                                                             action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+                p_client_core_->SetProcessQueuedActions(true);
+
+                // Both control actions go out in the batch of the first queued action, the second one is rate limited
+                wait_for_write_count(1);
+                rc = p_core_state_->EnqueueControlAction(ActionType::PUBACK, std::make_shared<TestActionData>(),
+                                                         action_id);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                wait_for_write_count(2);
+                {
+                    std::lock_guard<std::mutex> written_bufs_guard(written_bufs_lock);
+                    ASSERT_EQ(2U, written_bufs.size());
+                    EXPECT_EQ("ackackpacket", written_bufs[0]);
+                    EXPECT_EQ("ack", written_bufs[1]);
+                }
+
+                wait_for_write_count(3);
+                {
+                    std::lock_guard<std::mutex> written_bufs_guard(written_bufs_lock);
+                    ASSERT_EQ(3U, written_bufs.size());
+                    EXPECT_EQ("packet", written_bufs[2]);
+                }
+                p_core_state_->ClearActionRateLimit(ActionType::PUBLISH);
+            }
+
+            // Test Sync Action execution - Multiple threads perform Sync actions concurrently, each waits for its own
+            // response. A Sync action that does not receive a response times out and stops waiting for the Ack
+            TEST_F(ClientCoreTester, ConcurrentSyncActions) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                TestDeferredAckAction::pending_action_ids_.clear();
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::SUBSCRIBE, TestDeferredAckAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                const size_t thread_count = 4;
+                util::Vector<ResponseCode> thread_results(thread_count, ResponseCode::FAILURE);
+                util::Vector<std::thread> threads;
+                for (size_t itr = 0; itr < thread_count; itr++) {
+                    threads.push_back(std::thread([this, &thread_results, itr] {
+                        thread_results[itr] = p_client_core_->PerformAction(ActionType::SUBSCRIBE,
+                                                                            std::make_shared<TestActionData>(),
+                                                                            std::chrono::milliseconds(5000));
+                    }));
+                }
+
+                // All requests are sent before any response is received
+                util::Vector<uint16_t> pending_action_ids;
+                for (size_t itr = 0; itr < 200; itr++) {
+                    {
+                        std::lock_guard<std::mutex> pending_lock(TestDeferredAckAction::pending_action_ids_lock_);
+                        pending_action_ids = TestDeferredAckAction::pending_action_ids_;
+                    }
+                    if (thread_count == pending_action_ids.size()) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(thread_count, pending_action_ids.size());
+
+                for (size_t itr = 0; itr < pending_action_ids.size(); itr++) {
+                    p_core_state_->ForwardReceivedAck(pending_action_ids[itr],
+                                                      (0 == itr) ? ResponseCode::FAILURE : ResponseCode::SUCCESS);
+                }
+                for (std::thread &thread : threads) {
+                    thread.join();
+                }
+                EXPECT_EQ(thread_count - 1, static_cast<size_t>(std::count(thread_results.begin(),
+                                                                           thread_results.end(),
+                                                                           ResponseCode::SUCCESS)));
+                EXPECT_EQ(1, std::count(thread_results.begin(), thread_results.end(), ResponseCode::FAILURE));
+
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                rc = p_client_core_->PerformAction(ActionType::SUBSCRIBE, p_test_action_data,
+                                                   std::chrono::milliseconds(50));
+                EXPECT_EQ(ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR, rc);
+                EXPECT_FALSE(p_core_state_->DeletePendingAck(p_test_action_data->GetActionId()));
+            }
+
+            // Test pending Acks - Acks beyond the preallocated capacity are tracked, each handler is called exactly
+            // once, and Acks that are not answered within the Ack timeout receive a request timeout response
+            TEST_F(ClientCoreTester, PendingAckTimeout) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                std::atomic_int success_ack_count(0);
+                std::atomic_int timeout_ack_count(0);
+                ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler =
+                    [&success_ack_count, &timeout_ack_count](uint16_t action_id, ResponseCode rc) {
+                        if (ResponseCode::SUCCESS == rc) {
+                            success_ack_count++;
+                        } else if (ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR == rc) {
+                            timeout_ack_count++;
+                        }
+                    };
+
+                uint16_t ack_count = 3 * DEFAULT_PENDING_ACK_TABLE_CAPACITY;
+                for (uint16_t action_id = 1; action_id <= ack_count; action_id++) {
+                    EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(action_id, p_async_ack_handler));
+                }
+                for (uint16_t action_id = ack_count; action_id > 0; action_id--) {
+                    p_core_state_->ForwardReceivedAck(action_id, ResponseCode::SUCCESS);
+                    p_core_state_->ForwardReceivedAck(action_id, ResponseCode::SUCCESS);
+                }
+                EXPECT_EQ(ack_count, success_ack_count);
+                EXPECT_FALSE(p_core_state_->DeletePendingAck(1));
+
+                EXPECT_EQ(ResponseCode::NULL_VALUE_ERROR, p_core_state_->RegisterPendingAck(1, nullptr));
+
+                p_core_state_->SetAckTimeout(std::chrono::milliseconds(50));
+                EXPECT_EQ(std::chrono::milliseconds(50), p_core_state_->GetAckTimeout());
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(1, p_async_ack_handler));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(2, p_async_ack_handler));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(3, p_async_ack_handler));
+                EXPECT_TRUE(p_core_state_->DeletePendingAck(3));
+
+                // Expired Acks are deleted by the outbound processing thread
+                for (size_t itr = 0; itr < 100; itr++) {
+                    if (2 == timeout_ack_count) {
+                        break;
+                    }
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(2, timeout_ack_count);
+
+                p_core_state_->ForwardReceivedAck(1, ResponseCode::SUCCESS);
+                EXPECT_EQ(ack_count, success_ack_count);
+                EXPECT_FALSE(p_core_state_->DeletePendingAck(2));
+            }
+
+            // Test registering an Ack for an Action ID that is still pending - the earlier handler is completed with
+            // a failure and the response goes to the newer handler
+            TEST_F(ClientCoreTester, PendingAckReplaced) {
+                EXPECT_NE(nullptr, p_core_state_);
+
+                util::Vector<ResponseCode> first_results;
+                util::Vector<ResponseCode> second_results;
+                ActionData::AsyncAckNotificationHandlerPtr p_first_handler =
+                    [&first_results](uint16_t action_id, ResponseCode rc) {
+                        first_results.push_back(rc);
+                    };
+                ActionData::AsyncAckNotificationHandlerPtr p_second_handler =
+                    [&second_results](uint16_t action_id, ResponseCode rc) {
+                        second_results.push_back(rc);
+                    };
+
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(1, p_first_handler));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(1, p_second_handler));
+                ASSERT_EQ(1U, first_results.size());
+                EXPECT_EQ(ResponseCode::FAILURE, first_results[0]);
+                EXPECT_TRUE(second_results.empty());
+
+                p_core_state_->ForwardReceivedAck(1, ResponseCode::SUCCESS);
+                EXPECT_EQ(1U, first_results.size());
+                ASSERT_EQ(1U, second_results.size());
+                EXPECT_EQ(ResponseCode::SUCCESS, second_results[0]);
+            }
+
+            // Test queued actions are processed by tasks on an executor, expired Acks are deleted without queued
+            // actions, and the outbound processing thread takes over again once the executor is removed
+            TEST_F(ClientCoreTester, ExecutorProcessesQueuedActions) {
+                EXPECT_NE(nullptr, p_client_core_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                uint16_t action_id = 0;
+                std::atomic_int timeout_ack_count(0);
+                ActionData::AsyncAckNotificationHandlerPtr p_async_ack_handler =
+                    [&timeout_ack_count](uint16_t action_id, ResponseCode rc) {
+                        if (ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR == rc) {
+                            timeout_ack_count++;
+                        }
+                    };
+
+                TestAction::Reset();
+
+                ResponseCode rc = p_client_core_->RegisterAction(ActionType::RESERVED_ACTION, TestAction::Create);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                std::shared_ptr<util::Threading::WorkStealingExecutor>
+                    p_executor = util::Threading::WorkStealingExecutor::Create(2);
+                p_client_core_->SetExecutor(p_executor);
+
+                // Queued before processing is enabled, picked up once it is
+                std::shared_ptr<TestActionData> p_test_action_data = std::make_shared<TestActionData>();
+                rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_client_core_->SetProcessQueuedActions(true);
+                for (size_t itr = 1; itr < 10; itr++) {
+                    rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                }
+
+                for (size_t itr = 0; itr < 100 && 10 > p_test_action_data->perform_action_count_; itr++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(10, p_test_action_data->perform_action_count_);
+
+                p_core_state_->SetAckTimeout(std::chrono::milliseconds(50));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RegisterPendingAck(1, p_async_ack_handler));
+                for (size_t itr = 0; itr < 100 && 1 > timeout_ack_count; itr++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(1, timeout_ack_count);
+
+                p_client_core_->SetExecutor(nullptr);
+                rc = p_client_core_->PerformActionAsync(ActionType::RESERVED_ACTION, p_test_action_data, action_id);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                for (size_t itr = 0; itr < 100 && 11 > p_test_action_data->perform_action_count_; itr++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_EQ(11, p_test_action_data->perform_action_count_);
+            }
+
             // Test creation of action thread runner, thread should execute successfully,
             // Action instance count is incremented, Action instance count decremented on thread destroy
             TEST_F(ClientCoreTester, ActionRunner) {
@@ -19,29 +19,43 @@
  *
  */
 
+#include <algorithm>
+
 #include "MockNetworkConnection.hpp"
 
 namespace awsiotsdk {
     namespace tests {
         namespace mocks {
             void MockNetworkConnection::ClearNextReadBuf() {
+                std::lock_guard<std::mutex> read_buf_lock(next_read_buf_lock_);
                 has_read_buf_ = false;
                 next_read_buf_.clear();
             }
 
             void MockNetworkConnection::SetNextReadBuf(util::String next_read_buf) {
-                has_read_buf_ = true;
+                std::lock_guard<std::mutex> read_buf_lock(next_read_buf_lock_);
                 was_read_called_ = false;
                 next_read_buf_.clear();
                 for (char c : next_read_buf) {
                     next_read_buf_.push_back(static_cast<unsigned char>(c));
                 }
+                has_read_buf_ = true;
+                next_read_buf_wait_.notify_all();
             }
 
             util::String MockNetworkConnection::GetNextReadBuf() {
+                std::lock_guard<std::mutex> read_buf_lock(next_read_buf_lock_);
                 return util::String(next_read_buf_.begin(), next_read_buf_.end());
             }
 
+            ResponseCode MockNetworkConnection::WaitForReadableInternal(std::chrono::milliseconds timeout) {
+                std::unique_lock<std::mutex> read_buf_lock(next_read_buf_lock_);
+                if (next_read_buf_wait_.wait_for(read_buf_lock, timeout, [this] { return has_read_buf_.load(); })) {
+                    return ResponseCode::SUCCESS;
+                }
+                return ResponseCode::NETWORK_SSL_NOTHING_TO_READ;
+            }
+
             bool MockNetworkConnection::HasReadBufSet() { return has_read_buf_; }
 
             ResponseCode MockNetworkConnection::WriteInternal(const util::String &buf, size_t &size_written_bytes_out) {
@@ -57,33 +71,46 @@ namespace awsiotsdk {
                 size_read_bytes_out = 0;
 
                 if (has_read_buf_) {
-                    size_t remaining_bytes_in_buf = next_read_buf_.size();
-                    size_t cur_read_bytes = 0;
-                    size_read_bytes_out = ((size_bytes_to_read <= remaining_bytes_in_buf) ? size_bytes_to_read
-                                                                                          : remaining_bytes_in_buf);
-                    //size_t cur_read_bytes = 0;
-                    auto begin_itr = next_read_buf_.begin();
-                    auto end_itr = next_read_buf_.begin() + size_read_bytes_out;
-                    auto insert_itr = buf.begin() + buf_read_offset;
-                    auto insert_end_itr = buf.begin() + buf_read_offset + size_read_bytes_out;
-                    buf.erase(insert_itr, insert_end_itr);
-                    for (unsigned char c : next_read_buf_) {
-                        buf.push_back(c);
-                        if (cur_read_bytes >= size_read_bytes_out) {
-                            break;
-                        }
-                    }
-
-                    next_read_buf_.erase(begin_itr, end_itr);
-
-                    if (0 == next_read_buf_.size()) {
-                        has_read_buf_ = false;
-                    }
-
-                    return ResponseCode::SUCCESS;
+                    return ReadFromNextReadBuf(buf, buf_read_offset, size_bytes_to_read, size_read_bytes_out);
                 }
                 return ReadInternalProxy(buf, size_bytes_to_read, size_read_bytes_out);
             }
+
+            ResponseCode MockNetworkConnection::ReadAvailableInternal(util::Vector<unsigned char> &buf,
+                                                                      size_t buf_read_offset,
+                                                                      size_t min_bytes_to_read,
+                                                                      size_t max_bytes_to_read,
+                                                                      size_t &size_read_bytes_out) {
+                was_read_called_ = true;
+                read_available_call_count_++;
+                size_read_bytes_out = 0;
+
+                if (has_read_buf_) {
+                    return ReadFromNextReadBuf(buf, buf_read_offset, max_bytes_to_read, size_read_bytes_out);
+                }
+                return ReadInternalProxy(buf, max_bytes_to_read, size_read_bytes_out);
+            }
+
+            ResponseCode MockNetworkConnection::ReadFromNextReadBuf(util::Vector<unsigned char> &buf,
+                                                                    size_t buf_read_offset,
+                                                                    size_t max_bytes_to_read,
+                                                                    size_t &size_read_bytes_out) {
+                std::lock_guard<std::mutex> read_buf_lock(next_read_buf_lock_);
+                size_read_bytes_out = std::min(max_bytes_to_read, next_read_buf_.size());
+                if (buf.size() < buf_read_offset + size_read_bytes_out) {
+                    buf.resize(buf_read_offset + size_read_bytes_out);
+                }
+
+                auto end_itr = next_read_buf_.begin() + size_read_bytes_out;
+                std::copy(next_read_buf_.begin(), end_itr, buf.begin() + buf_read_offset);
+                next_read_buf_.erase(next_read_buf_.begin(), end_itr);
+
+                if (0 == next_read_buf_.size()) {
+                    has_read_buf_ = false;
+                }
+
+                return ResponseCode::SUCCESS;
+            }
         }
     }
 }
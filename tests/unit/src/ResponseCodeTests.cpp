@@ -386,6 +386,16 @@ namespace awsiotsdk {
                                                        ResponseCode::MQTT_SUBSCRIBE_FAILED);
                 EXPECT_EQ(expected_string, response_string);
 
+                response_string = ResponseHelper::ToString(ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR);
+                expected_string = ResponseCodeToString(ResponseHelper::MQTT_INFLIGHT_WINDOW_FULL_ERROR_STRING,
+                                                       ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR);
+                EXPECT_EQ(expected_string, response_string);
+
+                response_string = ResponseHelper::ToString(ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR);
+                expected_string = ResponseCodeToString(ResponseHelper::MQTT_OFFLINE_STORE_FULL_ERROR_STRING,
+                                                       ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR);
+                EXPECT_EQ(expected_string, response_string);
+
                 response_string = ResponseHelper::ToString(ResponseCode::JSON_PARSE_KEY_NOT_FOUND_ERROR);
                 expected_string = ResponseCodeToString(ResponseHelper::JSON_PARSE_KEY_NOT_FOUND_ERROR_STRING,
                                                        ResponseCode::JSON_PARSE_KEY_NOT_FOUND_ERROR);
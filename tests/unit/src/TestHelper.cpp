@@ -251,7 +251,7 @@ namespace awsiotsdk {
             buf.append(&temp_byte, 1);
             buf.append(encoded_rem_len);
 
-            temp_byte = is_session_present ? (char) 0 : (char) 1;
+            temp_byte = is_session_present ? (char) 1 : (char) 0;
             buf.append(&temp_byte, 1);
 
             temp_byte = static_cast<char>(connack_rc);
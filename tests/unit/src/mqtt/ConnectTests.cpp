@@ -33,6 +33,7 @@
 
 #define CONNECT_FIXED_HEADER_VAL 0x10
 #define DISCONNECT_FIXED_HEADER_VAL 0xE0
+#define SUBSCRIBE_FIXED_HEADER_VAL 0x82
 
 #define KEEP_ALIVE_TIMEOUT_SECS 30
 #define MQTT_COMMAND_TIMEOUT_MSECS 20000
@@ -45,6 +46,32 @@ namespace awsiotsdk {
         namespace unit {
             class ConnectDisconnectActionTester : public ::testing::Test {
             protected:
+                /**
+                 * @brief Client state that lets tests record outbound traffic without an outbound queue
+                 */
+                class TrafficClientState : public mqtt::ClientState {
+                public:
+                    TrafficClientState(std::chrono::milliseconds mqtt_command_timeout)
+                        : mqtt::ClientState(mqtt_command_timeout) {}
+
+                    void RecordOutboundActivity() {
+                        last_outbound_action_time_ = std::chrono::steady_clock::now().time_since_epoch().count();
+                    }
+                };
+
+                /**
+                 * @brief Keepalive runner that lets tests resubscribe without reconnecting
+                 */
+                class ResubscribeKeepaliveRunner : public mqtt::KeepaliveActionRunner {
+                public:
+                    ResubscribeKeepaliveRunner(std::shared_ptr<mqtt::ClientState> p_client_state)
+                        : mqtt::KeepaliveActionRunner(p_client_state) {}
+
+                    ResponseCode Resubscribe(std::shared_ptr<NetworkConnection> p_network_connection) {
+                        return mqtt::KeepaliveActionRunner::Resubscribe(p_network_connection, test_client_id_);
+                    }
+                };
+
                 std::shared_ptr<mqtt::ClientState> p_core_state_;
                 std::shared_ptr<tests::mocks::MockNetworkConnection> p_network_connection_;
                 tests::mocks::MockNetworkConnection *p_network_mock_;
@@ -62,6 +89,21 @@ namespace awsiotsdk {
                     p_network_connection_ = std::make_shared<tests::mocks::MockNetworkConnection>();
                     p_network_mock_ = p_network_connection_.get();
                 }
+
+                util::Vector<std::shared_ptr<mqtt::Subscription>> AddTestSubscriptions(size_t count) {
+                    util::Vector<std::shared_ptr<mqtt::Subscription>> subscriptions;
+                    for (size_t itr = 0; itr < count; itr++) {
+                        util::String topic_name = test_topic_name_ + "/" + std::to_string(itr);
+                        subscriptions.push_back(mqtt::Subscription::Create(
+                            Utf8String::Create(topic_name), mqtt::QoS::QOS0,
+                            [](util::String topic_name, util::String payload,
+                               std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                                return ResponseCode::SUCCESS;
+                            }, nullptr));
+                        p_core_state_->AddSubscription(subscriptions.back());
+                    }
+                    return subscriptions;
+                }
             };
 
             const uint16_t ConnectDisconnectActionTester::test_packet_id_ = 1234;
@@ -712,6 +754,237 @@ namespace awsiotsdk {
                 }
             }
 
+            TEST_F(ConnectDisconnectActionTester, KeepAliveSkipsPingreqWhileTrafficIsExchanged) {
+                std::shared_ptr<TrafficClientState>
+                    p_traffic_state = std::make_shared<TrafficClientState>(std::chrono::milliseconds(200));
+                p_network_connection_->last_write_buf_.clear();
+                p_network_connection_->was_write_called_ = false;
+
+                // Pings are due every second
+                p_traffic_state->SetKeepAliveTimeout(std::chrono::seconds(2));
+                p_traffic_state->SetConnected(true);
+                p_traffic_state->SetAutoReconnectEnabled(true);
+
+                EXPECT_CALL(*p_network_mock_, IsConnected()).WillRepeatedly(::testing::Return(true));
+                std::shared_ptr<mqtt::PingreqPacket> p_pingreq_packet = mqtt::PingreqPacket::Create();
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(::testing::DoAll(
+                    ::testing::SetArgReferee<1>(p_pingreq_packet->Size()),
+                    ::testing::Return(ResponseCode::SUCCESS)));
+
+                std::unique_ptr<Action> p_keepalive_action = mqtt::KeepaliveActionRunner::Create(p_traffic_state);
+                ASSERT_TRUE(p_keepalive_action->IsTimerDriven());
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::time_point next_run_time
+                    = p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr);
+                EXPECT_LE(start + std::chrono::milliseconds(900), next_run_time);
+                EXPECT_GE(start + std::chrono::milliseconds(1100), next_run_time);
+
+                // Traffic in both directions moves the ping out
+                std::this_thread::sleep_for(std::chrono::milliseconds(600));
+                p_traffic_state->RecordInboundActivity();
+                p_traffic_state->RecordOutboundActivity();
+                std::this_thread::sleep_for(std::chrono::milliseconds(500));
+                next_run_time = p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr);
+                EXPECT_FALSE(p_network_connection_->was_write_called_);
+                EXPECT_FALSE(p_traffic_state->IsPingreqPending());
+                EXPECT_LT(std::chrono::steady_clock::now(), next_run_time);
+
+                std::this_thread::sleep_until(next_run_time);
+                p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr);
+                EXPECT_TRUE(p_network_connection_->was_write_called_);
+                EXPECT_TRUE(p_traffic_state->IsPingreqPending());
+            }
+
+            TEST_F(ConnectDisconnectActionTester, KeepAliveWakesUpOnStop) {
+                p_core_state_->SetConnected(false);
+                p_core_state_->SetKeepAliveTimeout(std::chrono::seconds(KEEP_ALIVE_TIMEOUT_SECS));
+
+                std::unique_ptr<Action> p_keepalive_action = mqtt::KeepaliveActionRunner::Create(p_core_state_);
+                std::shared_ptr<std::atomic_bool> thread_task_sync = std::make_shared<std::atomic_bool>(true);
+                p_keepalive_action->SetParentThreadSync(thread_task_sync);
+
+                std::chrono::steady_clock::time_point stop_time;
+                {
+                    util::Threading::ThreadTask temp_task(util::Threading::DestructorAction::JOIN, thread_task_sync,
+                                                          "TestKeepAliveStop");
+                    temp_task.Run(&Action::PerformAction, std::move(p_keepalive_action), p_network_connection_,
+                                  nullptr);
+                    // Sleeps until the first connect, nothing else is due
+                    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+                    stop_time = std::chrono::steady_clock::now();
+                    temp_task.Stop();
+                    p_core_state_->WakeActionRunners();
+                }
+                EXPECT_GT(std::chrono::milliseconds(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS),
+                          std::chrono::duration_cast<std::chrono::milliseconds>(
+                              std::chrono::steady_clock::now() - stop_time));
+            }
+
+            TEST_F(ConnectDisconnectActionTester, KeepAliveWaitsForReconnectBackoff) {
+                util::Vector<std::chrono::milliseconds> schedule;
+                schedule.push_back(std::chrono::milliseconds(300));
+                p_core_state_->SetReconnectBackoffStrategy(mqtt::FixedScheduleBackoffStrategy::Create(schedule));
+                p_core_state_->SetAutoReconnectData(mqtt::ConnectPacket::Create(true, mqtt::Version::MQTT_3_1_1,
+                                                                                keep_alive_timeout_,
+                                                                                Utf8String::Create(test_client_id_),
+                                                                                nullptr, nullptr, nullptr, true));
+                int disconnect_count = 0;
+                int reconnect_count = 0;
+                p_core_state_->disconnect_handler_ptr_ = [&disconnect_count](
+                    util::String mqtt_client_id, std::shared_ptr<DisconnectCallbackContextData> p_app_handler_data) {
+                    disconnect_count++;
+                    return ResponseCode::SUCCESS;
+                };
+                p_core_state_->reconnect_handler_ptr_ = [&reconnect_count](
+                    util::String mqtt_client_id, std::shared_ptr<ReconnectCallbackContextData> p_app_handler_data,
+                    ResponseCode reconnect_result) {
+                    EXPECT_EQ(ResponseCode::ACTION_NOT_REGISTERED_ERROR, reconnect_result);
+                    reconnect_count++;
+                    return ResponseCode::SUCCESS;
+                };
+                p_core_state_->SetKeepAliveTimeout(keep_alive_timeout_);
+                p_core_state_->SetAutoReconnectEnabled(true);
+                p_core_state_->SetConnected(true);
+
+                std::unique_ptr<Action> p_keepalive_action = mqtt::KeepaliveActionRunner::Create(p_core_state_);
+                p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr);
+
+                // The disconnect callback runs right away, the first attempt waits for the backoff
+                p_core_state_->SetConnected(false);
+                p_core_state_->SetAutoReconnectRequired(true);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::time_point next_run_time
+                    = p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr);
+                EXPECT_EQ(1, disconnect_count);
+                EXPECT_EQ(0, reconnect_count);
+                EXPECT_LE(start + std::chrono::milliseconds(300), next_run_time);
+                EXPECT_GE(start + std::chrono::milliseconds(400), next_run_time);
+                EXPECT_EQ(next_run_time, p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr));
+                EXPECT_EQ(0, reconnect_count);
+
+                std::this_thread::sleep_until(next_run_time);
+                std::chrono::steady_clock::time_point attempt_time = std::chrono::steady_clock::now();
+                next_run_time = p_keepalive_action->PerformTimedAction(p_network_connection_, nullptr);
+                EXPECT_EQ(1, disconnect_count);
+                EXPECT_EQ(1, reconnect_count);
+                EXPECT_LE(attempt_time + std::chrono::milliseconds(300), next_run_time);
+                EXPECT_EQ(0U, p_core_state_->GetReconnectTimeHistogram().GetCount());
+            }
+
+            TEST_F(ConnectDisconnectActionTester, ResubscribePipelinesTrackedPackets) {
+                util::Vector<std::shared_ptr<mqtt::Subscription>> subscriptions = AddTestSubscriptions(10);
+                p_core_state_->SetSessionPresent(false);
+                int resubscribe_count = 0;
+                ResponseCode resubscribe_rc = ResponseCode::FAILURE;
+                p_core_state_->resubscribe_handler_ptr_ = [&resubscribe_count, &resubscribe_rc](
+                    util::String mqtt_client_id, std::shared_ptr<ResubscribeCallbackContextData> p_app_handler_data,
+                    ResponseCode resubscribe_result) {
+                    resubscribe_count++;
+                    resubscribe_rc = resubscribe_result;
+                    return ResponseCode::SUCCESS;
+                };
+
+                // Both packets go out in one write
+                EXPECT_CALL(*p_network_mock_, IsConnected()).WillRepeatedly(::testing::Return(true));
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(
+                    ::testing::Invoke([](const util::String &buf, size_t &size_written_bytes_out) {
+                        size_written_bytes_out = buf.length();
+                        return ResponseCode::SUCCESS;
+                    }));
+                ResubscribeKeepaliveRunner keepalive_runner(p_core_state_);
+                EXPECT_EQ(ResponseCode::SUCCESS, keepalive_runner.Resubscribe(p_network_connection_));
+                EXPECT_EQ(0, resubscribe_count);
+
+                util::Map<uint16_t, size_t> topics_per_packet;
+                for (std::shared_ptr<mqtt::Subscription> &p_subscription : subscriptions) {
+                    EXPECT_NE(0, p_subscription->GetPacketId());
+                    topics_per_packet[p_subscription->GetPacketId()]++;
+                }
+                ASSERT_EQ(2U, topics_per_packet.size());
+                EXPECT_EQ(static_cast<size_t>(MAX_TOPICS_IN_ONE_SUBSCRIBE_PACKET), topics_per_packet.begin()->second);
+                unsigned char *p_written = (unsigned char *) (p_network_connection_->last_write_buf_.c_str());
+                EXPECT_EQ(SUBSCRIBE_FIXED_HEADER_VAL, *p_written);
+
+                // The result is reported once the last SUBACK arrives
+                p_core_state_->ForwardReceivedAck(topics_per_packet.begin()->first, ResponseCode::SUCCESS);
+                EXPECT_EQ(0, resubscribe_count);
+                p_core_state_->ForwardReceivedAck(topics_per_packet.rbegin()->first, ResponseCode::MQTT_SUBSCRIBE_FAILED);
+                EXPECT_EQ(1, resubscribe_count);
+                EXPECT_EQ(ResponseCode::MQTT_SUBSCRIBE_PARTIALLY_FAILED, resubscribe_rc);
+                EXPECT_LE(std::chrono::milliseconds(0), p_core_state_->GetLastResubscribeDuration());
+            }
+
+            // Test the resubscribe waits for queued or sync actions that are being written
+            TEST_F(ConnectDisconnectActionTester, ResubscribeWaitsForPerformActionLock) {
+                AddTestSubscriptions(1);
+                p_core_state_->SetSessionPresent(false);
+                std::atomic_bool is_written(false);
+                EXPECT_CALL(*p_network_mock_, IsConnected()).WillRepeatedly(::testing::Return(true));
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(
+                    ::testing::Invoke([&is_written](const util::String &buf, size_t &size_written_bytes_out) {
+                        size_written_bytes_out = buf.length();
+                        is_written = true;
+                        return ResponseCode::SUCCESS;
+                    }));
+
+                ResubscribeKeepaliveRunner keepalive_runner(p_core_state_);
+                ResponseCode rc = ResponseCode::FAILURE;
+                std::unique_lock<std::mutex> perform_action_lock(p_core_state_->GetPerformActionLock());
+                std::thread resubscribe_thread([&keepalive_runner, &rc, this] {
+                    rc = keepalive_runner.Resubscribe(p_network_connection_);
+                });
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                EXPECT_FALSE(is_written);
+
+                perform_action_lock.unlock();
+                resubscribe_thread.join();
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_TRUE(is_written);
+            }
+
+            TEST_F(ConnectDisconnectActionTester, ResubscribeSkipsAcknowledgedSubscriptionsWhenSessionIsPresent) {
+                util::Vector<std::shared_ptr<mqtt::Subscription>> subscriptions = AddTestSubscriptions(3);
+                p_core_state_->SetSessionPresent(true);
+                int resubscribe_count = 0;
+                p_core_state_->resubscribe_handler_ptr_ = [&resubscribe_count](
+                    util::String mqtt_client_id, std::shared_ptr<ResubscribeCallbackContextData> p_app_handler_data,
+                    ResponseCode resubscribe_result) {
+                    EXPECT_EQ(ResponseCode::SUCCESS, resubscribe_result);
+                    resubscribe_count++;
+                    return ResponseCode::SUCCESS;
+                };
+                EXPECT_EQ(std::chrono::milliseconds(-1), p_core_state_->GetLastResubscribeDuration());
+
+                // Nothing is sent while the server has all subscriptions
+                ResubscribeKeepaliveRunner keepalive_runner(p_core_state_);
+                EXPECT_EQ(ResponseCode::SUCCESS, keepalive_runner.Resubscribe(p_network_connection_));
+                EXPECT_FALSE(p_network_connection_->was_write_called_);
+                EXPECT_EQ(1, resubscribe_count);
+                EXPECT_LE(std::chrono::milliseconds(0), p_core_state_->GetLastResubscribeDuration());
+                for (std::shared_ptr<mqtt::Subscription> &p_subscription : subscriptions) {
+                    EXPECT_TRUE(p_subscription->IsActive());
+                }
+
+                // A subscription whose SUBACK never arrived is sent again
+                subscriptions[1]->SetActive(false);
+                subscriptions[1]->SetAckIndex(test_packet_id_, 1);
+                EXPECT_CALL(*p_network_mock_, IsConnected()).WillRepeatedly(::testing::Return(true));
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(
+                    ::testing::Invoke([](const util::String &buf, size_t &size_written_bytes_out) {
+                        size_written_bytes_out = buf.length();
+                        return ResponseCode::SUCCESS;
+                    }));
+                EXPECT_EQ(ResponseCode::SUCCESS, keepalive_runner.Resubscribe(p_network_connection_));
+                uint16_t packet_id = subscriptions[1]->GetPacketId();
+                EXPECT_NE(test_packet_id_, packet_id);
+                EXPECT_EQ(0, subscriptions[0]->GetPacketId());
+                EXPECT_EQ(0, subscriptions[2]->GetPacketId());
+                p_core_state_->SetSubscriptionActive(packet_id, 1, mqtt::QoS::QOS0);
+                p_core_state_->ForwardReceivedAck(packet_id, ResponseCode::SUCCESS);
+                EXPECT_EQ(2, resubscribe_count);
+                EXPECT_TRUE(subscriptions[1]->IsActive());
+            }
+
             TEST_F(ConnectDisconnectActionTester, ConnectActionTestWithNoClientID) {
                 EXPECT_NE(nullptr, p_network_connection_);
                 EXPECT_NE(nullptr, p_core_state_);
@@ -19,6 +19,15 @@
  *
  */
 
+#include <cstdio>
+#include <cstdlib>
+
+#include <csignal>
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
 #include <gtest/gtest.h>
 
 #include "MockNetworkConnection.hpp"
@@ -28,6 +37,7 @@
 #include "mqtt/ClientState.hpp"
 #include "mqtt/NetworkRead.hpp"
 #include "mqtt/GreengrassMqttClient.hpp"
+#include "mqtt/OfflinePublishStore.hpp"
 
 #define PUBLISH_QOS0_FIXED_HEADER_RETAINED_FALSE_VAL 0x30
 #define PUBLISH_QOS0_FIXED_HEADER_RETAINED_TRUE_VAL 0x31
@@ -67,6 +77,47 @@ namespace awsiotsdk {
             const util::String PublishActionTester::test_payload_ = "Hello From C++ SDK Tester";
             const util::String PublishActionTester::test_topic_ = "testtopic";
 
+            /**
+             * @brief Client state that exposes the outbound queues, used to inspect and send queued publishes
+             */
+            class OutboundQueueTestState : public mqtt::ClientState {
+            public:
+                OutboundQueueTestState() : mqtt::ClientState(std::chrono::milliseconds(200)) {}
+                using ClientCoreState::OutboundAction;
+                using ClientCoreState::PopOutboundAction;
+                using ClientCoreState::DispatchControlActions;
+            };
+
+            /**
+             * @brief Client state that exposes the packet pools, used to check that released packets are reused
+             */
+            class PacketPoolTestState : public mqtt::ClientState {
+            public:
+                PacketPoolTestState() : mqtt::ClientState(std::chrono::milliseconds(200)) {}
+                using ClientState::publish_packet_pool_;
+                using ClientState::puback_packet_pool_;
+            };
+
+            static util::String CreateTestDirectory() {
+                char directory_path[] = "/tmp/offline_publish_store_XXXXXX";
+                EXPECT_NE(nullptr, mkdtemp(directory_path));
+                return util::String(directory_path);
+            }
+
+            static void DeleteTestDirectory(const util::String &directory_path) {
+                DIR *p_dir = opendir(directory_path.c_str());
+                ASSERT_NE(nullptr, p_dir);
+                struct dirent *p_entry;
+                while (nullptr != (p_entry = readdir(p_dir))) {
+                    util::String file_name(p_entry->d_name);
+                    if ("." != file_name && ".." != file_name) {
+                        std::remove((directory_path + "/" + file_name).c_str());
+                    }
+                }
+                closedir(p_dir);
+                rmdir(directory_path.c_str());
+            }
+
             void PublishActionTester::AsyncAckHandler(uint16_t action_id, ResponseCode rc) {
                 EXPECT_EQ(test_packet_id_, action_id);
                 EXPECT_EQ(ResponseCode::SUCCESS, rc);
@@ -229,7 +280,7 @@ namespace awsiotsdk {
 
                 /*** Check for Puback ***/
                 callback_received_ = false;
-                p_core_state_->RegisterPendingAck(test_packet_id_, p_async_ack_handler);
+                // The Ack handler was registered by the Publish action
 
                 p_network_connection_->ClearNextReadBuf();
                 p_network_connection_->SetNextReadBuf(TestHelper::GetSerializedPubAckMessage(test_packet_id_));
@@ -334,7 +385,7 @@ namespace awsiotsdk {
 
                 /*** Check for Puback ***/
                 callback_received_ = false;
-                p_core_state_->RegisterPendingAck(test_packet_id_, p_async_ack_handler);
+                // The Ack handler was registered by the Publish action
 
                 p_network_connection_->ClearNextReadBuf();
                 p_network_connection_->SetNextReadBuf(TestHelper::GetSerializedPubAckMessage(test_packet_id_));
@@ -390,6 +441,294 @@ namespace awsiotsdk {
                 EXPECT_TRUE(callback_received_);
             }
 
+            // Test a queued publish does not register its Ack handler, the Client Core registers it before
+            // performing the action, and the handler of the packet is left as it is
+            TEST_F(PublishActionTester, PublishQueuedActionTest) {
+                EXPECT_NE(nullptr, p_network_connection_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                std::unique_ptr<Action> p_publish_action = mqtt::PublishActionAsync::Create(p_core_state_);
+                std::shared_ptr<mqtt::PublishPacket> p_publish_packet = mqtt::PublishPacket::Create(
+                    Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS1, test_payload_);
+                p_publish_packet->p_async_ack_handler_ = std::bind(&PublishActionTester::AsyncAckHandler,
+                                                                   this,
+                                                                   std::placeholders::_1,
+                                                                   std::placeholders::_2);
+                p_publish_packet->SetPacketId(test_packet_id_);
+
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(
+                    ::testing::DoAll(::testing::SetArgReferee<1>(p_publish_packet->Size()),
+                                     ::testing::Return(ResponseCode::SUCCESS)));
+                ResponseCode rc = p_publish_action->PerformQueuedAction(p_network_connection_, p_publish_packet);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_TRUE(p_network_connection_->was_write_called_);
+                EXPECT_NE(nullptr, p_publish_packet->p_async_ack_handler_);
+                EXPECT_FALSE(p_core_state_->DeletePendingAck(test_packet_id_));
+            }
+
+            TEST_F(PublishActionTester, PublishSharedPayloadTest) {
+                EXPECT_NE(nullptr, p_network_connection_);
+                EXPECT_NE(nullptr, p_core_state_);
+
+                // Moved payload keeps its buffer
+                util::String moved_payload = test_payload_;
+                const char *p_moved_payload_data = moved_payload.data();
+                std::shared_ptr<mqtt::PublishPacket> p_publish_packet = mqtt::PublishPacket::Create(
+                    Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS0, std::move(moved_payload));
+                EXPECT_EQ(test_payload_, p_publish_packet->GetPayload());
+                EXPECT_EQ(p_moved_payload_data, p_publish_packet->GetSharedPayload()->data());
+
+                // Large shared payload is written from the caller's buffer, after the header
+                std::shared_ptr<const util::String> p_payload =
+                    std::make_shared<const util::String>(GATHERED_WRITE_MIN_DIRECT_SEGMENT_BYTES * 2, 'x');
+                p_publish_packet = mqtt::PublishPacket::Create(Utf8String::Create(test_topic_), false, false,
+                                                               mqtt::QoS::QOS0, p_payload);
+                EXPECT_EQ(p_payload, p_publish_packet->GetSharedPayload());
+                EXPECT_EQ(p_payload->length(), p_publish_packet->GetPayloadLen());
+
+                util::Vector<const char *> written_buffers;
+                util::String written_bytes;
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).Times(2).WillRepeatedly(
+                    ::testing::Invoke([&](const util::String &buf, size_t &size_written_bytes_out) {
+                        written_buffers.push_back(buf.data());
+                        written_bytes.append(buf);
+                        size_written_bytes_out = buf.length();
+                        return ResponseCode::SUCCESS;
+                    }));
+
+                std::unique_ptr<Action> p_publish_action = mqtt::PublishActionAsync::Create(p_core_state_);
+                ResponseCode rc = p_publish_action->PerformAction(p_network_connection_, p_publish_packet);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                ASSERT_EQ(2U, written_buffers.size());
+                EXPECT_EQ(p_payload->data(), written_buffers[1]);
+                EXPECT_EQ(p_publish_packet->ToString(), written_bytes);
+            }
+
+            TEST_F(PublishActionTester, PublishSerializeToBufferTest) {
+                std::shared_ptr<mqtt::PublishPacket> p_publish_packet = mqtt::PublishPacket::Create(
+                    Utf8String::Create(test_topic_), true, false, mqtt::QoS::QOS1, test_payload_);
+                p_publish_packet->SetPacketId(test_packet_id_);
+                util::String expected_packet = TestHelper::GetSerializedPublishMessage(test_topic_, test_packet_id_,
+                                                                                       mqtt::QoS::QOS1, false, true,
+                                                                                       test_payload_);
+                ASSERT_EQ(expected_packet.length(), p_publish_packet->Size());
+
+                // Exact size buffer
+                util::Vector<char> buf(expected_packet.length());
+                size_t serialized_length = 0;
+                ResponseCode rc = p_publish_packet->SerializeToBuffer(buf.data(), buf.size(), serialized_length);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_EQ(expected_packet.length(), serialized_length);
+                EXPECT_EQ(expected_packet, util::String(buf.data(), serialized_length));
+
+                // Buffer one byte short is rejected
+                rc = p_publish_packet->SerializeToBuffer(buf.data(), buf.size() - 1, serialized_length);
+                EXPECT_EQ(ResponseCode::FAILURE, rc);
+                EXPECT_EQ(0U, serialized_length);
+
+                // Reused buffer keeps its capacity across packets
+                util::String packet_buffer;
+                p_publish_packet->SerializeToBuffer(packet_buffer);
+                EXPECT_EQ(expected_packet, packet_buffer);
+                const char *p_packet_buffer_data = packet_buffer.data();
+                std::shared_ptr<mqtt::PubackPacket> p_puback_packet = mqtt::PubackPacket::Create(test_packet_id_);
+                p_puback_packet->SerializeToBuffer(packet_buffer);
+                EXPECT_EQ(TestHelper::GetSerializedPubAckMessage(test_packet_id_), packet_buffer);
+                EXPECT_EQ(p_packet_buffer_data, packet_buffer.data());
+            }
+
+            TEST_F(PublishActionTester, PacketPoolTest) {
+                std::shared_ptr<PacketPoolTestState> p_state = std::make_shared<PacketPoolTestState>();
+
+                // Puback packets are reused once they have been released
+                std::shared_ptr<mqtt::PubackPacket> p_puback_packet = p_state->AcquirePubackPacket(1);
+                mqtt::PubackPacket *p_first_puback_packet = p_puback_packet.get();
+                std::shared_ptr<mqtt::PubackPacket> p_held_puback_packet = p_state->AcquirePubackPacket(2);
+                EXPECT_NE(p_first_puback_packet, p_held_puback_packet.get());
+                p_puback_packet.reset();
+
+                EXPECT_EQ(2U, p_state->puback_packet_pool_.GetPooledCount());
+                p_puback_packet = p_state->AcquirePubackPacket(test_packet_id_);
+                // Nothing new was created, the pool holds the other reference
+                EXPECT_EQ(2U, p_state->puback_packet_pool_.GetPooledCount());
+                EXPECT_EQ(p_first_puback_packet, p_puback_packet.get());
+                EXPECT_EQ(2, p_puback_packet.use_count());
+                EXPECT_EQ(test_packet_id_, p_puback_packet->GetPublishPacketId());
+                EXPECT_EQ(TestHelper::GetSerializedPubAckMessage(test_packet_id_), p_puback_packet->ToString());
+
+                // Publish packets are reused with their payload buffer
+                std::shared_ptr<mqtt::PublishPacket> p_publish_packet = p_state->AcquirePublishPacket(
+                    Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS1, test_payload_);
+                p_publish_packet->SetPacketId(test_packet_id_);
+                p_publish_packet->p_async_ack_handler_ = [](uint16_t, ResponseCode) {};
+                mqtt::PublishPacket *p_first_publish_packet = p_publish_packet.get();
+                const char *p_first_payload_data = p_publish_packet->GetSharedPayload()->data();
+                p_publish_packet.reset();
+
+                std::unique_ptr<Utf8String> p_topic_name = Utf8String::Create(test_topic_);
+                util::String payload = "Hello From Pool";
+                p_publish_packet = p_state->AcquirePublishPacket(std::move(p_topic_name), true, false,
+                                                                 mqtt::QoS::QOS1, payload);
+                EXPECT_EQ(1U, p_state->publish_packet_pool_.GetPooledCount());
+                EXPECT_EQ(p_first_publish_packet, p_publish_packet.get());
+                EXPECT_EQ(2, p_publish_packet.use_count());
+                EXPECT_EQ(p_first_payload_data, p_publish_packet->GetSharedPayload()->data());
+                EXPECT_EQ(0, p_publish_packet->GetPacketId());
+                EXPECT_EQ(nullptr, p_publish_packet->p_async_ack_handler_);
+                EXPECT_EQ(TestHelper::GetSerializedPublishMessage(test_topic_, 0, mqtt::QoS::QOS1, false, true,
+                                                                  payload),
+                          p_publish_packet->ToString());
+
+                // Payload buffer is not reused while the caller still holds it
+                std::shared_ptr<const util::String> p_held_payload = p_publish_packet->GetSharedPayload();
+                p_publish_packet.reset();
+                p_publish_packet = p_state->AcquirePublishPacket(Utf8String::Create(test_topic_), false, false,
+                                                                 mqtt::QoS::QOS0, test_payload_);
+                EXPECT_EQ(p_first_publish_packet, p_publish_packet.get());
+                EXPECT_EQ(payload, *p_held_payload);
+                EXPECT_EQ(test_payload_, p_publish_packet->GetPayload());
+            }
+
+            TEST_F(PublishActionTester, InflightPublishWindowTest) {
+                EXPECT_NE(nullptr, p_network_connection_);
+
+                std::shared_ptr<OutboundQueueTestState> p_state = std::make_shared<OutboundQueueTestState>();
+                p_state->RegisterAction(ActionType::PUBLISH, mqtt::PublishActionAsync::Create, p_state);
+                std::unique_ptr<Action> p_publish_action = mqtt::PublishActionAsync::Create(p_state);
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_state);
+
+                util::Vector<ResponseCode> ack_results;
+                util::Vector<std::shared_ptr<mqtt::PublishPacket>> publish_packets;
+                for (uint16_t packet_id = test_packet_id_; packet_id < test_packet_id_ + 3; packet_id++) {
+                    std::shared_ptr<mqtt::PublishPacket> p_publish_packet = mqtt::PublishPacket::Create(
+                        Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS1, test_payload_);
+                    p_publish_packet->SetPacketId(packet_id);
+                    publish_packets.push_back(p_publish_packet);
+                }
+
+                /*** Window is full after two publishes ***/
+                p_state->SetMaxInflightPublishes(2);
+                EXPECT_EQ(2U, p_state->GetMaxInflightPublishes());
+                EXPECT_EQ(ResponseCode::SUCCESS, p_state->AddInflightPublish(publish_packets[0]));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_state->AddInflightPublish(publish_packets[1]));
+                EXPECT_EQ(ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR,
+                          p_state->AddInflightPublish(publish_packets[2]));
+                EXPECT_EQ(2U, p_state->GetInflightPublishCount());
+
+                /*** Only the first publish is sent before the connection drops ***/
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(
+                    ::testing::DoAll(::testing::SetArgReferee<1>(publish_packets[0]->Size()),
+                                     ::testing::Return(ResponseCode::SUCCESS)));
+                ResponseCode rc = p_publish_action->PerformAction(p_network_connection_, publish_packets[0]);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                /*** A sent publish outlives its Ack timeout while the client is disconnected ***/
+                p_state->SetConnected(false);
+                EXPECT_TRUE(p_state->KeepInflightPublish(test_packet_id_, ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR));
+                EXPECT_FALSE(p_state->KeepInflightPublish(test_packet_id_ + 1,
+                                                          ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR));
+                EXPECT_FALSE(p_state->KeepInflightPublish(test_packet_id_, ResponseCode::SUCCESS));
+                publish_packets[0]->p_async_ack_handler_ = [&ack_results](uint16_t packet_id, ResponseCode ack_rc) {
+                    ack_results.push_back(ack_rc);
+                };
+
+                /*** Reconnect with session present queues the sent publish with the duplicate flag ***/
+                p_network_connection_->last_write_buf_.clear();
+                p_network_connection_->was_write_called_ = false;
+                p_network_connection_->ClearNextReadBuf();
+                p_network_connection_->SetNextReadBuf(
+                    TestHelper::GetSerializedConnAckMessage(true, ConnackTestReturnCode::CONNECTION_ACCEPTED));
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_TRUE(p_state->IsConnected());
+                // Nothing is written from the read thread
+                EXPECT_FALSE(p_network_connection_->was_write_called_);
+
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_)).WillOnce(
+                    ::testing::DoAll(::testing::SetArgReferee<1>(publish_packets[0]->Size()),
+                                     ::testing::Return(ResponseCode::SUCCESS)));
+                EXPECT_EQ(1U, p_state->DispatchControlActions(p_network_connection_));
+                EXPECT_TRUE(p_network_connection_->was_write_called_);
+
+                unsigned char *p_last_msg = (unsigned char *) (p_network_connection_->last_write_buf_.c_str());
+                EXPECT_EQ(PUBLISH_QOS1_FIXED_HEADER_DUP_TRUE_RETAINED_FALSE_VAL, (int) p_last_msg[0]);
+                p_last_msg++;
+                TestHelper::ParseRemLenFromBuffer(&p_last_msg);
+                std::unique_ptr<Utf8String> written_topic_name = TestHelper::ReadUtf8StringFromBuffer(&p_last_msg);
+                EXPECT_EQ(test_topic_, written_topic_name->ToStdString());
+                EXPECT_EQ(test_packet_id_, TestHelper::ReadUint16FromBuffer(&p_last_msg));
+
+                /*** The resent publish waits for its Ack again, a timeout on a working connection is reported ***/
+                EXPECT_FALSE(p_state->KeepInflightPublish(test_packet_id_, ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR));
+                p_state->ForwardReceivedAck(test_packet_id_, ResponseCode::SUCCESS);
+                ASSERT_EQ(1U, ack_results.size());
+                EXPECT_EQ(ResponseCode::SUCCESS, ack_results[0]);
+
+                /*** Acknowledged publishes free their slot ***/
+                p_state->RemoveInflightPublish(test_packet_id_);
+                EXPECT_EQ(1U, p_state->GetInflightPublishCount());
+                EXPECT_EQ(ResponseCode::SUCCESS, p_state->AddInflightPublish(publish_packets[2]));
+                /*** PublishAsync is rejected while the window is full ***/
+                std::shared_ptr<GreengrassMqttClient> p_iot_greengrass_client =
+                    std::shared_ptr<GreengrassMqttClient>(GreengrassMqttClient::Create(p_network_connection_,
+                                                                                       std::chrono::milliseconds(2000)));
+                EXPECT_NE(nullptr, p_iot_greengrass_client);
+                p_iot_greengrass_client->SetMaxInflightPublishes(1);
+
+                uint16_t packet_id_out = 0;
+                rc = p_iot_greengrass_client->PublishAsync(Utf8String::Create(test_topic_), false, false,
+                                                           mqtt::QoS::QOS1, test_payload_, nullptr, packet_id_out);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                rc = p_iot_greengrass_client->PublishAsync(Utf8String::Create(test_topic_), false, false,
+                                                           mqtt::QoS::QOS1, test_payload_, nullptr, packet_id_out);
+                EXPECT_EQ(ResponseCode::MQTT_INFLIGHT_WINDOW_FULL_ERROR, rc);
+                rc = p_iot_greengrass_client->PublishAsync(Utf8String::Create(test_topic_), false, false,
+                                                           mqtt::QoS::QOS0, test_payload_, nullptr, packet_id_out);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_EQ(1U, p_iot_greengrass_client->GetInflightPublishCount());
+            }
+
+            TEST_F(PublishActionTester, InflightResendLargerThanControlQueueTest) {
+                EXPECT_NE(nullptr, p_network_connection_);
+
+                std::shared_ptr<OutboundQueueTestState> p_state = std::make_shared<OutboundQueueTestState>();
+                p_state->RegisterAction(ActionType::PUBLISH, mqtt::PublishActionAsync::Create, p_state);
+
+                /*** The window holds more sent publishes than fit in the control queue ***/
+                const uint16_t publish_count = DEFAULT_CONTROL_ACTION_QUEUE_SIZE + 10;
+                p_state->SetMaxInflightPublishes(publish_count);
+                std::shared_ptr<mqtt::PublishPacket> p_last_publish_packet;
+                for (uint16_t packet_id = 1; packet_id <= publish_count; packet_id++) {
+                    std::shared_ptr<mqtt::PublishPacket> p_publish_packet = mqtt::PublishPacket::Create(
+                        Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS1, test_payload_);
+                    p_publish_packet->SetPacketId(packet_id);
+                    EXPECT_EQ(ResponseCode::SUCCESS, p_state->AddInflightPublish(p_publish_packet));
+                    p_state->SetInflightPublishSent(packet_id);
+                    p_last_publish_packet = p_publish_packet;
+                }
+
+                /*** All of them are sent again after a reconnect, queueing twice does not send them twice ***/
+                p_state->SetConnected(false);
+                p_state->ResendInflightPublishes();
+                p_state->ResendInflightPublishes();
+                p_state->SetConnected(true);
+                EXPECT_CALL(*p_network_mock_, WriteInternalProxy(::testing::_, ::testing::_))
+                    .Times(publish_count)
+                    .WillRepeatedly(::testing::DoAll(::testing::SetArgReferee<1>(p_last_publish_packet->Size()),
+                                                     ::testing::Return(ResponseCode::SUCCESS)));
+                EXPECT_EQ(static_cast<size_t>(publish_count), p_state->DispatchControlActions(p_network_connection_));
+                EXPECT_EQ(0U, p_state->DispatchControlActions(p_network_connection_));
+
+                // The last publish was written last with the duplicate flag cleared, the session was not present
+                unsigned char *p_last_msg = (unsigned char *) (p_network_connection_->last_write_buf_.c_str());
+                EXPECT_EQ(PUBLISH_QOS1_FIXED_HEADER_DUP_FALSE_RETAINED_FALSE_VAL, (int) p_last_msg[0]);
+                p_last_msg++;
+                TestHelper::ParseRemLenFromBuffer(&p_last_msg);
+                TestHelper::ReadUtf8StringFromBuffer(&p_last_msg);
+                EXPECT_EQ(publish_count, TestHelper::ReadUint16FromBuffer(&p_last_msg));
+                EXPECT_EQ(static_cast<size_t>(publish_count), p_state->GetInflightPublishCount());
+            }
+
             TEST_F(PublishActionTester, ClientPublishErrorTest) {
                 EXPECT_NE(nullptr, p_network_connection_);
                 EXPECT_NE(nullptr, p_core_state_);
@@ -409,6 +748,184 @@ namespace awsiotsdk {
                                                            nullptr, packet_id_out);
                 EXPECT_EQ(ResponseCode::MQTT_INVALID_DATA_ERROR, rc);
             }
+        
+            TEST_F(PublishActionTester, OfflinePublishStoreTest) {
+                util::String directory_path = CreateTestDirectory();
+                util::String payload(1000, 'x');
+
+                EXPECT_EQ(nullptr, mqtt::OfflinePublishStore::Create(directory_path + "/missing", 4096, 2,
+                                                                     mqtt::OfflineStoreOverflowPolicy::REJECT_NEW));
+                std::unique_ptr<mqtt::OfflinePublishStore> p_store = mqtt::OfflinePublishStore::Create(
+                    directory_path, 4096, 2, mqtt::OfflineStoreOverflowPolicy::REJECT_NEW);
+                ASSERT_NE(nullptr, p_store);
+                EXPECT_FALSE(p_store->HasUnsentRecords());
+
+                /*** Three records fit in a segment, the store is full after two segments ***/
+                uint64_t record_ids[6];
+                for (size_t i = 0; i < 6; i++) {
+                    util::String topic_name = test_topic_ + std::to_string(i);
+                    EXPECT_EQ(ResponseCode::SUCCESS, p_store->Append(topic_name, payload, 0 == i, record_ids[i]));
+                }
+                uint64_t record_id = 0;
+                EXPECT_EQ(ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR,
+                          p_store->Append(test_topic_, payload, false, record_id));
+                EXPECT_EQ(ResponseCode::MQTT_INVALID_DATA_ERROR,
+                          p_store->Append(test_topic_, util::String(4096, 'x'), false, record_id));
+                EXPECT_EQ(2U, p_store->GetSegmentCount());
+                EXPECT_EQ(6U, p_store->GetPendingRecordCount());
+
+                mqtt::OfflinePublishStore::Record record;
+                ASSERT_TRUE(p_store->GetNextRecord(record));
+                EXPECT_EQ(record_ids[0], record.record_id_);
+                EXPECT_EQ(test_topic_ + "0", record.topic_name_);
+                EXPECT_EQ(payload, *record.p_payload_);
+                EXPECT_TRUE(record.is_retained_);
+                p_store->AcknowledgeRecord(record.record_id_);
+                EXPECT_EQ(ResponseCode::SUCCESS, p_store->Flush());
+
+                /*** Records that were not acknowledged are loaded again after a restart ***/
+                p_store = nullptr;
+                p_store = mqtt::OfflinePublishStore::Create(directory_path, 4096, 2,
+                                                            mqtt::OfflineStoreOverflowPolicy::DROP_OLDEST);
+                ASSERT_NE(nullptr, p_store);
+                EXPECT_EQ(5U, p_store->GetPendingRecordCount());
+                ASSERT_TRUE(p_store->GetNextRecord(record));
+                EXPECT_EQ(record_ids[1], record.record_id_);
+                EXPECT_EQ(test_topic_ + "1", record.topic_name_);
+                EXPECT_FALSE(record.is_retained_);
+
+                /*** Released records are handed out again before newer ones ***/
+                p_store->ReleaseRecord(record.record_id_);
+                ASSERT_TRUE(p_store->GetNextRecord(record));
+                EXPECT_EQ(record_ids[1], record.record_id_);
+                p_store->AcknowledgeRecord(record.record_id_);
+                ASSERT_TRUE(p_store->GetNextRecord(record));
+                EXPECT_EQ(record_ids[2], record.record_id_);
+
+                /*** Segments are deleted once all their records are acknowledged ***/
+                p_store->AcknowledgeRecord(record.record_id_);
+                EXPECT_EQ(1U, p_store->GetSegmentCount());
+                EXPECT_EQ(3U, p_store->GetPendingRecordCount());
+
+                /*** The oldest segment is dropped when full with DROP_OLDEST ***/
+                for (size_t i = 0; i < 4; i++) {
+                    EXPECT_EQ(ResponseCode::SUCCESS, p_store->Append(test_topic_, payload, false, record_id));
+                }
+                EXPECT_EQ(2U, p_store->GetSegmentCount());
+                EXPECT_EQ(4U, p_store->GetPendingRecordCount());
+                ASSERT_TRUE(p_store->GetNextRecord(record));
+                EXPECT_NE(record_ids[3], record.record_id_);
+
+                p_store = nullptr;
+                DeleteTestDirectory(directory_path);
+            }
+
+            TEST_F(PublishActionTester, OfflinePublishStoreDiskFullTest) {
+                util::String directory_path = CreateTestDirectory();
+                std::unique_ptr<mqtt::OfflinePublishStore> p_store = mqtt::OfflinePublishStore::Create(
+                    directory_path, 65536, 2, mqtt::OfflineStoreOverflowPolicy::REJECT_NEW);
+                ASSERT_NE(nullptr, p_store);
+
+                /*** A segment that cannot be allocated is not mapped, Append fails instead of faulting ***/
+                struct rlimit previous_limit;
+                ASSERT_EQ(0, getrlimit(RLIMIT_FSIZE, &previous_limit));
+                struct rlimit file_size_limit = previous_limit;
+                file_size_limit.rlim_cur = 4096;
+                void (*p_previous_handler)(int) = signal(SIGXFSZ, SIG_IGN);
+                ASSERT_EQ(0, setrlimit(RLIMIT_FSIZE, &file_size_limit));
+                uint64_t record_id = 0;
+                ResponseCode rc = p_store->Append(test_topic_, test_payload_, false, record_id);
+                setrlimit(RLIMIT_FSIZE, &previous_limit);
+                signal(SIGXFSZ, p_previous_handler);
+
+                EXPECT_EQ(ResponseCode::MQTT_OFFLINE_STORE_FULL_ERROR, rc);
+                EXPECT_EQ(0U, p_store->GetSegmentCount());
+                EXPECT_EQ(0U, p_store->GetPendingRecordCount());
+
+                /*** The failed segment file is removed, so the store still opens after a restart ***/
+                p_store = nullptr;
+                p_store = mqtt::OfflinePublishStore::Create(directory_path, 65536, 2,
+                                                            mqtt::OfflineStoreOverflowPolicy::REJECT_NEW);
+                ASSERT_NE(nullptr, p_store);
+                EXPECT_EQ(ResponseCode::SUCCESS, p_store->Append(test_topic_, test_payload_, false, record_id));
+                EXPECT_EQ(1U, p_store->GetSegmentCount());
+
+                p_store = nullptr;
+                DeleteTestDirectory(directory_path);
+            }
+
+            TEST_F(PublishActionTester, OfflinePublishDrainTest) {
+                util::String directory_path = CreateTestDirectory();
+                std::shared_ptr<mqtt::OfflinePublishStore> p_store = mqtt::OfflinePublishStore::Create(
+                    directory_path, DEFAULT_OFFLINE_STORE_SEGMENT_SIZE_BYTES, DEFAULT_OFFLINE_STORE_MAX_SEGMENT_COUNT,
+                    mqtt::OfflineStoreOverflowPolicy::REJECT_NEW);
+                ASSERT_NE(nullptr, p_store);
+
+                std::shared_ptr<OutboundQueueTestState> p_state = std::make_shared<OutboundQueueTestState>();
+                p_state->SetOfflinePublishStore(p_store);
+                p_state->SetOfflinePublishDrainRate(2);
+
+                /*** QoS1 publishes are stored while disconnected ***/
+                uint16_t acked_packet_id = 0;
+                size_t ack_count = 0;
+                for (size_t i = 0; i < 3; i++) {
+                    std::shared_ptr<mqtt::PublishPacket> p_publish_packet = mqtt::PublishPacket::Create(
+                        Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS1, test_payload_);
+                    uint16_t packet_id_out = 10;
+                    ResponseCode rc = p_state->EnqueuePublish(
+                        p_publish_packet, [&acked_packet_id, &ack_count](uint16_t packet_id, ResponseCode ack_rc) {
+                            EXPECT_EQ(ResponseCode::SUCCESS, ack_rc);
+                            acked_packet_id = packet_id;
+                            ack_count++;
+                        }, packet_id_out);
+                    EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                    EXPECT_EQ(0, packet_id_out);
+                }
+                EXPECT_EQ(3U, p_store->GetPendingRecordCount());
+                p_state->DrainOfflinePublishes();
+                EXPECT_EQ(0U, p_state->GetInflightPublishCount());
+
+                /*** Stored publishes are queued at the drain rate once connected ***/
+                p_state->SetConnected(true);
+                p_state->DrainOfflinePublishes();
+                EXPECT_EQ(2U, p_state->GetInflightPublishCount());
+                EXPECT_TRUE(p_store->HasUnsentRecords());
+
+                OutboundQueueTestState::OutboundAction action;
+                ASSERT_TRUE(p_state->PopOutboundAction(action));
+                std::shared_ptr<mqtt::PublishPacket> p_publish_packet =
+                    std::dynamic_pointer_cast<mqtt::PublishPacket>(action.second);
+                ASSERT_NE(nullptr, p_publish_packet);
+                EXPECT_EQ(test_topic_, p_publish_packet->GetTopicName());
+                EXPECT_EQ(test_payload_, *p_publish_packet->GetSharedPayload());
+
+                /*** Acknowledged publishes are removed from the store, failed ones are sent again ***/
+                p_publish_packet->p_async_ack_handler_(p_publish_packet->GetPacketId(), ResponseCode::SUCCESS);
+                EXPECT_EQ(1U, ack_count);
+                EXPECT_EQ(p_publish_packet->GetPacketId(), acked_packet_id);
+                EXPECT_EQ(2U, p_store->GetPendingRecordCount());
+
+                ASSERT_TRUE(p_state->PopOutboundAction(action));
+                p_publish_packet = std::dynamic_pointer_cast<mqtt::PublishPacket>(action.second);
+                ASSERT_NE(nullptr, p_publish_packet);
+                p_publish_packet->p_async_ack_handler_(p_publish_packet->GetPacketId(),
+                                                       ResponseCode::MQTT_REQUEST_TIMEOUT_ERROR);
+                EXPECT_EQ(1U, ack_count);
+                EXPECT_EQ(2U, p_store->GetPendingRecordCount());
+                EXPECT_EQ(0U, p_state->GetInflightPublishCount());
+
+                /*** New publishes are stored until earlier stored ones have been sent ***/
+                std::shared_ptr<mqtt::PublishPacket> p_new_publish_packet = mqtt::PublishPacket::Create(
+                    Utf8String::Create(test_topic_), false, false, mqtt::QoS::QOS1, test_payload_);
+                uint16_t packet_id_out = 10;
+                EXPECT_EQ(ResponseCode::SUCCESS, p_state->EnqueuePublish(p_new_publish_packet, nullptr, packet_id_out));
+                EXPECT_EQ(0, packet_id_out);
+                EXPECT_EQ(3U, p_store->GetPendingRecordCount());
+
+                p_state = nullptr;
+                p_store = nullptr;
+                DeleteTestDirectory(directory_path);
+            }
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,229 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file ReconnectBackoffTests.cpp
+ * @brief
+ *
+ */
+
+#include <chrono>
+#include <functional>
+#include <queue>
+#include <set>
+
+#include <gtest/gtest.h>
+
+#include "util/memory/stl/Map.hpp"
+#include "util/memory/stl/Vector.hpp"
+
+#include "mqtt/ReconnectBackoff.hpp"
+
+#define SIMULATED_CLIENT_COUNT 1000
+#define SIMULATED_BROKER_WINDOW_MS 100
+#define SIMULATED_BROKER_CONNECTS_PER_WINDOW 10
+
+namespace awsiotsdk {
+    namespace tests {
+        namespace unit {
+            class ReconnectBackoffTester : public ::testing::Test {
+            protected:
+                /**
+                 * @brief Broker accepting a limited number of connects per time window and throttling the rest
+                 */
+                class MockBroker {
+                protected:
+                    util::Map<int64_t, size_t> attempt_counts_;   ///< Connect attempts per window
+                    util::Map<int64_t, size_t> accepted_counts_;  ///< Accepted connects per window
+
+                public:
+                    bool TryConnect(std::chrono::milliseconds attempt_time) {
+                        int64_t window = attempt_time.count() / SIMULATED_BROKER_WINDOW_MS;
+                        attempt_counts_[window]++;
+                        if (SIMULATED_BROKER_CONNECTS_PER_WINDOW <= accepted_counts_[window]) {
+                            return false;
+                        }
+                        accepted_counts_[window]++;
+                        return true;
+                    }
+
+                    size_t GetPeakAttemptsPerWindow() {
+                        size_t peak_attempt_count = 0;
+                        for (auto &itr : attempt_counts_) {
+                            peak_attempt_count = std::max(peak_attempt_count, itr.second);
+                        }
+                        return peak_attempt_count;
+                    }
+                };
+
+                typedef std::pair<std::chrono::milliseconds, size_t> AttemptEntry;
+
+                /**
+                 * @brief Simulate all clients losing their connection at time zero, in virtual time
+                 *
+                 * @param create_strategy - Creates the strategy of the client with the given index
+                 * @param broker - Broker the clients reconnect to
+                 * @param histogram - Histogram the reconnect times are counted in
+                 */
+                static void SimulateMassDisconnect(
+                    std::function<std::shared_ptr<mqtt::ReconnectBackoffStrategy>(size_t)> create_strategy,
+                    MockBroker &broker, mqtt::ReconnectTimeHistogram &histogram) {
+                    util::Vector<std::shared_ptr<mqtt::ReconnectBackoffStrategy>> strategies;
+                    std::priority_queue<AttemptEntry, util::Vector<AttemptEntry>, std::greater<AttemptEntry>> attempts;
+                    for (size_t client_index = 0; SIMULATED_CLIENT_COUNT > client_index; client_index++) {
+                        strategies.push_back(create_strategy(client_index));
+                        strategies.back()->Reset(std::chrono::seconds(1), std::chrono::seconds(128));
+                        attempts.push(AttemptEntry(strategies.back()->GetNextBackoff(), client_index));
+                    }
+
+                    while (!attempts.empty()) {
+                        AttemptEntry attempt = attempts.top();
+                        attempts.pop();
+                        if (broker.TryConnect(attempt.first)) {
+                            histogram.Record(attempt.first);
+                        } else {
+                            attempts.push(AttemptEntry(attempt.first + strategies[attempt.second]->GetNextBackoff(),
+                                                       attempt.second));
+                        }
+                    }
+                }
+            };
+
+            TEST_F(ReconnectBackoffTester, ExponentialBackoffMatchesEarlierVersions) {
+                std::shared_ptr<mqtt::ExponentialBackoffStrategy>
+                    p_strategy = mqtt::ExponentialBackoffStrategy::Create();
+                p_strategy->Reset(std::chrono::seconds(1), std::chrono::seconds(8));
+                EXPECT_EQ(std::chrono::milliseconds(0), p_strategy->GetNextBackoff());
+                EXPECT_EQ(std::chrono::milliseconds(2000), p_strategy->GetNextBackoff());
+                EXPECT_EQ(std::chrono::milliseconds(4000), p_strategy->GetNextBackoff());
+                EXPECT_EQ(std::chrono::milliseconds(8000), p_strategy->GetNextBackoff());
+                EXPECT_EQ(std::chrono::milliseconds(8000), p_strategy->GetNextBackoff());
+
+                p_strategy->Reset(std::chrono::seconds(1), std::chrono::seconds(8));
+                EXPECT_EQ(std::chrono::milliseconds(0), p_strategy->GetNextBackoff());
+            }
+
+            TEST_F(ReconnectBackoffTester, JitteredBackoffStaysInBounds) {
+                std::set<std::chrono::milliseconds::rep> first_backoffs;
+                for (uint32_t seed = 0; 100 > seed; seed++) {
+                    std::shared_ptr<mqtt::FullJitterBackoffStrategy>
+                        p_full_jitter = mqtt::FullJitterBackoffStrategy::Create(seed);
+                    p_full_jitter->Reset(std::chrono::seconds(1), std::chrono::seconds(8));
+                    std::chrono::milliseconds ceiling = std::chrono::seconds(1);
+                    for (int attempt = 0; 10 > attempt; attempt++) {
+                        std::chrono::milliseconds backoff = p_full_jitter->GetNextBackoff();
+                        if (0 == attempt) {
+                            first_backoffs.insert(backoff.count());
+                        }
+                        EXPECT_LE(std::chrono::milliseconds(0), backoff);
+                        EXPECT_GE(ceiling, backoff);
+                        ceiling = std::min(ceiling * 2, std::chrono::milliseconds(std::chrono::seconds(8)));
+                    }
+
+                    std::shared_ptr<mqtt::DecorrelatedJitterBackoffStrategy>
+                        p_decorrelated_jitter = mqtt::DecorrelatedJitterBackoffStrategy::Create(seed);
+                    p_decorrelated_jitter->Reset(std::chrono::seconds(1), std::chrono::seconds(8));
+                    std::chrono::milliseconds last_backoff = std::chrono::seconds(1);
+                    for (int attempt = 0; 10 > attempt; attempt++) {
+                        std::chrono::milliseconds backoff = p_decorrelated_jitter->GetNextBackoff();
+                        EXPECT_LE(std::chrono::milliseconds(std::chrono::seconds(1)), backoff);
+                        EXPECT_GE(std::min(last_backoff * 3, std::chrono::milliseconds(std::chrono::seconds(8))),
+                                  backoff);
+                        last_backoff = backoff;
+                    }
+                }
+                // Clients seeded differently do not attempt together
+                EXPECT_LT(50U, first_backoffs.size());
+            }
+
+            TEST_F(ReconnectBackoffTester, FixedScheduleRepeatsLastBackoff) {
+                EXPECT_EQ(nullptr, mqtt::FixedScheduleBackoffStrategy::Create(
+                    util::Vector<std::chrono::milliseconds>()));
+
+                util::Vector<std::chrono::milliseconds> schedule;
+                schedule.push_back(std::chrono::milliseconds(100));
+                schedule.push_back(std::chrono::milliseconds(300));
+                std::shared_ptr<mqtt::FixedScheduleBackoffStrategy>
+                    p_strategy = mqtt::FixedScheduleBackoffStrategy::Create(schedule);
+                ASSERT_NE(nullptr, p_strategy);
+                p_strategy->Reset(std::chrono::seconds(1), std::chrono::seconds(128));
+                EXPECT_EQ(std::chrono::milliseconds(100), p_strategy->GetNextBackoff());
+                EXPECT_EQ(std::chrono::milliseconds(300), p_strategy->GetNextBackoff());
+                EXPECT_EQ(std::chrono::milliseconds(300), p_strategy->GetNextBackoff());
+                p_strategy->Reset(std::chrono::seconds(1), std::chrono::seconds(128));
+                EXPECT_EQ(std::chrono::milliseconds(100), p_strategy->GetNextBackoff());
+            }
+
+            TEST_F(ReconnectBackoffTester, HistogramCountsReconnectTimes) {
+                mqtt::ReconnectTimeHistogram histogram;
+                EXPECT_EQ(std::chrono::milliseconds(0), histogram.GetPercentile(50));
+                EXPECT_EQ(std::chrono::milliseconds::max(),
+                          mqtt::ReconnectTimeHistogram::GetBucketUpperBound(RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT - 1));
+
+                histogram.Record(std::chrono::milliseconds(50));
+                histogram.Record(std::chrono::milliseconds(150));
+                histogram.Record(std::chrono::milliseconds(150));
+                histogram.Record(std::chrono::milliseconds(1000));
+                EXPECT_EQ(4U, histogram.GetCount());
+                EXPECT_EQ(1U, histogram.GetBucketCount(0));
+                EXPECT_EQ(2U, histogram.GetBucketCount(1));
+                EXPECT_EQ(1U, histogram.GetBucketCount(4));
+                EXPECT_EQ(0U, histogram.GetBucketCount(RECONNECT_TIME_HISTOGRAM_BUCKET_COUNT));
+                EXPECT_EQ(std::chrono::milliseconds(200), histogram.GetPercentile(50));
+                EXPECT_EQ(std::chrono::milliseconds(1000), histogram.GetPercentile(100));
+                EXPECT_EQ(std::chrono::milliseconds(1000), histogram.GetMax());
+
+                histogram.Reset();
+                EXPECT_EQ(0U, histogram.GetCount());
+                EXPECT_EQ(std::chrono::milliseconds(0), histogram.GetMax());
+            }
+
+            TEST_F(ReconnectBackoffTester, JitterSpreadsReconnectsAfterMassDisconnect) {
+                MockBroker lockstep_broker;
+                mqtt::ReconnectTimeHistogram lockstep_histogram;
+                SimulateMassDisconnect([](size_t client_index) {
+                    return mqtt::ExponentialBackoffStrategy::Create();
+                }, lockstep_broker, lockstep_histogram);
+
+                MockBroker full_jitter_broker;
+                mqtt::ReconnectTimeHistogram full_jitter_histogram;
+                SimulateMassDisconnect([](size_t client_index) {
+                    return mqtt::FullJitterBackoffStrategy::Create(static_cast<uint32_t>(client_index));
+                }, full_jitter_broker, full_jitter_histogram);
+
+                MockBroker decorrelated_jitter_broker;
+                mqtt::ReconnectTimeHistogram decorrelated_jitter_histogram;
+                SimulateMassDisconnect([](size_t client_index) {
+                    return mqtt::DecorrelatedJitterBackoffStrategy::Create(static_cast<uint32_t>(client_index));
+                }, decorrelated_jitter_broker, decorrelated_jitter_histogram);
+
+                // Every client reconnects in the end
+                EXPECT_EQ(static_cast<uint64_t>(SIMULATED_CLIENT_COUNT), lockstep_histogram.GetCount());
+                EXPECT_EQ(static_cast<uint64_t>(SIMULATED_CLIENT_COUNT), full_jitter_histogram.GetCount());
+                EXPECT_EQ(static_cast<uint64_t>(SIMULATED_CLIENT_COUNT), decorrelated_jitter_histogram.GetCount());
+
+                // Without jitter each wave of attempts reaches the broker at once
+                EXPECT_EQ(static_cast<size_t>(SIMULATED_CLIENT_COUNT), lockstep_broker.GetPeakAttemptsPerWindow());
+                EXPECT_GT(static_cast<size_t>(SIMULATED_CLIENT_COUNT / 5), full_jitter_broker.GetPeakAttemptsPerWindow());
+                EXPECT_GT(static_cast<size_t>(SIMULATED_CLIENT_COUNT / 5),
+                          decorrelated_jitter_broker.GetPeakAttemptsPerWindow());
+
+                // Spread attempts are accepted instead of throttled, so the fleet is back much sooner
+                EXPECT_GT(lockstep_histogram.GetPercentile(99), full_jitter_histogram.GetPercentile(99) * 4);
+                EXPECT_GT(lockstep_histogram.GetPercentile(99), decorrelated_jitter_histogram.GetPercentile(99) * 4);
+            }
+        }
+    }
+}
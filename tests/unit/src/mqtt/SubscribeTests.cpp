@@ -20,6 +20,7 @@
  */
 
 #include <atomic>
+#include <thread>
 #include <gtest/gtest.h>
 
 #include "MockNetworkConnection.hpp"
@@ -613,6 +614,181 @@ namespace awsiotsdk {
                 } while (msg_count < 50);
             }
 
+            TEST_F(SubUnsubActionTester, IncomingPacketsReadInBulkTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                p_network_connection_->ClearNextReadBuf();
+                std::atomic_int callback_count(0);
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    [this, &callback_count](util::String topic_name, util::String payload,
+                                            std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        EXPECT_EQ(test_topic_base_, topic_name);
+                        EXPECT_EQ(test_payload_, payload);
+                        callback_count++;
+                        return ResponseCode::SUCCESS;
+                    };
+
+                std::shared_ptr<mqtt::Subscription> p_subscription =
+                    mqtt::Subscription::Create(Utf8String::Create(test_topic_base_), mqtt::QoS::QOS0, p_app_handler,
+                                               nullptr);
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                topic_vector.push_back(p_subscription);
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+
+                // Suback and two publish messages arrive together, all are decoded from one network read
+                std::vector<uint8_t> suback_list;
+                suback_list.push_back(0);
+                util::String publish_packet_str = TestHelper::GetSerializedPublishMessage(test_topic_base_,
+                                                                                          test_packet_id_,
+                                                                                          mqtt::QoS::QOS0,
+                                                                                          false,
+                                                                                          false,
+                                                                                          test_payload_);
+                p_network_connection_->SetNextReadBuf(TestHelper::GetSerializedSubAckMessage(test_packet_id_,
+                                                                                             suback_list)
+                                                          + publish_packet_str + publish_packet_str);
+                p_network_connection_->read_available_call_count_ = 0;
+
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_TRUE(p_subscription->IsActive());
+                EXPECT_EQ(2, callback_count);
+                EXPECT_EQ(1, p_network_connection_->read_available_call_count_);
+
+                // Packet split across reads is kept until the rest of it arrives
+                size_t split_offset = publish_packet_str.length() / 2;
+                p_network_connection_->SetNextReadBuf(publish_packet_str.substr(0, split_offset));
+                EXPECT_CALL(*p_network_mock_, ReadInternalProxy(::testing::_, ::testing::_, ::testing::_))
+                    .WillRepeatedly(::testing::Return(ResponseCode::NETWORK_SSL_NOTHING_TO_READ));
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::NETWORK_SSL_NOTHING_TO_READ, rc);
+                EXPECT_EQ(2, callback_count);
+
+                p_network_connection_->SetNextReadBuf(publish_packet_str.substr(split_offset));
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_EQ(3, callback_count);
+            }
+
+            TEST_F(SubUnsubActionTester, ReadThreadWakesUpOnIncomingDataTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                p_network_connection_->ClearNextReadBuf();
+                std::atomic_int callback_count(0);
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    [&callback_count](util::String topic_name, util::String payload,
+                                      std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        callback_count++;
+                        return ResponseCode::SUCCESS;
+                    };
+
+                std::shared_ptr<mqtt::Subscription> p_subscription =
+                    mqtt::Subscription::Create(Utf8String::Create(test_topic_base_), mqtt::QoS::QOS0, p_app_handler,
+                                               nullptr);
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                topic_vector.push_back(p_subscription);
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::vector<uint8_t> suback_list;
+                suback_list.push_back(0);
+                p_network_connection_->SetNextReadBuf(TestHelper::GetSerializedSubAckMessage(test_packet_id_,
+                                                                                             suback_list));
+                EXPECT_CALL(*p_network_mock_, ReadInternalProxy(::testing::_, ::testing::_, ::testing::_))
+                    .WillRepeatedly(::testing::Return(ResponseCode::NETWORK_SSL_NOTHING_TO_READ));
+
+                std::shared_ptr<std::atomic_bool> p_thread_continue = std::make_shared<std::atomic_bool>(true);
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+                p_network_read_action->SetParentThreadSync(p_thread_continue);
+                std::thread read_thread([this, &p_network_read_action] {
+                    p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                });
+
+                // Let the read thread go idle before data arrives
+                std::this_thread::sleep_for(std::chrono::milliseconds(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS / 2));
+
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                p_network_connection_->SetNextReadBuf(TestHelper::GetSerializedPublishMessage(test_topic_base_,
+                                                                                              test_packet_id_,
+                                                                                              mqtt::QoS::QOS0,
+                                                                                              false,
+                                                                                              false,
+                                                                                              test_payload_));
+                while (0 == callback_count
+                    && std::chrono::steady_clock::now() - start < std::chrono::milliseconds(1000)) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+
+                *p_thread_continue = false;
+                read_thread.join();
+
+                EXPECT_TRUE(p_subscription->IsActive());
+                EXPECT_EQ(1, callback_count);
+                // Delivery is not delayed until the end of a fixed sleep
+                EXPECT_GT(std::chrono::milliseconds(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS / 2), elapsed);
+            }
+
+            TEST_F(SubUnsubActionTester, ReadyActionHandlesAvailablePacketsTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                p_network_connection_->ClearNextReadBuf();
+                std::atomic_int callback_count(0);
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    [&callback_count](util::String topic_name, util::String payload,
+                                      std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        callback_count++;
+                        return ResponseCode::SUCCESS;
+                    };
+
+                std::shared_ptr<mqtt::Subscription> p_subscription =
+                    mqtt::Subscription::Create(Utf8String::Create(test_topic_base_), mqtt::QoS::QOS0, p_app_handler,
+                                               nullptr);
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                topic_vector.push_back(p_subscription);
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+                EXPECT_TRUE(p_network_read_action->IsReadinessDriven());
+
+                std::vector<uint8_t> suback_list;
+                suback_list.push_back(0);
+                util::String publish_packet_str = TestHelper::GetSerializedPublishMessage(test_topic_base_,
+                                                                                          test_packet_id_,
+                                                                                          mqtt::QoS::QOS0,
+                                                                                          false,
+                                                                                          false,
+                                                                                          test_payload_);
+                size_t split_offset = publish_packet_str.length() / 2;
+                p_network_connection_->SetNextReadBuf(TestHelper::GetSerializedSubAckMessage(test_packet_id_,
+                                                                                             suback_list)
+                                                          + publish_packet_str
+                                                          + publish_packet_str.substr(0, split_offset));
+
+                // Returns once the available bytes are handled instead of waiting for the rest of the packet
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                rc = p_network_read_action->PerformReadyAction(p_network_connection_, nullptr);
+                std::chrono::milliseconds elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now() - start);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_TRUE(p_subscription->IsActive());
+                EXPECT_EQ(1, callback_count);
+                EXPECT_GT(std::chrono::milliseconds(DEFAULT_CORE_THREAD_SLEEP_DURATION_MS / 2), elapsed);
+
+                p_network_connection_->SetNextReadBuf(publish_packet_str.substr(split_offset));
+                rc = p_network_read_action->PerformReadyAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_EQ(2, callback_count);
+            }
+
             TEST_F(SubUnsubActionTester, IncomingUnsubackOnSubscribedTopicTest) {
                 ASSERT_NE(nullptr, p_network_connection_);
                 ASSERT_NE(nullptr, p_core_state_);
@@ -736,7 +912,7 @@ namespace awsiotsdk {
                 srand(time(0));
 
                 for (unsigned int i = 0; i < VALID_WILDCARD_TOPICS; i++) {
-                    util::String randomly_generated_topic = {0};
+                    util::String randomly_generated_topic;
                     for (unsigned int j = 0; j < valid_wildcard_test_topics[i].length(); ++j) {
                         if (valid_wildcard_test_topics[i][j] != '+' &&
                             valid_wildcard_test_topics[i][j] != '#') {
@@ -759,6 +935,433 @@ namespace awsiotsdk {
                 }
             }
 
+            TEST_F(SubUnsubActionTester, OverlappingWildcardSubscriptionsTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                p_network_connection_->ClearNextReadBuf();
+                const util::String topic_filters[] = {"sport/tennis/player1", "sport/+/player1", "sport/#", "#"};
+                const size_t topic_filter_count = sizeof(topic_filters) / sizeof(topic_filters[0]);
+                std::atomic_int callback_counts[topic_filter_count];
+
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                std::vector<uint8_t> suback_list;
+                for (size_t i = 0; i < topic_filter_count; i++) {
+                    callback_counts[i] = 0;
+                    std::atomic_int *p_callback_count = &callback_counts[i];
+                    mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                        [p_callback_count](util::String topic_name, util::String payload,
+                                           std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                            (*p_callback_count)++;
+                            return ResponseCode::SUCCESS;
+                        };
+                    topic_vector.push_back(mqtt::Subscription::Create(Utf8String::Create(topic_filters[i]),
+                                                                      mqtt::QoS::QOS0, p_app_handler, nullptr));
+                    suback_list.push_back(0);
+                }
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                // Exact topic filter is preferred when a single subscription is requested
+                EXPECT_EQ(topic_vector[0], p_core_state_->GetSubscription("sport/tennis/player1"));
+                // # matches the parent level, wildcards never match reserved topics
+                EXPECT_EQ(nullptr, p_core_state_->GetSubscription("$aws/things/sport"));
+
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+                p_network_connection_->SetNextReadBuf(
+                    TestHelper::GetSerializedSubAckMessage(test_packet_id_, suback_list)
+                        + TestHelper::GetSerializedPublishMessage("sport/tennis/player1", test_packet_id_,
+                                                                  mqtt::QoS::QOS0, false, false, test_payload_)
+                        + TestHelper::GetSerializedPublishMessage("sport", test_packet_id_,
+                                                                  mqtt::QoS::QOS0, false, false, test_payload_)
+                        + TestHelper::GetSerializedPublishMessage("sport/golf/player2", test_packet_id_,
+                                                                  mqtt::QoS::QOS0, false, false, test_payload_));
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                EXPECT_EQ(1, callback_counts[0]);
+                EXPECT_EQ(1, callback_counts[1]);
+                EXPECT_EQ(3, callback_counts[2]);
+                EXPECT_EQ(3, callback_counts[3]);
+
+                // Removed filters stop matching, the rest of the index is unaffected
+                EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->RemoveSubscription("sport/#"));
+                util::Vector<std::shared_ptr<mqtt::Subscription>> matches;
+                p_core_state_->GetMatchingSubscriptions("sport/tennis/player1", matches);
+                EXPECT_EQ(3, static_cast<int>(matches.size()));
+                matches.clear();
+                p_core_state_->GetMatchingSubscriptions("sport", matches);
+                ASSERT_EQ(1, static_cast<int>(matches.size()));
+                EXPECT_EQ(topic_vector[3], matches[0]);
+            }
+
+            TEST_F(SubUnsubActionTester, IncomingPublishWithViewHandlerTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                p_network_connection_->ClearNextReadBuf();
+                std::shared_ptr<mqtt::Subscription> p_subscription = mqtt::Subscription::CreateWithViewHandler(
+                    Utf8String::Create(test_topic_base_), mqtt::QoS::QOS1, nullptr, nullptr);
+                EXPECT_EQ(nullptr, p_subscription);
+
+                util::Vector<util::String> received_topics;
+                util::Vector<util::String> received_payloads;
+                mqtt::Subscription::ApplicationViewCallbackHandlerPtr p_view_handler =
+                    [&received_topics, &received_payloads](const mqtt::MessageBufferView &topic_name,
+                                                           const mqtt::MessageBufferView &payload,
+                                                           std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        received_topics.push_back(topic_name.ToString());
+                        received_payloads.push_back(payload.ToString());
+                        return ResponseCode::SUCCESS;
+                    };
+                p_subscription = mqtt::Subscription::CreateWithViewHandler(nullptr, mqtt::QoS::QOS1, p_view_handler,
+                                                                           nullptr);
+                EXPECT_EQ(nullptr, p_subscription);
+                p_subscription = mqtt::Subscription::CreateWithViewHandler(Utf8String::Create("view/+"),
+                                                                           mqtt::QoS::QOS1, p_view_handler, nullptr);
+                ASSERT_NE(nullptr, p_subscription);
+
+                // String handlers on overlapping filters still receive their own copies
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    std::bind(&SubUnsubActionTester::SubscribeCallback,
+                              this,
+                              std::placeholders::_1,
+                              std::placeholders::_2,
+                              std::placeholders::_3);
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                topic_vector.push_back(p_subscription);
+                topic_vector.push_back(mqtt::Subscription::Create(Utf8String::Create("view/topic"), mqtt::QoS::QOS1,
+                                                                  p_app_handler, nullptr));
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::vector<uint8_t> suback_list;
+                suback_list.push_back(1);
+                suback_list.push_back(1);
+                cur_expected_topic_name_ = "view/topic";
+                callback_received_ = false;
+                p_network_connection_->SetNextReadBuf(
+                    TestHelper::GetSerializedSubAckMessage(test_packet_id_, suback_list)
+                        + TestHelper::GetSerializedPublishMessage("view/topic", test_packet_id_, mqtt::QoS::QOS1,
+                                                                  false, false, test_payload_)
+                        + TestHelper::GetSerializedPublishMessage("view/empty", test_packet_id_, mqtt::QoS::QOS0,
+                                                                  false, false, ""));
+
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_TRUE(callback_received_);
+                ASSERT_EQ(2U, received_payloads.size());
+                EXPECT_EQ("view/topic", received_topics[0]);
+                EXPECT_EQ(test_payload_, received_payloads[0]);
+                EXPECT_EQ("view/empty", received_topics[1]);
+                EXPECT_EQ("", received_payloads[1]);
+
+                // Queued messages are delivered to view handlers from the dispatcher's copy
+                std::shared_ptr<mqtt::InboundMessageDispatcher> p_dispatcher =
+                    mqtt::InboundMessageDispatcher::Create(DEFAULT_INBOUND_DISPATCH_WORKER_COUNT,
+                                                           DEFAULT_INBOUND_DISPATCH_MAX_QUEUE_SIZE,
+                                                           ActionQueueOverflowPolicy::REJECT,
+                                                           std::chrono::milliseconds(0));
+                p_core_state_->SetInboundDispatcher(p_dispatcher);
+                callback_received_ = false;
+                p_network_connection_->SetNextReadBuf(
+                    TestHelper::GetSerializedPublishMessage("view/topic", test_packet_id_, mqtt::QoS::QOS0,
+                                                            false, false, test_payload_));
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                p_dispatcher->Stop();
+                EXPECT_TRUE(callback_received_);
+                ASSERT_EQ(3U, received_payloads.size());
+                EXPECT_EQ("view/topic", received_topics[2]);
+                EXPECT_EQ(test_payload_, received_payloads[2]);
+                p_core_state_->SetInboundDispatcher(nullptr);
+            }
+
+            TEST_F(SubUnsubActionTester, SubscriptionRegistryConcurrentAccessStressTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                const int writer_thread_count = 4;
+                const int reader_thread_count = 4;
+                const int iterations_per_thread = 500;
+                const int publish_count = 200;
+                const util::String permanent_topic_filter = "stress/permanent/#";
+                const util::String permanent_topic = "stress/permanent/topic";
+
+                p_network_connection_->ClearNextReadBuf();
+                std::atomic_int callback_count(0);
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    [&callback_count](util::String topic_name, util::String payload,
+                                      std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        callback_count++;
+                        return ResponseCode::SUCCESS;
+                    };
+                std::shared_ptr<mqtt::Subscription> p_permanent_subscription =
+                    mqtt::Subscription::Create(Utf8String::Create(permanent_topic_filter), mqtt::QoS::QOS0,
+                                               p_app_handler, nullptr);
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                topic_vector.push_back(p_permanent_subscription);
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                // Incoming publishes are dispatched by the read runner while the registry is being modified
+                std::vector<uint8_t> suback_list;
+                suback_list.push_back(0);
+                util::String read_buf = TestHelper::GetSerializedSubAckMessage(test_packet_id_, suback_list);
+                for (int itr = 0; itr < publish_count; itr++) {
+                    read_buf += TestHelper::GetSerializedPublishMessage(permanent_topic, test_packet_id_,
+                                                                        mqtt::QoS::QOS0, false, false,
+                                                                        test_payload_);
+                }
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+                p_network_connection_->SetNextReadBuf(read_buf);
+
+                std::atomic_bool is_done(false);
+                util::Vector<std::thread> threads;
+                threads.push_back(std::thread([this, &p_network_read_action] {
+                    p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                }));
+
+                for (int thread_itr = 0; thread_itr < writer_thread_count; thread_itr++) {
+                    threads.push_back(std::thread([this, thread_itr, &p_app_handler] {
+                        for (int itr = 0; itr < iterations_per_thread; itr++) {
+                            util::String topic_filter = "stress/" + std::to_string(thread_itr) + "/"
+                                + std::to_string(itr % 8) + "/+";
+                            uint16_t packet_id = static_cast<uint16_t>(2000 + thread_itr * 1000 + itr % 8);
+                            std::shared_ptr<mqtt::Subscription> p_subscription =
+                                mqtt::Subscription::Create(Utf8String::Create(topic_filter), mqtt::QoS::QOS1,
+                                                           p_app_handler, nullptr);
+                            EXPECT_EQ(ResponseCode::SUCCESS, p_core_state_->AddSubscription(p_subscription));
+                            p_core_state_->SetSubscriptionPacketInfo(topic_filter, packet_id, 1);
+                            EXPECT_EQ(ResponseCode::SUCCESS,
+                                      p_core_state_->SetSubscriptionActive(packet_id, 1, mqtt::QoS::QOS1));
+                            EXPECT_TRUE(p_subscription->IsActive());
+                            if (0 == itr % 2) {
+                                p_core_state_->RemoveSubscription(topic_filter);
+                            } else {
+                                p_core_state_->SetSubscriptionPacketInfo(topic_filter, packet_id, 0);
+                                p_core_state_->RemoveAllSubscriptionsForPacketId(packet_id);
+                            }
+                        }
+                    }));
+                }
+
+                for (int thread_itr = 0; thread_itr < reader_thread_count; thread_itr++) {
+                    threads.push_back(std::thread([this, thread_itr, &is_done, &p_permanent_subscription,
+                                                      &permanent_topic] {
+                        std::shared_ptr<const mqtt::SubscriptionRegistry::Snapshot> p_snapshot;
+                        util::Vector<std::shared_ptr<mqtt::Subscription>> matches;
+                        util::String writer_topic = "stress/" + std::to_string(thread_itr) + "/1/topic";
+                        while (!is_done) {
+                            p_core_state_->RefreshSubscriptionSnapshot(p_snapshot);
+                            ASSERT_NE(nullptr, p_snapshot);
+
+                            matches.clear();
+                            p_snapshot->GetMatchingSubscriptions(permanent_topic, matches);
+                            ASSERT_EQ(1, static_cast<int>(matches.size()));
+                            EXPECT_EQ(p_permanent_subscription, matches[0]);
+
+                            matches.clear();
+                            p_snapshot->GetMatchingSubscriptions(writer_topic, matches);
+                            EXPECT_GE(1, static_cast<int>(matches.size()));
+                            for (auto &p_match : matches) {
+                                p_match->IsActive();
+                                EXPECT_EQ("stress/" + std::to_string(thread_itr) + "/1/+",
+                                          p_match->GetTopicName()->ToStdString());
+                            }
+                        }
+                    }));
+                }
+
+                for (int thread_itr = 0; thread_itr <= writer_thread_count; thread_itr++) {
+                    threads[thread_itr].join();
+                }
+                is_done = true;
+                for (size_t thread_itr = writer_thread_count + 1; thread_itr < threads.size(); thread_itr++) {
+                    threads[thread_itr].join();
+                }
+
+                EXPECT_EQ(publish_count, callback_count);
+                std::shared_ptr<const mqtt::SubscriptionRegistry::Snapshot>
+                    p_snapshot = p_core_state_->GetSubscriptionSnapshot();
+                ASSERT_EQ(1, static_cast<int>(p_snapshot->subscription_map_.size()));
+                EXPECT_EQ(p_permanent_subscription, p_snapshot->Find(permanent_topic_filter));
+                EXPECT_EQ(1, static_cast<int>(p_snapshot->subscription_trie_.Size()));
+            }
+
+            TEST_F(SubUnsubActionTester, InboundDispatcherSlowCallbackTest) {
+                ASSERT_NE(nullptr, p_network_connection_);
+                ASSERT_NE(nullptr, p_core_state_);
+
+                const int ordered_message_count = 20;
+                std::shared_ptr<mqtt::InboundMessageDispatcher> p_dispatcher =
+                    mqtt::InboundMessageDispatcher::Create(DEFAULT_INBOUND_DISPATCH_WORKER_COUNT,
+                                                           DEFAULT_INBOUND_DISPATCH_MAX_QUEUE_SIZE,
+                                                           ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT,
+                                                           std::chrono::milliseconds(1000));
+                p_core_state_->SetInboundDispatcher(p_dispatcher);
+
+                std::atomic_bool is_slow_callback_released(false);
+                std::atomic_bool is_slow_callback_running(false);
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_slow_handler =
+                    [&is_slow_callback_released, &is_slow_callback_running](util::String topic_name,
+                                                                             util::String payload,
+                                                                             std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        is_slow_callback_running = true;
+                        while (!is_slow_callback_released) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        return ResponseCode::SUCCESS;
+                    };
+                // Only accessed from the worker thread of this subscription
+                util::Vector<util::String> received_payloads;
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_ordered_handler =
+                    [&received_payloads](util::String topic_name, util::String payload,
+                                         std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        received_payloads.push_back(payload);
+                        return ResponseCode::SUCCESS;
+                    };
+
+                util::Vector<std::shared_ptr<mqtt::Subscription>> topic_vector;
+                topic_vector.push_back(mqtt::Subscription::Create(Utf8String::Create("slow/topic"), mqtt::QoS::QOS0,
+                                                                  p_slow_handler, nullptr));
+                topic_vector.push_back(mqtt::Subscription::Create(Utf8String::Create("ordered/topic"),
+                                                                  mqtt::QoS::QOS0, p_ordered_handler, nullptr));
+                ResponseCode rc = Subscribe(test_packet_id_, topic_vector);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+
+                std::vector<uint8_t> suback_list;
+                suback_list.push_back(0);
+                suback_list.push_back(0);
+                util::String read_buf = TestHelper::GetSerializedSubAckMessage(test_packet_id_, suback_list)
+                    + TestHelper::GetSerializedPublishMessage("slow/topic", test_packet_id_, mqtt::QoS::QOS0, false,
+                                                              false, test_payload_);
+                for (int itr = 0; itr < ordered_message_count; itr++) {
+                    read_buf += TestHelper::GetSerializedPublishMessage("ordered/topic", test_packet_id_,
+                                                                        mqtt::QoS::QOS0, false, false,
+                                                                        std::to_string(itr));
+                }
+                p_network_connection_->ClearNextReadBuf();
+                p_network_connection_->SetNextReadBuf(read_buf);
+
+                // All packets are read while the slow callback is still running
+                std::unique_ptr<Action> p_network_read_action = mqtt::NetworkReadActionRunner::Create(p_core_state_);
+                rc = p_network_read_action->PerformAction(p_network_connection_, nullptr);
+                EXPECT_EQ(ResponseCode::SUCCESS, rc);
+                EXPECT_FALSE(is_slow_callback_released);
+
+                mqtt::InboundDispatchStatistics statistics = p_dispatcher->GetStatistics();
+                EXPECT_EQ(static_cast<uint64_t>(ordered_message_count + 1), statistics.messages_queued_);
+                EXPECT_EQ(0u, statistics.messages_dropped_);
+
+                is_slow_callback_released = true;
+                p_dispatcher->Stop();
+                EXPECT_TRUE(is_slow_callback_running);
+                EXPECT_EQ(static_cast<uint64_t>(ordered_message_count + 1),
+                          p_dispatcher->GetStatistics().messages_delivered_);
+                ASSERT_EQ(static_cast<size_t>(ordered_message_count), received_payloads.size());
+                for (int itr = 0; itr < ordered_message_count; itr++) {
+                    EXPECT_EQ(std::to_string(itr), received_payloads[itr]);
+                }
+                p_core_state_->SetInboundDispatcher(nullptr);
+            }
+
+            TEST_F(SubUnsubActionTester, InboundDispatcherOverflowTest) {
+                std::atomic_bool is_callback_released(false);
+                std::atomic_bool is_callback_running(false);
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    [&is_callback_released, &is_callback_running](util::String topic_name, util::String payload,
+                                                                  std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        is_callback_running = true;
+                        while (!is_callback_released) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        return ResponseCode::SUCCESS;
+                    };
+                std::shared_ptr<mqtt::Subscription> p_subscription =
+                    mqtt::Subscription::Create(Utf8String::Create(test_topic_base_), mqtt::QoS::QOS0, p_app_handler,
+                                               nullptr);
+
+                std::shared_ptr<mqtt::InboundMessageDispatcher> p_dispatcher =
+                    mqtt::InboundMessageDispatcher::Create(1, 2, ActionQueueOverflowPolicy::REJECT,
+                                                           std::chrono::milliseconds(0));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "0"));
+                while (!is_callback_running) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                // Worker is busy, two messages fit in the queue
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "1"));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "2"));
+                EXPECT_EQ(ResponseCode::ACTION_QUEUE_FULL,
+                          p_dispatcher->Dispatch(p_subscription, test_topic_base_, "3"));
+
+                mqtt::InboundDispatchStatistics statistics = p_dispatcher->GetStatistics();
+                EXPECT_EQ(3u, statistics.messages_queued_);
+                EXPECT_EQ(1u, statistics.messages_dropped_);
+                EXPECT_EQ(2u, statistics.max_queue_depth_);
+                EXPECT_EQ(2u, statistics.queued_message_count_);
+
+                is_callback_released = true;
+                p_dispatcher->Stop();
+                EXPECT_EQ(3u, p_dispatcher->GetStatistics().messages_delivered_);
+                EXPECT_EQ(ResponseCode::FAILURE, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "4"));
+
+                // Blocking dispatch gives up once the timeout expires
+                is_callback_released = false;
+                is_callback_running = false;
+                p_dispatcher = mqtt::InboundMessageDispatcher::Create(1, 1,
+                                                                      ActionQueueOverflowPolicy::BLOCK_WITH_TIMEOUT,
+                                                                      std::chrono::milliseconds(10));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "0"));
+                while (!is_callback_running) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "1"));
+                EXPECT_EQ(ResponseCode::ACTION_QUEUE_FULL,
+                          p_dispatcher->Dispatch(p_subscription, test_topic_base_, "2"));
+                EXPECT_EQ(1u, p_dispatcher->GetStatistics().blocked_dispatch_count_);
+                is_callback_released = true;
+            }
+
+            // Test a callback can destroy the dispatcher it runs on, its worker is detached instead of joined
+            TEST_F(SubUnsubActionTester, InboundDispatcherDestroyedFromCallbackTest) {
+                std::atomic_bool is_callback_released(false);
+                std::atomic_bool is_dispatcher_destroyed(false);
+                std::atomic_int callback_count(0);
+                std::shared_ptr<mqtt::InboundMessageDispatcher> p_dispatcher =
+                    mqtt::InboundMessageDispatcher::Create(1, 2, ActionQueueOverflowPolicy::REJECT,
+                                                           std::chrono::milliseconds(0));
+                mqtt::Subscription::ApplicationCallbackHandlerPtr p_app_handler =
+                    [&is_callback_released, &is_dispatcher_destroyed, &callback_count, &p_dispatcher]
+                        (util::String topic_name, util::String payload,
+                         std::shared_ptr<mqtt::SubscriptionHandlerContextData> p_app_handler_data) {
+                        callback_count++;
+                        while (!is_callback_released) {
+                            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                        }
+                        // Last reference, the destructor runs on this worker
+                        p_dispatcher.reset();
+                        is_dispatcher_destroyed = true;
+                        return ResponseCode::SUCCESS;
+                    };
+                std::shared_ptr<mqtt::Subscription> p_subscription =
+                    mqtt::Subscription::Create(Utf8String::Create(test_topic_base_), mqtt::QoS::QOS0, p_app_handler,
+                                               nullptr);
+
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "0"));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_dispatcher->Dispatch(p_subscription, test_topic_base_, "1"));
+                is_callback_released = true;
+                while (!is_dispatcher_destroyed) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+
+                // The message still queued for the detached worker is not delivered
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                EXPECT_EQ(1, callback_count);
+            }
+
             TEST_F(SubUnsubActionTester, ClientSubscribeAndUnsubscribeErrorTest) {
                 EXPECT_NE(nullptr, p_network_connection_);
                 EXPECT_NE(nullptr, p_core_state_);
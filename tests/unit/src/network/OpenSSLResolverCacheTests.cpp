@@ -0,0 +1,276 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file OpenSSLResolverCacheTests.cpp
+ * @brief
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string.h>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "OpenSSLResolverCache.hpp"
+
+#define RESOLVER_TEST_ENDPOINT "resolver.test"
+#define RESOLVER_TEST_TIMEOUT std::chrono::milliseconds(1000)
+#define RESOLVER_TEST_SHORT_TIMEOUT std::chrono::milliseconds(20)
+
+namespace awsiotsdk {
+    namespace tests {
+        namespace unit {
+            /**
+             * @brief Resolver cache that returns one configured IPv4 address instead of using DNS
+             */
+            class ResolverCacheTestState : public network::OpenSSLResolverCache {
+            protected:
+                std::mutex lookup_lock_;
+                std::condition_variable release_wait_;
+
+                int LookupAddresses(const util::String &endpoint,
+                                    util::Vector<ResolvedAddress> &addresses_out) override {
+                    std::unique_lock<std::mutex> lookup_lock(lookup_lock_);
+                    lookup_count_++;
+                    uint32_t address = next_address_;
+                    int error = next_error_;
+                    if (0 < blocked_lookup_count_) {
+                        blocked_lookup_count_--;
+                        release_wait_.wait(lookup_lock, [this] { return is_released_; });
+                    }
+                    if (0 != error) {
+                        return error;
+                    }
+
+                    ResolvedAddress resolved_address;
+                    memset(&resolved_address.address_, 0, sizeof(resolved_address.address_));
+                    sockaddr_in *p_address = reinterpret_cast<sockaddr_in *>(&resolved_address.address_);
+                    p_address->sin_family = AF_INET;
+                    p_address->sin_addr.s_addr = htonl(address);
+                    resolved_address.address_length_ = sizeof(sockaddr_in);
+                    addresses_out.clear();
+                    addresses_out.push_back(resolved_address);
+                    return 0;
+                }
+
+            public:
+                std::atomic_int lookup_count_;    ///< Number of lookups run
+                uint32_t next_address_;           ///< Address returned by the next lookups
+                int next_error_;                  ///< Error returned by the next lookups, 0 for success
+                int blocked_lookup_count_;        ///< Number of next lookups that wait until released
+                bool is_released_;                ///< Boolean, True = blocked lookups return
+
+                using OpenSSLResolverCache::lookup_abandon_time_;
+                using OpenSSLResolverCache::resolver_threads_;
+                using OpenSSLResolverCache::StopResolverThreads;
+
+                ResolverCacheTestState() : lookup_count_(0) {
+                    next_address_ = 1;
+                    next_error_ = 0;
+                    blocked_lookup_count_ = 0;
+                    is_released_ = false;
+                }
+
+                void SetNextResult(uint32_t address, int error) {
+                    std::lock_guard<std::mutex> lookup_lock(lookup_lock_);
+                    next_address_ = address;
+                    next_error_ = error;
+                }
+
+                void BlockLookups(int count) {
+                    std::lock_guard<std::mutex> lookup_lock(lookup_lock_);
+                    blocked_lookup_count_ = count;
+                }
+
+                void ReleaseLookups() {
+                    {
+                        std::lock_guard<std::mutex> lookup_lock(lookup_lock_);
+                        is_released_ = true;
+                    }
+                    release_wait_.notify_all();
+                }
+
+                ~ResolverCacheTestState() {
+                    ReleaseLookups();
+                    StopResolverThreads();
+                }
+            };
+
+            class ResolverCacheTester : public ::testing::Test {
+            protected:
+                std::shared_ptr<ResolverCacheTestState> p_resolver_cache_;
+
+                ResolverCacheTester() {
+                    p_resolver_cache_ = std::make_shared<ResolverCacheTestState>();
+                }
+
+                static uint32_t GetAddress(const util::Vector<network::OpenSSLResolverCache::ResolvedAddress> &addresses) {
+                    if (1 != addresses.size()) {
+                        return 0;
+                    }
+                    return ntohl(reinterpret_cast<const sockaddr_in *>(&addresses[0].address_)->sin_addr.s_addr);
+                }
+            };
+
+            TEST_F(ResolverCacheTester, AddressesReusedWithinTimeToLive) {
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+
+                p_resolver_cache_->SetNextResult(2, 0);
+                addresses.clear();
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+                EXPECT_EQ(1, p_resolver_cache_->lookup_count_);
+            }
+
+            TEST_F(ResolverCacheTester, ResolvedAgainAfterTimeToLive) {
+                p_resolver_cache_->SetTimeToLive(std::chrono::milliseconds(20));
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+
+                p_resolver_cache_->SetNextResult(2, 0);
+                std::this_thread::sleep_for(std::chrono::milliseconds(40));
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(2U, GetAddress(addresses));
+                EXPECT_EQ(2, p_resolver_cache_->lookup_count_);
+            }
+
+            TEST_F(ResolverCacheTester, ExpiredAddressesUsedWhenLookupFails) {
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+
+                // Expire forces a new lookup, its failure falls back to the previous addresses
+                p_resolver_cache_->Expire(RESOLVER_TEST_ENDPOINT);
+                p_resolver_cache_->SetNextResult(2, EAI_NONAME);
+                addresses.clear();
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+                EXPECT_EQ(2, p_resolver_cache_->lookup_count_);
+
+                // Same for a lookup that does not finish in time
+                p_resolver_cache_->SetNextResult(3, 0);
+                p_resolver_cache_->BlockLookups(1);
+                addresses.clear();
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_SHORT_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+            }
+
+            TEST_F(ResolverCacheTester, UnknownHostWithoutPreviousAddresses) {
+                p_resolver_cache_->SetNextResult(1, EAI_NONAME);
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                EXPECT_EQ(ResponseCode::NETWORK_TCP_UNKNOWN_HOST,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_TRUE(addresses.empty());
+
+                // Failures are not cached
+                p_resolver_cache_->SetNextResult(1, 0);
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+            }
+
+            TEST_F(ResolverCacheTester, HungLookupAbandoned) {
+                p_resolver_cache_->lookup_abandon_time_ = std::chrono::milliseconds(50);
+                p_resolver_cache_->BlockLookups(1);
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                EXPECT_EQ(ResponseCode::NETWORK_TCP_UNKNOWN_HOST,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_SHORT_TIMEOUT, addresses));
+
+                // A young lookup is shared instead of being replaced
+                EXPECT_EQ(ResponseCode::NETWORK_TCP_UNKNOWN_HOST,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_SHORT_TIMEOUT, addresses));
+                EXPECT_EQ(1, p_resolver_cache_->lookup_count_);
+
+                std::this_thread::sleep_for(std::chrono::milliseconds(60));
+                p_resolver_cache_->SetNextResult(2, 0);
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(2U, GetAddress(addresses));
+                EXPECT_EQ(2, p_resolver_cache_->lookup_count_);
+
+                // The abandoned lookup finishing later does not replace the newer addresses
+                p_resolver_cache_->ReleaseLookups();
+                p_resolver_cache_->StopResolverThreads();
+                addresses.clear();
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(RESOLVER_TEST_ENDPOINT, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(2U, GetAddress(addresses));
+            }
+
+            TEST_F(ResolverCacheTester, ResolverThreadsBounded) {
+                p_resolver_cache_->BlockLookups(OPENSSL_DNS_RESOLVER_THREAD_COUNT + 1);
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                for (int itr = 0; itr < OPENSSL_DNS_RESOLVER_THREAD_COUNT + 1; itr++) {
+                    util::String endpoint = RESOLVER_TEST_ENDPOINT + std::to_string(itr);
+                    EXPECT_EQ(ResponseCode::NETWORK_TCP_UNKNOWN_HOST,
+                              p_resolver_cache_->Resolve(endpoint, RESOLVER_TEST_SHORT_TIMEOUT, addresses));
+                }
+                EXPECT_EQ(static_cast<size_t>(OPENSSL_DNS_RESOLVER_THREAD_COUNT),
+                          p_resolver_cache_->resolver_threads_.size());
+                EXPECT_EQ(OPENSSL_DNS_RESOLVER_THREAD_COUNT, p_resolver_cache_->lookup_count_);
+
+                // The queued lookup runs once a thread is free
+                p_resolver_cache_->ReleaseLookups();
+                util::String last_endpoint = RESOLVER_TEST_ENDPOINT + std::to_string(OPENSSL_DNS_RESOLVER_THREAD_COUNT);
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(last_endpoint, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(OPENSSL_DNS_RESOLVER_THREAD_COUNT + 1, p_resolver_cache_->lookup_count_);
+            }
+
+            TEST_F(ResolverCacheTester, HungLookupsDoNotBlockResolverThreads) {
+                p_resolver_cache_->lookup_abandon_time_ = std::chrono::milliseconds(50);
+                p_resolver_cache_->BlockLookups(OPENSSL_DNS_RESOLVER_THREAD_COUNT);
+                util::Vector<network::OpenSSLResolverCache::ResolvedAddress> addresses;
+                for (int itr = 0; itr < OPENSSL_DNS_RESOLVER_THREAD_COUNT; itr++) {
+                    util::String endpoint = RESOLVER_TEST_ENDPOINT + std::to_string(itr);
+                    EXPECT_EQ(ResponseCode::NETWORK_TCP_UNKNOWN_HOST,
+                              p_resolver_cache_->Resolve(endpoint, RESOLVER_TEST_SHORT_TIMEOUT, addresses));
+                }
+                EXPECT_EQ(OPENSSL_DNS_RESOLVER_THREAD_COUNT, p_resolver_cache_->lookup_count_);
+
+                // All threads are blocked in abandoned lookups, a new thread runs the next lookup
+                std::this_thread::sleep_for(std::chrono::milliseconds(60));
+                util::String next_endpoint = RESOLVER_TEST_ENDPOINT + std::to_string(OPENSSL_DNS_RESOLVER_THREAD_COUNT);
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(next_endpoint, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(1U, GetAddress(addresses));
+                EXPECT_EQ(static_cast<size_t>(OPENSSL_DNS_RESOLVER_THREAD_COUNT + 1),
+                          p_resolver_cache_->resolver_threads_.size());
+
+                // Once the hung lookups returned, the extra thread exits and is joined by the next lookup
+                p_resolver_cache_->ReleaseLookups();
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                util::String last_endpoint = RESOLVER_TEST_ENDPOINT + std::to_string(OPENSSL_DNS_RESOLVER_THREAD_COUNT + 1);
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_resolver_cache_->Resolve(last_endpoint, RESOLVER_TEST_TIMEOUT, addresses));
+                EXPECT_EQ(static_cast<size_t>(OPENSSL_DNS_RESOLVER_THREAD_COUNT),
+                          p_resolver_cache_->resolver_threads_.size());
+            }
+        }
+    }
+}
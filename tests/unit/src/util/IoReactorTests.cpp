@@ -0,0 +1,148 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file IoReactorTests.cpp
+ * @brief
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <gtest/gtest.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "util/threading/IoReactor.hpp"
+
+#define IO_REACTOR_TEST_POLL_INTERVAL_MS 20
+#define IO_REACTOR_TEST_MAX_WAIT_ITERATIONS 200
+
+namespace awsiotsdk {
+    namespace tests {
+        namespace unit {
+#ifdef __linux__
+            class IoReactorTester : public ::testing::Test {
+            protected:
+                /**
+                 * @brief Reads everything available from the read end of a pipe
+                 */
+                class PipeEventSource : public util::Threading::IoReactor::EventSource {
+                public:
+                    std::atomic_int fd_;
+                    std::atomic_int handled_count_;
+                    std::atomic_int read_bytes_;
+
+                    PipeEventSource(int fd) {
+                        fd_ = fd;
+                        handled_count_ = 0;
+                        read_bytes_ = 0;
+                    }
+
+                    int GetDescriptor() {
+                        return fd_;
+                    }
+
+                    void OnReadable() {
+                        char buf[16];
+                        ssize_t rc;
+                        while (0 < (rc = read(fd_, buf, sizeof(buf)))) {
+                            read_bytes_ += static_cast<int>(rc);
+                        }
+                        handled_count_++;
+                    }
+                };
+
+                int pipe_fds_[2];
+                std::shared_ptr<util::Threading::IoReactor> p_io_reactor_;
+
+                void SetUp() {
+                    ASSERT_EQ(0, pipe(pipe_fds_));
+                    ASSERT_EQ(0, fcntl(pipe_fds_[0], F_SETFL, fcntl(pipe_fds_[0], F_GETFL, 0) | O_NONBLOCK));
+                    p_io_reactor_ = util::Threading::IoReactor::Create(
+                        1, std::chrono::milliseconds(IO_REACTOR_TEST_POLL_INTERVAL_MS));
+                    ASSERT_NE(nullptr, p_io_reactor_);
+                }
+
+                void TearDown() {
+                    p_io_reactor_ = nullptr;
+                    close(pipe_fds_[0]);
+                    close(pipe_fds_[1]);
+                }
+
+                void WriteToPipe(const char *p_data, size_t length) {
+                    ASSERT_EQ(static_cast<ssize_t>(length), write(pipe_fds_[1], p_data, length));
+                }
+
+                static void WaitForReadBytes(PipeEventSource &source, int read_bytes) {
+                    for (int itr = 0; itr < IO_REACTOR_TEST_MAX_WAIT_ITERATIONS && read_bytes > source.read_bytes_;
+                         itr++) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                }
+            };
+
+            TEST_F(IoReactorTester, ReadableSourceIsHandledAgainAfterEachEvent) {
+                std::shared_ptr<PipeEventSource> p_source = std::make_shared<PipeEventSource>(pipe_fds_[0]);
+                EXPECT_EQ(ResponseCode::SUCCESS, p_io_reactor_->Register(p_source));
+                EXPECT_EQ(1U, p_io_reactor_->GetRegisteredCount());
+
+                WriteToPipe("abc", 3);
+                WaitForReadBytes(*p_source, 3);
+                EXPECT_EQ(3, p_source->read_bytes_);
+
+                // Source is armed again once its handler returned
+                WriteToPipe("de", 2);
+                WaitForReadBytes(*p_source, 5);
+                EXPECT_EQ(5, p_source->read_bytes_);
+                EXPECT_LE(2, p_source->handled_count_);
+
+                EXPECT_EQ(ResponseCode::SUCCESS, p_io_reactor_->Unregister(p_source));
+                EXPECT_EQ(0U, p_io_reactor_->GetRegisteredCount());
+                EXPECT_EQ(ResponseCode::NULL_VALUE_ERROR, p_io_reactor_->Unregister(p_source));
+
+                // Not handled after unregistering
+                int handled_count = p_source->handled_count_;
+                WriteToPipe("f", 1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(5 * IO_REACTOR_TEST_POLL_INTERVAL_MS));
+                EXPECT_EQ(handled_count, p_source->handled_count_);
+                EXPECT_EQ(5, p_source->read_bytes_);
+            }
+
+            TEST_F(IoReactorTester, ChangedDescriptorIsPickedUp) {
+                // Like a network connection that is not connected yet
+                std::shared_ptr<PipeEventSource> p_source = std::make_shared<PipeEventSource>(-1);
+                EXPECT_EQ(ResponseCode::SUCCESS, p_io_reactor_->Register(p_source));
+
+                WriteToPipe("abc", 3);
+                std::this_thread::sleep_for(std::chrono::milliseconds(2 * IO_REACTOR_TEST_POLL_INTERVAL_MS));
+                EXPECT_EQ(0, p_source->handled_count_);
+
+                p_source->fd_ = pipe_fds_[0];
+                WaitForReadBytes(*p_source, 3);
+                EXPECT_EQ(3, p_source->read_bytes_);
+
+                p_io_reactor_->Stop();
+                EXPECT_EQ(ResponseCode::FAILURE, p_io_reactor_->Register(std::make_shared<PipeEventSource>(-1)));
+                EXPECT_EQ(ResponseCode::SUCCESS, p_io_reactor_->Unregister(p_source));
+            }
+#endif
+        }
+    }
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file TimerServiceTests.cpp
+ * @brief
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "util/memory/stl/Vector.hpp"
+#include "util/threading/TimerService.hpp"
+#include "util/threading/WorkStealingExecutor.hpp"
+
+#define TIMER_TEST_MAX_WAIT_ITERATIONS 200
+
+namespace awsiotsdk {
+    namespace tests {
+        namespace unit {
+            class TimerServiceTester : public ::testing::Test {
+            protected:
+                static void WaitForCount(std::atomic_int &count, int expected_count) {
+                    for (int itr = 0; itr < TIMER_TEST_MAX_WAIT_ITERATIONS && expected_count > count; itr++) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                }
+            };
+
+            TEST_F(TimerServiceTester, CallbacksRunInDeadlineOrder) {
+                std::shared_ptr<util::Threading::TimerService>
+                    p_timer_service = util::Threading::TimerService::Create(nullptr);
+                ASSERT_NE(nullptr, p_timer_service);
+                EXPECT_EQ(0U, p_timer_service->Schedule(std::chrono::steady_clock::now(), nullptr));
+
+                std::mutex order_lock;
+                util::Vector<int> order;
+                std::atomic_int run_count(0);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::time_point last_run_time;
+                auto record = [&order_lock, &order, &run_count, &last_run_time](int index) {
+                    std::lock_guard<std::mutex> lock(order_lock);
+                    order.push_back(index);
+                    last_run_time = std::chrono::steady_clock::now();
+                    run_count++;
+                };
+                EXPECT_NE(0U, p_timer_service->Schedule(start + std::chrono::milliseconds(60), [&record] { record(3); }));
+                EXPECT_NE(0U, p_timer_service->Schedule(start + std::chrono::milliseconds(30), [&record] { record(2); }));
+                // Past deadlines are due right away
+                EXPECT_NE(0U, p_timer_service->Schedule(start - std::chrono::milliseconds(10), [&record] { record(1); }));
+
+                WaitForCount(run_count, 3);
+                ASSERT_EQ(3, run_count);
+                EXPECT_EQ(1, order[0]);
+                EXPECT_EQ(2, order[1]);
+                EXPECT_EQ(3, order[2]);
+                EXPECT_LE(std::chrono::milliseconds(60),
+                          std::chrono::duration_cast<std::chrono::milliseconds>(last_run_time - start));
+                EXPECT_EQ(0U, p_timer_service->GetPendingTimerCount());
+            }
+
+            TEST_F(TimerServiceTester, CancelledTimersDoNotRun) {
+                std::shared_ptr<util::Threading::TimerService>
+                    p_timer_service = util::Threading::TimerService::Create(nullptr);
+                ASSERT_NE(nullptr, p_timer_service);
+
+                std::atomic_int run_count(0);
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                util::Threading::TimerService::TimerId cancelled_timer_id
+                    = p_timer_service->Schedule(now + std::chrono::milliseconds(20), [&run_count] { run_count += 100; });
+                p_timer_service->Schedule(now + std::chrono::milliseconds(40), [&run_count] { run_count++; });
+                EXPECT_EQ(2U, p_timer_service->GetPendingTimerCount());
+                EXPECT_TRUE(p_timer_service->Cancel(cancelled_timer_id));
+                EXPECT_FALSE(p_timer_service->Cancel(cancelled_timer_id));
+
+                WaitForCount(run_count, 1);
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                EXPECT_EQ(1, run_count);
+
+                // Cancelling a running timer waits for its callback to return
+                std::atomic_bool is_callback_started(false);
+                std::atomic_bool is_callback_done(false);
+                util::Threading::TimerService::TimerId running_timer_id
+                    = p_timer_service->Schedule(std::chrono::steady_clock::now(),
+                                                [&is_callback_started, &is_callback_done] {
+                                                    is_callback_started = true;
+                                                    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                                                    is_callback_done = true;
+                                                });
+                for (int itr = 0; itr < TIMER_TEST_MAX_WAIT_ITERATIONS && !is_callback_started; itr++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                }
+                EXPECT_FALSE(p_timer_service->Cancel(running_timer_id));
+                EXPECT_TRUE(is_callback_done);
+            }
+
+            TEST_F(TimerServiceTester, CallbacksRunOnExecutor) {
+                std::shared_ptr<util::Threading::WorkStealingExecutor>
+                    p_executor = util::Threading::WorkStealingExecutor::Create(2);
+                std::shared_ptr<util::Threading::TimerService>
+                    p_timer_service = util::Threading::TimerService::Create(p_executor);
+                ASSERT_NE(nullptr, p_timer_service);
+
+                // A blocking callback does not hold up the next timer
+                std::atomic_int run_count(0);
+                std::atomic_bool is_blocked(true);
+                std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+                p_timer_service->Schedule(now, [&is_blocked] {
+                    for (int itr = 0; itr < TIMER_TEST_MAX_WAIT_ITERATIONS && is_blocked; itr++) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                });
+                p_timer_service->Schedule(now + std::chrono::milliseconds(10), [&run_count] { run_count++; });
+                WaitForCount(run_count, 1);
+                EXPECT_EQ(1, run_count);
+                is_blocked = false;
+
+                // Pending timers are dropped when the service stops
+                p_timer_service->Schedule(now + std::chrono::milliseconds(10000), [&run_count] { run_count++; });
+                p_timer_service->Stop();
+                EXPECT_EQ(0U, p_timer_service->GetPendingTimerCount());
+                EXPECT_EQ(0U, p_timer_service->Schedule(now, [&run_count] { run_count++; }));
+                EXPECT_EQ(1, run_count);
+            }
+        }
+    }
+}
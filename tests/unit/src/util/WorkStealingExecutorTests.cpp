@@ -0,0 +1,137 @@
+/*
+ * Copyright 2010-2017 Amazon.com, Inc. or its affiliates. All Rights Reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License").
+ * You may not use this file except in compliance with the License.
+ * A copy of the License is located at
+ *
+ *  http://aws.amazon.com/apache2.0
+ *
+ * or in the "license" file accompanying this file. This file is distributed
+ * on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either
+ * express or implied. See the License for the specific language governing
+ * permissions and limitations under the License.
+ */
+
+/**
+ * @file WorkStealingExecutorTests.cpp
+ * @brief
+ *
+ */
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <gtest/gtest.h>
+
+#include "util/memory/stl/Vector.hpp"
+#include "util/threading/WorkStealingExecutor.hpp"
+
+#define EXECUTOR_TEST_MAX_WAIT_ITERATIONS 200
+
+namespace awsiotsdk {
+    namespace tests {
+        namespace unit {
+            class WorkStealingExecutorTester : public ::testing::Test {
+            protected:
+                static void WaitForCount(std::atomic_int &count, int expected_count) {
+                    for (int itr = 0; itr < EXECUTOR_TEST_MAX_WAIT_ITERATIONS && expected_count > count; itr++) {
+                        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                    }
+                }
+            };
+
+            TEST_F(WorkStealingExecutorTester, SubmittedTasksAreRun) {
+                std::shared_ptr<util::Threading::WorkStealingExecutor>
+                    p_executor = util::Threading::WorkStealingExecutor::Create(2);
+                ASSERT_NE(nullptr, p_executor);
+                EXPECT_EQ(2U, p_executor->GetWorkerCount());
+                EXPECT_EQ(ResponseCode::NULL_VALUE_ERROR, p_executor->Submit(nullptr));
+
+                std::atomic_int run_count(0);
+                for (int itr = 0; itr < 100; itr++) {
+                    EXPECT_EQ(ResponseCode::SUCCESS, p_executor->Submit([&run_count] {
+                        run_count++;
+                    }));
+                }
+                WaitForCount(run_count, 100);
+                EXPECT_EQ(100, run_count);
+
+                // Sized from the hardware by default
+                std::shared_ptr<util::Threading::WorkStealingExecutor>
+                    p_default_executor = util::Threading::WorkStealingExecutor::Create(0);
+                ASSERT_NE(nullptr, p_default_executor);
+                EXPECT_LE(1U, p_default_executor->GetWorkerCount());
+            }
+
+            TEST_F(WorkStealingExecutorTester, IdleWorkerStealsQueuedTasks) {
+                std::shared_ptr<util::Threading::WorkStealingExecutor>
+                    p_executor = util::Threading::WorkStealingExecutor::Create(2);
+                ASSERT_NE(nullptr, p_executor);
+
+                // Tasks submitted by a task are queued on its own worker, which stays busy until they have run
+                std::atomic_int run_count(0);
+                std::atomic_bool is_waiting_done(false);
+                std::shared_ptr<util::Threading::WorkStealingExecutor> p_task_executor = p_executor;
+                EXPECT_EQ(ResponseCode::SUCCESS, p_executor->Submit([p_task_executor, &run_count, &is_waiting_done] {
+                    for (int itr = 0; itr < 4; itr++) {
+                        p_task_executor->Submit([&run_count] {
+                            run_count++;
+                        });
+                    }
+                    WaitForCount(run_count, 4);
+                    is_waiting_done = true;
+                }));
+
+                for (int itr = 0; itr < EXECUTOR_TEST_MAX_WAIT_ITERATIONS && !is_waiting_done; itr++) {
+                    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                }
+                EXPECT_TRUE(is_waiting_done);
+                EXPECT_EQ(4, run_count);
+                EXPECT_LE(4U, p_executor->GetStolenTaskCount());
+            }
+
+            TEST_F(WorkStealingExecutorTester, DelayedTasksRunInDueOrder) {
+                std::shared_ptr<util::Threading::WorkStealingExecutor>
+                    p_executor = util::Threading::WorkStealingExecutor::Create(1);
+                ASSERT_NE(nullptr, p_executor);
+
+                std::mutex order_lock;
+                util::Vector<int> order;
+                std::atomic_int run_count(0);
+                std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+                std::chrono::steady_clock::time_point last_run_time;
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_executor->SubmitAfter(std::chrono::milliseconds(60),
+                                                  [&order_lock, &order, &run_count, &last_run_time] {
+                                                      std::lock_guard<std::mutex> lock(order_lock);
+                                                      order.push_back(2);
+                                                      last_run_time = std::chrono::steady_clock::now();
+                                                      run_count++;
+                                                  }));
+                EXPECT_EQ(ResponseCode::SUCCESS,
+                          p_executor->SubmitAfter(std::chrono::milliseconds(20), [&order_lock, &order, &run_count] {
+                              std::lock_guard<std::mutex> lock(order_lock);
+                              order.push_back(1);
+                              run_count++;
+                          }));
+                WaitForCount(run_count, 2);
+                ASSERT_EQ(2, run_count);
+                EXPECT_EQ(1, order[0]);
+                EXPECT_EQ(2, order[1]);
+                EXPECT_LE(std::chrono::milliseconds(60),
+                          std::chrono::duration_cast<std::chrono::milliseconds>(last_run_time - start));
+
+                // Delayed tasks are dropped when the executor stops
+                EXPECT_EQ(ResponseCode::SUCCESS, p_executor->SubmitAfter(std::chrono::milliseconds(10000), [&run_count] {
+                    run_count++;
+                }));
+                p_executor->Stop();
+                EXPECT_EQ(ResponseCode::FAILURE, p_executor->Submit([] {}));
+                EXPECT_EQ(ResponseCode::FAILURE, p_executor->SubmitAfter(std::chrono::milliseconds(10), [] {}));
+                EXPECT_EQ(2, run_count);
+            }
+        }
+    }
+}